@@ -0,0 +1,247 @@
+// NOTE(leo): CPU opponent. Instead of simulating the ball forward tick by tick, it computes
+// where the ball will cross the paddle's x in closed form: the ball moves in a straight
+// line, and bouncing between the top and the bottom walls is the same as moving in a
+// straight line through mirrored copies of the court, so the intercept is folded back into
+// the court with one floor. That's O(1) per tick no matter how far away the ball is.
+//
+// The AI only presses keys, so the paddle goes through the same acceleration model as a
+// human's, and replays and netplay don't need to know the player is a CPU. Difficulty comes
+// from how late it sees the ball (reaction delay) and how wrong its prediction is (noise),
+// not from slowing the paddle down.
+
+// NOTE(leo): Power of two, the reaction delay can't be longer than this.
+#define AI_OBSERVATIONS_CAPACITY 32
+
+// ===========================================================================================
+
+typedef enum
+{
+    AI_EASY,
+    AI_MEDIUM,
+    AI_HARD,
+
+    AI_DIFFICULTIES_COUNT
+
+} AiDifficulty;
+
+typedef struct
+{
+    // NOTE(leo): In ticks. The AI sees the ball as it was this many ticks ago.
+    u32 reaction_delay_ticks;
+
+    // NOTE(leo): The largest prediction error, in screen units, for a ball a second or more
+    // away. It shrinks to half of that as the ball gets closer, like a human's read of a
+    // shot improves.
+    f32 prediction_noise;
+
+    // NOTE(leo): How close to the predicted intercept is close enough.
+    f32 dead_zone;
+
+} AiSettings;
+
+typedef struct
+{
+    b32            is_right_paddle;
+    AiSettings     settings;
+    pcg32_random_t rng;
+
+    Entity observed_balls[AI_OBSERVATIONS_CAPACITY];
+    u64    observations_count;
+
+    // NOTE(leo): Drawn once per approach of the ball, so the paddle doesn't shake.
+    b32 is_tracking;
+    f32 noise_offset;
+
+} AiPlayer;
+
+// ===========================================================================================
+
+GLOBAL AiSettings g_ai_settings[AI_DIFFICULTIES_COUNT] = {
+    {18, 0.30f, 0.030f}, // NOTE(leo): AI_EASY
+    {10, 0.16f, 0.020f}, // NOTE(leo): AI_MEDIUM
+    {4, 0.06f, 0.010f},  // NOTE(leo): AI_HARD
+};
+
+GLOBAL String8 g_ai_difficulty_names[AI_DIFFICULTIES_COUNT] = {
+    STRING8_LITERAL("easy"),
+    STRING8_LITERAL("medium"),
+    STRING8_LITERAL("hard"),
+};
+
+// ===========================================================================================
+
+// NOTE(leo): Returns false if the name isn't a difficulty.
+INTERNAL b32
+ai_difficulty_from_name(String8 name, AiDifficulty *difficulty)
+{
+    for(u32 i = 0; i < AI_DIFFICULTIES_COUNT; ++i)
+    {
+        if(str8_equals(name, g_ai_difficulty_names[i]))
+        {
+            *difficulty = (AiDifficulty)i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// NOTE(leo): The AI has its own RNG, so that it doesn't change the match's random sequence.
+// This one takes any settings, not only the difficulties' (the tournament runner's AIs).
+INTERNAL void
+ai_init_with_settings(AiPlayer  *ai,
+                      b32        is_right_paddle,
+                      AiSettings settings,
+                      u64        rng_state,
+                      u64        rng_sequence)
+{
+    ASSERT(settings.reaction_delay_ticks < AI_OBSERVATIONS_CAPACITY);
+
+    memset(ai, 0, sizeof(*ai));
+
+    ai->is_right_paddle = is_right_paddle;
+    ai->settings        = settings;
+
+    pcg32_srandom_r(&ai->rng, rng_state, rng_sequence);
+}
+
+INTERNAL void
+ai_init(AiPlayer    *ai,
+        b32          is_right_paddle,
+        AiDifficulty difficulty,
+        u64          rng_state,
+        u64          rng_sequence)
+{
+    ASSERT(difficulty < AI_DIFFICULTIES_COUNT);
+
+    ai_init_with_settings(ai,
+                          is_right_paddle,
+                          g_ai_settings[difficulty],
+                          rng_state,
+                          rng_sequence);
+}
+
+// NOTE(leo): Forgets what it saw, for when the match jumps (a rewind, for example).
+INTERNAL void
+ai_reset(AiPlayer *ai)
+{
+    ai->observations_count = 0;
+    ai->is_tracking        = false;
+}
+
+// NOTE(leo): Unfolds the bounces off the top and bottom walls: the court repeats every two
+// heights, mirrored every other height.
+INTERNAL f32
+ai_fold_into_court(f32 y)
+{
+    f32 height = BALL_AT_TOP - BALL_AT_BOTTOM;
+    f32 period = 2.0f * height;
+    f32 offset = (y - BALL_AT_BOTTOM) / period;
+
+    // NOTE(leo): floor, without the C runtime.
+    s32 periods = (s32)offset;
+
+    if((f32)periods > offset)
+    {
+        periods--;
+    }
+
+    offset = (y - BALL_AT_BOTTOM) - ((f32)periods * period);
+
+    if(offset > height)
+    {
+        offset = period - offset;
+    }
+
+    return BALL_AT_BOTTOM + offset;
+}
+
+// NOTE(leo): Where the ball will be in y when it reaches x, and in how many seconds. Assumes
+// the ball is moving towards x.
+INTERNAL f32
+ai_predict_intercept_y(Entity *ball, f32 x, f32 *seconds_to_intercept)
+{
+    f32 seconds = (x - real_to_f32(ball->position.x)) / real_to_f32(ball->velocity.x);
+
+    if(seconds < 0.0f)
+    {
+        seconds = 0.0f;
+    }
+
+    *seconds_to_intercept = seconds;
+
+    f32 y = real_to_f32(ball->position.y) + (real_to_f32(ball->velocity.y) * seconds);
+
+    return ai_fold_into_court(y);
+}
+
+// NOTE(leo): Called once per tick, before game_update, with the input the tick will run
+// with. Overwrites the keys of the AI's paddle.
+INTERNAL void
+ai_update(AiPlayer *ai, GameState *game_state, f32 last_frame_time_seconds, GameInput *input)
+{
+    u64 observation = ai->observations_count++;
+
+    ai->observed_balls[observation & (AI_OBSERVATIONS_CAPACITY - 1)] = game_state->ball;
+
+    u32 delay = ai->settings.reaction_delay_ticks;
+    u64 seen  = observation >= delay ? observation - delay : 0;
+
+    Entity *ball   = &ai->observed_balls[seen & (AI_OBSERVATIONS_CAPACITY - 1)];
+    Entity *paddle    = &game_state->left_paddle;
+    f32     contact_x = BALL_AT_LEFT_PADDLE;
+
+    if(ai->is_right_paddle)
+    {
+        paddle    = &game_state->right_paddle;
+        contact_x = BALL_AT_RIGHT_PADDLE;
+    }
+
+    b32 is_ball_coming = ai->is_right_paddle ? ball->velocity.x > REAL(0.0f)
+                                             : ball->velocity.x < REAL(0.0f);
+
+    // NOTE(leo): With nothing to return, wait in the middle.
+    f32 target_y = 0.0f;
+
+    if(game_state->match_started && is_ball_coming)
+    {
+        if(!ai->is_tracking)
+        {
+            ai->is_tracking  = true;
+            ai->noise_offset = ((random_f32_0_1(&ai->rng) * 2.0f) - 1.0f)
+                             * ai->settings.prediction_noise;
+        }
+
+        f32 seconds_to_intercept;
+        target_y = ai_predict_intercept_y(ball, contact_x, &seconds_to_intercept);
+
+        target_y += ai->noise_offset * (0.5f + (0.5f * MIN(seconds_to_intercept, 1.0f)));
+    }
+    else
+    {
+        ai->is_tracking = false;
+    }
+
+    int up_key   = ai->is_right_paddle ? KEY_UP : KEY_W;
+    int down_key = ai->is_right_paddle ? KEY_DOWN : KEY_S;
+
+    input->is_key_down[up_key]   = false;
+    input->is_key_down[down_key] = false;
+
+    // NOTE(leo): Letting go stops the paddle at once, so the only way to overshoot is to
+    // keep the key down when the next step goes past the target.
+    f32 distance  = target_y - real_to_f32(paddle->position.y);
+    f32 velocity  = real_to_f32(paddle->velocity.y);
+    f32 speed     = velocity < 0.0f ? -velocity : velocity;
+    f32 next_step = (speed + (PADDLE_ACCELERATION * last_frame_time_seconds))
+                  * last_frame_time_seconds;
+
+    if(distance > ai->settings.dead_zone && distance > next_step * 0.5f)
+    {
+        input->is_key_down[up_key] = true;
+    }
+    else if(distance < -ai->settings.dead_zone && -distance > next_step * 0.5f)
+    {
+        input->is_key_down[down_key] = true;
+    }
+}
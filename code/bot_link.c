@@ -0,0 +1,261 @@
+// NOTE(leo): Lets bots written as separate programs play a paddle through a segment of shared
+// memory. The game (the host) publishes the state after every tick and a bot answers with
+// the keys it wants for the next one. Nothing on either side makes a system call per tick:
+// both only read and write the segment and spin while they wait.
+//
+// The state is published under a seqlock: the host makes the sequence odd, writes, and makes
+// it even again, and a reader copies the state and retries if the sequence changed or was
+// odd. The host never waits for readers, and readers never block the host.
+//
+// Each paddle has a mailbox, a single word with the tick an action is for and the action, so
+// a bot submits with one store and the host takes it with one load. In tick synchronous mode
+// the host doesn't simulate a tick until every bot playing has answered it, so a slow bot
+// slows the match down instead of missing ticks.
+
+#define BOT_LINK_MAGIC   0x544F4250 // NOTE(leo): "PBOT" in little endian.
+#define BOT_LINK_VERSION 1
+
+#define BOT_LINK_DEFAULT_NAME "pong_bot"
+
+#define BOT_ACTION_STAY 0
+#define BOT_ACTION_UP   1
+#define BOT_ACTION_DOWN 2
+
+#define BOT_ACTION_BITS 8
+
+// NOTE(leo): How long the host waits for a bot in tick synchronous mode before giving up on
+// that tick, in spins. A pause is somewhere between 10 and 150 cycles depending on the CPU,
+// and every BOT_LINK_SPINS_PER_YIELD spins it yields instead, so this is from a few
+// milliseconds to a fraction of a second.
+#define BOT_LINK_DEFAULT_MAX_SPINS (1 << 20)
+
+// NOTE(leo): Power of two.
+#define BOT_LINK_SPINS_PER_YIELD 256
+
+// ===========================================================================================
+
+// NOTE(leo): Written by the bot only. Zero until the bot answers for the first time,
+// otherwise ((tick + 1) << BOT_ACTION_BITS) | action.
+typedef struct __attribute__((aligned(64)))
+{
+    u64 action;
+
+} BotMailbox;
+
+// NOTE(leo): The layout of the segment. Both sides are built from this file, which the
+// version guards. The parts written by different processes are on different cache lines.
+typedef struct
+{
+    // NOTE(leo): Written by the host before any bot can attach, then only is_closed changes.
+    u32 magic;
+    u32 version;
+    u32 game_state_size;
+    b32 is_tick_synchronous;
+    b32 is_bot_playing[2];
+    b32 is_closed;
+
+    // NOTE(leo): The seqlock, and what it protects. tick is the tick the published state is
+    // the state before, so it's the tick the bots answer for.
+    __attribute__((aligned(64))) u32 sequence;
+    u64       tick;
+    GameState game_state;
+
+    BotMailbox mailboxes[2];
+
+} BotLink;
+
+// ===========================================================================================
+
+// NOTE(leo): Called with the number of spins so far. Once in a while it yields instead of
+// pausing: with fewer cores than spinning processes, the other side could otherwise only run
+// when the scheduler preempts this one.
+INTERNAL void
+bot_link_pause(u64 spin)
+{
+    if((spin & (BOT_LINK_SPINS_PER_YIELD - 1)) == BOT_LINK_SPINS_PER_YIELD - 1)
+    {
+        os_yield_processor();
+    }
+    else
+    {
+        __builtin_ia32_pause();
+    }
+}
+
+// NOTE(leo): The segment must be zeroed. The paddles that aren't played by bots stay with
+// the host's own input. The magic goes last, a bot that sees it sees the rest of the header.
+INTERNAL void
+bot_link_host_init(BotLink *link, b32 is_left_bot, b32 is_right_bot, b32 is_tick_synchronous)
+{
+    link->version             = BOT_LINK_VERSION;
+    link->game_state_size     = sizeof(GameState);
+    link->is_tick_synchronous = is_tick_synchronous;
+    link->is_bot_playing[0]   = is_left_bot;
+    link->is_bot_playing[1]   = is_right_bot;
+
+    __atomic_store_n(&link->magic, BOT_LINK_MAGIC, __ATOMIC_RELEASE);
+}
+
+// NOTE(leo): Whether the host on the other side was built from the same code.
+INTERNAL b32
+bot_link_is_compatible(BotLink *link)
+{
+    return link->magic == BOT_LINK_MAGIC && link->version == BOT_LINK_VERSION
+        && link->game_state_size == sizeof(GameState);
+}
+
+// NOTE(leo): Host only. game_state is the state before tick.
+INTERNAL void
+bot_link_publish(BotLink *link, GameState *game_state, u64 tick)
+{
+    u32 sequence = link->sequence;
+
+    __atomic_store_n(&link->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    link->tick       = tick;
+    link->game_state = *game_state;
+
+    __atomic_store_n(&link->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+// NOTE(leo): Bot side. Returns the tick of the state copied.
+INTERNAL u64
+bot_link_read(BotLink *link, GameState *game_state)
+{
+    for(u64 spin = 0;; ++spin)
+    {
+        u32 sequence = __atomic_load_n(&link->sequence, __ATOMIC_ACQUIRE);
+
+        if(!(sequence & 1))
+        {
+            u64 tick    = link->tick;
+            *game_state = link->game_state;
+
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+            if(__atomic_load_n(&link->sequence, __ATOMIC_RELAXED) == sequence)
+            {
+                return tick;
+            }
+        }
+
+        bot_link_pause(spin);
+    }
+}
+
+// NOTE(leo): Bot side. Spins until the host publishes a tick after last_tick (pass U64_MAX
+// before the first one) or closes the link. Returns false when it closed.
+INTERNAL b32
+bot_link_wait_for_tick(BotLink *link, u64 last_tick)
+{
+    for(u64 spin = 0; !__atomic_load_n(&link->is_closed, __ATOMIC_ACQUIRE); ++spin)
+    {
+        // NOTE(leo): Only a hint, bot_link_read gets the state and its tick consistently.
+        if(__atomic_load_n(&link->sequence, __ATOMIC_ACQUIRE)
+           && __atomic_load_n(&link->tick, __ATOMIC_RELAXED) != last_tick)
+        {
+            return true;
+        }
+
+        bot_link_pause(spin);
+    }
+
+    return false;
+}
+
+// NOTE(leo): Bot side. player is 0 for the left paddle and 1 for the right one.
+INTERNAL void
+bot_link_submit(BotLink *link, u32 player, u64 tick, u32 action)
+{
+    u64 word = ((tick + 1) << BOT_ACTION_BITS) | action;
+    __atomic_store_n(&link->mailboxes[player].action, word, __ATOMIC_RELEASE);
+}
+
+// NOTE(leo): Host only. Returns the bot's latest action, whichever tick it was for. Sets
+// is_for_tick if it was for the given one.
+INTERNAL u32
+bot_link_take(BotLink *link, u32 player, u64 tick, b32 *is_for_tick)
+{
+    u64 word = __atomic_load_n(&link->mailboxes[player].action, __ATOMIC_ACQUIRE);
+
+    *is_for_tick = (word >> BOT_ACTION_BITS) == tick + 1;
+
+    return (u32)(word & ((1 << BOT_ACTION_BITS) - 1));
+}
+
+// NOTE(leo): Host only, for tick synchronous mode. Spins until the bot answers the given
+// tick, at most max_spins times, so a bot that died doesn't freeze the game. Returns false
+// on time out.
+INTERNAL b32
+bot_link_wait_for_action(BotLink *link, u32 player, u64 tick, u64 max_spins, u32 *action)
+{
+    for(u64 spin = 0; spin < max_spins; ++spin)
+    {
+        b32 is_for_tick;
+        *action = bot_link_take(link, player, tick, &is_for_tick);
+
+        if(is_for_tick)
+        {
+            return true;
+        }
+
+        bot_link_pause(spin);
+    }
+
+    return false;
+}
+
+// NOTE(leo): Host only. Called before simulating a tick, after publishing the state before
+// it. Each bot's action goes to actions[player]. Without tick synchronous mode that's the
+// latest one the bot submitted, whichever tick it was for. With it, the host waits for the
+// bot to answer this tick, and actions[player] keeps the last action if it times out. Returns
+// false if a bot timed out.
+INTERNAL b32
+bot_link_gather_actions(BotLink *link, u64 tick, u64 max_spins, u32 *actions)
+{
+    b32 result = true;
+
+    for(u32 player = 0; player < 2; ++player)
+    {
+        if(!link->is_bot_playing[player])
+        {
+            continue;
+        }
+
+        u32 action;
+        b32 is_for_tick;
+
+        if(!link->is_tick_synchronous)
+        {
+            actions[player] = bot_link_take(link, player, tick, &is_for_tick);
+        }
+        else if(bot_link_wait_for_action(link, player, tick, max_spins, &action))
+        {
+            actions[player] = action;
+        }
+        else
+        {
+            result = false;
+        }
+    }
+
+    return result;
+}
+
+// NOTE(leo): Host only. Replaces the keys of the paddles played by bots with their actions.
+INTERNAL void
+bot_link_apply_actions(BotLink *link, u32 *actions, GameInput *input)
+{
+    int up_keys[]   = {KEY_W, KEY_UP};
+    int down_keys[] = {KEY_S, KEY_DOWN};
+
+    for(u32 player = 0; player < 2; ++player)
+    {
+        if(link->is_bot_playing[player])
+        {
+            input->is_key_down[up_keys[player]]   = actions[player] == BOT_ACTION_UP;
+            input->is_key_down[down_keys[player]] = actions[player] == BOT_ACTION_DOWN;
+        }
+    }
+}
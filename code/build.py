@@ -42,10 +42,38 @@ def build_main():
     executable_name = "pong"
 
     win32_source_files = ["win32/win32_main.c"]
-    win32_libraries = ["-lkernel32", "-luser32", "-lwinmm", "-lgdi32", "-lole32"]
-
-    linux_source_files = []
-    linux_libraries = []
+    win32_libraries = ["-lkernel32", "-luser32", "-lwinmm", "-lgdi32", "-lole32", "-lws2_32"]
+
+    # NOTE(leo): The Linux platform layer is headless for now. It has no window and no audio,
+    # it's used for the instrumentation, regression and benchmark modes.
+    linux_source_files = ["linux/linux_main.c"]
+    linux_libraries = ["-pthread"]
+
+    # NOTE(leo): The dedicated match server is a second Linux executable (<executable>_server),
+    # built from the game core only.
+    linux_server_source_files = ["linux/linux_server.c"]
+    linux_server_libraries = ["-pthread"]
+
+    # NOTE(leo): The reinforcement learning environment is a Linux shared library
+    # (lib<executable>_env.so), see pong_env.h.
+    linux_env_source_files = ["linux/linux_env.c"]
+    linux_env_libraries = ["-pthread"]
+    linux_env_compile_flags = ["-shared", "-fPIC", "-fvisibility=hidden"]
+
+    # NOTE(leo): The example bot (<executable>_bot) plays a paddle through shared memory, see
+    # bot_link.c.
+    linux_bot_source_files = ["linux/linux_bot.c"]
+    linux_bot_libraries = ["-pthread"]
+
+    # NOTE(leo): The example frame reader (<executable>_frame_reader) reads the frames a game
+    # built with -D FRAME_EXPORT publishes, see frame_export.c.
+    linux_frame_reader_source_files = ["linux/linux_frame_reader.c"]
+    linux_frame_reader_libraries = ["-pthread"]
+
+    # NOTE(leo): The tournament runner (<executable>_tournament) plays AIs against each other
+    # on every core, built from the game core only.
+    linux_tournament_source_files = ["linux/linux_tournament.c"]
+    linux_tournament_libraries = ["-pthread", "-lm"]
 
     macos_source_files = []
     macos_libraries = []
@@ -59,10 +87,6 @@ def build_main():
 
     compile_command = ["clang",
                        "-std=c99",
-                       "-fuse-ld=lld",
-                       "-nodefaultlibs",
-                       "-nostdlib",
-                       "-mno-stack-arg-probe",
                       f"-D PROGRAM_NAME=\"{program_name}\"",
                        "-Wall",
                        "-Wextra",
@@ -73,6 +97,12 @@ def build_main():
     slow_flags = development_flags + ["-O0"]
     fast_flags = development_flags + release_flags
 
+    # NOTE(leo): On Windows we don't link with the CRT. On Linux the C library is the OS API,
+    # so we link with it as we'd link with kernel32 on Windows.
+    win32_compile_flags = ["-fuse-ld=lld", "-nodefaultlibs", "-nostdlib", "-mno-stack-arg-probe"]
+    linux_compile_flags = []
+    macos_compile_flags = []
+
     win32_linker_flags = "-Wl,-wx,-subsystem:windows,-incremental:no,-opt:ref"
     linux_linker_flags = ""
     macos_linker_flags = ""
@@ -108,8 +138,7 @@ def build_main():
         executable_file = executable_name + ".exe"
     elif sys.platform == "linux":
         build_directory = f"{project_root_dir_relative}/build/linux"
-        print("Please, make sure the Linux build settings are configured properly.")
-        sys.exit()
+        executable_file = executable_name
     else:
         build_directory = f"{project_root_dir_relative}/build/mac"
         print("Please, make sure the MacOS build settings are configured properly.")
@@ -138,25 +167,30 @@ def build_main():
         if argc > 2:
             compile_command += argv[2:]
 
+    # NOTE(leo): Same flags for every executable, only the sources and the output differ.
+    base_compile_command = list(compile_command)
+
     executable_path = f"{build_directory}/{executable_file}"
     compile_command += ["-o", executable_path]
 
     if sys.platform == "win32":
+        compile_command += win32_compile_flags
         compile_command += win32_source_files
         compile_command += win32_libraries
     elif sys.platform == "linux":
+        compile_command += linux_compile_flags
         compile_command += linux_source_files
         compile_command += linux_libraries
     else: # darwin
+        compile_command += macos_compile_flags
         compile_command += macos_source_files
         compile_command += macos_libraries
 
     if sys.platform == "win32":
         compile_command += [win32_linker_flags]
     elif sys.platform == "linux":
-        # TODO: linker arguments for linux.
-        compile_command += [linux_linker_flags]
-        assert 0
+        if len(linux_linker_flags) > 0:
+            compile_command += [linux_linker_flags]
     else:
         # TODO: linker arguments for macos.
         compile_command += [macos_linker_flags]
@@ -169,6 +203,74 @@ def build_main():
         compile_command_file.write(compile_command_str)
 
     subprocess.run(compile_command)
+
+    if sys.platform == "linux":
+        server_executable_path = f"{build_directory}/{executable_name}_server"
+
+        server_compile_command = base_compile_command + ["-o", server_executable_path]
+        server_compile_command += linux_compile_flags
+        server_compile_command += linux_server_source_files
+        server_compile_command += linux_server_libraries
+
+        if len(linux_linker_flags) > 0:
+            server_compile_command += [linux_linker_flags]
+
+        print(" ".join(server_compile_command) + "\n")
+        subprocess.run(server_compile_command)
+
+        env_library_path = f"{build_directory}/lib{executable_name}_env.so"
+
+        env_compile_command = base_compile_command + ["-o", env_library_path]
+        env_compile_command += linux_compile_flags + linux_env_compile_flags
+        env_compile_command += linux_env_source_files
+        env_compile_command += linux_env_libraries
+
+        if len(linux_linker_flags) > 0:
+            env_compile_command += [linux_linker_flags]
+
+        print(" ".join(env_compile_command) + "\n")
+        subprocess.run(env_compile_command)
+
+        bot_executable_path = f"{build_directory}/{executable_name}_bot"
+
+        bot_compile_command = base_compile_command + ["-o", bot_executable_path]
+        bot_compile_command += linux_compile_flags
+        bot_compile_command += linux_bot_source_files
+        bot_compile_command += linux_bot_libraries
+
+        if len(linux_linker_flags) > 0:
+            bot_compile_command += [linux_linker_flags]
+
+        print(" ".join(bot_compile_command) + "\n")
+        subprocess.run(bot_compile_command)
+
+        frame_reader_executable_path = f"{build_directory}/{executable_name}_frame_reader"
+
+        frame_reader_compile_command = base_compile_command + ["-o",
+                                                               frame_reader_executable_path]
+        frame_reader_compile_command += linux_compile_flags
+        frame_reader_compile_command += linux_frame_reader_source_files
+        frame_reader_compile_command += linux_frame_reader_libraries
+
+        if len(linux_linker_flags) > 0:
+            frame_reader_compile_command += [linux_linker_flags]
+
+        print(" ".join(frame_reader_compile_command) + "\n")
+        subprocess.run(frame_reader_compile_command)
+
+        tournament_executable_path = f"{build_directory}/{executable_name}_tournament"
+
+        tournament_compile_command = base_compile_command + ["-o", tournament_executable_path]
+        tournament_compile_command += linux_compile_flags
+        tournament_compile_command += linux_tournament_source_files
+        tournament_compile_command += linux_tournament_libraries
+
+        if len(linux_linker_flags) > 0:
+            tournament_compile_command += [linux_linker_flags]
+
+        print(" ".join(tournament_compile_command) + "\n")
+        subprocess.run(tournament_compile_command)
+
     print(f"Total build script time: {round(time.time() - time_start, 2)} seconds.")
 
 if __name__ == "__main__":
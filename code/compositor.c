@@ -0,0 +1,302 @@
+// NOTE(leo): Renders a frame as two layers. The static layer is what only changes once in a
+// while (the background, the middle line, the scoreboard). It's rendered into a buffer of its
+// own, and only again when its key (whatever it's drawn from) or the size of the back buffer
+// changes. The dynamic layer is what moves every frame. It's drawn straight into the back
+// buffer, after copying the static layer over what the dynamic layer drew there last time.
+//
+// The back buffers keep what was drawn into them, so the compositor remembers, for each one,
+// which static layer it has and the rectangles the dynamic layer covered in it. A back
+// buffer that's new to it, or that has an older static layer, gets the whole static layer
+// copied in.
+//
+// Parts of the static layer can be on top of the dynamic one (compositor_add_top_rect), they
+// are copied back over what the dynamic layer drew on them (compositor_restore_top_rects).
+//
+// Only 0x00RRGGBB and grayscale back buffers, the others are rendered whole.
+
+#define COMPOSITOR_MAX_TARGETS     4
+#define COMPOSITOR_MAX_DIRTY_RECTS 8
+#define COMPOSITOR_MAX_TOP_RECTS   24
+
+// ===========================================================================================
+
+typedef struct
+{
+    void *pixels;
+    s32   width;
+    s32   height;
+
+    // NOTE(leo): The static layer it has, 0 for none, and where the dynamic layer drew.
+    u32       static_layer_version;
+    PixelRect dirty_rects[COMPOSITOR_MAX_DIRTY_RECTS];
+    u32       dirty_rects_count;
+
+} CompositorTarget;
+
+typedef struct
+{
+    BackBuffer static_layer;
+    u64        static_layer_capacity;
+    u64        static_layer_key;
+    u32        static_layer_version;
+
+    // NOTE(leo): Set by compositor_begin_frame when the static layer has to be rendered
+    // again, cleared by compositor_end_static_layer.
+    b32 is_static_layer_stale;
+
+    PixelRect top_rects[COMPOSITOR_MAX_TOP_RECTS];
+    u32       top_rects_count;
+
+    CompositorTarget  targets[COMPOSITOR_MAX_TARGETS];
+    u32               next_target;
+    CompositorTarget *target;
+
+} Compositor;
+
+// ===========================================================================================
+
+// NOTE(leo): For when the back buffers were reallocated, what they had is gone.
+INTERNAL void
+compositor_invalidate(Compositor *compositor)
+{
+    memset(compositor->targets, 0, sizeof(compositor->targets));
+    compositor->next_target = 0;
+    compositor->target      = NULL;
+}
+
+INTERNAL void
+compositor_destroy(Compositor *compositor)
+{
+    free(compositor->static_layer.pixels);
+    memset(compositor, 0, sizeof(*compositor));
+}
+
+INTERNAL PixelRect
+pixel_rect_intersection(PixelRect a, PixelRect b)
+{
+    s32 x_begin = MAX(a.x, b.x);
+    s32 y_begin = MAX(a.y, b.y);
+    s32 x_end   = MIN(a.x + a.width, b.x + b.width);
+    s32 y_end   = MIN(a.y + a.height, b.y + b.height);
+
+    PixelRect result = {0};
+
+    if(x_end > x_begin && y_end > y_begin)
+    {
+        result.x      = x_begin;
+        result.y      = y_begin;
+        result.width  = x_end - x_begin;
+        result.height = y_end - y_begin;
+    }
+
+    return result;
+}
+
+// NOTE(leo): Copies the rectangle of the static layer into g_back_buffer.
+INTERNAL void
+compositor_copy_from_static_layer(Compositor *compositor, PixelRect rect)
+{
+    PixelRect whole = {0, 0, g_back_buffer.width, g_back_buffer.height};
+    rect            = pixel_rect_intersection(rect, whole);
+
+    if(!rect.width)
+    {
+        return;
+    }
+
+    u64 bytes_per_pixel = g_back_buffer.format == BACK_BUFFER_RGB ? sizeof(u32) : sizeof(u8);
+    u64 pitch           = (u64)g_back_buffer.pitch;
+    u64 offset          = ((u64)rect.y * pitch) + ((u64)rect.x * bytes_per_pixel);
+
+    u8 *source = (u8 *)compositor->static_layer.pixels + offset;
+    u8 *dest   = (u8 *)g_back_buffer.pixels + offset;
+
+    // NOTE(leo): Whole rows are one copy, padding included, the static layer has the same
+    // pitch.
+    if(rect.width == g_back_buffer.width)
+    {
+        memcpy(dest, source, (u64)rect.height * pitch);
+        return;
+    }
+
+    for(s32 row = 0; row < rect.height; ++row)
+    {
+        memcpy(dest, source, (u64)rect.width * bytes_per_pixel);
+
+        source += pitch;
+        dest += pitch;
+    }
+}
+
+// NOTE(leo): Starts a frame into g_back_buffer. static_layer_key is what the static layer is
+// drawn from. Returns false if the frame can't be composited, then it has to be rendered
+// whole. When it returns true with is_static_layer_stale set, the caller renders the static
+// layer into static_layer, between compositor_begin_static_layer and
+// compositor_end_static_layer, and then calls compositor_restore_background.
+INTERNAL b32
+compositor_begin_frame(Compositor *compositor, u64 static_layer_key)
+{
+    compositor->target = NULL;
+
+    if(g_back_buffer.format != BACK_BUFFER_RGB
+       && g_back_buffer.format != BACK_BUFFER_GRAYSCALE)
+    {
+        return false;
+    }
+
+    BackBuffer *static_layer = &compositor->static_layer;
+
+    if(static_layer->width != g_back_buffer.width
+       || static_layer->height != g_back_buffer.height
+       || static_layer->format != g_back_buffer.format
+       || static_layer->aspect_ratio != g_back_buffer.aspect_ratio
+       || compositor->static_layer_key != static_layer_key || !static_layer->pixels)
+    {
+        u64 size = back_buffer_size(&g_back_buffer);
+
+        // NOTE(leo): Only grows, like the glyph atlas.
+        if(size > compositor->static_layer_capacity)
+        {
+            free(static_layer->pixels);
+
+            static_layer->pixels              = malloc(size);
+            compositor->static_layer_capacity = static_layer->pixels ? size : 0;
+
+            if(!static_layer->pixels)
+            {
+                return false;
+            }
+        }
+
+        void *pixels = static_layer->pixels;
+
+        *static_layer        = g_back_buffer;
+        static_layer->pixels = pixels;
+
+        compositor->static_layer_key      = static_layer_key;
+        compositor->is_static_layer_stale = true;
+    }
+
+    CompositorTarget *target = NULL;
+
+    for(u32 i = 0; i < COMPOSITOR_MAX_TARGETS; ++i)
+    {
+        CompositorTarget *candidate = &compositor->targets[i];
+
+        if(candidate->pixels == g_back_buffer.pixels
+           && candidate->width == g_back_buffer.width
+           && candidate->height == g_back_buffer.height)
+        {
+            target = candidate;
+            break;
+        }
+    }
+
+    if(!target)
+    {
+        target = &compositor->targets[compositor->next_target];
+        compositor->next_target = (compositor->next_target + 1) % COMPOSITOR_MAX_TARGETS;
+
+        memset(target, 0, sizeof(*target));
+        target->pixels = g_back_buffer.pixels;
+        target->width  = g_back_buffer.width;
+        target->height = g_back_buffer.height;
+    }
+
+    compositor->target = target;
+
+    return true;
+}
+
+// NOTE(leo): Returns what g_back_buffer was, to give to compositor_end_static_layer.
+INTERNAL BackBuffer
+compositor_begin_static_layer(Compositor *compositor)
+{
+    BackBuffer back_buffer = g_back_buffer;
+
+    g_back_buffer               = compositor->static_layer;
+    compositor->top_rects_count = 0;
+
+    return back_buffer;
+}
+
+INTERNAL void
+compositor_end_static_layer(Compositor *compositor, BackBuffer back_buffer)
+{
+    g_back_buffer = back_buffer;
+
+    compositor->static_layer_version++;
+    compositor->is_static_layer_stale = false;
+}
+
+// NOTE(leo): While rendering the static layer. Marks a part of it as being on top of the
+// dynamic layer.
+INTERNAL void
+compositor_add_top_rect(Compositor *compositor, PixelRect rect)
+{
+    ASSERT(compositor->top_rects_count < COMPOSITOR_MAX_TOP_RECTS);
+
+    if(compositor->top_rects_count < COMPOSITOR_MAX_TOP_RECTS)
+    {
+        compositor->top_rects[compositor->top_rects_count++] = rect;
+    }
+}
+
+// NOTE(leo): Brings g_back_buffer back to the static layer, everywhere the dynamic layer
+// drew the last time, or everywhere if it has another static layer.
+INTERNAL void
+compositor_restore_background(Compositor *compositor)
+{
+    CompositorTarget *target = compositor->target;
+
+    if(target->static_layer_version != compositor->static_layer_version)
+    {
+        PixelRect whole = {0, 0, g_back_buffer.width, g_back_buffer.height};
+        compositor_copy_from_static_layer(compositor, whole);
+
+        target->static_layer_version = compositor->static_layer_version;
+    }
+    else
+    {
+        for(u32 i = 0; i < target->dirty_rects_count; ++i)
+        {
+            compositor_copy_from_static_layer(compositor, target->dirty_rects[i]);
+        }
+    }
+
+    target->dirty_rects_count = 0;
+}
+
+// NOTE(leo): Marks where the dynamic layer drew, to restore it in the next frame into this
+// back buffer.
+INTERNAL void
+compositor_mark_dirty(Compositor *compositor, PixelRect rect)
+{
+    CompositorTarget *target = compositor->target;
+
+    if(target->dirty_rects_count < COMPOSITOR_MAX_DIRTY_RECTS)
+    {
+        target->dirty_rects[target->dirty_rects_count++] = rect;
+    }
+    else
+    {
+        // NOTE(leo): Too many to remember, the next frame into it copies the whole layer.
+        target->static_layer_version = 0;
+    }
+}
+
+// NOTE(leo): Copies the parts of the static layer that are on top of the dynamic one back
+// over what the dynamic layer drew in the rectangle.
+INTERNAL void
+compositor_restore_top_rects(Compositor *compositor, PixelRect rect)
+{
+    for(u32 i = 0; i < compositor->top_rects_count; ++i)
+    {
+        PixelRect covered = pixel_rect_intersection(rect, compositor->top_rects[i]);
+
+        if(covered.width)
+        {
+            compositor_copy_from_static_layer(compositor, covered);
+        }
+    }
+}
@@ -0,0 +1,225 @@
+// NOTE(leo): The reinforcement learning environment, see pong_env.h for the API. Every match
+// is a plain GameState stepped at 60 ticks per second, with the serve pressed automatically,
+// so the agents only ever choose between staying, going up and going down.
+
+#include "pong_env.h"
+
+#define ENV_TICK_SECONDS (1.0f / 60.0f)
+
+// ===========================================================================================
+
+typedef struct
+{
+    GameState game_state;
+    AiPlayer  ai;
+
+} EnvMatch;
+
+struct PongEnv
+{
+    PongEnvConfig config;
+
+    // NOTE(leo): Draws the seeds of every new episode, so a run only depends on config.seed.
+    pcg32_random_t seeds_rng;
+
+    EnvMatch *matches;
+};
+
+// ===========================================================================================
+
+INTERNAL void
+env_reset_match(PongEnv *env, EnvMatch *match)
+{
+    u64 rng_state    = (u64)pcg32_random_r(&env->seeds_rng) << 32;
+    rng_state       |= pcg32_random_r(&env->seeds_rng);
+    u64 rng_sequence = pcg32_random_r(&env->seeds_rng);
+
+    game_main(&match->game_state, rng_state, rng_sequence);
+
+    if(env->config.players_count == 1)
+    {
+        ai_init(&match->ai,
+                true,
+                (AiDifficulty)env->config.ai_difficulty,
+                rng_state ^ 0x9E3779B97F4A7C15,
+                rng_sequence + 1);
+    }
+}
+
+INTERNAL void
+env_set_keys(GameInput *input, u8 action, int up_key, int down_key)
+{
+    input->is_key_down[up_key]   = action == PONG_ENV_ACTION_UP;
+    input->is_key_down[down_key] = action == PONG_ENV_ACTION_DOWN;
+}
+
+PONG_ENV_API PongEnv *
+pong_env_create(PongEnvConfig *config)
+{
+    if(!config->envs_count || config->players_count < 1 || config->players_count > 2
+       || config->ai_difficulty >= AI_DIFFICULTIES_COUNT || !config->points_per_episode
+       || config->observation_type > PONG_ENV_OBSERVE_FRAME)
+    {
+        return NULL;
+    }
+
+    if(config->observation_type == PONG_ENV_OBSERVE_FRAME
+       && (!config->frame_width || !config->frame_height
+           || (u64)config->frame_width * config->frame_height > S32_MAX))
+    {
+        return NULL;
+    }
+
+    PongEnv *env = malloc(sizeof(PongEnv));
+
+    if(!env)
+    {
+        return NULL;
+    }
+
+    env->config  = *config;
+    env->matches = malloc(config->envs_count * sizeof(EnvMatch));
+
+    if(!env->matches)
+    {
+        free(env);
+        return NULL;
+    }
+
+    pcg32_srandom_r(&env->seeds_rng, config->seed, (u64)config->envs_count);
+
+    pong_env_reset(env);
+
+    return env;
+}
+
+PONG_ENV_API void
+pong_env_destroy(PongEnv *env)
+{
+    if(env)
+    {
+        free(env->matches);
+        free(env);
+    }
+}
+
+PONG_ENV_API uint64_t
+pong_env_observation_size(PongEnv *env)
+{
+    if(env->config.observation_type == PONG_ENV_OBSERVE_FRAME)
+    {
+        return (u64)env->config.frame_width * env->config.frame_height;
+    }
+
+    return PONG_ENV_STATE_VALUES_COUNT * sizeof(f32);
+}
+
+PONG_ENV_API void
+pong_env_reset(PongEnv *env)
+{
+    for(u32 i = 0; i < env->config.envs_count; ++i)
+    {
+        env_reset_match(env, &env->matches[i]);
+    }
+}
+
+PONG_ENV_API void
+pong_env_step(PongEnv *env, const uint8_t *actions, float *rewards, uint8_t *dones)
+{
+    u32 players_count = env->config.players_count;
+
+    for(u32 i = 0; i < env->config.envs_count; ++i)
+    {
+        EnvMatch  *match      = &env->matches[i];
+        GameState *game_state = &match->game_state;
+
+        GameInput input = {0};
+        env_set_keys(&input, actions[i * players_count], KEY_W, KEY_S);
+
+        if(players_count == 2)
+        {
+            env_set_keys(&input, actions[(i * players_count) + 1], KEY_UP, KEY_DOWN);
+        }
+        else
+        {
+            ai_update(&match->ai, game_state, ENV_TICK_SECONDS, &input);
+        }
+
+        // NOTE(leo): Serving isn't a decision the agents have to learn.
+        input.is_key_down[KEY_ENTER] = !game_state->match_started;
+
+        u32 left_points  = game_state->left_points;
+        u32 right_points = game_state->right_points;
+
+        game_update(game_state, &input, ENV_TICK_SECONDS);
+
+        f32 left_reward = (f32)(game_state->left_points - left_points)
+                        - (f32)(game_state->right_points - right_points);
+
+        rewards[i * players_count] = left_reward;
+
+        if(players_count == 2)
+        {
+            rewards[(i * players_count) + 1] = -left_reward;
+        }
+
+        b32 is_done = game_state->left_points >= env->config.points_per_episode
+                   || game_state->right_points >= env->config.points_per_episode;
+
+        dones[i] = (u8)is_done;
+
+        if(is_done)
+        {
+            env_reset_match(env, match);
+        }
+    }
+}
+
+PONG_ENV_API void
+pong_env_observe(PongEnv *env, void *observations)
+{
+    if(env->config.observation_type == PONG_ENV_OBSERVE_STATE)
+    {
+        f32 *values = observations;
+
+        for(u32 i = 0; i < env->config.envs_count; ++i)
+        {
+            GameState *game_state = &env->matches[i].game_state;
+
+            *values++ = real_to_f32(game_state->ball.position.x);
+            *values++ = real_to_f32(game_state->ball.position.y);
+            *values++ = real_to_f32(game_state->ball.velocity.x);
+            *values++ = real_to_f32(game_state->ball.velocity.y);
+            *values++ = real_to_f32(game_state->left_paddle.position.y);
+            *values++ = real_to_f32(game_state->left_paddle.velocity.y);
+            *values++ = real_to_f32(game_state->right_paddle.position.y);
+            *values++ = real_to_f32(game_state->right_paddle.velocity.y);
+        }
+
+        return;
+    }
+
+    // NOTE(leo): The back buffer is pointed at each observation in turn. The aspect ratio is
+    // the game's, not the frame's, so a square frame looks like the game squeezed into it.
+    u64        frame_size           = pong_env_observation_size(env);
+    u8        *frame                = observations;
+    BackBuffer platform_back_buffer = g_back_buffer;
+
+    // NOTE(leo): The observations are packed, no padding between rows.
+    g_back_buffer.format = BACK_BUFFER_GRAYSCALE;
+    back_buffer_set_size(&g_back_buffer,
+                         (s32)env->config.frame_width,
+                         (s32)env->config.frame_height,
+                         false);
+    g_back_buffer.aspect_ratio = TARGET_ASPECT_RATIO;
+
+    for(u32 i = 0; i < env->config.envs_count; ++i)
+    {
+        g_back_buffer.pixels = frame;
+        game_render(&env->matches[i].game_state);
+
+        frame += frame_size;
+    }
+
+    g_back_buffer = platform_back_buffer;
+}
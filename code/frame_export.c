@@ -0,0 +1,257 @@
+// NOTE(leo): Exports the frames the game presents through a segment of shared memory, for
+// programs like stream overlays and venue screens that show them somewhere else. The segment
+// is a ring of slots, each big enough for a whole back buffer. The game (the host) copies
+// every frame it presents into the next slot, and readers use the pixels right where they
+// are in the segment, without copying them out.
+//
+// Each slot has a seqlock, like bot_link.c: the host makes its sequence odd, writes the
+// frame, and makes it even again. A reader takes the sequence, reads the frame, and checks
+// the sequence didn't change, otherwise the host wrote over the slot while it was reading.
+// The host never waits for readers. With N slots, a reader has N - 1 frames to read the
+// newest one before the host gets back to its slot.
+//
+// The slots can't grow once readers have mapped them, so frames bigger than a slot are
+// skipped (and counted).
+
+#define FRAME_EXPORT_MAGIC   0x58455246 // NOTE(leo): "FREX" in little endian.
+#define FRAME_EXPORT_VERSION 1
+
+#define FRAME_EXPORT_DEFAULT_NAME  "pong_frames"
+#define FRAME_EXPORT_DEFAULT_SLOTS 3
+#define FRAME_EXPORT_MAX_SLOTS     8
+
+// NOTE(leo): The pixels of every slot start on a page of their own.
+#define FRAME_EXPORT_PAGE_SIZE 4096
+
+// ===========================================================================================
+
+typedef struct __attribute__((aligned(64)))
+{
+    // NOTE(leo): The seqlock, and the frame it protects. frame is the host's frame number,
+    // index counts the frames published, from 0, so readers can tell how many they missed.
+    u32 sequence;
+    u32 format;
+    s32 width;
+    s32 height;
+    s32 pitch;
+    f32 aspect_ratio;
+    u32 palette[2];
+    u64 frame;
+    u64 index;
+    u64 size;
+
+    // NOTE(leo): From the start of the segment. Set before readers can attach.
+    u64 pixels_offset;
+
+} FrameExportSlot;
+
+// NOTE(leo): The layout of the start of the segment, the pixels of the slots come after it.
+// The first fields don't move from a version to the next, so a reader can always tell the
+// version and the size of the segment.
+typedef struct
+{
+    // NOTE(leo): Written by the host before any reader can attach, then only is_closed
+    // changes.
+    u32 magic;
+    u32 version;
+    u64 segment_size;
+    u64 slot_capacity;
+    u32 slots_count;
+    b32 is_closed;
+
+    // NOTE(leo): Written by the host for every frame. The newest frame is in the slot
+    // frames_published - 1, modulo the number of slots.
+    __attribute__((aligned(64))) u64 frames_published;
+    u64 frames_skipped;
+
+    FrameExportSlot slots[FRAME_EXPORT_MAX_SLOTS];
+
+} FrameExport;
+
+// ===========================================================================================
+
+INTERNAL u64
+frame_export_round_to_page(u64 size)
+{
+    return (size + FRAME_EXPORT_PAGE_SIZE - 1) & ~(u64)(FRAME_EXPORT_PAGE_SIZE - 1);
+}
+
+// NOTE(leo): Host only. Creates the segment with slots of slot_capacity bytes. Returns NULL
+// if it can't.
+INTERNAL FrameExport *
+frame_export_create(char *name, u32 slots_count, u64 slot_capacity)
+{
+    ASSERT(slots_count >= 2 && slots_count <= FRAME_EXPORT_MAX_SLOTS);
+
+    u64 header_size  = frame_export_round_to_page(sizeof(FrameExport));
+    u64 slot_size    = frame_export_round_to_page(slot_capacity);
+    u64 segment_size = header_size + (slot_size * slots_count);
+
+    FrameExport *export = os_shared_memory_open(name, segment_size, true);
+
+    if(!export)
+    {
+        return NULL;
+    }
+
+    // NOTE(leo): Touches every page now, so the first time around the ring doesn't take page
+    // faults in the middle of frames.
+    memset((u8 *)export + header_size, 0, segment_size - header_size);
+
+    export->version       = FRAME_EXPORT_VERSION;
+    export->segment_size  = segment_size;
+    export->slot_capacity = slot_capacity;
+    export->slots_count   = slots_count;
+
+    for(u32 i = 0; i < slots_count; ++i)
+    {
+        export->slots[i].pixels_offset = header_size + (slot_size * i);
+    }
+
+    // NOTE(leo): The magic goes last, a reader that sees it sees the rest of the header.
+    __atomic_store_n(&export->magic, FRAME_EXPORT_MAGIC, __ATOMIC_RELEASE);
+
+    return export;
+}
+
+// NOTE(leo): Host only. Readers still attached see is_closed, the pixels stay mapped until
+// they detach.
+INTERNAL void
+frame_export_destroy(FrameExport *export, char *name)
+{
+    __atomic_store_n(&export->is_closed, true, __ATOMIC_RELEASE);
+    os_shared_memory_close(name, export, export->segment_size, true);
+}
+
+INTERNAL u8 *
+frame_export_pixels(FrameExport *export, FrameExportSlot *slot)
+{
+    return (u8 *)export + slot->pixels_offset;
+}
+
+// NOTE(leo): Host only. Copies the frame into the next slot, with its padding, so the rows
+// keep their alignment. Returns false if it was too big for a slot.
+INTERNAL b32
+frame_export_publish(FrameExport *export, BackBuffer *frame, u64 frame_number)
+{
+    u64 size = back_buffer_size(frame);
+
+    if(size > export->slot_capacity)
+    {
+        u64 skipped = export->frames_skipped;
+        __atomic_store_n(&export->frames_skipped, skipped + 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    u64              published = export->frames_published;
+    FrameExportSlot *slot      = &export->slots[published % export->slots_count];
+    u32              sequence  = slot->sequence;
+
+    __atomic_store_n(&slot->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    slot->format       = (u32)frame->format;
+    slot->width        = frame->width;
+    slot->height       = frame->height;
+    slot->pitch        = frame->pitch;
+    slot->aspect_ratio = frame->aspect_ratio;
+    slot->palette[0]   = frame->palette[0];
+    slot->palette[1]   = frame->palette[1];
+    slot->frame        = frame_number;
+    slot->index        = published;
+    slot->size         = size;
+
+    memcpy(frame_export_pixels(export, slot), frame->pixels, size);
+
+    __atomic_store_n(&slot->sequence, sequence + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&export->frames_published, published + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+// NOTE(leo): Reader side. Maps the segment once the host has initialized it. Returns NULL if
+// there is none yet, or if it was made by another version of this file (then is_compatible
+// is false).
+INTERNAL FrameExport *
+frame_export_attach(char *name, b32 *is_compatible)
+{
+    *is_compatible = true;
+
+    FrameExport *export = os_shared_memory_open(name, sizeof(FrameExport), false);
+
+    if(!export)
+    {
+        return NULL;
+    }
+
+    u64 segment_size = 0;
+
+    if(__atomic_load_n(&export->magic, __ATOMIC_ACQUIRE) == FRAME_EXPORT_MAGIC)
+    {
+        *is_compatible = export->version == FRAME_EXPORT_VERSION;
+        segment_size   = export->segment_size;
+    }
+
+    os_shared_memory_close(name, export, sizeof(FrameExport), false);
+
+    if(!segment_size || !*is_compatible)
+    {
+        return NULL;
+    }
+
+    return os_shared_memory_open(name, segment_size, false);
+}
+
+INTERNAL void
+frame_export_detach(FrameExport *export, char *name)
+{
+    os_shared_memory_close(name, export, export->segment_size, false);
+}
+
+// NOTE(leo): Reader side. Returns the slot of the newest frame, or NULL if there is none or
+// the host is writing it. Whatever is read from the slot and its pixels is only good if
+// frame_export_read_end returns true for the same sequence.
+INTERNAL FrameExportSlot *
+frame_export_read_begin(FrameExport *export, u32 *sequence)
+{
+    u64 published = __atomic_load_n(&export->frames_published, __ATOMIC_ACQUIRE);
+
+    if(!published)
+    {
+        return NULL;
+    }
+
+    FrameExportSlot *slot = &export->slots[(published - 1) % export->slots_count];
+    *sequence             = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+
+    return (*sequence & 1) ? NULL : slot;
+}
+
+// NOTE(leo): Reader side. Returns false if the host wrote over the slot since
+// frame_export_read_begin.
+INTERNAL b32
+frame_export_read_end(FrameExportSlot *slot, u32 sequence)
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    return __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) == sequence;
+}
+
+// NOTE(leo): Reader side. A BackBuffer over the pixels of the slot, to use the renderer's
+// functions on them (expand_bitplane, for example).
+INTERNAL BackBuffer
+frame_export_slot_frame(FrameExport *export, FrameExportSlot *slot)
+{
+    BackBuffer frame   = {0};
+    frame.pixels       = frame_export_pixels(export, slot);
+    frame.width        = slot->width;
+    frame.height       = slot->height;
+    frame.pitch        = slot->pitch;
+    frame.aspect_ratio = slot->aspect_ratio;
+    frame.format       = (BackBufferFormat)slot->format;
+    frame.palette[0]   = slot->palette[0];
+    frame.palette[1]   = slot->palette[1];
+    frame.pixels_count = slot->width * slot->height;
+
+    return frame;
+}
@@ -0,0 +1,563 @@
+// NOTE(leo): The game simulation alone, with no renderer and no audio, so that programs like
+// the match server can be built from it. game_main.c adds rendering and audio on top.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wsign-conversion"
+
+#include "third_party/ryu/d2fixed.c"
+
+#pragma clang diagnostic pop
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wshorten-64-to-32"
+
+#include "third_party/pcg-c-basic-0.9/pcg_basic.c"
+
+#pragma clang diagnostic pop
+
+#include "utils.c"
+
+#include "strings.c"
+#include "os.c"
+
+#include "math.c"
+
+// ===========================================================================================
+
+#define TARGET_ASPECT_RATIO_NUMERATOR   16.0f
+#define TARGET_ASPECT_RATIO_DENOMINATOR 9.0f
+
+#define TARGET_ASPECT_RATIO (TARGET_ASPECT_RATIO_NUMERATOR / TARGET_ASPECT_RATIO_DENOMINATOR)
+
+#define PADDLE_WIDTH                 0.015f
+#define PADDLE_HEIGHT                0.09f
+#define PADDLE_SIMETRICAL_X_POSITION 0.9f
+#define LEFT_PADDLE_POSITION_X       (-PADDLE_SIMETRICAL_X_POSITION)
+#define RIGHT_PADDLE_POSITION_X      (PADDLE_SIMETRICAL_X_POSITION)
+#define BALL_SCALE                   0.015f
+
+#define PADDLE_MAX_VELOCITY_Y 2.3f
+#define PADDLE_ACCELERATION   9.0f
+
+#define SCREEN_TOP    1.0f
+#define SCREEN_BOTTOM -1.0f
+#define SCREEN_LEFT   -1.0f
+#define SCREEN_RIGHT  1.0f
+
+#define HALF_HEIGHT(height) ((height * TARGET_ASPECT_RATIO) / 2.0f)
+
+// NOTE(leo): HALF_HEIGHT for the sizes stored in entities.
+#define REAL_HALF_HEIGHT(height)                                                             \
+    real_divide(real_multiply((height), REAL(TARGET_ASPECT_RATIO)), REAL(2.0f))
+
+#define PADDLE_AT_TOP    (SCREEN_TOP - HALF_HEIGHT(PADDLE_HEIGHT))
+#define PADDLE_AT_BOTTOM (SCREEN_BOTTOM + HALF_HEIGHT(PADDLE_HEIGHT))
+
+#define BALL_AT_TOP    (SCREEN_TOP - HALF_HEIGHT(BALL_SCALE))
+#define BALL_AT_BOTTOM (SCREEN_BOTTOM + HALF_HEIGHT(BALL_SCALE))
+
+// NOTE(leo): The ball's x when it touches a paddle's face.
+#define BALL_AT_LEFT_PADDLE                                                                  \
+    (LEFT_PADDLE_POSITION_X + (PADDLE_WIDTH / 2.0f) + (BALL_SCALE / 2.0f))
+#define BALL_AT_RIGHT_PADDLE                                                                 \
+    (RIGHT_PADDLE_POSITION_X - (PADDLE_WIDTH / 2.0f) - (BALL_SCALE / 2.0f))
+
+// ===========================================================================================
+
+typedef struct
+{
+    v2   position;
+    v2   velocity;
+    real width;
+    real height;
+
+} Entity;
+
+typedef enum
+{
+    WINNER_NONE,
+    WINNER_LEFT,
+    WINNER_RIGHT
+
+} Winner;
+
+typedef enum
+{
+    SOUND_POINT,
+    SOUND_WALL,
+    SOUND_PADDLE
+
+} SoundToPlay;
+
+// NOTE(leo): Everything a match needs lives here, including the random number generator, so
+// that the same seed and the same inputs always reproduce the same match.
+typedef struct
+{
+    Entity         ball;
+    Entity         left_paddle;
+    Entity         right_paddle;
+    Winner         winner;
+    b32            match_started;
+    u32            left_points;
+    u32            right_points;
+    pcg32_random_t rng;
+
+    // NOTE(leo): Set by the last update. It doesn't matter how sound_to_play is initialized,
+    // as long as collision_detected is false, no sound will play.
+    b32         collision_detected;
+    SoundToPlay sound_to_play;
+
+} GameState;
+
+enum
+{
+    KEY_W,
+    KEY_S,
+    KEY_UP,
+    KEY_DOWN,
+    KEY_ENTER,
+
+    KEYS_COUNT
+};
+
+typedef struct
+{
+    b32 is_key_down[KEYS_COUNT];
+
+} GameInput;
+
+// ===========================================================================================
+
+INTERNAL void
+set_random_ball_y_position(GameState *game_state)
+{
+    game_state->ball.position.y = random_real_0_1(&game_state->rng);
+
+    // NOTE(leo): We need to add (if position is negative) or subtract (if position is
+    // positive) the ball scale to avoid starting with the ball already at the wall, which
+    // would trigger the collision detector and play sound.
+    game_state->ball.position.y = pcg32_boundedrand_r(&game_state->rng, 2)
+                                    ? game_state->ball.position.y - REAL(BALL_SCALE)
+                                    : -game_state->ball.position.y + REAL(BALL_SCALE);
+}
+
+// NOTE(leo): The platform layer picks the seed, so that it can be logged and fed back to
+// reproduce the match.
+INTERNAL void
+game_main(GameState *game_state, u64 rng_state, u64 rng_sequence)
+{
+    memset(game_state, 0, sizeof(*game_state));
+
+    game_state->left_paddle.position.x = REAL(LEFT_PADDLE_POSITION_X);
+    game_state->left_paddle.width      = REAL(PADDLE_WIDTH);
+    game_state->left_paddle.height     = REAL(PADDLE_HEIGHT);
+
+    game_state->right_paddle.position.x = REAL(RIGHT_PADDLE_POSITION_X);
+    game_state->right_paddle.width      = REAL(PADDLE_WIDTH);
+    game_state->right_paddle.height     = REAL(PADDLE_HEIGHT);
+
+    game_state->ball.width  = REAL(BALL_SCALE);
+    game_state->ball.height = REAL(BALL_SCALE);
+
+    pcg32_srandom_r(&game_state->rng, rng_state, rng_sequence);
+
+    set_random_ball_y_position(game_state);
+}
+
+INTERNAL void
+update_paddles(Entity    *left_paddle,
+               Entity    *right_paddle,
+               GameInput *input,
+               real       last_frame_time_seconds)
+{
+    Entity *paddles[]   = {left_paddle, right_paddle};
+    int     up_keys[]   = {KEY_W, KEY_UP};
+    int     down_keys[] = {KEY_S, KEY_DOWN};
+
+    for(size_t i = 0; i < STATIC_ARRAY_LENGTH(paddles); ++i)
+    {
+        Entity *paddle   = paddles[i];
+        int     up_key   = up_keys[i];
+        int     down_key = down_keys[i];
+
+        if(input->is_key_down[up_key] && input->is_key_down[down_key])
+        {
+            paddle->velocity.y = REAL(0.0f);
+        }
+        else if(input->is_key_down[up_key])
+        {
+            if(paddle->velocity.y < REAL(PADDLE_MAX_VELOCITY_Y))
+            {
+                paddle->velocity.y +=
+                    real_multiply(REAL(PADDLE_ACCELERATION), last_frame_time_seconds);
+            }
+        }
+        else if(input->is_key_down[down_key])
+        {
+            if(paddle->velocity.y > REAL(-PADDLE_MAX_VELOCITY_Y))
+            {
+                paddle->velocity.y -=
+                    real_multiply(REAL(PADDLE_ACCELERATION), last_frame_time_seconds);
+            }
+        }
+        else
+        {
+            paddle->velocity.y = REAL(0.0f);
+        }
+
+        v2 paddle_frame_velocity =
+            v2_scalar_multiply(paddle->velocity, last_frame_time_seconds);
+        paddle->position = v2_add(paddle->position, paddle_frame_velocity);
+
+        if(paddle->position.y >= REAL(PADDLE_AT_TOP))
+        {
+            paddle->position.y = REAL(PADDLE_AT_TOP);
+            paddle->velocity.y = REAL(0.0f);
+        }
+        else if(paddle->position.y <= REAL(PADDLE_AT_BOTTOM))
+        {
+            paddle->position.y = REAL(PADDLE_AT_BOTTOM);
+            paddle->velocity.y = REAL(0.0f);
+        }
+    }
+}
+
+INTERNAL void
+set_winner(GameState *game_state, Winner winner)
+{
+    memset(&game_state->ball.velocity, 0, sizeof(game_state->ball.velocity));
+
+    set_random_ball_y_position(game_state);
+
+    game_state->winner = winner;
+
+#define BALL_RESTART_POSITION_X_PADDING 0.07f
+    if(winner == WINNER_LEFT)
+    {
+        game_state->ball.position.x = REAL(-BALL_RESTART_POSITION_X_PADDING);
+        game_state->left_points++;
+    }
+    else if(winner == WINNER_RIGHT)
+    {
+        game_state->ball.position.x = REAL(BALL_RESTART_POSITION_X_PADDING);
+        game_state->right_points++;
+    }
+#undef BALL_RESTART_POSITION_X_PADDING
+
+    game_state->match_started = false;
+}
+
+INTERNAL void
+update_ball(GameState *game_state, real last_frame_time_seconds)
+{
+    game_state->collision_detected = false;
+
+    v2 ball_frame_velocity =
+        v2_scalar_multiply(game_state->ball.velocity, last_frame_time_seconds);
+    game_state->ball.position = v2_add(game_state->ball.position, ball_frame_velocity);
+
+    if(game_state->ball.position.x > REAL(SCREEN_RIGHT))
+    {
+        game_state->collision_detected = true;
+        game_state->sound_to_play      = SOUND_POINT;
+
+        set_winner(game_state, WINNER_LEFT);
+    }
+    else if(game_state->ball.position.x < REAL(SCREEN_LEFT))
+    {
+        game_state->collision_detected = true;
+        game_state->sound_to_play      = SOUND_POINT;
+
+        set_winner(game_state, WINNER_RIGHT);
+    }
+    else if(game_state->ball.position.y >= REAL(BALL_AT_TOP))
+    {
+        game_state->collision_detected = true;
+        game_state->sound_to_play      = SOUND_WALL;
+
+        game_state->ball.position.y = REAL(BALL_AT_TOP);
+        game_state->ball.velocity.y = -game_state->ball.velocity.y;
+    }
+    else if(game_state->ball.position.y <= REAL(BALL_AT_BOTTOM))
+    {
+        game_state->collision_detected = true;
+        game_state->sound_to_play      = SOUND_WALL;
+
+        game_state->ball.position.y = REAL(BALL_AT_BOTTOM);
+        game_state->ball.velocity.y = -game_state->ball.velocity.y;
+    }
+    else
+    {
+        real ball_half_width  = real_divide(game_state->ball.width, REAL(2.0f));
+        real ball_half_height = REAL_HALF_HEIGHT(game_state->ball.height);
+
+        real ball_left   = game_state->ball.position.x - ball_half_width;
+        real ball_right  = game_state->ball.position.x + ball_half_width;
+        real ball_top    = game_state->ball.position.y + ball_half_height;
+        real ball_bottom = game_state->ball.position.y - ball_half_height;
+
+        real left_paddle_half_width  = real_divide(game_state->left_paddle.width, REAL(2.0f));
+        real left_paddle_half_height = REAL_HALF_HEIGHT(game_state->left_paddle.height);
+
+        real left_paddle_left  = game_state->left_paddle.position.x - left_paddle_half_width;
+        real left_paddle_right = game_state->left_paddle.position.x + left_paddle_half_width;
+        real left_paddle_top   = game_state->left_paddle.position.y + left_paddle_half_height;
+        real left_paddle_bottom =
+            game_state->left_paddle.position.y - left_paddle_half_height;
+
+        if((ball_left <= left_paddle_right && ball_right >= left_paddle_left)
+           && (ball_bottom <= left_paddle_top && ball_top >= left_paddle_bottom)
+           && (game_state->ball.velocity.x < REAL(0.0f)))
+        {
+            game_state->ball.position.x = REAL(BALL_AT_LEFT_PADDLE);
+
+            game_state->ball.velocity.x = -game_state->ball.velocity.x;
+            game_state->ball.velocity.y += game_state->left_paddle.velocity.y;
+
+            game_state->collision_detected = true;
+
+            game_state->sound_to_play = SOUND_PADDLE;
+        }
+        else
+        {
+            real right_paddle_half_width =
+                real_divide(game_state->right_paddle.width, REAL(2.0f));
+            real right_paddle_half_height = REAL_HALF_HEIGHT(game_state->right_paddle.height);
+
+            real right_paddle_left =
+                game_state->right_paddle.position.x - right_paddle_half_width;
+            real right_paddle_right =
+                game_state->right_paddle.position.x + right_paddle_half_width;
+            real right_paddle_top =
+                game_state->right_paddle.position.y + right_paddle_half_height;
+            real right_paddle_bottom =
+                game_state->right_paddle.position.y - right_paddle_half_height;
+
+            if((ball_left <= right_paddle_right && ball_right >= right_paddle_left)
+               && (ball_bottom <= right_paddle_top && ball_top >= right_paddle_bottom)
+               && (game_state->ball.velocity.x > REAL(0.0f)))
+            {
+                game_state->ball.position.x = REAL(BALL_AT_RIGHT_PADDLE);
+
+                game_state->ball.velocity.x = -game_state->ball.velocity.x;
+                game_state->ball.velocity.y += game_state->right_paddle.velocity.y;
+
+                game_state->collision_detected = true;
+
+                game_state->sound_to_play = SOUND_PADDLE;
+            }
+        }
+    }
+}
+
+// NOTE(leo): The simulation never touches the back buffer, so headless runs (replays,
+// benchmarks) can skip game_render entirely.
+INTERNAL void
+game_update(GameState *game_state, GameInput *input, f32 last_frame_time_seconds)
+{
+    real delta_time = real_from_f32(last_frame_time_seconds);
+
+    if(!game_state->match_started && input->is_key_down[KEY_ENTER])
+    {
+        game_state->match_started = true;
+
+        game_state->ball.velocity.x =
+            real_multiply(REAL(0.65f), random_real_0_1(&game_state->rng))
+            + REAL(0.65f); // 0.65 <= x < 1.3
+
+#define SEN_75DEG 0.96592582628906828675f
+
+        // NOTE(leo): Generating a velocity vector that is, at maximum, 75 degrees from the X
+        // axis.
+
+        game_state->ball.velocity.y =
+            real_multiply(real_multiply(game_state->ball.velocity.x, REAL(SEN_75DEG)),
+                          random_real_0_1(&game_state->rng));
+
+#undef SEN_75DEG
+
+        // TODO(leo): Decide whether the ball goes up or down randomly.
+        game_state->ball.velocity.y = pcg32_boundedrand_r(&game_state->rng, 2)
+                                        ? game_state->ball.velocity.y
+                                        : -game_state->ball.velocity.y;
+
+        if(game_state->left_points == 0 && game_state->right_points == 0)
+        {
+            // TODO(leo): Decides which player starts with the ball ramdomly.
+            game_state->ball.velocity.x = pcg32_boundedrand_r(&game_state->rng, 2)
+                                            ? game_state->ball.velocity.x
+                                            : -game_state->ball.velocity.x;
+        }
+        else if(game_state->winner == WINNER_RIGHT)
+        {
+            game_state->ball.velocity.x = -game_state->ball.velocity.x;
+        }
+    }
+
+    update_paddles(&game_state->left_paddle, &game_state->right_paddle, input, delta_time);
+
+    update_ball(game_state, delta_time);
+}
+
+// ===========================================================================================
+
+// NOTE(leo): The canonical form of a GameState, for checksums and desync reports: one word
+// per field in a fixed order, so neither padding nor the layout of the struct matters.
+#define GAME_STATE_WORDS_COUNT 28
+
+GLOBAL char *g_game_state_word_names[GAME_STATE_WORDS_COUNT] = {
+    "ball.position.x",
+    "ball.position.y",
+    "ball.velocity.x",
+    "ball.velocity.y",
+    "ball.width",
+    "ball.height",
+    "left_paddle.position.x",
+    "left_paddle.position.y",
+    "left_paddle.velocity.x",
+    "left_paddle.velocity.y",
+    "left_paddle.width",
+    "left_paddle.height",
+    "right_paddle.position.x",
+    "right_paddle.position.y",
+    "right_paddle.velocity.x",
+    "right_paddle.velocity.y",
+    "right_paddle.width",
+    "right_paddle.height",
+    "winner",
+    "match_started",
+    "left_points",
+    "right_points",
+    "rng.state (low)",
+    "rng.state (high)",
+    "rng.inc (low)",
+    "rng.inc (high)",
+    "collision_detected",
+    "sound_to_play",
+};
+
+// NOTE(leo): The words before this one are reals.
+#define GAME_STATE_FIRST_NON_REAL_WORD 18
+
+INTERNAL u32 *
+game_state_write_entity_words(u32 *at, Entity *entity)
+{
+    *at++ = real_bits(entity->position.x);
+    *at++ = real_bits(entity->position.y);
+    *at++ = real_bits(entity->velocity.x);
+    *at++ = real_bits(entity->velocity.y);
+    *at++ = real_bits(entity->width);
+    *at++ = real_bits(entity->height);
+
+    return at;
+}
+
+INTERNAL void
+game_state_canonical_words(GameState *game_state, u32 *words)
+{
+    u32 *at = words;
+
+    at = game_state_write_entity_words(at, &game_state->ball);
+    at = game_state_write_entity_words(at, &game_state->left_paddle);
+    at = game_state_write_entity_words(at, &game_state->right_paddle);
+
+    *at++ = (u32)game_state->winner;
+    *at++ = (u32)game_state->match_started;
+    *at++ = game_state->left_points;
+    *at++ = game_state->right_points;
+    *at++ = (u32)game_state->rng.state;
+    *at++ = (u32)(game_state->rng.state >> 32);
+    *at++ = (u32)game_state->rng.inc;
+    *at++ = (u32)(game_state->rng.inc >> 32);
+    *at++ = (u32)game_state->collision_detected;
+
+    // NOTE(leo): Left over from the last sound when no sound is playing, so it doesn't count.
+    *at++ = game_state->collision_detected ? (u32)game_state->sound_to_play : 0;
+
+    ASSERT(at == words + GAME_STATE_WORDS_COUNT);
+}
+
+INTERNAL u32
+checksum_rotate_left(u32 value, u32 bits)
+{
+    return (value << bits) | (value >> (32 - bits));
+}
+
+// NOTE(leo): MurmurHash3 over the canonical words, a few nanoseconds per tick. It's meant to
+// be chained, passing the checksum of the tick before (0 before the first tick): once two
+// runs of a match differ, every later checksum differs too, so matching checksums at a tick
+// mean every tick before it matched as well, and two logs of checksums can be bisected.
+INTERNAL u32
+game_state_checksum(GameState *game_state, u32 previous_checksum)
+{
+    u32 words[GAME_STATE_WORDS_COUNT];
+    game_state_canonical_words(game_state, words);
+
+    u32 hash = previous_checksum;
+
+    for(u32 i = 0; i < GAME_STATE_WORDS_COUNT; ++i)
+    {
+        u32 word = words[i] * 0xCC9E2D51;
+        word     = checksum_rotate_left(word, 15) * 0x1B873593;
+
+        hash ^= word;
+        hash = (checksum_rotate_left(hash, 13) * 5) + 0xE6546B64;
+    }
+
+    hash ^= GAME_STATE_WORDS_COUNT * sizeof(u32);
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6B;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35;
+    hash ^= hash >> 16;
+
+    return hash;
+}
+
+// NOTE(leo): Prints two states field by field, side by side, marking the fields that
+// differ. Used to report desyncs.
+INTERNAL void
+game_state_print_differences(GameState *a, GameState *b, char *a_name, char *b_name)
+{
+    u32 a_words[GAME_STATE_WORDS_COUNT];
+    u32 b_words[GAME_STATE_WORDS_COUNT];
+
+    game_state_canonical_words(a, a_words);
+    game_state_canonical_words(b, b_words);
+
+    OS_PRINTF_LITERAL("  %a / %a:\n", a_name, b_name);
+
+    for(u32 i = 0; i < GAME_STATE_WORDS_COUNT; ++i)
+    {
+        char *marker = a_words[i] != b_words[i] ? "  <<" : "";
+
+        if(i < GAME_STATE_FIRST_NON_REAL_WORD)
+        {
+            real a_value;
+            real b_value;
+
+            memcpy(&a_value, &a_words[i], sizeof(a_value));
+            memcpy(&b_value, &b_words[i], sizeof(b_value));
+
+            OS_PRINTF_LITERAL("    %a: %.9f (%xu32) / %.9f (%xu32)%a\n",
+                              g_game_state_word_names[i],
+                              (f64)real_to_f32(a_value),
+                              a_words[i],
+                              (f64)real_to_f32(b_value),
+                              b_words[i],
+                              marker);
+        }
+        else
+        {
+            OS_PRINTF_LITERAL("    %a: %u32 / %u32%a\n",
+                              g_game_state_word_names[i],
+                              a_words[i],
+                              b_words[i],
+                              marker);
+        }
+    }
+}
@@ -1,28 +1,12 @@
-#include <stdint.h>
-#include <stdbool.h>
-#include <stdarg.h>
+#include "game_core.c"
 
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wsign-conversion"
+// NOTE(leo): SSE2 is part of x64, it needs no check.
+#include <emmintrin.h>
 
-#include "third_party/ryu/d2fixed.c"
-
-#pragma clang diagnostic pop
-
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wshorten-64-to-32"
-
-#include "third_party/pcg-c-basic-0.9/pcg_basic.c"
-
-#pragma clang diagnostic pop
-
-#include "utils.c"
-
-#include "strings.c"
-#include "os.c"
-
-#include "math.c"
 #include "software_renderer.c"
+#include "glyph_atlas.c"
+#include "compositor.c"
+#include "particles.c"
 #include "sound.c"
 
 // ===========================================================================================
@@ -30,126 +14,180 @@
 #define BACKGROUND_COLOR COLOR(0.03f, 0.03f, 0.03f)
 #define ENTITIES_COLOR   COLOR(1.0f, 1.0f, 1.0f)
 
-#define PADDLE_WIDTH                 0.015f
-#define PADDLE_HEIGHT                0.09f
-#define PADDLE_SIMETRICAL_X_POSITION 0.9f
-#define LEFT_PADDLE_POSITION_X       (-PADDLE_SIMETRICAL_X_POSITION)
-#define RIGHT_PADDLE_POSITION_X      (PADDLE_SIMETRICAL_X_POSITION)
-#define BALL_SCALE                   0.015f
-
 #define MIDDLE_LINE_TICK_WIDTH  0.002f
 #define MIDDLE_LINE_TICK_HEIGHT 0.02f
 #define MIDDLE_LINE_TICK_GAP    (MIDDLE_LINE_TICK_HEIGHT / 2.0f)
 
-#define SCREEN_TOP    1.0f
-#define SCREEN_BOTTOM -1.0f
-#define SCREEN_LEFT   -1.0f
-#define SCREEN_RIGHT  1.0f
-
-#define HALF_HEIGHT(height) ((height * TARGET_ASPECT_RATIO) / 2.0f)
-
 #define MIDDLE_LINE_TICK_AT_TOP    (SCREEN_TOP - HALF_HEIGHT(MIDDLE_LINE_TICK_HEIGHT))
 #define MIDDLE_LINE_TICK_AT_BOTTOM (SCREEN_BOTTOM + HALF_HEIGHT(MIDDLE_LINE_TICK_HEIGHT))
 
-#define PADDLE_AT_TOP    (SCREEN_TOP - HALF_HEIGHT(PADDLE_HEIGHT))
-#define PADDLE_AT_BOTTOM (SCREEN_BOTTOM + HALF_HEIGHT(PADDLE_HEIGHT))
+#define TILE_SCALE 0.0124f
+#define TOP_TILE_Y 0.9f
+#define DIGITS_GAP 2.0f
 
-#define BALL_AT_TOP    (SCREEN_TOP - HALF_HEIGHT(BALL_SCALE))
-#define BALL_AT_BOTTOM (SCREEN_BOTTOM + HALF_HEIGHT(BALL_SCALE))
-
-// ===========================================================================================
+#define RIGHT_SCREEN_FIRST_TILE_X                                                            \
+    ((SCREEN_RIGHT / 2.0f) - (TILE_SCALE * 2.0f) + (TILE_SCALE / 2.0f))
+#define LEFT_SCREEN_FIRST_TILE_X (RIGHT_SCREEN_FIRST_TILE_X + SCREEN_LEFT) // -1.0f
 
-typedef struct
+// NOTE(leo): The scoreboard's digits are 4 by 7 tiles. Only the tiles in these tilemaps are
+// ever ink, the two in the middle of the rows in between are always background.
+#define DIGIT_TILES_COUNT 20
+#define DIGIT_COLUMNS     4
+#define DIGIT_ROWS        7
+
+// NOTE(leo): The sparks of a few hits and the trail fit with room to spare.
+#define GAME_PARTICLES_CAPACITY 2048
+#define PARTICLE_SCALE          0.004f
+
+// NOTE(leo): Sparks fly off at a fraction of the ball's velocity, with some spread, in screen
+// units per second.
+#define SPARKS_PER_HIT    48
+#define SPARK_SPEED_MIN   0.3f
+#define SPARK_SPEED_MAX   1.2f
+#define SPARK_SPREAD      0.6f
+#define SPARK_SECONDS_MIN 0.25f
+#define SPARK_SECONDS_MAX 0.6f
+
+#define TRAIL_PARTICLES_PER_TICK 3
+#define TRAIL_SECONDS            0.15f
+
+// clang-format off
+GLOBAL u8 g_digits_tilemaps[][DIGIT_TILES_COUNT] =
 {
-    v2  position;
-    v2  velocity;
-    f32 width;
-    f32 height;
+    {
+        1, 1, 1, 1,
+        1,       1,
+        1,       1,
+        1, 0, 0, 1, // 0
+        1,       1,
+        1,       1,
+        1, 1, 1, 1
+    },
+    {
+        0, 0, 0, 1,
+        0,       1,
+        0,       1,
+        0, 0, 0, 1, // 1
+        0,       1,
+        0,       1,
+        0, 0, 0, 1
+    },
+    {
+        1, 1, 1, 1,
+        0,       1,
+        0,       1,
+        1, 1, 1, 1, // 2
+        1,       0,
+        1,       0,
+        1, 1, 1, 1
+    },
+    {
+        1, 1, 1, 1,
+        0,       1,
+        0,       1,
+        1, 1, 1, 1, // 3
+        0,       1,
+        0,       1,
+        1, 1, 1, 1
+    },
+    {
+        1, 0, 0, 1,
+        1,       1,
+        1,       1,
+        1, 1, 1, 1, // 4
+        0,       1,
+        0,       1,
+        0, 0, 0, 1
+    },
+    {
+        1, 1, 1, 1,
+        1,       0,
+        1,       0,
+        1, 1, 1, 1, // 5
+        0,       1,
+        0,       1,
+        1, 1, 1, 1
+    },
+    {
+        1, 0, 0, 0,
+        1,       0,
+        1,       0,
+        1, 1, 1, 1, // 6
+        1,       1,
+        1,       1,
+        1, 1, 1, 1
+    },
+    {
+        1, 1, 1, 1,
+        0,       1,
+        0,       1,
+        0, 0, 0, 1, // 7
+        0,       1,
+        0,       1,
+        0, 0, 0, 1
+    },
+    {
+        1, 1, 1, 1,
+        1,       1,
+        1,       1,
+        1, 1, 1, 1, // 8
+        1,       1,
+        1,       1,
+        1, 1, 1, 1
+    },
+    {
+        1, 1, 1, 1,
+        1,       1,
+        1,       1,
+        1, 1, 1, 1, // 9
+        0,       1,
+        0,       1,
+        0, 0, 0, 1
+    }
+};
+// clang-format on
 
-} Entity;
+// NOTE(leo): Where each tile of the tilemaps is in the 4 by 7 grid.
+GLOBAL u8 g_digit_tile_cells[DIGIT_TILES_COUNT] = {
+    0, 1, 2, 3, 4, 7, 8, 11, 12, 13, 14, 15, 16, 19, 20, 23, 24, 25, 26, 27};
 
-typedef enum
-{
-    WINNER_NONE,
-    WINNER_LEFT,
-    WINNER_RIGHT
+// NOTE(leo): A 3 by 5 bitmap font for overlay text, each glyph one octal digit per row, the
+// top row first, the left pixel in the highest bit. The glyphs get an empty column and row
+// to space them. Lowercase letters are drawn in uppercase, anything missing as a space.
+#define FONT_COLUMNS 4
+#define FONT_ROWS    6
 
-} Winner;
+// NOTE(leo): How many font pixels fit the height of the back buffer.
+#define FONT_PIXELS_PER_SCREEN_HEIGHT 180
 
-typedef struct
-{
-    Entity ball;
-    Entity left_paddle;
-    Entity right_paddle;
-    Winner winner;
-    b32    match_started;
-    u32    left_points;
-    u32    right_points;
+GLOBAL char g_font_characters[] = " 0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ.:/%-";
 
-} GameState;
-
-enum
+// clang-format off
+GLOBAL u16 g_font_glyphs[] =
 {
-    KEY_W,
-    KEY_S,
-    KEY_UP,
-    KEY_DOWN,
-    KEY_ENTER,
-
-    KEYS_COUNT
+    000000,
+    075557, 026227, 071747, 071717, 055711, 074717, 074757, 071111, 075757, 075717,
+    025755, 065656, 034443, 065556, 074647, 074644, 034553, 055755, 072227, 011152,
+    055655, 044447, 057755, 065555, 025552, 065644, 025573, 065655, 034716, 072222,
+    055557, 055552, 055775, 055255, 055222, 071247,
+    000002, 002020, 011244, 051245, 000700
 };
+// clang-format on
 
-typedef enum
-{
-    SOUND_POINT,
-    SOUND_WALL,
-    SOUND_PADDLE
+#define GLYPH_SET_DIGITS 0
+#define GLYPH_SET_FONT   1
 
-} SoundToPlay;
+GLOBAL GlyphAtlas g_glyph_atlas = {0};
 
-// NOTE(leo): It doesn't matter how we initialize this variable, as long as g_bytes_remaining
-// is zero, no sound will play.
-GLOBAL SoundToPlay g_sound_to_play;
+// NOTE(leo): Drawn over the frame in the bitmap font when it's not empty. Set by whoever
+// renders, like g_back_buffer.
+GLOBAL String8 g_overlay_text = {0};
 
-GLOBAL b32 g_is_key_down[KEYS_COUNT] = {0};
-GLOBAL b32 g_collision_detected      = false;
+// NOTE(leo): Drawn under the paddles and the ball when set. Set by whoever renders too.
+GLOBAL ParticleSystem *g_particles = NULL;
 
 // ===========================================================================================
 
-INTERNAL void
-set_random_ball_y_position(GameState *game_state)
-{
-    game_state->ball.position.y = random_f32_0_1();
-
-    // NOTE(leo): We need to add (if position is negative) or subtract (if position is
-    // positive) the ball scale to avoid starting with the ball already at the wall, which
-    // would trigger the collision detector and play sound.
-    game_state->ball.position.y = pcg32_boundedrand_r(&g_rng, 2)
-                                    ? game_state->ball.position.y - BALL_SCALE
-                                    : -game_state->ball.position.y + BALL_SCALE;
-}
-
-INTERNAL void
-game_main(GameState *game_state)
-{
-    memset(game_state, 0, sizeof(*game_state));
-
-    game_state->left_paddle.position.x = LEFT_PADDLE_POSITION_X;
-    game_state->left_paddle.width      = PADDLE_WIDTH;
-    game_state->left_paddle.height     = PADDLE_HEIGHT;
-
-    game_state->right_paddle.position.x = RIGHT_PADDLE_POSITION_X;
-    game_state->right_paddle.width      = PADDLE_WIDTH;
-    game_state->right_paddle.height     = PADDLE_HEIGHT;
-
-    game_state->ball.width  = BALL_SCALE;
-    game_state->ball.height = BALL_SCALE;
-
-    pcg32_srandom_r(&g_rng, __rdtsc() ^ (u64)game_state, (u64)&memset);
-
-    set_random_ball_y_position(game_state);
-}
-
 INTERNAL void
 render_middle_line(void)
 {
@@ -174,450 +212,455 @@ render_middle_line(void)
                    ENTITIES_COLOR);
 }
 
-INTERNAL void
+INTERNAL PixelRect
 render_entity(Entity *entity, Color color)
 {
-    draw_rectangle(entity->position.x,
-                   entity->position.y,
-                   entity->width,
-                   entity->height,
-                   color);
+    return draw_rectangle(real_to_f32(entity->position.x),
+                          real_to_f32(entity->position.y),
+                          real_to_f32(entity->width),
+                          real_to_f32(entity->height),
+                          color);
 }
 
+// NOTE(leo): Expands a digit's tilemap into its DIGIT_COLUMNS by DIGIT_ROWS cells.
 INTERNAL void
-update_and_render_paddles(Entity *left_paddle,
-                          Entity *right_paddle,
-                          f32     last_frame_time_seconds)
+digit_to_cells(u32 digit, u8 *cells)
 {
-#define MAX_VELOCITY_Y 2.3f
-#define ACCELERATION   9.0f
-
-    Entity *paddles[]   = {left_paddle, right_paddle};
-    int     up_keys[]   = {KEY_W, KEY_UP};
-    int     down_keys[] = {KEY_S, KEY_DOWN};
+    memset(cells, 0, DIGIT_COLUMNS * DIGIT_ROWS);
 
-    for(size_t i = 0; i < STATIC_ARRAY_LENGTH(paddles); ++i)
+    for(u32 i = 0; i < DIGIT_TILES_COUNT; ++i)
     {
-        Entity *paddle   = paddles[i];
-        int     up_key   = up_keys[i];
-        int     down_key = down_keys[i];
+        cells[g_digit_tile_cells[i]] = g_digits_tilemaps[digit][i];
+    }
+}
 
-        if(g_is_key_down[up_key] && g_is_key_down[down_key])
-        {
-            paddle->velocity.y = 0.0f;
-        }
-        else if(g_is_key_down[up_key])
-        {
-            if(paddle->velocity.y < MAX_VELOCITY_Y)
-            {
-                paddle->velocity.y += ACCELERATION * last_frame_time_seconds;
-            }
-        }
-        else if(g_is_key_down[down_key])
-        {
-            if(paddle->velocity.y > -MAX_VELOCITY_Y)
-            {
-                paddle->velocity.y -= ACCELERATION * last_frame_time_seconds;
-            }
-        }
-        else
-        {
-            paddle->velocity.y = 0.0f;
-        }
+// NOTE(leo): Expands a glyph of g_font_glyphs into its FONT_COLUMNS by FONT_ROWS cells.
+INTERNAL void
+font_glyph_to_cells(u32 glyph, u8 *cells)
+{
+    memset(cells, 0, FONT_COLUMNS * FONT_ROWS);
 
-        v2 paddle_frame_velocity =
-            v2_scalar_multiply(paddle->velocity, last_frame_time_seconds);
-        paddle->position = v2_add(paddle->position, paddle_frame_velocity);
+    for(u32 row = 0; row < 5; ++row)
+    {
+        u32 bits = (g_font_glyphs[glyph] >> (3 * (4 - row))) & 7;
 
-        if(paddle->position.y >= PADDLE_AT_TOP)
+        for(u32 column = 0; column < 3; ++column)
         {
-            paddle->position.y = PADDLE_AT_TOP;
-            paddle->velocity.y = 0.0f;
+            cells[(row * FONT_COLUMNS) + column] = (bits & (4 >> column)) != 0;
         }
-        else if(paddle->position.y <= PADDLE_AT_BOTTOM)
-        {
-            paddle->position.y = PADDLE_AT_BOTTOM;
-            paddle->velocity.y = 0.0f;
-        }
-
-        render_entity(paddle, ENTITIES_COLOR);
     }
-
-#undef MAX_VELOCITY_Y
-#undef ACCELERATION
 }
 
-INTERNAL void
-set_winner(GameState *game_state, Winner winner)
+// NOTE(leo): Makes sure the glyph atlas is built for g_back_buffer. Returns false when glyphs
+// have to be drawn as rectangles instead: for back buffers the atlas doesn't support, while
+// the span renderer records rectangles, or when the tiles are too small to be seen.
+INTERNAL b32
+game_prepare_glyph_atlas(void)
 {
-    memset(&game_state->ball.velocity, 0, sizeof(game_state->ball.velocity));
+    if(g_draw_list)
+    {
+        return false;
+    }
 
-    set_random_ball_y_position(game_state);
+    if(glyph_atlas_is_built_for(&g_glyph_atlas, &g_back_buffer))
+    {
+        return true;
+    }
 
-    game_state->winner = winner;
+    PixelRect tile = rectangle_to_pixels(0.0f, 0.0f, TILE_SCALE, TILE_SCALE);
+    s32 font_pixel = g_back_buffer.height / FONT_PIXELS_PER_SCREEN_HEIGHT;
 
-#define BALL_RESTART_POSITION_X_PADDING 0.07f;
-    if(winner == WINNER_LEFT)
+    if(tile.width <= 0 || tile.height <= 0)
     {
-        game_state->ball.position.x = -BALL_RESTART_POSITION_X_PADDING;
-        game_state->left_points++;
+        return false;
     }
-    else if(winner == WINNER_RIGHT)
+
+    u8 digit_cells[10 * DIGIT_COLUMNS * DIGIT_ROWS];
+    u8 font_cells[STATIC_ARRAY_LENGTH(g_font_glyphs) * FONT_COLUMNS * FONT_ROWS];
+
+    for(u32 digit = 0; digit < 10; ++digit)
+    {
+        digit_to_cells(digit, &digit_cells[digit * DIGIT_COLUMNS * DIGIT_ROWS]);
+    }
+
+    for(u32 glyph = 0; glyph < STATIC_ARRAY_LENGTH(g_font_glyphs); ++glyph)
     {
-        game_state->ball.position.x = BALL_RESTART_POSITION_X_PADDING;
-        game_state->right_points++;
+        font_glyph_to_cells(glyph, &font_cells[glyph * FONT_COLUMNS * FONT_ROWS]);
     }
-#undef BALL_RESTART_POSITION_X_PADDING
 
-    game_state->match_started = false;
+    GlyphSetDefinition definitions[2] = {0};
+
+    definitions[GLYPH_SET_DIGITS].cells        = digit_cells;
+    definitions[GLYPH_SET_DIGITS].glyphs_count = 10;
+    definitions[GLYPH_SET_DIGITS].columns      = DIGIT_COLUMNS;
+    definitions[GLYPH_SET_DIGITS].rows         = DIGIT_ROWS;
+    definitions[GLYPH_SET_DIGITS].cell_width   = tile.width;
+    definitions[GLYPH_SET_DIGITS].cell_height  = tile.height;
+
+    definitions[GLYPH_SET_FONT].cells        = font_cells;
+    definitions[GLYPH_SET_FONT].glyphs_count = STATIC_ARRAY_LENGTH(g_font_glyphs);
+    definitions[GLYPH_SET_FONT].columns      = FONT_COLUMNS;
+    definitions[GLYPH_SET_FONT].rows         = FONT_ROWS;
+    definitions[GLYPH_SET_FONT].cell_width   = font_pixel > 1 ? font_pixel : 1;
+    definitions[GLYPH_SET_FONT].cell_height  = font_pixel > 1 ? font_pixel : 1;
+
+    Color colors[] = {BACKGROUND_COLOR, ENTITIES_COLOR};
+
+    return glyph_atlas_build(&g_glyph_atlas,
+                             &g_back_buffer,
+                             colors,
+                             definitions,
+                             STATIC_ARRAY_LENGTH(definitions));
 }
 
+// NOTE(leo): What glyph_atlas_draw draws, with rectangles: the background of the whole glyph,
+// then the ink one run of cells at a time.
 INTERNAL void
-update_and_render_ball(GameState *game_state, f32 last_frame_time_seconds)
+render_glyph_with_rectangles(u8 *cells, s32 columns, s32 rows, PixelRect cell)
 {
-    g_collision_detected = false;
+    draw_rectangle_in_pixels(cell.x,
+                             cell.y,
+                             cell.width * columns,
+                             cell.height * rows,
+                             BACKGROUND_COLOR);
 
-    v2 ball_frame_velocity =
-        v2_scalar_multiply(game_state->ball.velocity, last_frame_time_seconds);
-    game_state->ball.position = v2_add(game_state->ball.position, ball_frame_velocity);
-
-    if(game_state->ball.position.x > SCREEN_RIGHT)
+    for(s32 row = 0; row < rows; ++row)
     {
-        g_collision_detected = true;
-        g_sound_to_play      = SOUND_POINT;
+        for(s32 column = 0; column < columns;)
+        {
+            s32 run = 0;
 
-        set_winner(game_state, WINNER_LEFT);
-    }
-    else if(game_state->ball.position.x < SCREEN_LEFT)
-    {
-        g_collision_detected = true;
-        g_sound_to_play      = SOUND_POINT;
+            while(column + run < columns && cells[(row * columns) + column + run])
+            {
+                run++;
+            }
 
-        set_winner(game_state, WINNER_RIGHT);
+            if(run)
+            {
+                draw_rectangle_in_pixels(cell.x + (column * cell.width),
+                                         cell.y + (row * cell.height),
+                                         cell.width * run,
+                                         cell.height,
+                                         ENTITIES_COLOR);
+            }
+
+            column += run + 1;
+        }
     }
-    else if(game_state->ball.position.y >= BALL_AT_TOP)
+}
+
+// NOTE(leo): has_atlas is what game_prepare_glyph_atlas returned. When rendering a static
+// layer, the digits are on top of the dynamic one.
+INTERNAL void
+render_scoreboard(GameState *game_state, b32 has_atlas, Compositor *compositor)
+{
+    for(int i = 0; i < 2; ++i)
     {
-        g_collision_detected = true;
-        g_sound_to_play      = SOUND_WALL;
+        u32 points = i == 0 ? game_state->left_points : game_state->right_points;
+
+        // NOTE(leo): From the last digit to the first.
+        u32 digits[10];
+        u32 digits_count = 0;
+
+        do
+        {
+            digits[digits_count++] = points % 10;
+            points /= 10;
+
+        } while(points);
+
+        f32 x = i == 0 ? LEFT_SCREEN_FIRST_TILE_X : RIGHT_SCREEN_FIRST_TILE_X;
+        x -= ((f32)(digits_count - 1) * (TILE_SCALE * DIGITS_GAP));
+
+        for(u32 j = digits_count; j > 0; --j)
+        {
+            u32       digit = digits[j - 1];
+            PixelRect tile  = rectangle_to_pixels(x, TOP_TILE_Y, TILE_SCALE, TILE_SCALE);
+
+            if(has_atlas)
+            {
+                glyph_atlas_draw(&g_glyph_atlas, GLYPH_SET_DIGITS, digit, tile.x, tile.y);
+            }
+            else
+            {
+                u8 cells[DIGIT_COLUMNS * DIGIT_ROWS];
+                digit_to_cells(digit, cells);
+                render_glyph_with_rectangles(cells, DIGIT_COLUMNS, DIGIT_ROWS, tile);
+            }
+
+            if(compositor)
+            {
+                PixelRect box = tile;
+                box.width *= DIGIT_COLUMNS;
+                box.height *= DIGIT_ROWS;
+
+                compositor_add_top_rect(compositor, box);
+            }
 
-        game_state->ball.position.y = BALL_AT_TOP;
-        game_state->ball.velocity.y = -game_state->ball.velocity.y;
+            x += TILE_SCALE * DIGITS_GAP * 3.0f;
+        }
     }
-    else if(game_state->ball.position.y <= BALL_AT_BOTTOM)
-    {
-        g_collision_detected = true;
-        g_sound_to_play      = SOUND_WALL;
+}
 
-        game_state->ball.position.y = BALL_AT_BOTTOM;
-        game_state->ball.velocity.y = -game_state->ball.velocity.y;
+// NOTE(leo): Draws the text in the bitmap font at the top left corner of g_back_buffer.
+// Returns where it drew.
+INTERNAL PixelRect
+render_overlay_text(String8 text, b32 has_atlas)
+{
+    s32 font_pixel = g_back_buffer.height / FONT_PIXELS_PER_SCREEN_HEIGHT;
+
+    if(font_pixel < 1)
+    {
+        font_pixel = 1;
     }
-    else
+
+    // NOTE(leo): One glyph away from the corner.
+    PixelRect cell = {0};
+    cell.x         = font_pixel * FONT_COLUMNS;
+    cell.y         = font_pixel * FONT_ROWS;
+    cell.width     = font_pixel;
+    cell.height    = font_pixel;
+
+    PixelRect drawn = cell;
+    drawn.width     = font_pixel * FONT_COLUMNS * (s32)text.length;
+    drawn.height    = font_pixel * FONT_ROWS;
+
+    for(u32 i = 0; i < text.length; ++i)
     {
-        f32 ball_left   = game_state->ball.position.x - (game_state->ball.width / 2.0f);
-        f32 ball_right  = game_state->ball.position.x + (game_state->ball.width / 2.0f);
-        f32 ball_top    = game_state->ball.position.y + HALF_HEIGHT(game_state->ball.height);
-        f32 ball_bottom = game_state->ball.position.y - HALF_HEIGHT(game_state->ball.height);
-
-        f32 left_paddle_left =
-            game_state->left_paddle.position.x - (game_state->left_paddle.width / 2.0f);
-        f32 left_paddle_right =
-            game_state->left_paddle.position.x + (game_state->left_paddle.width / 2.0f);
-        f32 left_paddle_top =
-            game_state->left_paddle.position.y + HALF_HEIGHT(game_state->left_paddle.height);
-        f32 left_paddle_bottom =
-            game_state->left_paddle.position.y - HALF_HEIGHT(game_state->left_paddle.height);
-
-        if((ball_left <= left_paddle_right && ball_right >= left_paddle_left)
-           && (ball_bottom <= left_paddle_top && ball_top >= left_paddle_bottom)
-           && (game_state->ball.velocity.x < 0.0f))
-        {
-            game_state->ball.position.x =
-                LEFT_PADDLE_POSITION_X + (PADDLE_WIDTH / 2.0f) + (BALL_SCALE / 2.0f);
+        char character = text.data[i];
+        u32  glyph     = 0;
 
-            game_state->ball.velocity.x = -game_state->ball.velocity.x;
-            game_state->ball.velocity.y += game_state->left_paddle.velocity.y;
+        if(character >= 'a' && character <= 'z')
+        {
+            character = (char)(character - 'a' + 'A');
+        }
 
-            g_collision_detected = true;
+        for(u32 j = 0; j < STATIC_ARRAY_LENGTH(g_font_characters) - 1; ++j)
+        {
+            if(g_font_characters[j] == character)
+            {
+                glyph = j;
+                break;
+            }
+        }
 
-            g_sound_to_play = SOUND_PADDLE;
+        if(has_atlas)
+        {
+            glyph_atlas_draw(&g_glyph_atlas, GLYPH_SET_FONT, glyph, cell.x, cell.y);
         }
         else
         {
-            f32 right_paddle_left =
-                game_state->right_paddle.position.x - (game_state->right_paddle.width / 2.0f);
-            f32 right_paddle_right =
-                game_state->right_paddle.position.x + (game_state->right_paddle.width / 2.0f);
-            f32 right_paddle_top = game_state->right_paddle.position.y
-                                 + HALF_HEIGHT(game_state->right_paddle.height);
-            f32 right_paddle_bottom = game_state->right_paddle.position.y
-                                    - HALF_HEIGHT(game_state->right_paddle.height);
-
-            if((ball_left <= right_paddle_right && ball_right >= right_paddle_left)
-               && (ball_bottom <= right_paddle_top && ball_top >= right_paddle_bottom)
-               && (game_state->ball.velocity.x > 0.0f))
-            {
-                game_state->ball.position.x =
-                    RIGHT_PADDLE_POSITION_X - (PADDLE_WIDTH / 2.0f) - (BALL_SCALE / 2.0f);
+            u8 cells[FONT_COLUMNS * FONT_ROWS];
+            font_glyph_to_cells(glyph, cells);
+            render_glyph_with_rectangles(cells, FONT_COLUMNS, FONT_ROWS, cell);
+        }
 
-                game_state->ball.velocity.x = -game_state->ball.velocity.x;
-                game_state->ball.velocity.y += game_state->right_paddle.velocity.y;
+        cell.x += font_pixel * FONT_COLUMNS;
+    }
 
-                g_collision_detected = true;
+    return drawn;
+}
 
-                g_sound_to_play = SOUND_PADDLE;
-            }
-        }
+INTERNAL void
+game_render(GameState *game_state)
+{
+    // TODO(leo): Since it is a waste of time to clear the back buffer every frame, let's find
+    // a way to render only the things that changed with the background color before updating
+    // and rendering with the actual color.
+    clear_back_buffer(BACKGROUND_COLOR);
+
+    render_middle_line();
+
+    if(g_particles)
+    {
+        particles_render(g_particles, PARTICLE_SCALE, ENTITIES_COLOR, BACKGROUND_COLOR);
     }
 
+    render_entity(&game_state->left_paddle, ENTITIES_COLOR);
+    render_entity(&game_state->right_paddle, ENTITIES_COLOR);
+
     if(game_state->match_started)
     {
         render_entity(&game_state->ball, ENTITIES_COLOR);
     }
+
+    b32 has_atlas = game_prepare_glyph_atlas();
+
+    render_scoreboard(game_state, has_atlas, NULL);
+
+    if(g_overlay_text.length)
+    {
+        render_overlay_text(g_overlay_text, has_atlas);
+    }
 }
 
+// NOTE(leo): Same frame as game_render, composited from a static layer with the middle line
+// and the scoreboard, rendered again only when the score or the size of the back buffer
+// changes, and the entities and the overlay text drawn over it (see compositor.c). Back
+// buffers the compositor can't handle are drawn the usual way.
 INTERNAL void
-render_scoreboard(GameState *game_state)
+game_render_layers(GameState *game_state, Compositor *compositor)
 {
-#define TILE_SCALE  0.0124f
-#define TOP_TILE_Y  0.9f
-#define TILES_COUNT 20
-#define DIGITS_GAP  2.0f
-
-#define RIGHT_SCREEN_FIRST_TILE_X                                                            \
-    ((SCREEN_RIGHT / 2.0f) - (TILE_SCALE * 2.0f) + (TILE_SCALE / 2.0f))
-#define LEFT_SCREEN_FIRST_TILE_X (RIGHT_SCREEN_FIRST_TILE_X + SCREEN_LEFT) // -1.0f
+    u64 static_layer_key = ((u64)game_state->left_points << 32) | game_state->right_points;
 
-    // clang-format off
-    int digits_tilemaps[][TILES_COUNT] =
+    if(g_draw_list || !compositor_begin_frame(compositor, static_layer_key))
     {
-        {
-            1, 1, 1, 1,
-            1,       1,
-            1,       1,
-            1, 0, 0, 1, // 0
-            1,       1,
-            1,       1,
-            1, 1, 1, 1
-        },
-        {
-            0, 0, 0, 1,
-            0,       1,
-            0,       1,
-            0, 0, 0, 1, // 1
-            0,       1,
-            0,       1,
-            0, 0, 0, 1
-        },
-        {
-            1, 1, 1, 1,
-            0,       1,
-            0,       1,
-            1, 1, 1, 1, // 2
-            1,       0,
-            1,       0,
-            1, 1, 1, 1
-        },
-        {
-            1, 1, 1, 1,
-            0,       1,
-            0,       1,
-            1, 1, 1, 1, // 3
-            0,       1,
-            0,       1,
-            1, 1, 1, 1
-        },
-        {
-            1, 0, 0, 1,
-            1,       1,
-            1,       1,
-            1, 1, 1, 1, // 4
-            0,       1,
-            0,       1,
-            0, 0, 0, 1
-        },
-        {
-            1, 1, 1, 1,
-            1,       0,
-            1,       0,
-            1, 1, 1, 1, // 5
-            0,       1,
-            0,       1,
-            1, 1, 1, 1
-        },
-        {
-            1, 0, 0, 0,
-            1,       0,
-            1,       0,
-            1, 1, 1, 1, // 6
-            1,       1,
-            1,       1,
-            1, 1, 1, 1
-        },
-        {
-            1, 1, 1, 1,
-            0,       1,
-            0,       1,
-            0, 0, 0, 1, // 7
-            0,       1,
-            0,       1,
-            0, 0, 0, 1
-        },
-        {
-            1, 1, 1, 1,
-            1,       1,
-            1,       1,
-            1, 1, 1, 1, // 8
-            1,       1,
-            1,       1,
-            1, 1, 1, 1
-        },
-        {
-            1, 1, 1, 1,
-            1,       1,
-            1,       1,
-            1, 1, 1, 1, // 9
-            0,       1,
-            0,       1,
-            0, 0, 0, 1
-        }
-    };
-    // clang-format on
+        game_render(game_state);
+        return;
+    }
 
-    Color possible_colors[] = {BACKGROUND_COLOR, ENTITIES_COLOR};
+    b32 has_atlas = game_prepare_glyph_atlas();
 
-    for(int i = 0; i < 2; ++i)
+    if(compositor->is_static_layer_stale)
     {
-        u32 points = i == 0 ? game_state->left_points : game_state->right_points;
+        BackBuffer back_buffer = compositor_begin_static_layer(compositor);
 
-        u32 temp_points  = points;
-        u32 digits_count = temp_points == 0 ? 1 : 0;
-        while(temp_points)
-        {
-            digits_count++;
-            temp_points /= 10;
-        }
+        clear_back_buffer(BACKGROUND_COLOR);
+        render_middle_line();
+        render_scoreboard(game_state, has_atlas, compositor);
 
-        f32 x = i == 0 ? LEFT_SCREEN_FIRST_TILE_X : RIGHT_SCREEN_FIRST_TILE_X;
-        x -= ((f32)(digits_count - 1) * (TILE_SCALE * DIGITS_GAP));
-        f32 y = TOP_TILE_Y;
+        compositor_end_static_layer(compositor, back_buffer);
+    }
 
-        for(u32 j = digits_count; j > 0; --j)
-        {
-            u32 ten_raised_to_j = 10;
-            for(u32 foo = 1; foo < j; ++foo)
-            {
-                ten_raised_to_j *= 10;
-            }
+    compositor_restore_background(compositor);
 
-            u32 digit = (points % ten_raised_to_j) / (ten_raised_to_j / 10);
+    // NOTE(leo): One rectangle around all of them, the compositor can't remember many.
+    if(g_particles && g_particles->count)
+    {
+        PixelRect particles =
+            particles_render(g_particles, PARTICLE_SCALE, ENTITIES_COLOR, BACKGROUND_COLOR);
 
-            PixelRect pixel_rect = {0};
+        compositor_mark_dirty(compositor, particles);
+        compositor_restore_top_rects(compositor, particles);
+    }
 
-            for(size_t k = 0; k < STATIC_ARRAY_LENGTH(digits_tilemaps[0]); ++k)
-            {
-                Color color_to_use = possible_colors[digits_tilemaps[digit][k]];
-
-                if(k == 0)
-                {
-                    pixel_rect = draw_rectangle(x, y, TILE_SCALE, TILE_SCALE, color_to_use);
-                }
-                else
-                {
-                    draw_rectangle_in_pixels(pixel_rect.x,
-                                             pixel_rect.y,
-                                             pixel_rect.width,
-                                             pixel_rect.height,
-                                             color_to_use);
-                }
-
-                pixel_rect.x += ((k >= 4 && k <= 7) || (k >= 12 && k <= 15))
-                                  ? pixel_rect.width * 3
-                                  : pixel_rect.width;
-
-                if(k == 3 || k == 11)
-                {
-                    pixel_rect.x -= pixel_rect.width * 4;
-                    pixel_rect.y += pixel_rect.height;
-                }
-                else if(k == 5 || k == 7 || k == 13 || k == 15)
-                {
-                    pixel_rect.x -= pixel_rect.width * 6;
-                    pixel_rect.y += pixel_rect.height;
-                }
-            }
+    PixelRect entities[3];
+    u32       entities_count = 0;
 
-            x += TILE_SCALE * DIGITS_GAP * 3.0f;
-        }
+    entities[entities_count++] = render_entity(&game_state->left_paddle, ENTITIES_COLOR);
+    entities[entities_count++] = render_entity(&game_state->right_paddle, ENTITIES_COLOR);
+
+    if(game_state->match_started)
+    {
+        entities[entities_count++] = render_entity(&game_state->ball, ENTITIES_COLOR);
     }
 
-#undef TILE_SCALE
-#undef TOP_TILE_Y
-#undef TILES_COUNT
-#undef DIGITS_GAP
+    for(u32 i = 0; i < entities_count; ++i)
+    {
+        compositor_mark_dirty(compositor, entities[i]);
+        compositor_restore_top_rects(compositor, entities[i]);
+    }
 
-#undef RIGHT_SCREEN_FIRST_TILE_X
-#undef LEFT_SCREEN_FIRST_TILE_X
+    // NOTE(leo): Over the scoreboard too, like in game_render.
+    if(g_overlay_text.length)
+    {
+        compositor_mark_dirty(compositor, render_overlay_text(g_overlay_text, has_atlas));
+    }
 }
 
+// NOTE(leo): Same frame as game_render, drawn by recording its rectangles and then drawing
+// them a scanline at a time (see render_draw_list). Only for 0x00RRGGBB back buffers, the
+// others are drawn the usual way.
 INTERNAL void
-game_update_and_render(GameState *game_state, f32 last_frame_time_seconds)
+game_render_spans(GameState *game_state, DrawList *draw_list)
 {
-    // TODO(leo): Since it is a waste of time to clear the back buffer every frame, let's find
-    // a way to render only the things that changed with the background color before updating
-    // and rendering with the actual color.
-    clear_back_buffer(BACKGROUND_COLOR);
-
-    if(!game_state->match_started && g_is_key_down[KEY_ENTER])
+    if(g_back_buffer.format != BACK_BUFFER_RGB)
     {
-        game_state->match_started = true;
-
-        game_state->ball.velocity.x = (0.65f * random_f32_0_1()) + 0.65f; // 0.65 <= x < 1.3
+        game_render(game_state);
+        return;
+    }
 
-#define SEN_75DEG 0.96592582628906828675f
+    g_draw_list = draw_list;
+    game_render(game_state);
+    g_draw_list = NULL;
 
-        // NOTE(leo): Generating a velocity vector that is, at maximum, 75 degrees from the X
-        // axis.
+    if(draw_list->has_overflowed)
+    {
+        game_render(game_state);
+    }
+    else
+    {
+        render_draw_list(draw_list);
+    }
+}
 
-        game_state->ball.velocity.y =
-            game_state->ball.velocity.x * SEN_75DEG * random_f32_0_1();
+INTERNAL f32
+random_f32_between(pcg32_random_t *rng, f32 min, f32 max)
+{
+    return min + ((max - min) * random_f32_0_1(rng));
+}
 
-#undef SEN_75DEG
+// NOTE(leo): After each tick. Sparks where the ball hit a paddle or a wall in it, and the
+// ball's trail. The match doesn't know about them, the random numbers are the particles'.
+INTERNAL void
+game_spawn_particles(GameState *game_state, ParticleSystem *particles)
+{
+    f32 ball_x          = real_to_f32(game_state->ball.position.x);
+    f32 ball_y          = real_to_f32(game_state->ball.position.y);
+    f32 ball_velocity_x = real_to_f32(game_state->ball.velocity.x);
+    f32 ball_velocity_y = real_to_f32(game_state->ball.velocity.y);
 
-        // TODO(leo): Decide whether the ball goes up or down randomly.
-        game_state->ball.velocity.y = pcg32_boundedrand_r(&g_rng, 2)
-                                        ? game_state->ball.velocity.y
-                                        : -game_state->ball.velocity.y;
+    if(game_state->collision_detected && game_state->sound_to_play != SOUND_POINT)
+    {
+        // NOTE(leo): The ball already bounced, the side it hit is the one it's leaving.
+        f32 x = ball_x;
+        f32 y = ball_y;
 
-        if(game_state->left_points == 0 && game_state->right_points == 0)
+        if(game_state->sound_to_play == SOUND_PADDLE)
         {
-            // TODO(leo): Decides which player starts with the ball ramdomly.
-            game_state->ball.velocity.x = pcg32_boundedrand_r(&g_rng, 2)
-                                            ? game_state->ball.velocity.x
-                                            : -game_state->ball.velocity.x;
+            x += ball_velocity_x > 0.0f ? -(BALL_SCALE / 2.0f) : (BALL_SCALE / 2.0f);
         }
-        else if(game_state->winner == WINNER_RIGHT)
+        else
         {
-            game_state->ball.velocity.x = -game_state->ball.velocity.x;
+            y += ball_velocity_y > 0.0f ? -HALF_HEIGHT(BALL_SCALE) : HALF_HEIGHT(BALL_SCALE);
+        }
+
+        pcg32_random_t *rng = &particles->rng;
+
+        for(u32 i = 0; i < SPARKS_PER_HIT; ++i)
+        {
+            f32 speed    = random_f32_between(rng, SPARK_SPEED_MIN, SPARK_SPEED_MAX);
+            f32 spread_x = random_f32_between(rng, -SPARK_SPREAD, SPARK_SPREAD);
+            f32 spread_y = random_f32_between(rng, -SPARK_SPREAD, SPARK_SPREAD);
+            f32 seconds  = random_f32_between(rng, SPARK_SECONDS_MIN, SPARK_SECONDS_MAX);
+
+            particles_spawn(particles,
+                            x,
+                            y,
+                            (ball_velocity_x * speed) + spread_x,
+                            (ball_velocity_y * speed) + spread_y,
+                            seconds);
         }
     }
 
-    render_middle_line();
+    if(game_state->match_started)
+    {
+        f32 half_size = BALL_SCALE / 2.0f;
 
-    update_and_render_paddles(&game_state->left_paddle,
-                              &game_state->right_paddle,
-                              last_frame_time_seconds);
+        for(u32 i = 0; i < TRAIL_PARTICLES_PER_TICK; ++i)
+        {
+            f32 x = ball_x + random_f32_between(&particles->rng, -half_size, half_size);
+            f32 y = ball_y + random_f32_between(&particles->rng, -half_size, half_size);
 
-    update_and_render_ball(game_state, last_frame_time_seconds);
+            particles_spawn(particles, x, y, 0.0f, 0.0f, TRAIL_SECONDS);
+        }
+    }
+}
 
-    render_scoreboard(game_state);
+// NOTE(leo): The only two colors the game draws with, for BACK_BUFFER_BITPLANE buffers.
+INTERNAL void
+game_set_bitplane_palette(BackBuffer *back_buffer)
+{
+    back_buffer->palette[0] = color_to_u32(BACKGROUND_COLOR);
+    back_buffer->palette[1] = color_to_u32(ENTITIES_COLOR);
 }
 
 INTERNAL void
-game_send_audio(void)
+game_send_audio(GameState *game_state)
 {
-    if(g_collision_detected)
+    if(game_state->collision_detected)
     {
-        switch(g_sound_to_play)
+        switch(game_state->sound_to_play)
         {
             case SOUND_POINT:
             {
@@ -0,0 +1,238 @@
+// NOTE(leo): Glyphs rasterized once, in the format and at the size of the back buffer, so
+// drawing one is a row copy per row of pixels instead of a rectangle per tile. A glyph is a
+// grid of cells, each cell either ink or background, and every cell is cell_width by
+// cell_height pixels. The sets of glyphs are stacked in the atlas, the glyphs of a set side
+// by side.
+//
+// The atlas is built for one size of back buffer, the caller rebuilds it when that changes.
+// Only 0x00RRGGBB and grayscale back buffers, the others keep drawing rectangles.
+
+#define GLYPH_ATLAS_MAX_SETS 4
+
+// ===========================================================================================
+
+typedef struct
+{
+    // NOTE(leo): glyphs_count grids of columns by rows cells, row by row, non-zero for ink.
+    u8 *cells;
+    u32 glyphs_count;
+    s32 columns;
+    s32 rows;
+
+    s32 cell_width;
+    s32 cell_height;
+
+} GlyphSetDefinition;
+
+typedef struct
+{
+    // NOTE(leo): Row of the atlas the set starts at.
+    s32 y;
+    s32 glyph_width;
+    s32 glyph_height;
+    u32 glyphs_count;
+
+} GlyphSet;
+
+typedef struct
+{
+    void *pixels;
+    u64   capacity;
+    s32   width;
+    s32   height;
+    u32   bytes_per_pixel;
+
+    // NOTE(leo): What it was built for, to know when to rebuild it.
+    BackBufferFormat format;
+    s32              back_buffer_width;
+    s32              back_buffer_height;
+
+    GlyphSet sets[GLYPH_ATLAS_MAX_SETS];
+    u32      sets_count;
+
+} GlyphAtlas;
+
+// ===========================================================================================
+
+INTERNAL b32
+glyph_atlas_is_built_for(GlyphAtlas *atlas, BackBuffer *back_buffer)
+{
+    return atlas->sets_count && atlas->format == back_buffer->format
+        && atlas->back_buffer_width == back_buffer->width
+        && atlas->back_buffer_height == back_buffer->height;
+}
+
+// NOTE(leo): colors are the background's and the ink's. Returns false if the atlas couldn't
+// be allocated or the format isn't supported, then it's left empty.
+INTERNAL b32
+glyph_atlas_build(GlyphAtlas         *atlas,
+                  BackBuffer         *back_buffer,
+                  Color              *colors,
+                  GlyphSetDefinition *definitions,
+                  u32                 definitions_count)
+{
+    ASSERT(definitions_count <= GLYPH_ATLAS_MAX_SETS);
+
+    atlas->sets_count         = 0;
+    atlas->format             = back_buffer->format;
+    atlas->back_buffer_width  = back_buffer->width;
+    atlas->back_buffer_height = back_buffer->height;
+
+    if(back_buffer->format == BACK_BUFFER_RGB)
+    {
+        atlas->bytes_per_pixel = sizeof(u32);
+    }
+    else if(back_buffer->format == BACK_BUFFER_GRAYSCALE)
+    {
+        atlas->bytes_per_pixel = sizeof(u8);
+    }
+    else
+    {
+        return false;
+    }
+
+    atlas->width  = 0;
+    atlas->height = 0;
+
+    for(u32 i = 0; i < definitions_count; ++i)
+    {
+        GlyphSetDefinition *definition = &definitions[i];
+        GlyphSet           *set        = &atlas->sets[i];
+
+        set->y            = atlas->height;
+        set->glyph_width  = definition->columns * definition->cell_width;
+        set->glyph_height = definition->rows * definition->cell_height;
+        set->glyphs_count = definition->glyphs_count;
+
+        s32 set_width = set->glyph_width * (s32)set->glyphs_count;
+
+        if(set_width > atlas->width)
+        {
+            atlas->width = set_width;
+        }
+
+        atlas->height += set->glyph_height;
+    }
+
+    u64 size = (u64)atlas->width * (u64)atlas->height * atlas->bytes_per_pixel;
+
+    // NOTE(leo): Only grows, shrinking the window doesn't reallocate it.
+    if(size > atlas->capacity)
+    {
+        free(atlas->pixels);
+
+        atlas->pixels   = malloc(size);
+        atlas->capacity = atlas->pixels ? size : 0;
+
+        if(!atlas->pixels)
+        {
+            return false;
+        }
+    }
+
+    u32 pixel_colors[2];
+
+    for(u32 i = 0; i < 2; ++i)
+    {
+        pixel_colors[i] = back_buffer->format == BACK_BUFFER_RGB ? color_to_u32(colors[i])
+                                                                 : color_to_gray(colors[i]);
+    }
+
+    for(u32 i = 0; i < definitions_count; ++i)
+    {
+        GlyphSetDefinition *definition      = &definitions[i];
+        GlyphSet           *set             = &atlas->sets[i];
+        s32                 cells_per_glyph = definition->rows * definition->columns;
+
+        for(s32 y = 0; y < set->glyph_height; ++y)
+        {
+            s32 row  = y / definition->cell_height;
+            u8 *line = (u8 *)atlas->pixels
+                     + ((u64)(set->y + y) * (u64)atlas->width * atlas->bytes_per_pixel);
+
+            for(s32 x = 0; x < set->glyph_width * (s32)set->glyphs_count; ++x)
+            {
+                s32 glyph  = x / set->glyph_width;
+                s32 column = (x % set->glyph_width) / definition->cell_width;
+                u8 *cells  = &definition->cells[glyph * cells_per_glyph];
+                u32 color  = pixel_colors[cells[(row * definition->columns) + column] != 0];
+
+                if(atlas->bytes_per_pixel == sizeof(u32))
+                {
+                    ((u32 *)line)[x] = color;
+                }
+                else
+                {
+                    line[x] = (u8)color;
+                }
+            }
+        }
+    }
+
+    atlas->sets_count = definitions_count;
+
+    return true;
+}
+
+// NOTE(leo): Copies the glyph into g_back_buffer with its top left corner at x, y, clipped
+// to the buffer.
+INTERNAL void
+glyph_atlas_draw(GlyphAtlas *atlas, u32 set_index, u32 glyph, s32 x, s32 y)
+{
+    ASSERT(set_index < atlas->sets_count && glyph_atlas_is_built_for(atlas, &g_back_buffer));
+
+    GlyphSet *set = &atlas->sets[set_index];
+
+    ASSERT(glyph < set->glyphs_count);
+
+    s32 source_x = (s32)glyph * set->glyph_width;
+    s32 source_y = set->y;
+    s32 width    = set->glyph_width;
+    s32 height   = set->glyph_height;
+
+    if(x < 0)
+    {
+        source_x -= x;
+        width += x;
+        x = 0;
+    }
+
+    if(y < 0)
+    {
+        source_y -= y;
+        height += y;
+        y = 0;
+    }
+
+    if(x + width > g_back_buffer.width)
+    {
+        width = g_back_buffer.width - x;
+    }
+
+    if(y + height > g_back_buffer.height)
+    {
+        height = g_back_buffer.height - y;
+    }
+
+    if(width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    u64 bytes_per_pixel = atlas->bytes_per_pixel;
+    u64 source_pitch    = (u64)atlas->width * bytes_per_pixel;
+    u64 dest_pitch      = (u64)g_back_buffer.pitch;
+
+    u8 *source = (u8 *)atlas->pixels + ((u64)source_y * source_pitch)
+               + ((u64)source_x * bytes_per_pixel);
+    u8 *dest   = (u8 *)g_back_buffer.pixels + ((u64)y * dest_pitch)
+               + ((u64)x * bytes_per_pixel);
+
+    for(s32 row = 0; row < height; ++row)
+    {
+        memcpy(dest, source, (u64)width * bytes_per_pixel);
+
+        source += source_pitch;
+        dest += dest_pitch;
+    }
+}
@@ -0,0 +1,461 @@
+// NOTE(leo): General purpose job system. A job is a function and a pointer, and it can submit
+// more jobs. Each worker thread has a Chase-Lev deque: the owner pushes and takes jobs at the
+// bottom without any lock, and the other workers steal from the top with a compare and swap
+// when their own deque is empty. The thread that initializes the system is worker 0 and has a
+// deque too, so the main thread runs jobs while it waits instead of sleeping.
+//
+// Dependencies are expressed with counters. Submitting a job with a counter increments it,
+// and the counter is decremented when the job finishes. job_wait is the fence: it runs jobs
+// (its own first, then stolen ones) until the counter gets to zero, so a job can wait for
+// the jobs it submitted without blocking a thread.
+//
+// There is no thread local storage (the Windows build has no CRT to set it up), so every
+// call takes the JobWorker that's running it. A job gets its worker as the first parameter.
+//
+// Workers that run out of work spin for a while, then sleep on a semaphore. Submitting wakes
+// one of them only if some are asleep, so a busy system makes no system calls.
+
+// NOTE(leo): Power of two. The most jobs one worker can have pending at once, submitted but
+// not started. A worker that submits into a full deque runs one of its jobs first.
+#define JOB_DEQUE_CAPACITY 4096
+
+// NOTE(leo): How many times an idle worker looks for work before it goes to sleep.
+#define JOB_IDLE_SPINS 2048
+
+#define JOB_MAX_WORKERS 64
+
+// ===========================================================================================
+
+typedef struct JobSystem JobSystem;
+typedef struct JobWorker JobWorker;
+
+typedef void JobProc(JobWorker *worker, void *data);
+
+typedef struct
+{
+    u32 pending;
+
+} JobCounter;
+
+typedef struct
+{
+    JobProc    *proc;
+    void       *data;
+    JobCounter *counter;
+
+} Job;
+
+typedef struct
+{
+    // NOTE(leo): 0 is one worker per logical processor. Worker 0 is the thread calling
+    // job_system_init.
+    u32 workers_count;
+
+    // NOTE(leo): Worker i runs on logical processor (first_processor + i) % processors.
+    b32 pin_workers;
+    u32 first_processor;
+
+} JobSystemConfig;
+
+typedef struct
+{
+    u64 jobs_executed;
+    u64 jobs_stolen;
+    u64 failed_steals;
+    u64 sleeps;
+
+} JobWorkerStats;
+
+struct __attribute__((aligned(64))) JobWorker
+{
+    JobSystem *system;
+    u32        index;
+    OsThread   thread;
+
+    pcg32_random_t victims_rng;
+
+    // NOTE(leo): Only the owner writes the jobs and bottom, thieves advance top. The jobs are
+    // stored by value: the owner can only write over a slot once top went past it, so a
+    // thief that copied a job which was written over fails its compare and swap.
+    Job deque[JOB_DEQUE_CAPACITY];
+
+    __attribute__((aligned(64))) s64 top;
+    __attribute__((aligned(64))) s64 bottom;
+
+    __attribute__((aligned(64))) JobWorkerStats stats;
+};
+
+struct JobSystem
+{
+    // NOTE(leo): The workers are cache line aligned inside workers_memory. The Windows build
+    // has no CRT, so no aligned_alloc, only malloc.
+    JobWorker *workers;
+    void      *workers_memory;
+    u32        workers_count;
+
+    OsSemaphore wake_up;
+    u32         sleeping_count;
+    b32         is_shutting_down;
+};
+
+// ===========================================================================================
+
+// NOTE(leo): Field by field, with atomics, because a thief can read a slot while the owner
+// writes it (and then throws the copy away).
+INTERNAL void
+job_store(Job *to, Job *from)
+{
+    __atomic_store_n(&to->proc, from->proc, __ATOMIC_RELAXED);
+    __atomic_store_n(&to->data, from->data, __ATOMIC_RELAXED);
+    __atomic_store_n(&to->counter, from->counter, __ATOMIC_RELAXED);
+}
+
+INTERNAL void
+job_load(Job *to, Job *from)
+{
+    to->proc    = __atomic_load_n(&from->proc, __ATOMIC_RELAXED);
+    to->data    = __atomic_load_n(&from->data, __ATOMIC_RELAXED);
+    to->counter = __atomic_load_n(&from->counter, __ATOMIC_RELAXED);
+}
+
+// NOTE(leo): Owner only.
+INTERNAL void
+job_deque_push(JobWorker *worker, Job *job)
+{
+    s64 bottom = __atomic_load_n(&worker->bottom, __ATOMIC_RELAXED);
+
+    ASSERT(bottom - __atomic_load_n(&worker->top, __ATOMIC_ACQUIRE) < JOB_DEQUE_CAPACITY);
+
+    job_store(&worker->deque[bottom & (JOB_DEQUE_CAPACITY - 1)], job);
+    __atomic_store_n(&worker->bottom, bottom + 1, __ATOMIC_RELEASE);
+}
+
+// NOTE(leo): Owner only. The newest job first, its data is the most likely to be in cache.
+// When one job is left, the owner races the thieves for it on top. Returns false if the deque
+// was empty.
+INTERNAL b32
+job_deque_take(JobWorker *worker, Job *job)
+{
+    s64 bottom = __atomic_load_n(&worker->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&worker->bottom, bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    s64 top = __atomic_load_n(&worker->top, __ATOMIC_RELAXED);
+
+    if(top > bottom)
+    {
+        __atomic_store_n(&worker->bottom, bottom + 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    job_load(job, &worker->deque[bottom & (JOB_DEQUE_CAPACITY - 1)]);
+
+    b32 result = true;
+
+    if(top == bottom)
+    {
+        result = __atomic_compare_exchange_n(&worker->top,
+                                             &top,
+                                             top + 1,
+                                             false,
+                                             __ATOMIC_SEQ_CST,
+                                             __ATOMIC_RELAXED);
+
+        __atomic_store_n(&worker->bottom, bottom + 1, __ATOMIC_RELAXED);
+    }
+
+    return result;
+}
+
+// NOTE(leo): Any thread. The oldest job. Returns false if the deque was empty or another
+// thread got the job first.
+INTERNAL b32
+job_deque_steal(JobWorker *victim, Job *job, b32 *was_contended)
+{
+    s64 top = __atomic_load_n(&victim->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    s64 bottom = __atomic_load_n(&victim->bottom, __ATOMIC_ACQUIRE);
+
+    *was_contended = false;
+
+    if(top >= bottom)
+    {
+        return false;
+    }
+
+    job_load(job, &victim->deque[top & (JOB_DEQUE_CAPACITY - 1)]);
+
+    if(!__atomic_compare_exchange_n(&victim->top,
+                                    &top,
+                                    top + 1,
+                                    false,
+                                    __ATOMIC_SEQ_CST,
+                                    __ATOMIC_RELAXED))
+    {
+        *was_contended = true;
+        return false;
+    }
+
+    return true;
+}
+
+// ===========================================================================================
+
+// NOTE(leo): Its own deque first, then every other worker once, starting from a random one
+// so the thieves spread out. Returns false if there was no job anywhere.
+INTERNAL b32
+job_find(JobWorker *worker, Job *job)
+{
+    if(job_deque_take(worker, job))
+    {
+        return true;
+    }
+
+    JobSystem *system        = worker->system;
+    u32        workers_count = system->workers_count;
+    u32        first         = pcg32_boundedrand_r(&worker->victims_rng, workers_count);
+
+    for(u32 i = 0; i < workers_count; ++i)
+    {
+        JobWorker *victim = &system->workers[(first + i) % workers_count];
+
+        if(victim == worker)
+        {
+            continue;
+        }
+
+        b32 was_contended;
+
+        if(job_deque_steal(victim, job, &was_contended))
+        {
+            worker->stats.jobs_stolen++;
+            return true;
+        }
+
+        if(was_contended)
+        {
+            worker->stats.failed_steals++;
+        }
+    }
+
+    return false;
+}
+
+INTERNAL void
+job_execute(JobWorker *worker, Job *job)
+{
+    job->proc(worker, job->data);
+    worker->stats.jobs_executed++;
+
+    if(job->counter)
+    {
+        __atomic_fetch_sub(&job->counter->pending, 1, __ATOMIC_RELEASE);
+    }
+}
+
+INTERNAL void
+job_worker_thread(void *parameter)
+{
+    JobWorker *worker = parameter;
+    JobSystem *system = worker->system;
+
+    while(!__atomic_load_n(&system->is_shutting_down, __ATOMIC_ACQUIRE))
+    {
+        Job job;
+        b32 has_job = false;
+
+        for(u32 spin = 0; !has_job && spin < JOB_IDLE_SPINS; ++spin)
+        {
+            has_job = job_find(worker, &job);
+
+            if(!has_job)
+            {
+                __builtin_ia32_pause();
+            }
+        }
+
+        if(has_job)
+        {
+            job_execute(worker, &job);
+            continue;
+        }
+
+        // NOTE(leo): Announce the sleep, then look once more. A job submitted after that
+        // look sees the announcement and signals, and the semaphore remembers the signal
+        // even if it comes before the wait.
+        __atomic_fetch_add(&system->sleeping_count, 1, __ATOMIC_SEQ_CST);
+
+        has_job = job_find(worker, &job);
+
+        if(!has_job && !__atomic_load_n(&system->is_shutting_down, __ATOMIC_SEQ_CST))
+        {
+            worker->stats.sleeps++;
+            os_semaphore_wait(&system->wake_up);
+        }
+
+        __atomic_fetch_sub(&system->sleeping_count, 1, __ATOMIC_SEQ_CST);
+
+        if(has_job)
+        {
+            job_execute(worker, &job);
+        }
+    }
+}
+
+// ===========================================================================================
+
+// NOTE(leo): Called by worker 0, once every job finished.
+INTERNAL void
+job_system_shutdown(JobSystem *system)
+{
+    __atomic_store_n(&system->is_shutting_down, true, __ATOMIC_SEQ_CST);
+    os_semaphore_signal(&system->wake_up, system->workers_count);
+
+    for(u32 i = 1; i < system->workers_count; ++i)
+    {
+        os_thread_join(&system->workers[i].thread);
+    }
+
+    os_semaphore_destroy(&system->wake_up);
+    free(system->workers_memory);
+}
+
+// NOTE(leo): Returns false if a thread couldn't be created. The calling thread becomes
+// worker 0, see job_system_main_worker.
+INTERNAL b32
+job_system_init(JobSystem *system, JobSystemConfig *config)
+{
+    u32 processors_count = os_get_processors_count();
+    u32 workers_count    = config->workers_count ? config->workers_count : processors_count;
+
+    workers_count = MIN(workers_count, JOB_MAX_WORKERS);
+
+    memset(system, 0, sizeof(*system));
+
+    system->workers_count  = workers_count;
+    system->workers_memory = malloc((workers_count * sizeof(JobWorker)) + 63);
+    system->workers        = (JobWorker *)(((u64)system->workers_memory + 63) & ~(u64)63);
+
+    if(!system->workers_memory || !os_semaphore_init(&system->wake_up, 0))
+    {
+        free(system->workers_memory);
+        return false;
+    }
+
+    memset(system->workers, 0, workers_count * sizeof(JobWorker));
+
+    for(u32 i = 0; i < workers_count; ++i)
+    {
+        JobWorker *worker = &system->workers[i];
+        worker->system    = system;
+        worker->index     = i;
+
+        pcg32_srandom_r(&worker->victims_rng, (u64)worker, i);
+    }
+
+    if(config->pin_workers)
+    {
+        os_thread_set_affinity(NULL, config->first_processor % processors_count);
+    }
+
+    for(u32 i = 1; i < workers_count; ++i)
+    {
+        JobWorker *worker = &system->workers[i];
+
+        if(!os_thread_create(&worker->thread, job_worker_thread, worker))
+        {
+            // NOTE(leo): Only the ones that started have to be stopped.
+            system->workers_count = i;
+            job_system_shutdown(system);
+            return false;
+        }
+
+        if(config->pin_workers)
+        {
+            os_thread_set_affinity(&worker->thread,
+                                   (config->first_processor + i) % processors_count);
+        }
+    }
+
+    return true;
+}
+
+INTERNAL JobWorker *
+job_system_main_worker(JobSystem *system)
+{
+    return &system->workers[0];
+}
+
+// NOTE(leo): The sum of every worker's stats. Only exact while no job is running.
+INTERNAL JobWorkerStats
+job_system_get_stats(JobSystem *system)
+{
+    JobWorkerStats total = {0};
+
+    for(u32 i = 0; i < system->workers_count; ++i)
+    {
+        JobWorkerStats *stats = &system->workers[i].stats;
+
+        total.jobs_executed += stats->jobs_executed;
+        total.jobs_stolen += stats->jobs_stolen;
+        total.failed_steals += stats->failed_steals;
+        total.sleeps += stats->sleeps;
+    }
+
+    return total;
+}
+
+// NOTE(leo): counter can be NULL for a job nobody waits for.
+INTERNAL void
+job_submit(JobWorker *worker, JobProc *proc, void *data, JobCounter *counter)
+{
+    if(counter)
+    {
+        __atomic_fetch_add(&counter->pending, 1, __ATOMIC_RELAXED);
+    }
+
+    s64 bottom = __atomic_load_n(&worker->bottom, __ATOMIC_RELAXED);
+
+    while(bottom - __atomic_load_n(&worker->top, __ATOMIC_ACQUIRE) >= JOB_DEQUE_CAPACITY)
+    {
+        Job pending_job;
+
+        if(job_deque_take(worker, &pending_job))
+        {
+            job_execute(worker, &pending_job);
+        }
+
+        bottom = __atomic_load_n(&worker->bottom, __ATOMIC_RELAXED);
+    }
+
+    Job job     = {0};
+    job.proc    = proc;
+    job.data    = data;
+    job.counter = counter;
+
+    job_deque_push(worker, &job);
+
+    if(__atomic_load_n(&worker->system->sleeping_count, __ATOMIC_SEQ_CST))
+    {
+        os_semaphore_signal(&worker->system->wake_up, 1);
+    }
+}
+
+// NOTE(leo): The fence. Runs jobs until every job submitted with the counter finished.
+INTERNAL void
+job_wait(JobWorker *worker, JobCounter *counter)
+{
+    while(__atomic_load_n(&counter->pending, __ATOMIC_ACQUIRE))
+    {
+        Job job;
+
+        if(job_find(worker, &job))
+        {
+            job_execute(worker, &job);
+        }
+        else
+        {
+            __builtin_ia32_pause();
+        }
+    }
+}
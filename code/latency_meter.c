@@ -0,0 +1,253 @@
+// NOTE(leo): Input-to-present latency instrumentation. The platform layer stamps each paddle
+// key press with its high resolution counter (QPC on Windows, CLOCK_MONOTONIC on Linux) as
+// soon as it arrives. After each update we check whether the paddle has moved since the
+// press, and the first present of the frame with that update (or a later one) closes the
+// sample. So a sample is the time between the key reaching the program and the paddle
+// movement reaching the BitBlt/present. With a render thread the frame presented can be an
+// older one, or there can be nothing new to present, so the platform layer gives the number
+// of the frame after each update and of the frame presented.
+
+#define LATENCY_HISTOGRAM_BUCKET_MICROSECONDS 250
+#define LATENCY_MAX_FRAMES_TRACKED            8
+
+// NOTE(leo): 100ms worth of buckets, plus one overflow bucket at the end of the histogram.
+#define LATENCY_HISTOGRAM_BUCKETS_COUNT 400
+
+#define LATENCY_REPORT_LITERAL(literal_format, ...)                                          \
+    report_length += STR8_FORMAT_LITERAL(report + report_length,                             \
+                                         report_capacity - report_length,                    \
+                                         literal_format,                                     \
+                                         __VA_ARGS__)
+
+// ===========================================================================================
+
+enum
+{
+    LATENCY_LEFT_PADDLE,
+    LATENCY_RIGHT_PADDLE,
+
+    LATENCY_PADDLES_COUNT
+};
+
+typedef struct
+{
+    s64 arrival_tick;
+    f32 paddle_y_before_update;
+    u32 frames_waited;
+    b32 is_pending;
+    b32 reached_back_buffer;
+
+    // NOTE(leo): The first frame with the paddle moved, once reached_back_buffer.
+    u64 frame;
+
+} LatencyProbe;
+
+typedef struct
+{
+    LatencyProbe probes[LATENCY_PADDLES_COUNT];
+
+    u32 histogram[LATENCY_HISTOGRAM_BUCKETS_COUNT + 1];
+    u32 frames_histogram[LATENCY_MAX_FRAMES_TRACKED + 1];
+
+    u64 samples_count;
+    u64 dropped_count;
+    u64 frames_count;
+    s64 min_ticks;
+    s64 max_ticks;
+    s64 total_ticks;
+    f32 ticks_per_second;
+
+} LatencyMeter;
+
+// ===========================================================================================
+
+INTERNAL void
+latency_meter_init(LatencyMeter *meter, f32 ticks_per_second)
+{
+    memset(meter, 0, sizeof(*meter));
+    meter->ticks_per_second = ticks_per_second;
+    meter->min_ticks        = S64_MAX;
+}
+
+INTERNAL void
+latency_key_pressed(LatencyMeter *meter, u32 paddle_index, s64 arrival_tick)
+{
+    ASSERT(paddle_index < LATENCY_PADDLES_COUNT);
+
+    LatencyProbe *probe = &meter->probes[paddle_index];
+
+    // NOTE(leo): If a press is still waiting to be presented we keep the oldest one, since it
+    // is the one the player is waiting for.
+    if(!probe->is_pending)
+    {
+        probe->arrival_tick        = arrival_tick;
+        probe->frames_waited       = 0;
+        probe->is_pending          = true;
+        probe->reached_back_buffer = false;
+    }
+}
+
+INTERNAL void
+latency_key_released(LatencyMeter *meter, u32 paddle_index)
+{
+    ASSERT(paddle_index < LATENCY_PADDLES_COUNT);
+
+    LatencyProbe *probe = &meter->probes[paddle_index];
+
+    // NOTE(leo): Released before the paddle moved (tapped against a wall, for example).
+    // There is no movement to wait for, so the sample is dropped.
+    if(probe->is_pending && !probe->reached_back_buffer)
+    {
+        probe->is_pending = false;
+        meter->dropped_count++;
+    }
+}
+
+INTERNAL void
+latency_before_update(LatencyMeter *meter, GameState *game_state)
+{
+    meter->probes[LATENCY_LEFT_PADDLE].paddle_y_before_update =
+        real_to_f32(game_state->left_paddle.position.y);
+    meter->probes[LATENCY_RIGHT_PADDLE].paddle_y_before_update =
+        real_to_f32(game_state->right_paddle.position.y);
+}
+
+INTERNAL void
+latency_after_update(LatencyMeter *meter, GameState *game_state, u64 frame)
+{
+    f32 paddles_y[] = {real_to_f32(game_state->left_paddle.position.y),
+                       real_to_f32(game_state->right_paddle.position.y)};
+
+    for(u32 i = 0; i < LATENCY_PADDLES_COUNT; ++i)
+    {
+        LatencyProbe *probe = &meter->probes[i];
+
+        if(probe->is_pending && !probe->reached_back_buffer
+           && (paddles_y[i] != probe->paddle_y_before_update))
+        {
+            probe->reached_back_buffer = true;
+            probe->frame               = frame;
+        }
+    }
+}
+
+// NOTE(leo): Only for presents that put a frame on the screen.
+INTERNAL void
+latency_after_present(LatencyMeter *meter, s64 present_tick, u64 presented_frame)
+{
+    meter->frames_count++;
+
+    for(u32 i = 0; i < LATENCY_PADDLES_COUNT; ++i)
+    {
+        LatencyProbe *probe = &meter->probes[i];
+
+        if(!probe->is_pending)
+        {
+            continue;
+        }
+
+        probe->frames_waited++;
+
+        if(probe->reached_back_buffer && presented_frame >= probe->frame)
+        {
+            s64 latency_ticks = present_tick - probe->arrival_tick;
+            ASSERT(latency_ticks >= 0);
+
+            f32 latency_microseconds =
+                ((f32)latency_ticks * 1000000.0f) / meter->ticks_per_second;
+            u32 bucket = (u32)(latency_microseconds / LATENCY_HISTOGRAM_BUCKET_MICROSECONDS);
+
+            if(bucket > LATENCY_HISTOGRAM_BUCKETS_COUNT)
+            {
+                bucket = LATENCY_HISTOGRAM_BUCKETS_COUNT;
+            }
+
+            u32 frames = probe->frames_waited > LATENCY_MAX_FRAMES_TRACKED
+                           ? LATENCY_MAX_FRAMES_TRACKED
+                           : probe->frames_waited;
+
+            meter->histogram[bucket]++;
+            meter->frames_histogram[frames]++;
+            meter->samples_count++;
+            meter->total_ticks += latency_ticks;
+
+            if(latency_ticks < meter->min_ticks)
+            {
+                meter->min_ticks = latency_ticks;
+            }
+
+            if(latency_ticks > meter->max_ticks)
+            {
+                meter->max_ticks = latency_ticks;
+            }
+
+            probe->is_pending = false;
+        }
+    }
+}
+
+INTERNAL f32
+latency_percentile_milliseconds(LatencyMeter *meter, f32 percentile)
+{
+    u64 target_count = (u64)((f32)meter->samples_count * percentile);
+    u64 accumulated  = 0;
+    u32 bucket       = 0;
+
+    for(; bucket < LATENCY_HISTOGRAM_BUCKETS_COUNT; ++bucket)
+    {
+        accumulated += meter->histogram[bucket];
+
+        if(accumulated > target_count)
+        {
+            break;
+        }
+    }
+
+    // NOTE(leo): Upper edge of the bucket, so we never report less than what happened.
+    return ((f32)(bucket + 1) * LATENCY_HISTOGRAM_BUCKET_MICROSECONDS) / 1000.0f;
+}
+
+INTERNAL u32
+latency_format_report(LatencyMeter *meter, char *report, u32 report_capacity)
+{
+    u32 report_length = 0;
+
+    f32 ms_per_tick = 1000.0f / meter->ticks_per_second;
+
+    LATENCY_REPORT_LITERAL("Input-to-present latency: %u64 samples, %u64 dropped, %u64 "
+                           "frames\n",
+                           meter->samples_count,
+                           meter->dropped_count,
+                           meter->frames_count);
+
+    if(meter->samples_count)
+    {
+        LATENCY_REPORT_LITERAL(
+            "  min %.3f ms, mean %.3f ms, max %.3f ms\n",
+            (f64)((f32)meter->min_ticks * ms_per_tick),
+            (f64)(((f32)meter->total_ticks / (f32)meter->samples_count) * ms_per_tick),
+            (f64)((f32)meter->max_ticks * ms_per_tick));
+
+        LATENCY_REPORT_LITERAL("  p50 <= %.2f ms, p90 <= %.2f ms, p99 <= %.2f ms\n",
+                               (f64)latency_percentile_milliseconds(meter, 0.5f),
+                               (f64)latency_percentile_milliseconds(meter, 0.9f),
+                               (f64)latency_percentile_milliseconds(meter, 0.99f));
+
+        LATENCY_REPORT_LITERAL("  Presents waited (last one is %u32 or more):\n",
+                               LATENCY_MAX_FRAMES_TRACKED);
+
+        for(u32 frames = 0; frames <= LATENCY_MAX_FRAMES_TRACKED; ++frames)
+        {
+            if(meter->frames_histogram[frames])
+            {
+                LATENCY_REPORT_LITERAL("    %u32: %u32\n",
+                                       frames,
+                                       meter->frames_histogram[frames]);
+            }
+        }
+    }
+
+    return report_length;
+}
+
+#undef LATENCY_REPORT_LITERAL
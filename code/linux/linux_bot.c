@@ -0,0 +1,156 @@
+#ifndef __clang__
+// NOTE(leo): Same as the other platform layers, we are using Clang-only stuff.
+    #error This code should only be compiled with Clang.
+#endif // __clang__
+
+#ifndef __x86_64__
+    #error This code should only be compiled for x64.
+#endif // __x86_64__
+
+// ===========================================================================================
+
+// NOTE(leo): Example bot (<executable>_bot). It attaches to the segment of a running game,
+// reads every state the game publishes and answers with what the built-in AI would press.
+// It's a separate process on purpose, to show everything a bot needs is in bot_link.c.
+//
+// Usage: pong_bot <left|right> [easy|medium|hard] [segment name]
+
+#define _GNU_SOURCE
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <x86intrin.h>
+
+#include "../game_core.c"
+#include "../ai.c"
+#include "../bot_link.c"
+
+// ===========================================================================================
+
+#include "linux_os.c"
+#include "linux_common.c"
+
+#define BOT_TICK_SECONDS (1.0f / 60.0f)
+
+// NOTE(leo): How long to wait for the game to create the segment.
+#define BOT_ATTACH_ATTEMPTS 500
+
+// ===========================================================================================
+
+int
+main(int argc, char **argv)
+{
+    g_cpu_ticks_per_second = (f32)NANOSECONDS_PER_SECOND;
+
+    if(argc < 2 || argc > 4
+       || (strcmp(argv[1], "left") != 0 && strcmp(argv[1], "right") != 0))
+    {
+        OS_PRINT_LITERAL("Usage: pong_bot <left|right> [easy|medium|hard] [segment name]\n");
+        return 1;
+    }
+
+    u32          player     = strcmp(argv[1], "right") == 0;
+    AiDifficulty difficulty = AI_MEDIUM;
+    char        *name       = argc >= 4 ? argv[3] : BOT_LINK_DEFAULT_NAME;
+
+    if(argc >= 3)
+    {
+        String8 difficulty_name = {argv[2], (u32)strlen(argv[2])};
+
+        if(!ai_difficulty_from_name(difficulty_name, &difficulty))
+        {
+            LINUX_ERROR_LITERAL("Unknown difficulty %a, use easy, medium or hard.", argv[2]);
+        }
+    }
+
+    BotLink *link = NULL;
+
+    for(u32 attempt = 0; !link && attempt < BOT_ATTACH_ATTEMPTS; ++attempt)
+    {
+        link = os_shared_memory_open(name, sizeof(BotLink), false);
+
+        // NOTE(leo): The game creates the segment, then initializes it.
+        if(!link || !__atomic_load_n(&link->magic, __ATOMIC_ACQUIRE))
+        {
+            if(link)
+            {
+                os_shared_memory_close(name, link, sizeof(BotLink), false);
+                link = NULL;
+            }
+
+            linux_sleep_until(linux_get_cpu_tick() + (NANOSECONDS_PER_SECOND / 100));
+        }
+    }
+
+    if(!link)
+    {
+        LINUX_ERROR_LITERAL("No game to play in the shared memory segment /%a.", name);
+    }
+
+    if(!bot_link_is_compatible(link))
+    {
+        LINUX_ERROR_LITERAL("The game was built from a different version of bot_link.c.");
+    }
+
+    if(!link->is_bot_playing[player])
+    {
+        LINUX_ERROR_LITERAL("The game doesn't let a bot play the %a paddle.", argv[1]);
+    }
+
+    u64 rng_state = __rdtsc() ^ (u64)&link;
+
+    AiPlayer ai;
+    ai_init(&ai, player == 1, difficulty, rng_state, (u64)&ai);
+
+    u64 ticks_answered = 0;
+    u64 last_tick      = U64_MAX;
+
+    // NOTE(leo): Spins between ticks, so the answer comes as soon as the state does.
+    while(bot_link_wait_for_tick(link, last_tick))
+    {
+        GameState game_state;
+        u64       tick = bot_link_read(link, &game_state);
+
+        GameInput input = {0};
+        ai_update(&ai, &game_state, BOT_TICK_SECONDS, &input);
+
+        int up_key   = player ? KEY_UP : KEY_W;
+        int down_key = player ? KEY_DOWN : KEY_S;
+        u32 action   = BOT_ACTION_STAY;
+
+        if(input.is_key_down[up_key] && !input.is_key_down[down_key])
+        {
+            action = BOT_ACTION_UP;
+        }
+        else if(input.is_key_down[down_key] && !input.is_key_down[up_key])
+        {
+            action = BOT_ACTION_DOWN;
+        }
+
+        bot_link_submit(link, player, tick, action);
+
+        last_tick = tick;
+        ticks_answered++;
+    }
+
+    OS_PRINTF_LITERAL("Bot (%a paddle, %S): answered %u64 ticks.\n",
+                      argv[1],
+                      &g_ai_difficulty_names[difficulty],
+                      ticks_answered);
+
+    os_shared_memory_close(name, link, sizeof(BotLink), false);
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+// NOTE(leo): What every Linux program (the headless game and the match server) needs on top
+// of linux_os.c: error reporting and the clock.
+
+#define LINUX_ERROR_LITERAL(literal_error_format, ...)                                       \
+    linux_message(MSG_ERROR, STRING8_LITERAL(literal_error_format), ##__VA_ARGS__)
+
+#define LINUX_WARNING_LITERAL(literal_warning_format, ...)                                   \
+    linux_message(MSG_WARNING, STRING8_LITERAL(literal_warning_format), ##__VA_ARGS__)
+
+#define NANOSECONDS_PER_SECOND 1000000000LL
+
+// ===========================================================================================
+
+typedef enum
+{
+    MSG_ERROR,
+    MSG_WARNING
+
+} MessageType;
+
+GLOBAL f32 g_cpu_ticks_per_second;
+
+// ===========================================================================================
+
+INTERNAL void
+linux_exit(int exit_code)
+{
+    exit(exit_code);
+}
+
+INTERNAL void
+linux_message(MessageType type, String8 message_format, ...)
+{
+    GET_formated_AND_formated_length_FROM_FORMAT_STRING8(message_format);
+
+    int current_error = errno;
+
+    switch(type)
+    {
+        case MSG_ERROR:
+        {
+            OS_PRINT_LITERAL("ERROR: ");
+            os_print((String8) {formated, formated_length});
+            OS_PRINTF_LITERAL("\nerrno: %s32\n", current_error);
+            linux_exit(1);
+            break;
+        }
+        case MSG_WARNING:
+        {
+            OS_PRINT_LITERAL("WARNING: ");
+            os_print((String8) {formated, formated_length});
+            OS_PRINTF_LITERAL("\nerrno: %s32\n", current_error);
+            break;
+        }
+    }
+}
+
+INTERNAL s64
+linux_get_cpu_tick(void)
+{
+    struct timespec time_spec;
+
+    if(clock_gettime(CLOCK_MONOTONIC, &time_spec) != 0)
+    {
+        LINUX_ERROR_LITERAL("Failed to read the monotonic clock.");
+    }
+
+    return ((s64)time_spec.tv_sec * NANOSECONDS_PER_SECOND) + (s64)time_spec.tv_nsec;
+}
+
+INTERNAL f32
+linux_get_seconds_elapsed(s64 init_tick, s64 end_tick)
+{
+    s64 delta = end_tick - init_tick;
+    ASSERT(delta >= 0);
+    return (f32)delta / g_cpu_ticks_per_second;
+}
+
+INTERNAL void
+linux_sleep_until(s64 tick)
+{
+    struct timespec time_spec;
+    time_spec.tv_sec  = tick / NANOSECONDS_PER_SECOND;
+    time_spec.tv_nsec = tick % NANOSECONDS_PER_SECOND;
+
+    // NOTE(leo): Absolute deadline, so being interrupted by a signal just means sleeping
+    // again until the same deadline.
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &time_spec, NULL) == EINTR)
+    {
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef __clang__
+// NOTE(leo): Same as the other platform layers, we are using Clang-only stuff.
+    #error This code should only be compiled with Clang.
+#endif // __clang__
+
+#ifndef __x86_64__
+    #error This code should only be compiled for x64.
+#endif // __x86_64__
+
+// ===========================================================================================
+
+// NOTE(leo): The reinforcement learning environment as a shared library (lib<executable>_env
+// .so), for training bots. Only the functions in pong_env.h are exported, everything else in
+// the unity build is INTERNAL.
+
+#define _GNU_SOURCE
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../game_main.c"
+#include "../ai.c"
+#include "../env.c"
+
+// ===========================================================================================
+
+#include "linux_os.c"
+#include "linux_common.c"
@@ -0,0 +1,229 @@
+#ifndef __clang__
+// NOTE(leo): Same as the other platform layers, we are using Clang-only stuff.
+    #error This code should only be compiled with Clang.
+#endif // __clang__
+
+#ifndef __x86_64__
+    #error This code should only be compiled for x64.
+#endif // __x86_64__
+
+// ===========================================================================================
+
+// NOTE(leo): Example reader of the exported frames (<executable>_frame_reader). It attaches
+// to the segment of a running game, reads every new frame where it is in the segment, the
+// way a viewer uploading it somewhere would, and can save the last one as a PNG. Like the
+// example bot, it's a separate process to show everything a reader needs is in
+// frame_export.c.
+//
+// Usage: pong_frame_reader [seconds] [png file] [segment name]
+
+#define _GNU_SOURCE
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../game_main.c"
+#include "../screenshot.c"
+#include "../frame_export.c"
+
+// ===========================================================================================
+
+#include "linux_os.c"
+#include "linux_common.c"
+
+// NOTE(leo): How long to wait for the game to create the segment.
+#define FRAME_READER_ATTACH_ATTEMPTS 500
+
+// NOTE(leo): How often to look for a new frame. A viewer would do it on its own vsync.
+#define FRAME_READER_POLL_NANOSECONDS (NANOSECONDS_PER_SECOND / 1000)
+
+#define FRAME_READER_SAVE_ATTEMPTS 16
+
+// ===========================================================================================
+
+// NOTE(leo): Stands in for what a viewer does with a frame, reads every byte of it once.
+INTERNAL u64
+frame_reader_consume(u8 *pixels, u64 size)
+{
+    u64 *words  = (u64 *)pixels;
+    u64  result = 0;
+
+    for(u64 i = 0; i < size / sizeof(u64); ++i)
+    {
+        result += words[i];
+    }
+
+    return result;
+}
+
+// NOTE(leo): Encodes the newest frame straight from its slot, again if the game wrote over it
+// meanwhile.
+INTERNAL b32
+frame_reader_save_png(FrameExport *export, char *png_path)
+{
+    crc32_init_tables();
+
+    for(u32 attempt = 0; attempt < FRAME_READER_SAVE_ATTEMPTS; ++attempt)
+    {
+        u32              sequence;
+        FrameExportSlot *slot = frame_export_read_begin(export, &sequence);
+
+        if(!slot)
+        {
+            continue;
+        }
+
+        BackBuffer frame = frame_export_slot_frame(export, slot);
+
+        if(!frame_export_read_end(slot, sequence) || frame.width <= 0 || frame.height <= 0)
+        {
+            continue;
+        }
+
+        u32 *row     = malloc((u64)frame.width * sizeof(u32));
+        u8  *encoded = malloc(screenshot_encoded_capacity(&frame, SCREENSHOT_PNG));
+
+        if(!row || !encoded)
+        {
+            LINUX_ERROR_LITERAL("Failed to allocate the PNG.");
+        }
+
+        u64 size     = screenshot_encode_png(&frame, row, encoded);
+        b32 is_whole = frame_export_read_end(slot, sequence);
+        b32 is_saved = is_whole && os_write_entire_file(png_path, encoded, size);
+
+        free(row);
+        free(encoded);
+
+        if(is_whole)
+        {
+            return is_saved;
+        }
+    }
+
+    return false;
+}
+
+int
+main(int argc, char **argv)
+{
+    g_cpu_ticks_per_second = (f32)NANOSECONDS_PER_SECOND;
+
+    if(argc > 4)
+    {
+        OS_PRINT_LITERAL("Usage: pong_frame_reader [seconds] [png file] [segment name]\n");
+        return 1;
+    }
+
+    f64   seconds  = argc >= 2 ? strtod(argv[1], NULL) : 0.0;
+    char *png_path = argc >= 3 ? argv[2] : NULL;
+    char *name     = argc >= 4 ? argv[3] : FRAME_EXPORT_DEFAULT_NAME;
+
+    FrameExport *export        = NULL;
+    b32          is_compatible = true;
+
+    for(u32 attempt = 0; !export && is_compatible && attempt < FRAME_READER_ATTACH_ATTEMPTS;
+        ++attempt)
+    {
+        export = frame_export_attach(name, &is_compatible);
+
+        if(!export)
+        {
+            linux_sleep_until(linux_get_cpu_tick() + (NANOSECONDS_PER_SECOND / 100));
+        }
+    }
+
+    if(!is_compatible)
+    {
+        LINUX_ERROR_LITERAL("The game was built from a different version of frame_export.c.");
+    }
+
+    if(!export)
+    {
+        LINUX_ERROR_LITERAL("No frames to read in the shared memory segment /%a.", name);
+    }
+
+    u64 frames_read   = 0;
+    u64 frames_missed = 0;
+    u64 reads_torn    = 0;
+    u64 bytes_read    = 0;
+    u64 checksum      = 0;
+    s64 read_ticks    = 0;
+    u64 last_index    = U64_MAX;
+
+    s64 begin = linux_get_cpu_tick();
+    s64 end   = begin + (s64)(seconds * (f64)NANOSECONDS_PER_SECOND);
+
+    // NOTE(leo): 0 seconds reads until the game quits.
+    while(!__atomic_load_n(&export->is_closed, __ATOMIC_ACQUIRE)
+          && (seconds <= 0.0 || linux_get_cpu_tick() < end))
+    {
+        s64              read_begin = linux_get_cpu_tick();
+        u32              sequence;
+        FrameExportSlot *slot = frame_export_read_begin(export, &sequence);
+
+        if(slot && slot->index != last_index)
+        {
+            u64 index = slot->index;
+            u64 size  = MIN(slot->size, export->slot_capacity);
+            u64 sum   = frame_reader_consume(frame_export_pixels(export, slot), size);
+
+            if(frame_export_read_end(slot, sequence))
+            {
+                frames_missed += last_index == U64_MAX ? 0 : index - last_index - 1;
+                frames_read++;
+                bytes_read += size;
+                checksum += sum;
+                read_ticks += linux_get_cpu_tick() - read_begin;
+
+                last_index = index;
+            }
+            else
+            {
+                reads_torn++;
+            }
+
+            continue;
+        }
+
+        linux_sleep_until(linux_get_cpu_tick() + FRAME_READER_POLL_NANOSECONDS);
+    }
+
+    f64 elapsed = (f64)(linux_get_cpu_tick() - begin) / (f64)NANOSECONDS_PER_SECOND;
+
+    OS_PRINTF_LITERAL("Frame reader (/%a, %u32 slots): %u64 frames read in %.2f s, %u64 "
+                      "missed, %u64 reads written over\n"
+                      "  %.3f ms per frame, %.2f MB per frame (checksum %u64)\n",
+                      name,
+                      export->slots_count,
+                      frames_read,
+                      elapsed,
+                      frames_missed,
+                      reads_torn,
+                      (f64)read_ticks / 1000000.0 / (f64)MAX(frames_read, 1),
+                      (f64)bytes_read / 1000000.0 / (f64)MAX(frames_read, 1),
+                      checksum);
+
+    b32 has_failed = png_path && !frame_reader_save_png(export, png_path);
+
+    if(has_failed)
+    {
+        OS_PRINTF_LITERAL("Failed to save the last frame to %a.\n", png_path);
+    }
+
+    frame_export_detach(export, name);
+
+    return has_failed ? 1 : 0;
+}
@@ -0,0 +1,3906 @@
+#ifndef __clang__
+// NOTE(leo): Same as the Windows platform layer, we are using Clang-only stuff.
+    #error This code should only be compiled with Clang.
+#endif // __clang__
+
+#ifndef __x86_64__
+    #error This code should only be compiled for x64.
+#endif // __x86_64__
+
+// ===========================================================================================
+
+// NOTE(leo): This is a headless platform layer. There is no window and no audio, only the
+// game simulation and the software renderer drawing into a back buffer in plain memory. It
+// exists to run the instrumentation, regression and benchmark modes on Linux machines.
+
+#define _GNU_SOURCE
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <spawn.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <x86intrin.h>
+
+#include "../game_main.c"
+#include "../latency_meter.c"
+#include "../replay.c"
+#include "../snapshot_ring.c"
+#include "../netplay.c"
+#include "../spectator.c"
+#include "../ai.c"
+#include "../env.c"
+#include "../bot_link.c"
+#include "../job_system.c"
+#include "../post_process.c"
+#include "../render_pipeline.c"
+#include "../resolution_governor.c"
+#include "../screenshot.c"
+#include "../video.c"
+#include "../frame_export.c"
+
+// ===========================================================================================
+
+#include "linux_os.c"
+#include "linux_common.c"
+
+#define HEADLESS_BACK_BUFFER_WIDTH  1280
+#define HEADLESS_BACK_BUFFER_HEIGHT 720
+#define HEADLESS_REFRESH_RATE       60.0f
+
+// ===========================================================================================
+
+GLOBAL b32 g_is_key_down[KEYS_COUNT] = {0};
+
+GLOBAL struct
+{
+    // NOTE(leo): There is no window to BitBlt to, so presenting is a copy into this buffer.
+    // That way the present call costs about what it costs on Windows.
+    void *front_buffer;
+
+} g_linux = {0};
+
+// ===========================================================================================
+
+// NOTE(leo): Sets the back buffer up like the Windows layer does, rows aligned to
+// BACK_BUFFER_ROW_ALIGNMENT in prefaulted memory. The format must already be set. Returns
+// whether it got explicit huge pages.
+INTERNAL b32
+linux_allocate_back_buffer(BackBuffer *back_buffer, s32 width, s32 height)
+{
+    back_buffer_set_size(back_buffer, width, height, true);
+
+    b32 is_huge;
+    back_buffer->pixels = os_allocate_frame_memory(back_buffer_size(back_buffer), &is_huge);
+
+    if(!back_buffer->pixels)
+    {
+        LINUX_ERROR_LITERAL("Failed to allocate the back buffer.");
+    }
+
+    return is_huge;
+}
+
+INTERNAL void
+linux_free_back_buffer(BackBuffer *back_buffer)
+{
+    os_free_frame_memory(back_buffer->pixels, back_buffer_size(back_buffer));
+    back_buffer->pixels = NULL;
+}
+
+// NOTE(leo): Whether the two frames are the same, pixel for pixel. The padding of the rows
+// isn't part of the frames.
+INTERNAL b32
+linux_back_buffers_match(BackBuffer *a, BackBuffer *b)
+{
+    ASSERT(a->width == b->width && a->height == b->height && a->format == b->format);
+
+    u64 row_size = (u64)back_buffer_row_size(a);
+
+    for(s32 y = 0; y < a->height; ++y)
+    {
+        if(memcmp((u8 *)a->pixels + ((u64)y * (u64)a->pitch),
+                  (u8 *)b->pixels + ((u64)y * (u64)b->pitch),
+                  row_size)
+           != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+INTERNAL void
+linux_resize_graphics(s32 new_width, s32 new_height)
+{
+    if((new_width != g_back_buffer.width) || (new_height != g_back_buffer.height))
+    {
+        linux_free_back_buffer(&g_back_buffer);
+        free(g_linux.front_buffer);
+
+        linux_allocate_back_buffer(&g_back_buffer, new_width, new_height);
+        g_linux.front_buffer = malloc((u64)new_width * (u64)new_height * sizeof(u32));
+
+        if(!g_linux.front_buffer)
+        {
+            LINUX_ERROR_LITERAL("Failed to allocate the front buffer.");
+        }
+    }
+}
+
+// NOTE(leo): Copies the frame into dest without the padding between rows, the way the front
+// buffer (like a window) has it.
+INTERNAL void
+linux_copy_frame(BackBuffer *back_buffer, void *dest)
+{
+    u64 row_size = (u64)back_buffer->width * sizeof(u32);
+
+    if((u64)back_buffer->pitch == row_size)
+    {
+        memcpy(dest, back_buffer->pixels, row_size * (u64)back_buffer->height);
+        return;
+    }
+
+    for(s32 y = 0; y < back_buffer->height; ++y)
+    {
+        memcpy((u8 *)dest + ((u64)y * row_size),
+               (u8 *)back_buffer->pixels + ((u64)y * (u64)back_buffer->pitch),
+               row_size);
+    }
+}
+
+INTERNAL void
+linux_present(void)
+{
+    linux_copy_frame(&g_back_buffer, g_linux.front_buffer);
+}
+
+// ===========================================================================================
+
+// NOTE(leo): Runs the same frame loop as the Windows layer (update, sleep, present) at the
+// headless refresh rate while injecting synthetic key events at random moments of the sleep,
+// which is where real key events arrive. Each event is stamped when injected and applied at
+// the next input poll, so the pipeline measured is the same one measured on Windows. Every
+// press must reach the present right after the frame that polled it, otherwise the test
+// fails.
+INTERNAL int
+linux_run_latency_test(u32 frames_to_run)
+{
+    // NOTE(leo): Fixed seed, so that a failing run can be reproduced.
+    pcg32_random_t input_rng;
+    pcg32_srandom_r(&input_rng, 0x853C49E6748FEA9BULL, 0xDA3E39CB94B95BDBULL);
+
+    linux_resize_graphics(HEADLESS_BACK_BUFFER_WIDTH, HEADLESS_BACK_BUFFER_HEIGHT);
+
+    f32 target_frame_seconds = 1.0f / HEADLESS_REFRESH_RATE;
+    s64 target_frame_ticks   = (s64)(target_frame_seconds * g_cpu_ticks_per_second);
+
+    LatencyMeter meter;
+    latency_meter_init(&meter, g_cpu_ticks_per_second);
+
+    GameState game_state;
+    game_main(&game_state, __rdtsc() ^ (u64)&game_state, (u64)&memset);
+
+    int up_keys[]   = {KEY_W, KEY_UP};
+    int down_keys[] = {KEY_S, KEY_DOWN};
+
+    struct
+    {
+        u32 paddle_index;
+        int key;
+        b32 is_down;
+        s64 arrival_tick;
+        b32 is_queued;
+
+    } synthetic_event = {0};
+
+    f32 last_frame_time_seconds = target_frame_seconds;
+
+    for(u32 frame = 0; frame < frames_to_run; ++frame)
+    {
+        s64 frame_begin_tick = linux_get_cpu_tick();
+
+        if(synthetic_event.is_queued)
+        {
+            g_is_key_down[synthetic_event.key] = synthetic_event.is_down;
+
+            if(synthetic_event.is_down)
+            {
+                latency_key_pressed(&meter,
+                                    synthetic_event.paddle_index,
+                                    synthetic_event.arrival_tick);
+            }
+            else
+            {
+                latency_key_released(&meter, synthetic_event.paddle_index);
+            }
+
+            synthetic_event.is_queued = false;
+        }
+
+        GameInput input;
+        memcpy(input.is_key_down, g_is_key_down, sizeof(g_is_key_down));
+
+        latency_before_update(&meter, &game_state);
+        game_update(&game_state, &input, last_frame_time_seconds);
+        game_render(&game_state);
+        latency_after_update(&meter, &game_state, frame);
+
+        s64 frame_end_tick = frame_begin_tick + target_frame_ticks;
+
+        if(pcg32_boundedrand_r(&input_rng, 4) == 0)
+        {
+            u32 paddle_index = pcg32_boundedrand_r(&input_rng, 2);
+            int up_key       = up_keys[paddle_index];
+            int down_key     = down_keys[paddle_index];
+
+            Entity *paddle =
+                paddle_index == 0 ? &game_state.left_paddle : &game_state.right_paddle;
+
+            synthetic_event.paddle_index = paddle_index;
+
+            if(g_is_key_down[up_key] || g_is_key_down[down_key])
+            {
+                synthetic_event.key     = g_is_key_down[up_key] ? up_key : down_key;
+                synthetic_event.is_down = false;
+            }
+            else
+            {
+                // NOTE(leo): Always away from the closest wall, so the paddle can move.
+                synthetic_event.key     = paddle->position.y > REAL(0.0f) ? down_key : up_key;
+                synthetic_event.is_down = true;
+            }
+
+            s64 now_tick = linux_get_cpu_tick();
+
+            if(now_tick < frame_end_tick)
+            {
+                s64 injection_tick =
+                    now_tick + (s64)pcg32_boundedrand_r(&input_rng,
+                                                        (u32)(frame_end_tick - now_tick));
+                linux_sleep_until(injection_tick);
+            }
+
+            synthetic_event.arrival_tick = linux_get_cpu_tick();
+            synthetic_event.is_queued    = true;
+        }
+
+        linux_sleep_until(frame_end_tick);
+
+        linux_present();
+        latency_after_present(&meter, linux_get_cpu_tick(), frame);
+
+        last_frame_time_seconds =
+            linux_get_seconds_elapsed(frame_begin_tick, linux_get_cpu_tick());
+    }
+
+    char report[2048];
+    u32  report_length = latency_format_report(&meter, report, sizeof(report));
+    os_print((String8) {report, report_length});
+
+    // NOTE(leo): An event that arrives during the sleep of frame N is polled on frame N+1
+    // and must be presented at the end of frame N+1, the first present after the poll.
+    u32 late_samples = 0;
+    for(u32 frames = 2; frames <= LATENCY_MAX_FRAMES_TRACKED; ++frames)
+    {
+        late_samples += meter.frames_histogram[frames];
+    }
+
+    b32 passed = meter.samples_count > 0 && late_samples == 0 && meter.dropped_count == 0;
+
+    OS_PRINTF_LITERAL("Latency test: %a (%u32 late samples)\n",
+                      passed ? "PASSED" : "FAILED",
+                      late_samples);
+
+    return passed ? 0 : 1;
+}
+
+// NOTE(leo): Plays a match with random inputs and random frame times as fast as possible,
+// without rendering, and records it. Useful to produce replays for the replay mode when there
+// is no Windows machine around. Every now and then it also rewinds the match, like a player
+// would with the rewind controls, to exercise the rewind records.
+INTERNAL int
+linux_run_record(char *file_path, u32 ticks_to_run)
+{
+    u64 rng_state    = __rdtsc() ^ (u64)&rng_state;
+    u64 rng_sequence = (u64)&memset;
+
+    pcg32_random_t input_rng;
+    pcg32_srandom_r(&input_rng, rng_state, rng_sequence + 1);
+
+    GameState game_state;
+    game_main(&game_state, rng_state, rng_sequence);
+
+    ReplayRecorder recorder;
+    replay_recorder_init(&recorder, REPLAY_RECORDER_CAPACITY, rng_state, rng_sequence);
+
+    RewindController rewind;
+    rewind_init(&rewind, &game_state);
+
+    GameInput input = {0};
+
+    for(u32 tick = 0; tick < ticks_to_run; ++tick)
+    {
+        if(pcg32_boundedrand_r(&input_rng, 2000) == 0)
+        {
+            rewind_step(&rewind, -(s32)pcg32_boundedrand_r(&input_rng, 600));
+
+            u64 ticks_back = rewind_resume(&rewind, &game_state);
+            replay_record_rewind(&recorder, ticks_back, &game_state);
+        }
+
+        // NOTE(leo): Each key flips once every 16 ticks on average, which is a lot more
+        // than a human does, but it exercises the encoder.
+        for(u32 key = 0; key < KEYS_COUNT; ++key)
+        {
+            if(pcg32_boundedrand_r(&input_rng, 16) == 0)
+            {
+                input.is_key_down[key] = !input.is_key_down[key];
+            }
+        }
+
+        // NOTE(leo): 60Hz with some jitter, like a real frame time.
+        f32 delta_time_seconds =
+            (1.0f / HEADLESS_REFRESH_RATE) + ((random_f32_0_1(&input_rng) - 0.5f) * 0.002f);
+
+        game_update(&game_state, &input, delta_time_seconds);
+        replay_record_tick(&recorder, &input, delta_time_seconds, &game_state);
+        rewind_record_tick(&rewind, &game_state);
+    }
+
+    if(!replay_save(&recorder, file_path))
+    {
+        LINUX_ERROR_LITERAL("Failed to save the replay to %a.", file_path);
+    }
+
+    OS_PRINTF_LITERAL("Recorded %u32 ticks (%u64 bytes, %.2f bytes per tick) to %a.\n"
+                      "Final score: %u32 x %u32\n",
+                      ticks_to_run,
+                      recorder.size,
+                      (f64)recorder.size / (f64)ticks_to_run,
+                      file_path,
+                      game_state.left_points,
+                      game_state.right_points);
+
+    return 0;
+}
+
+// NOTE(leo): Feeds the recorded inputs and delta times back to the simulation at maximum
+// speed and checks the state after every tick against the recorded checksum, and the final
+// state against the recorded one, bit for bit. On the first tick that diverges, the states
+// before and after it are dumped. With render the frames are also rasterized, so recorded
+// matches work as rendering workloads.
+INTERNAL int
+linux_run_replay(char *file_path, b32 render)
+{
+    FileContents file = os_read_entire_file(file_path);
+
+    ReplayPlayer player;
+    if(!replay_player_open(&player, file))
+    {
+        LINUX_ERROR_LITERAL("Failed to open %a as a replay.", file_path);
+    }
+
+    if(render)
+    {
+        linux_resize_graphics(HEADLESS_BACK_BUFFER_WIDTH, HEADLESS_BACK_BUFFER_HEIGHT);
+    }
+
+    GameState game_state;
+    game_main(&game_state, player.header->rng_state, player.header->rng_sequence);
+
+    SnapshotRing ring;
+    snapshot_ring_init(&ring, SNAPSHOT_RING_CAPACITY);
+    snapshot_ring_push(&ring, &game_state);
+
+    s64 begin_tick = linux_get_cpu_tick();
+
+    GameInput input;
+    f32       delta_time_seconds;
+    u64       ticks_back;
+    u64       ticks_simulated  = 0;
+    u64       diverged_at_tick = U64_MAX;
+    u32       checksum         = 0;
+    GameState state_before_divergence;
+    GameState state_after_divergence;
+
+    for(;;)
+    {
+        ReplayRecordType record_type =
+            replay_next_record(&player, &input, &delta_time_seconds, &ticks_back);
+
+        if(record_type == REPLAY_RECORD_END)
+        {
+            break;
+        }
+        else if(record_type == REPLAY_RECORD_REWIND)
+        {
+            u64 tick = snapshot_ring_newest_tick(&ring) - ticks_back;
+
+            if(!snapshot_ring_has(&ring, tick))
+            {
+                LINUX_ERROR_LITERAL("Replay rewinds further than the snapshot ring holds.");
+            }
+
+            game_state = *snapshot_ring_get(&ring, tick);
+            snapshot_ring_truncate(&ring, tick);
+        }
+        else
+        {
+            game_update(&game_state, &input, delta_time_seconds);
+            snapshot_ring_push(&ring, &game_state);
+
+            checksum = game_state_checksum(&game_state, checksum);
+
+            if(diverged_at_tick == U64_MAX && checksum != player.tick_checksum)
+            {
+                diverged_at_tick        = ticks_simulated;
+                state_before_divergence =
+                    *snapshot_ring_get(&ring, snapshot_ring_newest_tick(&ring) - 1);
+                state_after_divergence  = game_state;
+            }
+
+            ticks_simulated++;
+
+            if(render)
+            {
+                game_render(&game_state);
+            }
+        }
+    }
+
+    f32 seconds = linux_get_seconds_elapsed(begin_tick, linux_get_cpu_tick());
+
+    b32 passed = (player.records_read == player.header->records_count)
+              && (diverged_at_tick == U64_MAX)
+              && (memcmp(&game_state, player.final_state, sizeof(GameState)) == 0);
+
+    if(diverged_at_tick != U64_MAX)
+    {
+        OS_PRINTF_LITERAL("The state first differs from the recording after tick %u64:\n",
+                          diverged_at_tick);
+        game_state_print_differences(&state_before_divergence,
+                                     &state_after_divergence,
+                                     "before the tick",
+                                     "after the tick");
+    }
+
+    OS_PRINTF_LITERAL("Replayed %u64 of %u64 records (%u64 ticks) in %.3f ms (%.0f ticks "
+                      "per second)%a.\n"
+                      "Final score: %u32 x %u32\n"
+                      "Replay: %a\n",
+                      player.records_read,
+                      player.header->records_count,
+                      ticks_simulated,
+                      (f64)seconds * 1000.0,
+                      (f64)ticks_simulated / (f64)seconds,
+                      render ? ", rendering" : "",
+                      game_state.left_points,
+                      game_state.right_points,
+                      passed ? "MATCHED" : "DIVERGED");
+
+    return passed ? 0 : 1;
+}
+
+// NOTE(leo): Plays a netplay match between two sessions in this process, over UDP on
+// loopback, with artificial latency, jitter and loss in both directions. Time is simulated:
+// every frame is one tick, but frames run as fast as possible. Both players press random
+// keys. At the end, both sessions must be in the same state as a plain simulation of the
+// inputs that were actually played, bit for bit, and must never have seen a checksum that
+// didn't match.
+//
+// Every confirmed state of both sessions is kept, so when a desync is noticed the first tick
+// they differ on is bisected from their checksums and both states are dumped. Passing a
+// desync tick corrupts the right player's match on that tick, to see it happen.
+INTERNAL int
+linux_run_netplay_test(u32 ticks_to_run,
+                       f32 latency_ms,
+                       f32 jitter_ms,
+                       f32 loss_percent,
+                       u32 desync_tick)
+{
+#define LOOPBACK_IPV4 0x7F000001 // NOTE(leo): 127.0.0.1
+
+    u64 rng_state    = __rdtsc() ^ (u64)&rng_state;
+    u64 rng_sequence = (u64)&memset;
+
+    pcg32_random_t input_rng;
+    pcg32_srandom_r(&input_rng, rng_state, rng_sequence + 1);
+
+    u32 players[] = {NETPLAY_LEFT_PLAYER, NETPLAY_RIGHT_PLAYER};
+
+    UdpSocket          sockets[2];
+    NetplaySession     sessions[2];
+    NetplayConditioner conditioners[2];
+    NetplayInput       held_inputs[2] = {0};
+    NetplayInput      *played_inputs[2];
+    u32               *checksum_logs[2];
+    GameState         *state_logs[2];
+    u32                logged_ticks[2] = {0};
+    b32                is_desync_injected = false;
+
+    for(u32 i = 0; i < 2; ++i)
+    {
+        if(!os_udp_open(&sockets[i], 0))
+        {
+            LINUX_ERROR_LITERAL("Failed to open a UDP socket.");
+        }
+
+        netplay_session_init(&sessions[i], players[i], rng_state, rng_sequence);
+        netplay_conditioner_init(&conditioners[i],
+                                 latency_ms / 1000.0f,
+                                 jitter_ms / 1000.0f,
+                                 loss_percent / 100.0f,
+                                 rng_state + i);
+
+        played_inputs[i] = malloc(ticks_to_run * sizeof(NetplayInput));
+        checksum_logs[i] = malloc(ticks_to_run * sizeof(u32));
+        state_logs[i]    = malloc(ticks_to_run * sizeof(GameState));
+
+        if(!played_inputs[i] || !checksum_logs[i] || !state_logs[i])
+        {
+            LINUX_ERROR_LITERAL("Failed to allocate the played inputs.");
+        }
+    }
+
+    // NOTE(leo): Generous, so that only a session that got stuck fails the test.
+    u32 max_frames = (ticks_to_run * 4) + (NETPLAY_TICKS_PER_SECOND * 10);
+
+    f64 now_seconds       = 0.0;
+    u32 frames            = 0;
+    f32 max_frame_work_ms = 0.0f;
+    b32 is_done           = false;
+
+    NetplayPacket packet;
+
+    while(!is_done && frames < max_frames)
+    {
+        for(u32 i = 0; i < 2; ++i)
+        {
+            NetplaySession *session = &sessions[i];
+
+            s64 work_begin_tick = linux_get_cpu_tick();
+
+            for(;;)
+            {
+                NetAddress from;
+                u32        size = os_udp_receive(&sockets[i], &from, &packet, sizeof(packet));
+
+                if(!size)
+                {
+                    break;
+                }
+
+                netplay_receive_packet(session, &packet, size);
+            }
+
+            if(session->current_tick < ticks_to_run)
+            {
+                // NOTE(leo): Holds a direction for a while, like a player would, and taps
+                // enter every now and then to serve.
+                if(pcg32_boundedrand_r(&input_rng, 20) == 0)
+                {
+                    NetplayInput directions[] = {0, NETPLAY_INPUT_UP, NETPLAY_INPUT_DOWN};
+                    held_inputs[i] = directions[pcg32_boundedrand_r(&input_rng, 3)];
+                }
+
+                NetplayInput input = held_inputs[i];
+
+                if(pcg32_boundedrand_r(&input_rng, 120) == 0)
+                {
+                    input |= NETPLAY_INPUT_ENTER;
+                }
+
+                if(netplay_advance(session, input))
+                {
+                    played_inputs[i][session->current_tick - 1] = input;
+                }
+            }
+            else
+            {
+                netplay_synchronize(session);
+            }
+
+            f32 frame_work_ms =
+                linux_get_seconds_elapsed(work_begin_tick, linux_get_cpu_tick()) * 1000.0f;
+
+            if(frame_work_ms > max_frame_work_ms)
+            {
+                max_frame_work_ms = frame_work_ms;
+            }
+
+            if(i == NETPLAY_RIGHT_PLAYER && !is_desync_injected && session->is_running
+               && session->current_tick >= desync_tick)
+            {
+                // NOTE(leo): In every state that wasn't checksummed yet, so that a rollback
+                // can't undo it.
+                for(u32 tick = session->checksummed_ticks; tick <= session->current_tick;
+                    ++tick)
+                {
+                    snapshot_ring_get(&session->snapshots, tick)->rng.state ^= 1;
+                }
+
+                session->game_state.rng.state ^= 1;
+                is_desync_injected = true;
+            }
+
+            u32 packet_size = netplay_build_packet(session, &packet);
+            netplay_conditioner_push(&conditioners[i], now_seconds, &packet, packet_size);
+
+            while(logged_ticks[i] < session->checksummed_ticks)
+            {
+                u32 tick = logged_ticks[i]++;
+
+                checksum_logs[i][tick] = session->checksums[NETPLAY_INPUT_INDEX(tick)];
+                state_logs[i][tick]    = *snapshot_ring_get(&session->snapshots, tick + 1);
+            }
+        }
+
+        now_seconds += (f64)NETPLAY_TICK_SECONDS;
+
+        for(u32 i = 0; i < 2; ++i)
+        {
+            NetAddress to = {LOOPBACK_IPV4, sockets[1 - i].port};
+
+            for(;;)
+            {
+                u32 size = netplay_conditioner_pop(&conditioners[i], now_seconds, &packet);
+
+                if(!size)
+                {
+                    break;
+                }
+
+                os_udp_send(&sockets[i], to, &packet, size);
+            }
+        }
+
+        frames++;
+
+        is_done = true;
+        for(u32 i = 0; i < 2; ++i)
+        {
+            is_done = is_done && sessions[i].current_tick == ticks_to_run
+                   && sessions[i].remote_confirmed_ticks == ticks_to_run
+                   && !sessions[i].has_misprediction;
+        }
+    }
+
+    // NOTE(leo): What both sessions should have ended up with.
+    GameState expected_state;
+    game_main(&expected_state, sessions[0].rng_state, sessions[0].rng_sequence);
+
+    for(u32 tick = 0; is_done && tick < ticks_to_run; ++tick)
+    {
+        GameInput input = netplay_game_input(played_inputs[0][tick], played_inputs[1][tick]);
+        game_update(&expected_state, &input, NETPLAY_TICK_SECONDS);
+    }
+
+    b32 passed = is_done && !sessions[0].has_desync && !sessions[1].has_desync
+              && memcmp(&sessions[0].game_state, &expected_state, sizeof(GameState)) == 0
+              && memcmp(&sessions[1].game_state, &expected_state, sizeof(GameState)) == 0;
+
+    OS_PRINTF_LITERAL("Netplay test: %u32 ticks, %.1f ms latency, %.1f ms jitter, %.1f%% "
+                      "loss, %u32 frames\n",
+                      ticks_to_run,
+                      (f64)latency_ms,
+                      (f64)jitter_ms,
+                      (f64)loss_percent,
+                      frames);
+
+    char *player_names[] = {"left: ", "right:"};
+
+    for(u32 i = 0; i < 2; ++i)
+    {
+        NetplayStats *stats = &sessions[i].stats;
+
+        OS_PRINTF_LITERAL("  %a %u64 ticks, %u64 stalled, %u64 rollbacks, %u64 ticks "
+                          "resimulated (at most %u32 at once), %u64 packets sent, %u64 "
+                          "received, %u64 dropped, %u64 checksums compared\n",
+                          player_names[i],
+                          stats->ticks_advanced,
+                          stats->ticks_stalled,
+                          stats->rollbacks,
+                          stats->ticks_resimulated,
+                          stats->max_rollback_ticks,
+                          stats->packets_sent,
+                          stats->packets_received,
+                          conditioners[i].packets_dropped,
+                          stats->checksums_compared);
+
+        if(sessions[i].has_desync)
+        {
+            OS_PRINTF_LITERAL("  %a desync noticed on tick %u32, the ticks before %u32 "
+                              "were verified\n",
+                              player_names[i],
+                              sessions[i].desync_tick,
+                              sessions[i].verified_ticks);
+        }
+    }
+
+    if(sessions[0].has_desync || sessions[1].has_desync)
+    {
+        // NOTE(leo): The checksums are chained, so once the logs differ they differ until
+        // the end.
+        u32 low  = 0;
+        u32 high = MIN(logged_ticks[0], logged_ticks[1]);
+
+        while(low < high)
+        {
+            u32 middle = low + ((high - low) / 2);
+
+            if(checksum_logs[0][middle] == checksum_logs[1][middle])
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+
+        if(low < MIN(logged_ticks[0], logged_ticks[1]))
+        {
+            OS_PRINTF_LITERAL("  The states first differ after tick %u32:\n", low);
+            game_state_print_differences(&state_logs[0][low],
+                                         &state_logs[1][low],
+                                         "left player",
+                                         "right player");
+        }
+    }
+
+    OS_PRINTF_LITERAL("  Worst frame work (receive, rollback and advance): %.3f ms, the "
+                      "tick is %.3f ms\n"
+                      "  Final score: %u32 x %u32\n"
+                      "Netplay test: %a\n",
+                      (f64)max_frame_work_ms,
+                      (f64)(NETPLAY_TICK_SECONDS * 1000.0f),
+                      expected_state.left_points,
+                      expected_state.right_points,
+                      passed ? "PASSED" : "FAILED");
+
+    return passed ? 0 : 1;
+
+#undef LOOPBACK_IPV4
+}
+
+// NOTE(leo): Streams a match with random inputs to a simulated spectator that loses some
+// packets and acknowledges with a round trip of delay. The encoder and the decoder are timed
+// in separate passes over the same packets, so neither pays for the other or for the
+// simulation. Every decoded snapshot must match the quantized state exactly.
+INTERNAL int
+linux_run_spectator_bench(u32 ticks_to_run,
+                          u32 position_fraction_bits,
+                          u32 velocity_fraction_bits,
+                          f32 loss_percent)
+{
+#define ACKNOWLEDGEMENT_DELAY_TICKS 6 // NOTE(leo): 100ms round trip.
+
+    SpectatorConfig config       = {position_fraction_bits, velocity_fraction_bits};
+    u64             rng_state    = __rdtsc() ^ (u64)&rng_state;
+    u64             rng_sequence = (u64)&memset;
+
+    pcg32_random_t input_rng;
+    pcg32_srandom_r(&input_rng, rng_state, rng_sequence + 1);
+
+    GameState *states         = malloc(ticks_to_run * sizeof(GameState));
+    b32       *is_delivered   = malloc(ticks_to_run * sizeof(b32));
+    u32       *packet_offsets = malloc((ticks_to_run + 1) * sizeof(u32));
+    u8        *packets        = malloc((u64)ticks_to_run * SPECTATOR_MAX_PACKET_SIZE);
+
+    if(!states || !is_delivered || !packet_offsets || !packets)
+    {
+        LINUX_ERROR_LITERAL("Failed to allocate the benchmark for %u32 ticks.", ticks_to_run);
+    }
+
+    GameState    game_state;
+    NetplayInput held_inputs[2] = {0};
+
+    game_main(&game_state, rng_state, rng_sequence);
+
+    for(u32 tick = 0; tick < ticks_to_run; ++tick)
+    {
+        for(u32 player = 0; player < 2; ++player)
+        {
+            if(pcg32_boundedrand_r(&input_rng, 20) == 0)
+            {
+                NetplayInput directions[] = {0, NETPLAY_INPUT_UP, NETPLAY_INPUT_DOWN};
+                held_inputs[player] = directions[pcg32_boundedrand_r(&input_rng, 3)];
+            }
+        }
+
+        NetplayInput enter = 0;
+
+        if(pcg32_boundedrand_r(&input_rng, 120) == 0)
+        {
+            enter = NETPLAY_INPUT_ENTER;
+        }
+
+        GameInput input = netplay_game_input(held_inputs[0] | enter, held_inputs[1]);
+
+        game_update(&game_state, &input, NETPLAY_TICK_SECONDS);
+
+        states[tick]       = game_state;
+        is_delivered[tick] = random_f32_0_1(&input_rng) * 100.0f >= loss_percent;
+    }
+
+    // NOTE(leo): Encoding. The spectator acknowledges the newest snapshot it got, and the
+    // server learns about it a round trip later.
+    SpectatorEncoder encoder;
+    spectator_encoder_init(&encoder, config);
+
+    u32 acknowledged_tick = SPECTATOR_NO_TICK;
+    u32 keyframes_count   = 0;
+    u32 max_packet_size   = 0;
+
+    s64 encode_begin = linux_get_cpu_tick();
+
+    packet_offsets[0] = 0;
+
+    for(u32 tick = 0; tick < ticks_to_run; ++tick)
+    {
+        if(tick >= ACKNOWLEDGEMENT_DELAY_TICKS
+           && is_delivered[tick - ACKNOWLEDGEMENT_DELAY_TICKS])
+        {
+            acknowledged_tick = tick - ACKNOWLEDGEMENT_DELAY_TICKS;
+        }
+
+        spectator_encoder_push(&encoder, &states[tick]);
+
+        u32 size = spectator_encode(&encoder,
+                                    acknowledged_tick,
+                                    packets + packet_offsets[tick],
+                                    SPECTATOR_MAX_PACKET_SIZE);
+
+        packet_offsets[tick + 1] = packet_offsets[tick] + size;
+
+        if(size > max_packet_size)
+        {
+            max_packet_size = size;
+        }
+
+        // NOTE(leo): The byte after the tick is the distance to the baseline, 0 for a
+        // keyframe.
+        keyframes_count += packets[packet_offsets[tick] + 4] == 0 ? 1 : 0;
+    }
+
+    s64 encode_time = linux_get_cpu_tick() - encode_begin;
+
+    // NOTE(leo): Decoding.
+    SpectatorDecoder decoder;
+    spectator_decoder_init(&decoder, config);
+
+    u32 decode_failures = 0;
+    s64 decode_begin    = linux_get_cpu_tick();
+
+    for(u32 tick = 0; tick < ticks_to_run; ++tick)
+    {
+        if(is_delivered[tick])
+        {
+            u32 size = packet_offsets[tick + 1] - packet_offsets[tick];
+
+            if(!spectator_decode(&decoder, packets + packet_offsets[tick], size))
+            {
+                decode_failures++;
+            }
+        }
+    }
+
+    s64 decode_time = linux_get_cpu_tick() - decode_begin;
+
+    // NOTE(leo): Verification, untimed. Also samples halfway between ticks, like a
+    // spectator rendering at a different rate than the simulation would.
+    spectator_decoder_init(&decoder, config);
+
+    u32 mismatches         = 0;
+    f32 max_position_error = 0.0f;
+    u32 delivered_count    = 0;
+
+    for(u32 tick = 0; tick < ticks_to_run; ++tick)
+    {
+        if(!is_delivered[tick])
+        {
+            continue;
+        }
+
+        u32 size = packet_offsets[tick + 1] - packet_offsets[tick];
+        spectator_decode(&decoder, packets + packet_offsets[tick], size);
+
+        SpectatorFrame  expected;
+        SpectatorFrame *decoded = spectator_decoder_get(&decoder, tick);
+
+        spectator_quantize(&config, &states[tick], &expected);
+
+        if(!decoded || memcmp(decoded, &expected, sizeof(expected)) != 0)
+        {
+            mismatches++;
+            continue;
+        }
+
+        GameState sampled;
+        spectator_decoder_sample(&decoder, (f64)tick, &sampled);
+
+        GameState *state = &states[tick];
+
+        real errors[] = {sampled.ball.position.x - state->ball.position.x,
+                         sampled.ball.position.y - state->ball.position.y,
+                         sampled.left_paddle.position.y - state->left_paddle.position.y,
+                         sampled.right_paddle.position.y - state->right_paddle.position.y};
+
+        for(u32 i = 0; i < STATIC_ARRAY_LENGTH(errors); ++i)
+        {
+            f32 error = real_to_f32(errors[i]);
+            error     = error < 0.0f ? -error : error;
+
+            if(error > max_position_error)
+            {
+                max_position_error = error;
+            }
+        }
+
+        // NOTE(leo): Halfway between two delivered ticks of the same rally, the ball has to
+        // be between where it was on each of them.
+        if(tick && is_delivered[tick - 1]
+           && states[tick - 1].left_points == states[tick].left_points
+           && states[tick - 1].right_points == states[tick].right_points
+           && states[tick - 1].match_started == states[tick].match_started)
+        {
+            spectator_decoder_sample(&decoder, (f64)tick - 0.5, &sampled);
+
+            f32 previous_x = real_to_f32(states[tick - 1].ball.position.x);
+            f32 current_x  = real_to_f32(states[tick].ball.position.x);
+            f32 sampled_x  = real_to_f32(sampled.ball.position.x);
+            f32 tolerance  = 1.0f / (f32)(1 << position_fraction_bits);
+
+            if(sampled_x < MIN(previous_x, current_x) - tolerance
+               || sampled_x > MAX(previous_x, current_x) + tolerance)
+            {
+                mismatches++;
+            }
+        }
+
+        delivered_count++;
+    }
+
+    u64 total_bytes = packet_offsets[ticks_to_run];
+    f64 encode_ns   = (f64)encode_time / (f64)ticks_to_run;
+    f64 decode_ns   = (f64)decode_time / (f64)(delivered_count ? delivered_count : 1);
+    f64 encode_mb_s = (f64)total_bytes / ((f64)encode_time / NANOSECONDS_PER_SECOND) / 1.0e6;
+    f64 decode_mb_s = (f64)total_bytes / ((f64)decode_time / NANOSECONDS_PER_SECOND) / 1.0e6;
+    b32 passed      = mismatches == 0 && decode_failures == 0;
+
+    OS_PRINTF_LITERAL("Spectator bench: %u32 ticks, %u32 position and %u32 velocity fraction "
+                      "bits, %.1f%% loss, acknowledgements %u32 ticks late\n"
+                      "  %.2f bytes per tick on average, %u32 at most, %u32 keyframes "
+                      "(full GameState is %u32 bytes)\n"
+                      "  Encode: %.1f ns per tick (%.1f MB/s)\n"
+                      "  Decode: %.1f ns per tick (%.1f MB/s)\n"
+                      "  Largest position error: %f (%u32 mismatches, %u32 failed decodes)\n"
+                      "Spectator bench: %a\n",
+                      ticks_to_run,
+                      position_fraction_bits,
+                      velocity_fraction_bits,
+                      (f64)loss_percent,
+                      (u32)ACKNOWLEDGEMENT_DELAY_TICKS,
+                      (f64)total_bytes / (f64)ticks_to_run,
+                      max_packet_size,
+                      keyframes_count,
+                      (u32)sizeof(GameState),
+                      encode_ns,
+                      encode_mb_s,
+                      decode_ns,
+                      decode_mb_s,
+                      (f64)max_position_error,
+                      mismatches,
+                      decode_failures,
+                      passed ? "PASSED" : "FAILED");
+
+    free(states);
+    free(is_delivered);
+    free(packet_offsets);
+    free(packets);
+
+    return passed ? 0 : 1;
+
+#undef ACKNOWLEDGEMENT_DELAY_TICKS
+}
+
+// NOTE(leo): Two AIs play each other until one of them scores the given number of points,
+// serving automatically. Then their cost is measured on their own, running them again over
+// every tick of the match.
+INTERNAL int
+linux_run_ai_match(u32          points_to_win,
+                   AiDifficulty left_difficulty,
+                   AiDifficulty right_difficulty)
+{
+#define MAX_TICKS (60 * 60 * 60)
+
+    u64 rng_state    = __rdtsc() ^ (u64)&rng_state;
+    u64 rng_sequence = (u64)&memset;
+
+    GameState game_state;
+    game_main(&game_state, rng_state, rng_sequence);
+
+    AiPlayer players[2];
+    ai_init(&players[0], false, left_difficulty, rng_state, rng_sequence + 1);
+    ai_init(&players[1], true, right_difficulty, rng_state, rng_sequence + 2);
+
+    GameState *states = malloc(MAX_TICKS * sizeof(GameState));
+
+    if(!states)
+    {
+        LINUX_ERROR_LITERAL("Failed to allocate %u32 ticks.", (u32)MAX_TICKS);
+    }
+
+    u32 ticks       = 0;
+    u32 rallies     = 0;
+    u32 paddle_hits = 0;
+
+    while(ticks < MAX_TICKS && game_state.left_points < points_to_win
+          && game_state.right_points < points_to_win)
+    {
+        GameInput input = {0};
+
+        if(!game_state.match_started)
+        {
+            input.is_key_down[KEY_ENTER] = true;
+            rallies++;
+        }
+
+        states[ticks++] = game_state;
+
+        ai_update(&players[0], &game_state, NETPLAY_TICK_SECONDS, &input);
+        ai_update(&players[1], &game_state, NETPLAY_TICK_SECONDS, &input);
+
+        game_update(&game_state, &input, NETPLAY_TICK_SECONDS);
+
+        if(game_state.collision_detected && game_state.sound_to_play == SOUND_PADDLE)
+        {
+            paddle_hits++;
+        }
+    }
+
+    // NOTE(leo): Timing pass. Repeated so the clock's resolution doesn't matter.
+    u32 repetitions = 16;
+    s64 begin       = linux_get_cpu_tick();
+
+    for(u32 repetition = 0; repetition < repetitions; ++repetition)
+    {
+        for(u32 tick = 0; tick < ticks; ++tick)
+        {
+            GameInput input = {0};
+            ai_update(&players[0], &states[tick], NETPLAY_TICK_SECONDS, &input);
+            ai_update(&players[1], &states[tick], NETPLAY_TICK_SECONDS, &input);
+        }
+    }
+
+    s64 elapsed = linux_get_cpu_tick() - begin;
+
+    OS_PRINTF_LITERAL("AI match: %S (left) vs %S (right), %u32 x %u32 in %u32 ticks\n"
+                      "  %u32 rallies, %.1f paddle hits per rally\n"
+                      "  %.2f ns per ai_update\n",
+                      &g_ai_difficulty_names[left_difficulty],
+                      &g_ai_difficulty_names[right_difficulty],
+                      game_state.left_points,
+                      game_state.right_points,
+                      ticks,
+                      rallies,
+                      (f64)paddle_hits / (f64)(rallies ? rallies : 1),
+                      (f64)elapsed / ((f64)ticks * repetitions * 2.0));
+
+    free(states);
+
+    return 0;
+
+#undef MAX_TICKS
+}
+
+// NOTE(leo): Steps a vectorized environment with random actions, like a training loop would,
+// and measures stepping and observing separately. Everything runs on this thread, so the
+// steps per second are per core.
+INTERNAL int
+linux_run_env_bench(u32 envs_count, u32 steps, u32 observation_type)
+{
+    PongEnvConfig config = {0};
+    config.envs_count         = envs_count;
+    config.players_count      = 1;
+    config.ai_difficulty      = PONG_ENV_AI_MEDIUM;
+    config.observation_type   = observation_type;
+    config.frame_width        = 84;
+    config.frame_height       = 84;
+    config.points_per_episode = 21;
+    config.seed               = __rdtsc();
+
+    PongEnv *env = pong_env_create(&config);
+
+    if(!env)
+    {
+        LINUX_ERROR_LITERAL("Failed to create %u32 environments.", envs_count);
+    }
+
+    u64 observation_size = pong_env_observation_size(env);
+
+    u8  *actions      = malloc(envs_count);
+    f32 *rewards      = malloc(envs_count * sizeof(f32));
+    u8  *dones        = malloc(envs_count);
+    u8  *observations = malloc(envs_count * observation_size);
+    f64 *returns      = calloc(envs_count, sizeof(f64));
+
+    if(!actions || !rewards || !dones || !observations || !returns)
+    {
+        LINUX_ERROR_LITERAL("Failed to allocate the benchmark buffers.");
+    }
+
+    pcg32_random_t actions_rng;
+    pcg32_srandom_r(&actions_rng, config.seed, (u64)&actions_rng);
+
+    s64 step_ticks    = 0;
+    s64 observe_ticks = 0;
+    u64 episodes      = 0;
+    f64 returns_sum   = 0.0;
+
+    for(u32 step = 0; step < steps; ++step)
+    {
+        for(u32 i = 0; i < envs_count; ++i)
+        {
+            actions[i] = (u8)pcg32_boundedrand_r(&actions_rng, 3);
+        }
+
+        s64 begin = linux_get_cpu_tick();
+        pong_env_step(env, actions, rewards, dones);
+
+        s64 middle = linux_get_cpu_tick();
+        pong_env_observe(env, observations);
+
+        s64 end = linux_get_cpu_tick();
+
+        step_ticks += middle - begin;
+        observe_ticks += end - middle;
+
+        // NOTE(leo): Only finished episodes count.
+        for(u32 i = 0; i < envs_count; ++i)
+        {
+            returns[i] += (f64)rewards[i];
+
+            if(dones[i])
+            {
+                episodes++;
+                returns_sum += returns[i];
+                returns[i] = 0.0;
+            }
+        }
+    }
+
+    f64 env_steps = (f64)envs_count * (f64)steps;
+    f64 seconds   = (f64)(step_ticks + observe_ticks) / (f64)NANOSECONDS_PER_SECOND;
+
+    OS_PRINTF_LITERAL("Environment benchmark: %u32 environments, %u32 steps, %a observations "
+                      "(%u64 bytes each)\n"
+                      "  %.1f ns per step, %.1f ns per observation\n"
+                      "  %u64 episodes, %.3f mean reward per episode (random against "
+                      "medium AI)\n"
+                      "  %.0f environment steps per second per core\n",
+                      envs_count,
+                      steps,
+                      observation_type == PONG_ENV_OBSERVE_FRAME ? "84x84 frame" : "state",
+                      observation_size,
+                      (f64)step_ticks / env_steps,
+                      (f64)observe_ticks / env_steps,
+                      episodes,
+                      returns_sum / (f64)(episodes ? episodes : 1),
+                      env_steps / seconds);
+
+    pong_env_destroy(env);
+
+    free(actions);
+    free(rewards);
+    free(dones);
+    free(observations);
+    free(returns);
+
+    return 0;
+}
+
+INTERNAL int
+linux_compare_s64(const void *a, const void *b)
+{
+    s64 difference = *(const s64 *)a - *(const s64 *)b;
+    return (difference > 0) - (difference < 0);
+}
+
+// NOTE(leo): Two example bots (<executable>_bot) play each other through the shared memory
+// segment in tick synchronous mode, with no frame pacing, so the match runs as fast as the
+// round trips allow. The latency is from publishing a state to having both answers.
+INTERNAL int
+linux_run_bot_bench(u32 ticks_to_run)
+{
+    char    executable_path[512];
+    ssize_t path_length =
+        readlink("/proc/self/exe", executable_path, sizeof(executable_path) - sizeof("_bot"));
+
+    if(path_length <= 0)
+    {
+        LINUX_ERROR_LITERAL("Failed to find the path of the executable.");
+    }
+
+    memcpy(executable_path + path_length, "_bot", sizeof("_bot"));
+
+    BotLink *link      = os_shared_memory_open(BOT_LINK_DEFAULT_NAME, sizeof(BotLink), true);
+    s64     *latencies = malloc(ticks_to_run * sizeof(s64));
+
+    if(!link || !latencies)
+    {
+        LINUX_ERROR_LITERAL("Failed to create the shared memory for the bots.");
+    }
+
+    bot_link_host_init(link, true, true, true);
+
+    char *bot_arguments[2][4] = {
+        {executable_path, "left", "hard", NULL},
+        {executable_path, "right", "medium", NULL},
+    };
+
+    pid_t bots[2];
+
+    for(u32 i = 0; i < 2; ++i)
+    {
+        if(posix_spawn(&bots[i], executable_path, NULL, NULL, bot_arguments[i], environ) != 0)
+        {
+            LINUX_ERROR_LITERAL("Failed to start %a.", executable_path);
+        }
+    }
+
+    u64 rng_state    = __rdtsc() ^ (u64)&rng_state;
+    u64 rng_sequence = (u64)&memset;
+
+    GameState game_state;
+    game_main(&game_state, rng_state, rng_sequence);
+
+    u32 actions[2] = {BOT_ACTION_STAY, BOT_ACTION_STAY};
+    u32 timeouts   = 0;
+
+    // NOTE(leo): The bots take a moment to start, the first tick isn't measured.
+    bot_link_publish(link, &game_state, 0);
+
+    while(!bot_link_gather_actions(link, 0, BOT_LINK_DEFAULT_MAX_SPINS, actions))
+    {
+    }
+
+    s64 begin = linux_get_cpu_tick();
+
+    for(u32 tick = 0; tick < ticks_to_run; ++tick)
+    {
+        s64 publish_tick = linux_get_cpu_tick();
+        bot_link_publish(link, &game_state, tick + 1);
+
+        if(!bot_link_gather_actions(link, tick + 1, BOT_LINK_DEFAULT_MAX_SPINS, actions))
+        {
+            timeouts++;
+        }
+
+        latencies[tick] = linux_get_cpu_tick() - publish_tick;
+
+        GameInput input = {0};
+        bot_link_apply_actions(link, actions, &input);
+        input.is_key_down[KEY_ENTER] = !game_state.match_started;
+
+        game_update(&game_state, &input, NETPLAY_TICK_SECONDS);
+    }
+
+    f64 seconds = (f64)(linux_get_cpu_tick() - begin) / (f64)NANOSECONDS_PER_SECOND;
+
+    __atomic_store_n(&link->is_closed, true, __ATOMIC_RELEASE);
+
+    for(u32 i = 0; i < 2; ++i)
+    {
+        waitpid(bots[i], NULL, 0);
+    }
+
+    os_shared_memory_close(BOT_LINK_DEFAULT_NAME, link, sizeof(BotLink), true);
+
+    qsort(latencies, ticks_to_run, sizeof(s64), linux_compare_s64);
+
+    u32 last = ticks_to_run - 1;
+
+    OS_PRINTF_LITERAL("Bot benchmark: hard (left) vs medium (right), %u32 ticks, "
+                      "%u32 x %u32\n"
+                      "  %.0f ticks per second\n"
+                      "  round trip: min %u64 ns, p50 %u64 ns, p99 %u64 ns, max %u64 ns\n"
+                      "  %u32 ticks timed out\n",
+                      ticks_to_run,
+                      game_state.left_points,
+                      game_state.right_points,
+                      (f64)ticks_to_run / seconds,
+                      (u64)latencies[0],
+                      (u64)latencies[last / 2],
+                      (u64)latencies[(u64)last * 99 / 100],
+                      (u64)latencies[last],
+                      timeouts);
+
+    free(latencies);
+
+    return timeouts ? 1 : 0;
+}
+
+// ===========================================================================================
+
+#define JOB_STRESS_TREE_FAN_OUT 4
+
+// NOTE(leo): The data the stress test's jobs work on. Every job checks what it depends on,
+// so an ordering bug shows up as an error count, not only as a wrong sum.
+GLOBAL struct
+{
+    u32  nodes_count;
+    u32 *nodes_executed;
+    u32  ordering_errors;
+
+    u64 *stage_values;
+    u64 *stage_sums;
+
+} g_job_stress;
+
+// NOTE(leo): The tree test. Node i submits its children, waits for them, then checks they
+// all ran exactly once before it counts itself.
+INTERNAL void
+linux_job_stress_tree_node(JobWorker *worker, void *data)
+{
+    u32 *executed = data;
+    u32  node     = (u32)(executed - g_job_stress.nodes_executed);
+
+    JobCounter children = {0};
+
+    for(u32 i = 1; i <= JOB_STRESS_TREE_FAN_OUT; ++i)
+    {
+        u64 child = ((u64)node * JOB_STRESS_TREE_FAN_OUT) + i;
+
+        if(child < g_job_stress.nodes_count)
+        {
+            job_submit(worker,
+                       linux_job_stress_tree_node,
+                       &g_job_stress.nodes_executed[child],
+                       &children);
+        }
+    }
+
+    job_wait(worker, &children);
+
+    for(u32 i = 1; i <= JOB_STRESS_TREE_FAN_OUT; ++i)
+    {
+        u64 child = ((u64)node * JOB_STRESS_TREE_FAN_OUT) + i;
+
+        if(child < g_job_stress.nodes_count
+           && __atomic_load_n(&g_job_stress.nodes_executed[child], __ATOMIC_ACQUIRE) != 1)
+        {
+            __atomic_fetch_add(&g_job_stress.ordering_errors, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    __atomic_fetch_add(executed, 1, __ATOMIC_RELEASE);
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+
+// NOTE(leo): The fence test, two stages. The second reads what two jobs of the first wrote.
+INTERNAL void
+linux_job_stress_stage_1(JobWorker *worker, void *data)
+{
+    u64 *value = data;
+    u64  index = (u64)(value - g_job_stress.stage_values);
+
+    *value = (index * index) + 1;
+}
+
+INTERNAL void
+linux_job_stress_stage_2(JobWorker *worker, void *data)
+{
+    u64 *sum   = data;
+    u64  index = (u64)(sum - g_job_stress.stage_sums);
+    u64  count = g_job_stress.nodes_count;
+
+    *sum = g_job_stress.stage_values[index] + g_job_stress.stage_values[count - 1 - index];
+}
+
+INTERNAL void
+linux_job_stress_empty(JobWorker *worker, void *data)
+{
+}
+
+#pragma clang diagnostic pop
+
+// NOTE(leo): Runs the three tests a number of rounds and fails on the first wrong result.
+// The empty jobs measure the overhead of a job: submitting it, finding it and running it.
+INTERNAL int
+linux_run_job_stress(u32 workers_count, u32 jobs_count, u32 rounds)
+{
+    JobSystemConfig config = {0};
+    config.workers_count   = workers_count;
+
+    JobSystem job_system;
+
+    if(!job_system_init(&job_system, &config))
+    {
+        LINUX_ERROR_LITERAL("Failed to start the job system.");
+    }
+
+    JobWorker *main_worker = job_system_main_worker(&job_system);
+
+    g_job_stress.nodes_count    = jobs_count;
+    g_job_stress.nodes_executed = malloc(jobs_count * sizeof(u32));
+    g_job_stress.stage_values   = malloc(jobs_count * sizeof(u64));
+    g_job_stress.stage_sums     = malloc(jobs_count * sizeof(u64));
+
+    if(!g_job_stress.nodes_executed || !g_job_stress.stage_values || !g_job_stress.stage_sums)
+    {
+        LINUX_ERROR_LITERAL("Failed to allocate %u32 jobs.", jobs_count);
+    }
+
+    s64 tree_ticks  = 0;
+    s64 stage_ticks = 0;
+    s64 empty_ticks = 0;
+    u32 errors      = 0;
+
+    for(u32 round = 0; round < rounds && !errors; ++round)
+    {
+        memset(g_job_stress.nodes_executed, 0, jobs_count * sizeof(u32));
+        memset(g_job_stress.stage_sums, 0, jobs_count * sizeof(u64));
+        g_job_stress.ordering_errors = 0;
+
+        s64 begin = linux_get_cpu_tick();
+
+        JobCounter tree = {0};
+        job_submit(main_worker,
+                   linux_job_stress_tree_node,
+                   g_job_stress.nodes_executed,
+                   &tree);
+        job_wait(main_worker, &tree);
+
+        s64 middle = linux_get_cpu_tick();
+
+        JobCounter stage_1 = {0};
+        JobCounter stage_2 = {0};
+
+        for(u32 i = 0; i < jobs_count; ++i)
+        {
+            job_submit(main_worker,
+                       linux_job_stress_stage_1,
+                       &g_job_stress.stage_values[i],
+                       &stage_1);
+        }
+
+        job_wait(main_worker, &stage_1);
+
+        for(u32 i = 0; i < jobs_count; ++i)
+        {
+            job_submit(main_worker,
+                       linux_job_stress_stage_2,
+                       &g_job_stress.stage_sums[i],
+                       &stage_2);
+        }
+
+        job_wait(main_worker, &stage_2);
+
+        s64 end = linux_get_cpu_tick();
+
+        JobCounter empty = {0};
+
+        for(u32 i = 0; i < jobs_count; ++i)
+        {
+            job_submit(main_worker, linux_job_stress_empty, NULL, &empty);
+        }
+
+        job_wait(main_worker, &empty);
+
+        empty_ticks += linux_get_cpu_tick() - end;
+        tree_ticks += middle - begin;
+        stage_ticks += end - middle;
+
+        errors += g_job_stress.ordering_errors;
+
+        for(u32 i = 0; i < jobs_count; ++i)
+        {
+            u64 a = i;
+            u64 b = jobs_count - 1 - i;
+
+            errors += g_job_stress.nodes_executed[i] != 1;
+            errors += g_job_stress.stage_sums[i] != (a * a) + (b * b) + 2;
+        }
+    }
+
+    JobWorkerStats stats = job_system_get_stats(&job_system);
+
+    f64 jobs = (f64)jobs_count * rounds;
+
+    OS_PRINTF_LITERAL("Job system stress test: %u32 workers, %u32 jobs per test, "
+                      "%u32 rounds\n"
+                      "  tree (fan out %u32, nested waits): %.1f ns per job\n"
+                      "  two stages behind a fence:       %.1f ns per job\n"
+                      "  empty jobs:                       %.1f ns per job\n"
+                      "  %u64 jobs executed, %u64 stolen, %u64 lost steal races, "
+                      "%u64 sleeps\n"
+                      "  %u32 errors, %a\n",
+                      job_system.workers_count,
+                      jobs_count,
+                      rounds,
+                      (u32)JOB_STRESS_TREE_FAN_OUT,
+                      (f64)tree_ticks / jobs,
+                      (f64)stage_ticks / (jobs * 2.0),
+                      (f64)empty_ticks / jobs,
+                      stats.jobs_executed,
+                      stats.jobs_stolen,
+                      stats.failed_steals,
+                      stats.sleeps,
+                      errors,
+                      errors ? "FAILED" : "PASSED");
+
+    job_system_shutdown(&job_system);
+
+    free(g_job_stress.nodes_executed);
+    free(g_job_stress.stage_values);
+    free(g_job_stress.stage_sums);
+
+    return errors ? 1 : 0;
+}
+
+// NOTE(leo): Plays an AI match through the render pipeline without pacing, first rendering
+// every frame when it's submitted (what the Windows layer does with a single processor),
+// then on the render thread. In both runs the main thread simulates a tick and its
+// particles, submits it and presents the newest frame, and waits for the render thread
+// before submitting if it's a frame behind, like the refresh rate makes it do in the game.
+// tick_microseconds of busy work stand in for a heavier simulation. The last frame of both
+// runs must be the same.
+// NOTE(leo): Same as linux_present, but the render thread owns g_back_buffer.
+INTERNAL b32
+linux_present_pipeline_frame(RenderPipeline *pipeline, b32 can_repeat)
+{
+    s32 buffer = render_pipeline_acquire_frame(pipeline, can_repeat);
+
+    if(buffer < 0)
+    {
+        return false;
+    }
+
+    linux_copy_frame(&pipeline->back_buffers[buffer], g_linux.front_buffer);
+
+    render_pipeline_release_frame(pipeline, buffer);
+
+    return true;
+}
+
+INTERNAL f64
+linux_run_render_pipeline_pass(RenderPipeline *pipeline, u32 frames, u32 tick_microseconds)
+{
+    GameState game_state;
+    game_main(&game_state, 0x853C49E6748FEA9BULL, 0xDA3E39CB94B95BDBULL);
+
+    AiPlayer players[2];
+    ai_init(&players[0], false, AI_HARD, 0x853C49E6748FEA9BULL, 1);
+    ai_init(&players[1], true, AI_MEDIUM, 0x853C49E6748FEA9BULL, 2);
+
+    ParticleSystem particles;
+
+    if(!particles_init(&particles, GAME_PARTICLES_CAPACITY, 1)
+       || !render_pipeline_set_particles(pipeline, &particles))
+    {
+        LINUX_ERROR_LITERAL("Failed to allocate the particles.");
+    }
+
+    s64 begin = linux_get_cpu_tick();
+
+    for(u32 frame = 0; frame < frames; ++frame)
+    {
+        s64       tick_begin = linux_get_cpu_tick();
+        GameInput input      = {0};
+
+        input.is_key_down[KEY_ENTER] = !game_state.match_started;
+
+        ai_update(&players[0], &game_state, NETPLAY_TICK_SECONDS, &input);
+        ai_update(&players[1], &game_state, NETPLAY_TICK_SECONDS, &input);
+        game_update(&game_state, &input, NETPLAY_TICK_SECONDS);
+
+        particles_update(&particles, NETPLAY_TICK_SECONDS);
+        game_spawn_particles(&game_state, &particles);
+
+        while(linux_get_cpu_tick() - tick_begin < (s64)tick_microseconds * 1000)
+        {
+        }
+
+        char    overlay_text_buffer[RENDER_OVERLAY_TEXT_CAPACITY];
+        String8 overlay_text = {overlay_text_buffer, 0};
+        overlay_text.length  = STR8_FORMAT_LITERAL(overlay_text_buffer,
+                                                  sizeof(overlay_text_buffer),
+                                                  "FRAME %u32",
+                                                  frame);
+
+        render_pipeline_wait_for_frame(pipeline, pipeline->frames_submitted);
+        render_pipeline_submit(pipeline, &game_state, overlay_text);
+        linux_present_pipeline_frame(pipeline, false);
+    }
+
+    render_pipeline_wait_idle(pipeline);
+
+    if(!linux_present_pipeline_frame(pipeline, true))
+    {
+        LINUX_ERROR_LITERAL("The last frame wasn't rendered.");
+    }
+
+    particles_destroy(&particles);
+
+    return (f64)(linux_get_cpu_tick() - begin) / NANOSECONDS_PER_SECOND;
+}
+
+INTERNAL int
+linux_run_render_pipeline_bench(u32 frames, s32 width, s32 height, u32 tick_microseconds)
+{
+    u64 buffer_size = (u64)width * (u64)height * sizeof(u32);
+
+    BackBuffer back_buffers[RENDER_PIPELINE_BUFFERS_COUNT] = {0};
+
+    for(u32 i = 0; i < RENDER_PIPELINE_BUFFERS_COUNT; ++i)
+    {
+        linux_allocate_back_buffer(&back_buffers[i], width, height);
+    }
+
+    void *serial_frame   = malloc(buffer_size);
+    g_linux.front_buffer = malloc(buffer_size);
+
+    if(!serial_frame || !g_linux.front_buffer)
+    {
+        LINUX_ERROR_LITERAL("Failed to allocate the back buffers.");
+    }
+
+    f64 seconds[2];
+    u64 frames_rendered[2];
+    b32 frames_match = false;
+
+    RenderPipelineStats stats = {0};
+
+    for(u32 is_threaded = 0; is_threaded < 2; ++is_threaded)
+    {
+        RenderPipeline pipeline;
+
+        if(!render_pipeline_init(&pipeline, is_threaded, 1))
+        {
+            LINUX_ERROR_LITERAL("Failed to start the render thread.");
+        }
+
+        render_pipeline_set_back_buffers(&pipeline, back_buffers);
+
+        seconds[is_threaded] =
+            linux_run_render_pipeline_pass(&pipeline, frames, tick_microseconds);
+        frames_rendered[is_threaded] = pipeline.stats.frames_rendered;
+        stats                        = pipeline.stats;
+
+        render_pipeline_shutdown(&pipeline);
+
+        if(!is_threaded)
+        {
+            memcpy(serial_frame, g_linux.front_buffer, buffer_size);
+        }
+        else
+        {
+            frames_match = memcmp(serial_frame, g_linux.front_buffer, buffer_size) == 0;
+        }
+    }
+
+    OS_PRINTF_LITERAL("Render pipeline benchmark: %u32 frames at %u32x%u32, %u32 us of "
+                      "extra work per tick, %u32 processors\n"
+                      "  serial:    %.3f ms per frame (%.1f frames/s)\n"
+                      "  pipelined: %.3f ms per frame (%.1f frames/s), %.2fx the serial "
+                      "throughput\n"
+                      "  pipelined: %u64 frames rendered, %u64 presented, %u64 states "
+                      "skipped, %u64 frames dropped\n"
+                      "  last frame %a the serial one, %a\n",
+                      frames,
+                      (u32)width,
+                      (u32)height,
+                      tick_microseconds,
+                      os_get_processors_count(),
+                      seconds[0] * 1000.0 / frames,
+                      frames / seconds[0],
+                      seconds[1] * 1000.0 / frames,
+                      frames / seconds[1],
+                      seconds[0] / seconds[1],
+                      frames_rendered[1],
+                      stats.frames_presented,
+                      stats.states_skipped,
+                      stats.frames_dropped,
+                      frames_match ? "matches" : "differs from",
+                      frames_match ? "PASSED" : "FAILED");
+
+    if(os_get_processors_count() < 2)
+    {
+        OS_PRINT_LITERAL("  With a single processor the render thread can only take turns "
+                         "with the main thread.\n");
+    }
+
+    for(u32 i = 0; i < RENDER_PIPELINE_BUFFERS_COUNT; ++i)
+    {
+        linux_free_back_buffer(&back_buffers[i]);
+    }
+
+    free(serial_frame);
+    free(g_linux.front_buffer);
+    g_linux.front_buffer = NULL;
+
+    return frames_match ? 0 : 1;
+}
+
+// NOTE(leo): Plays an AI match at output_width by output_height without pacing, with the
+// resolution governor picking the render resolution against a render budget, and presents by
+// stretching the frames to the output size. Prints every change of scale, then how many
+// frames were rendered at each one.
+INTERNAL int
+linux_run_resolution_governor(u32 frames,
+                              s32 output_width,
+                              s32 output_height,
+                              f32 budget_milliseconds)
+{
+    // NOTE(leo): The back buffer never gets bigger than the output, so it's only allocated
+    // once, and resizing only changes its dimensions.
+    linux_allocate_back_buffer(&g_back_buffer, output_width, output_height);
+
+    u64 back_buffer_capacity = back_buffer_size(&g_back_buffer);
+    g_linux.front_buffer = malloc((u64)output_width * (u64)output_height * sizeof(u32));
+
+    if(!g_linux.front_buffer)
+    {
+        LINUX_ERROR_LITERAL("Failed to allocate the front buffer.");
+    }
+
+    ResolutionGovernor governor;
+    resolution_governor_init(&governor, budget_milliseconds / 1000.0f);
+
+    GameState game_state;
+    game_main(&game_state, 0x853C49E6748FEA9BULL, 0xDA3E39CB94B95BDBULL);
+
+    AiPlayer players[2];
+    ai_init(&players[0], false, AI_HARD, 0x853C49E6748FEA9BULL, 1);
+    ai_init(&players[1], true, AI_MEDIUM, 0x853C49E6748FEA9BULL, 2);
+
+    u32 frames_per_level[STATIC_ARRAY_LENGTH(g_resolution_scales)] = {0};
+    f64 render_seconds                                               = 0.0;
+    f64 present_seconds                                              = 0.0;
+
+    OS_PRINTF_LITERAL("Resolution governor: %u32 frames at %u32x%u32, %.2f ms render "
+                      "budget\n",
+                      frames,
+                      (u32)output_width,
+                      (u32)output_height,
+                      (f64)budget_milliseconds);
+
+    for(u32 frame = 0; frame < frames; ++frame)
+    {
+        s32 render_width;
+        s32 render_height;
+        resolution_governor_apply(&governor,
+                                  output_width,
+                                  output_height,
+                                  &render_width,
+                                  &render_height);
+
+        back_buffer_set_size(&g_back_buffer, render_width, render_height, true);
+
+        GameInput input = {0};
+
+        input.is_key_down[KEY_ENTER] = !game_state.match_started;
+
+        ai_update(&players[0], &game_state, NETPLAY_TICK_SECONDS, &input);
+        ai_update(&players[1], &game_state, NETPLAY_TICK_SECONDS, &input);
+        game_update(&game_state, &input, NETPLAY_TICK_SECONDS);
+
+        s64 render_begin = linux_get_cpu_tick();
+        game_render(&game_state);
+        s64 render_end = linux_get_cpu_tick();
+
+        if(g_back_buffer.width == output_width && g_back_buffer.height == output_height)
+        {
+            linux_present();
+        }
+        else
+        {
+            upscale_back_buffer(&g_back_buffer,
+                                g_linux.front_buffer,
+                                output_width,
+                                output_height);
+        }
+
+        f32 frame_render_seconds = linux_get_seconds_elapsed(render_begin, render_end);
+
+        render_seconds += (f64)frame_render_seconds;
+        present_seconds += (f64)linux_get_seconds_elapsed(render_end, linux_get_cpu_tick());
+        frames_per_level[governor.level]++;
+
+        f32 average = resolution_governor_average(&governor);
+
+        if(resolution_governor_update(&governor, frame_render_seconds))
+        {
+            s32 width;
+            s32 height;
+            resolution_governor_apply(&governor,
+                                      output_width,
+                                      output_height,
+                                      &width,
+                                      &height);
+
+            OS_PRINTF_LITERAL("  frame %u32: %.2f ms average render, scale %u32/%u32 "
+                              "(%u32x%u32)\n",
+                              frame,
+                              (f64)average * 1000.0,
+                              resolution_governor_scale(&governor),
+                              (u32)RESOLUTION_SCALE_DENOMINATOR,
+                              (u32)width,
+                              (u32)height);
+        }
+    }
+
+    OS_PRINTF_LITERAL("  %u32 changes of scale, %.3f ms per render, %.3f ms per present\n",
+                      governor.changes_count,
+                      render_seconds * 1000.0 / frames,
+                      present_seconds * 1000.0 / frames);
+
+    for(u32 level = 0; level < STATIC_ARRAY_LENGTH(g_resolution_scales); ++level)
+    {
+        if(frames_per_level[level])
+        {
+            OS_PRINTF_LITERAL("  scale %u32/%u32: %u32 frames\n",
+                              g_resolution_scales[level],
+                              (u32)RESOLUTION_SCALE_DENOMINATOR,
+                              frames_per_level[level]);
+        }
+    }
+
+    os_free_frame_memory(g_back_buffer.pixels, back_buffer_capacity);
+    free(g_linux.front_buffer);
+    memset(&g_back_buffer, 0, sizeof(g_back_buffer));
+    g_linux.front_buffer = NULL;
+
+    return 0;
+}
+
+// NOTE(leo): Plays an AI match without pacing twice, rendering into a 32-bit back buffer and
+// presenting it, then into a bitplane one and expanding it when presenting. Every frame of
+// the two runs must be the same, pixel for pixel.
+INTERNAL int
+linux_run_bitplane_bench(u32 frames, s32 width, s32 height)
+{
+    BackBuffer back_buffers[2] = {0};
+
+    back_buffers[1].format = BACK_BUFFER_BITPLANE;
+    game_set_bitplane_palette(&back_buffers[1]);
+
+    for(u32 i = 0; i < 2; ++i)
+    {
+        linux_allocate_back_buffer(&back_buffers[i], width, height);
+    }
+
+    // NOTE(leo): Packed, like the front buffer.
+    s32  frame_pitch      = width * (s32)sizeof(u32);
+    u64  frame_size       = (u64)frame_pitch * (u64)height;
+    u32 *frames_presented = malloc(frame_size * 2);
+
+    if(!frames_presented)
+    {
+        LINUX_ERROR_LITERAL("Failed to allocate the back buffers.");
+    }
+
+    GameState game_state;
+    game_main(&game_state, 0x853C49E6748FEA9BULL, 0xDA3E39CB94B95BDBULL);
+
+    AiPlayer players[2];
+    ai_init(&players[0], false, AI_HARD, 0x853C49E6748FEA9BULL, 1);
+    ai_init(&players[1], true, AI_MEDIUM, 0x853C49E6748FEA9BULL, 2);
+
+    s64 render_ticks[2]  = {0};
+    s64 present_ticks[2] = {0};
+    u32 frames_differing = 0;
+
+    for(u32 frame = 0; frame < frames; ++frame)
+    {
+        GameInput input = {0};
+
+        input.is_key_down[KEY_ENTER] = !game_state.match_started;
+
+        ai_update(&players[0], &game_state, NETPLAY_TICK_SECONDS, &input);
+        ai_update(&players[1], &game_state, NETPLAY_TICK_SECONDS, &input);
+        game_update(&game_state, &input, NETPLAY_TICK_SECONDS);
+
+        for(u32 i = 0; i < 2; ++i)
+        {
+            u32 *front_buffer = frames_presented + ((u64)i * (u64)width * (u64)height);
+            s64  begin        = linux_get_cpu_tick();
+
+            g_back_buffer = back_buffers[i];
+            game_render(&game_state);
+
+            s64 middle = linux_get_cpu_tick();
+
+            if(i == 0)
+            {
+                linux_copy_frame(&g_back_buffer, front_buffer);
+            }
+            else
+            {
+                expand_bitplane(&g_back_buffer, front_buffer, frame_pitch);
+            }
+
+            render_ticks[i] += middle - begin;
+            present_ticks[i] += linux_get_cpu_tick() - middle;
+        }
+
+        u32 *bitplane_frame = frames_presented + ((u64)width * (u64)height);
+        frames_differing += memcmp(frames_presented, bitplane_frame, frame_size) != 0;
+    }
+
+    OS_PRINTF_LITERAL("Bitplane benchmark: %u32 frames at %u32x%u32\n"
+                      "  32-bit:   %.3f ms per render, %.3f ms per present, %u64 bytes\n"
+                      "  bitplane: %.3f ms per render, %.3f ms per present (expansion), "
+                      "%u64 bytes\n"
+                      "  %u32 frames differ, %a\n",
+                      frames,
+                      (u32)width,
+                      (u32)height,
+                      (f64)render_ticks[0] / 1000000.0 / frames,
+                      (f64)present_ticks[0] / 1000000.0 / frames,
+                      back_buffer_size(&back_buffers[0]),
+                      (f64)render_ticks[1] / 1000000.0 / frames,
+                      (f64)present_ticks[1] / 1000000.0 / frames,
+                      back_buffer_size(&back_buffers[1]),
+                      frames_differing,
+                      frames_differing ? "FAILED" : "PASSED");
+
+    linux_free_back_buffer(&back_buffers[0]);
+    linux_free_back_buffer(&back_buffers[1]);
+    free(frames_presented);
+    memset(&g_back_buffer, 0, sizeof(g_back_buffer));
+
+    return frames_differing ? 1 : 0;
+}
+
+// NOTE(leo): Plays an AI match without pacing, with its particles, rendering every frame
+// with draw_rectangle (clear, then draw over) and with the span renderer, into two 32-bit
+// back buffers. Every frame of the two must be the same, pixel for pixel.
+INTERNAL int
+linux_run_span_bench(u32 frames, s32 width, s32 height)
+{
+    BackBuffer back_buffers[2] = {0};
+
+    for(u32 i = 0; i < 2; ++i)
+    {
+        linux_allocate_back_buffer(&back_buffers[i], width, height);
+    }
+
+    DrawList      *draw_list = malloc(sizeof(DrawList));
+    ParticleSystem particles;
+
+    if(!draw_list || !particles_init(&particles, GAME_PARTICLES_CAPACITY, 1))
+    {
+        LINUX_ERROR_LITERAL("Failed to allocate the draw list.");
+    }
+
+    g_particles = &particles;
+
+    GameState game_state;
+    game_main(&game_state, 0x853C49E6748FEA9BULL, 0xDA3E39CB94B95BDBULL);
+
+    AiPlayer players[2];
+    ai_init(&players[0], false, AI_HARD, 0x853C49E6748FEA9BULL, 1);
+    ai_init(&players[1], true, AI_MEDIUM, 0x853C49E6748FEA9BULL, 2);
+
+    s64 render_ticks[2]  = {0};
+    u64 rects_drawn      = 0;
+    u32 frames_differing = 0;
+
+    for(u32 frame = 0; frame < frames; ++frame)
+    {
+        GameInput input = {0};
+
+        input.is_key_down[KEY_ENTER] = !game_state.match_started;
+
+        ai_update(&players[0], &game_state, NETPLAY_TICK_SECONDS, &input);
+        ai_update(&players[1], &game_state, NETPLAY_TICK_SECONDS, &input);
+        game_update(&game_state, &input, NETPLAY_TICK_SECONDS);
+
+        particles_update(&particles, NETPLAY_TICK_SECONDS);
+        game_spawn_particles(&game_state, &particles);
+
+        s64 begin = linux_get_cpu_tick();
+
+        g_back_buffer = back_buffers[0];
+        game_render(&game_state);
+
+        s64 middle = linux_get_cpu_tick();
+
+        g_back_buffer = back_buffers[1];
+        game_render_spans(&game_state, draw_list);
+
+        render_ticks[0] += middle - begin;
+        render_ticks[1] += linux_get_cpu_tick() - middle;
+        rects_drawn += draw_list->rects_count;
+
+        frames_differing += !linux_back_buffers_match(&back_buffers[0], &back_buffers[1]);
+    }
+
+    OS_PRINTF_LITERAL("Span renderer benchmark: %u32 frames at %u32x%u32, %.1f rectangles "
+                      "per frame\n"
+                      "  draw_rectangle: %.3f ms per frame\n"
+                      "  spans:          %.3f ms per frame (%.2fx)\n"
+                      "  %u32 frames differ, %a\n",
+                      frames,
+                      (u32)width,
+                      (u32)height,
+                      (f64)rects_drawn / frames,
+                      (f64)render_ticks[0] / 1000000.0 / frames,
+                      (f64)render_ticks[1] / 1000000.0 / frames,
+                      (f64)render_ticks[0] / (f64)render_ticks[1],
+                      frames_differing,
+                      frames_differing ? "FAILED" : "PASSED");
+
+    linux_free_back_buffer(&back_buffers[0]);
+    linux_free_back_buffer(&back_buffers[1]);
+    free(draw_list);
+    particles_destroy(&particles);
+    memset(&g_back_buffer, 0, sizeof(g_back_buffer));
+    g_particles = NULL;
+
+    return frames_differing ? 1 : 0;
+}
+
+// NOTE(leo): Draws the scoreboard, with scores going through every number of up to three
+// digits, and a line of overlay text with every glyph of the font, with rectangles and from
+// the glyph atlas, into two cleared back buffers. The two must be the same, pixel for pixel.
+INTERNAL int
+linux_run_glyph_bench(u32 frames, s32 width, s32 height)
+{
+    BackBuffer back_buffers[2] = {0};
+
+    for(u32 i = 0; i < 2; ++i)
+    {
+        linux_allocate_back_buffer(&back_buffers[i], width, height);
+    }
+
+    GameState game_state;
+    game_main(&game_state, 0x853C49E6748FEA9BULL, 0xDA3E39CB94B95BDBULL);
+
+    String8 text = {g_font_characters, STATIC_ARRAY_LENGTH(g_font_characters) - 1};
+
+    s64 build_begin = linux_get_cpu_tick();
+
+    g_back_buffer = back_buffers[1];
+
+    if(!game_prepare_glyph_atlas())
+    {
+        LINUX_ERROR_LITERAL("Can't build the glyph atlas at this size.");
+    }
+
+    s64 build_ticks      = linux_get_cpu_tick() - build_begin;
+    s64 render_ticks[2]  = {0};
+    u32 frames_differing = 0;
+
+    for(u32 frame = 0; frame < frames; ++frame)
+    {
+        game_state.left_points  = frame % 1000;
+        game_state.right_points = (frame * 7) % 1000;
+
+        for(u32 i = 0; i < 2; ++i)
+        {
+            g_back_buffer = back_buffers[i];
+            clear_back_buffer(BACKGROUND_COLOR);
+
+            s64 begin = linux_get_cpu_tick();
+
+            render_scoreboard(&game_state, i == 1, NULL);
+            render_overlay_text(text, i == 1);
+
+            render_ticks[i] += linux_get_cpu_tick() - begin;
+        }
+
+        frames_differing += !linux_back_buffers_match(&back_buffers[0], &back_buffers[1]);
+    }
+
+    OS_PRINTF_LITERAL("Glyph atlas benchmark: %u32 frames at %u32x%u32, atlas of %u32x%u32 "
+                      "built in %.3f ms\n"
+                      "  rectangles: %.3f ms per frame\n"
+                      "  atlas:      %.3f ms per frame (%.2fx)\n"
+                      "  %u32 frames differ, %a\n",
+                      frames,
+                      (u32)width,
+                      (u32)height,
+                      (u32)g_glyph_atlas.width,
+                      (u32)g_glyph_atlas.height,
+                      (f64)build_ticks / 1000000.0,
+                      (f64)render_ticks[0] / 1000000.0 / frames,
+                      (f64)render_ticks[1] / 1000000.0 / frames,
+                      (f64)render_ticks[0] / (f64)render_ticks[1],
+                      frames_differing,
+                      frames_differing ? "FAILED" : "PASSED");
+
+    linux_free_back_buffer(&back_buffers[0]);
+    linux_free_back_buffer(&back_buffers[1]);
+    memset(&g_back_buffer, 0, sizeof(g_back_buffer));
+
+    return frames_differing ? 1 : 0;
+}
+
+// NOTE(leo): Plays an AI match without pacing, with its particles, rendering every frame
+// whole with game_render, and composited (see compositor.c) into two back buffers taken in
+// turns, like the render pipeline does. Every composited frame must be the same as the whole
+// one, pixel for pixel.
+INTERNAL int
+linux_run_compositor_bench(u32 frames, s32 width, s32 height)
+{
+    BackBuffer back_buffers[3] = {0};
+
+    for(u32 i = 0; i < 3; ++i)
+    {
+        linux_allocate_back_buffer(&back_buffers[i], width, height);
+    }
+
+    Compositor     compositor = {0};
+    ParticleSystem particles;
+
+    if(!particles_init(&particles, GAME_PARTICLES_CAPACITY, 1))
+    {
+        LINUX_ERROR_LITERAL("Failed to allocate the particles.");
+    }
+
+    g_particles = &particles;
+
+    GameState game_state;
+    game_main(&game_state, 0x853C49E6748FEA9BULL, 0xDA3E39CB94B95BDBULL);
+
+    AiPlayer players[2];
+    ai_init(&players[0], false, AI_HARD, 0x853C49E6748FEA9BULL, 1);
+    ai_init(&players[1], true, AI_MEDIUM, 0x853C49E6748FEA9BULL, 2);
+
+    s64 render_ticks[2]       = {0};
+    u32 static_layer_versions = 0;
+    u32 frames_differing      = 0;
+
+    for(u32 frame = 0; frame < frames; ++frame)
+    {
+        GameInput input = {0};
+
+        input.is_key_down[KEY_ENTER] = !game_state.match_started;
+
+        ai_update(&players[0], &game_state, NETPLAY_TICK_SECONDS, &input);
+        ai_update(&players[1], &game_state, NETPLAY_TICK_SECONDS, &input);
+        game_update(&game_state, &input, NETPLAY_TICK_SECONDS);
+
+        particles_update(&particles, NETPLAY_TICK_SECONDS);
+        game_spawn_particles(&game_state, &particles);
+
+        // NOTE(leo): Text of changing length, so what's left of the longer one has to go.
+        char overlay_text_buffer[32];
+        g_overlay_text.data   = overlay_text_buffer;
+        g_overlay_text.length = STR8_FORMAT_LITERAL(overlay_text_buffer,
+                                                    sizeof(overlay_text_buffer),
+                                                    "FRAME %u32",
+                                                    frame);
+
+        // NOTE(leo): As if the window was resized once in a while.
+        if(frame % 1000 == 999)
+        {
+            compositor_invalidate(&compositor);
+        }
+
+        s64 begin = linux_get_cpu_tick();
+
+        g_back_buffer = back_buffers[0];
+        game_render(&game_state);
+
+        s64 middle = linux_get_cpu_tick();
+
+        u32 static_layer_version = compositor.static_layer_version;
+
+        g_back_buffer = back_buffers[1 + (frame % 2)];
+        game_render_layers(&game_state, &compositor);
+
+        render_ticks[0] += middle - begin;
+        render_ticks[1] += linux_get_cpu_tick() - middle;
+        static_layer_versions += compositor.static_layer_version != static_layer_version;
+
+        frames_differing += !linux_back_buffers_match(&back_buffers[0], &g_back_buffer);
+    }
+
+    OS_PRINTF_LITERAL("Compositor benchmark: %u32 frames at %u32x%u32, the static layer "
+                      "rendered %u32 times\n"
+                      "  whole:      %.3f ms per frame\n"
+                      "  composited: %.3f ms per frame (%.2fx)\n"
+                      "  %u32 frames differ, %a\n",
+                      frames,
+                      (u32)width,
+                      (u32)height,
+                      static_layer_versions,
+                      (f64)render_ticks[0] / 1000000.0 / frames,
+                      (f64)render_ticks[1] / 1000000.0 / frames,
+                      (f64)render_ticks[0] / (f64)render_ticks[1],
+                      frames_differing,
+                      frames_differing ? "FAILED" : "PASSED");
+
+    for(u32 i = 0; i < 3; ++i)
+    {
+        linux_free_back_buffer(&back_buffers[i]);
+    }
+
+    compositor_destroy(&compositor);
+    particles_destroy(&particles);
+    memset(&g_back_buffer, 0, sizeof(g_back_buffer));
+    memset(&g_overlay_text, 0, sizeof(g_overlay_text));
+    g_particles = NULL;
+
+    return frames_differing ? 1 : 0;
+}
+
+// NOTE(leo): Allocates a back buffer rounds times, the way a resize does, once with malloc
+// and packed rows and once with os_allocate_frame_memory and aligned rows, and renders
+// frames_per_round frames into each. The first frame after the allocation pays for the page
+// faults unless the memory was prefaulted.
+INTERNAL int
+linux_run_framebuffer_bench(s32 width, s32 height, u32 rounds, u32 frames_per_round)
+{
+    GameState game_state;
+    game_main(&game_state, 0x853C49E6748FEA9BULL, 0xDA3E39CB94B95BDBULL);
+
+    s64 allocate_ticks[2]    = {0};
+    s64 first_frame_ticks[2] = {0};
+    s64 frame_ticks[2]       = {0};
+    b32 is_huge              = false;
+
+    for(u32 round = 0; round < rounds; ++round)
+    {
+        for(u32 i = 0; i < 2; ++i)
+        {
+            BackBuffer back_buffer = {0};
+            s64        begin       = linux_get_cpu_tick();
+
+            if(i == 0)
+            {
+                back_buffer_set_size(&back_buffer, width, height, false);
+                back_buffer.pixels = malloc(back_buffer_size(&back_buffer));
+
+                if(!back_buffer.pixels)
+                {
+                    LINUX_ERROR_LITERAL("Failed to allocate the back buffer.");
+                }
+            }
+            else
+            {
+                is_huge = linux_allocate_back_buffer(&back_buffer, width, height);
+            }
+
+            s64 allocated = linux_get_cpu_tick();
+
+            g_back_buffer = back_buffer;
+
+            for(u32 frame = 0; frame < frames_per_round; ++frame)
+            {
+                s64 frame_begin = linux_get_cpu_tick();
+                game_render(&game_state);
+                s64 frame_end = linux_get_cpu_tick();
+
+                if(frame == 0)
+                {
+                    first_frame_ticks[i] += frame_end - frame_begin;
+                }
+                else
+                {
+                    frame_ticks[i] += frame_end - frame_begin;
+                }
+            }
+
+            allocate_ticks[i] += allocated - begin;
+
+            if(i == 0)
+            {
+                free(back_buffer.pixels);
+            }
+            else
+            {
+                linux_free_back_buffer(&back_buffer);
+            }
+        }
+    }
+
+    u32 steady_frames = rounds * (frames_per_round - 1);
+
+    OS_PRINTF_LITERAL("Framebuffer benchmark: %u32 allocations at %u32x%u32, %u32 frames "
+                      "each, %a\n",
+                      rounds,
+                      (u32)width,
+                      (u32)height,
+                      frames_per_round,
+                      is_huge ? "explicit huge pages" : "transparent huge pages if enabled");
+
+    for(u32 i = 0; i < 2; ++i)
+    {
+        OS_PRINTF_LITERAL("  %a %.3f ms to allocate, %.3f ms first frame, %.3f ms after\n",
+                          i == 0 ? "malloc, packed rows:          "
+                                 : "frame memory, aligned rows:   ",
+                          (f64)allocate_ticks[i] / 1000000.0 / rounds,
+                          (f64)first_frame_ticks[i] / 1000000.0 / rounds,
+                          steady_frames ? (f64)frame_ticks[i] / 1000000.0 / steady_frames
+                                        : 0.0);
+    }
+
+    memset(&g_back_buffer, 0, sizeof(g_back_buffer));
+
+    return 0;
+}
+
+INTERNAL u32
+linux_read_u32_big_endian(u8 *at)
+{
+    return ((u32)at[0] << 24) | ((u32)at[1] << 16) | ((u32)at[2] << 8) | (u32)at[3];
+}
+
+// NOTE(leo): Only what screenshot_encode_png writes: 8-bit RGB, stored deflate blocks and
+// no filters. Decodes into pixels, width times height 0x00RRGGBB. Returns false if the file
+// isn't valid or isn't that size.
+INTERNAL b32
+linux_decode_png(FileContents file, s32 width, s32 height, u32 *pixels)
+{
+    u8 signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+    if(file.size < 8 || memcmp(file.data, signature, 8) != 0)
+    {
+        return false;
+    }
+
+    u64 raw_size   = (u64)height * (1 + ((u64)width * 3));
+    u8 *zlib       = malloc(file.size);
+    u8 *raw        = malloc(raw_size);
+    u64 zlib_size  = 0;
+    b32 has_header = false;
+    b32 has_end    = false;
+    b32 is_valid   = zlib && raw;
+
+    for(u64 at = 8; is_valid && !has_end;)
+    {
+        if(file.size - at < 12)
+        {
+            is_valid = false;
+            break;
+        }
+
+        u32 size = linux_read_u32_big_endian(file.data + at);
+        u8 *type = file.data + at + 4;
+
+        if(file.size - at - 12 < size
+           || linux_read_u32_big_endian(type + 4 + size) != crc32_update(0, type, 4 + size))
+        {
+            is_valid = false;
+            break;
+        }
+
+        if(memcmp(type, "IHDR", 4) == 0)
+        {
+            u8 expected_rest[5] = {8, 2, 0, 0, 0};
+
+            has_header = size == 13 && linux_read_u32_big_endian(type + 4) == (u32)width
+                         && linux_read_u32_big_endian(type + 8) == (u32)height
+                         && memcmp(type + 12, expected_rest, 5) == 0;
+            is_valid   = has_header;
+        }
+        else if(memcmp(type, "IDAT", 4) == 0)
+        {
+            memcpy(zlib + zlib_size, type + 4, size);
+            zlib_size += size;
+        }
+        else if(memcmp(type, "IEND", 4) == 0)
+        {
+            has_end = true;
+        }
+
+        at += 12 + (u64)size;
+    }
+
+    u64 raw_at = 0;
+
+    if(is_valid && has_header && has_end && zlib_size >= 6
+       && ((zlib[0] << 8) | zlib[1]) % 31 == 0 && (zlib[0] & 0xF) == 8)
+    {
+        u64 at       = 2;
+        b32 is_final = false;
+
+        while(is_valid && !is_final)
+        {
+            if(zlib_size - at < 5 || (zlib[at] & 6) != 0)
+            {
+                is_valid = false;
+                break;
+            }
+
+            is_final = zlib[at] & 1;
+
+            u32 size         = zlib[at + 1] | ((u32)zlib[at + 2] << 8);
+            u32 size_inverse = zlib[at + 3] | ((u32)zlib[at + 4] << 8);
+            at += 5;
+
+            if((size ^ size_inverse) != 0xFFFF || zlib_size - at < size
+               || raw_size - raw_at < size)
+            {
+                is_valid = false;
+                break;
+            }
+
+            memcpy(raw + raw_at, zlib + at, size);
+            raw_at += size;
+            at += size;
+        }
+
+        u32 adler = adler32_update(1, raw, raw_size);
+
+        is_valid = is_valid && zlib_size - at == 4 && raw_at == raw_size
+                   && linux_read_u32_big_endian(zlib + at) == adler;
+    }
+    else
+    {
+        is_valid = false;
+    }
+
+    for(s32 y = 0; is_valid && y < height; ++y)
+    {
+        u8 *row = raw + ((u64)y * (1 + ((u64)width * 3)));
+
+        is_valid = row[0] == 0;
+
+        for(s32 x = 0; x < width; ++x)
+        {
+            u8 *rgb = row + 1 + (x * 3);
+
+            pixels[((u64)y * (u64)width) + (u64)x] =
+                ((u32)rgb[0] << 16) | ((u32)rgb[1] << 8) | rgb[2];
+        }
+    }
+
+    free(zlib);
+    free(raw);
+
+    return is_valid;
+}
+
+// NOTE(leo): Like linux_decode_png, for any 3 channels QOI file. Follows the reference
+// decoder rather than screenshot_encode_qoi: the index is RGBA and starts as (0, 0, 0, 0),
+// the pixel before the first one is (0, 0, 0, 255) and the alpha is part of the hash.
+INTERNAL b32
+linux_decode_qoi(FileContents file, s32 width, s32 height, u32 *pixels)
+{
+    if(file.size < 22 || memcmp(file.data, "qoif", 4) != 0
+       || linux_read_u32_big_endian(file.data + 4) != (u32)width
+       || linux_read_u32_big_endian(file.data + 8) != (u32)height || file.data[12] != 3)
+    {
+        return false;
+    }
+
+    u8 *at  = file.data + 14;
+    u8 *end = file.data + file.size - 8;
+
+    // NOTE(leo): 0xAARRGGBB.
+    u32 index[64]    = {0};
+    u32 pixel        = 0xFF000000;
+    u64 pixels_count = (u64)width * (u64)height;
+
+    for(u64 i = 0; i < pixels_count;)
+    {
+        if(at >= end)
+        {
+            return false;
+        }
+
+        u8  op  = *at++;
+        u32 run = 1;
+        s32 a   = (s32)(pixel >> 24);
+        s32 r   = (s32)((pixel >> 16) & 0xFF);
+        s32 g   = (s32)((pixel >> 8) & 0xFF);
+        s32 b   = (s32)(pixel & 0xFF);
+
+        if(op == 0xFE)
+        {
+            r = at[0];
+            g = at[1];
+            b = at[2];
+            at += 3;
+        }
+        else if(op == 0xFF)
+        {
+            r = at[0];
+            g = at[1];
+            b = at[2];
+            a = at[3];
+            at += 4;
+        }
+        else if((op >> 6) == 0)
+        {
+            a = (s32)(index[op] >> 24);
+            r = (s32)((index[op] >> 16) & 0xFF);
+            g = (s32)((index[op] >> 8) & 0xFF);
+            b = (s32)(index[op] & 0xFF);
+        }
+        else if((op >> 6) == 1)
+        {
+            r += ((op >> 4) & 3) - 2;
+            g += ((op >> 2) & 3) - 2;
+            b += (op & 3) - 2;
+        }
+        else if((op >> 6) == 2)
+        {
+            s32 dg = (op & 0x3F) - 32;
+            u8  rb = *at++;
+
+            r += dg + (rb >> 4) - 8;
+            g += dg;
+            b += dg + (rb & 0xF) - 8;
+        }
+        else
+        {
+            run = (op & 0x3F) + 1;
+        }
+
+        r &= 0xFF;
+        g &= 0xFF;
+        b &= 0xFF;
+
+        pixel = ((u32)a << 24) | (u32)((r << 16) | (g << 8) | b);
+
+        index[((r * 3) + (g * 5) + (b * 7) + (a * 11)) % 64] = pixel;
+
+        // NOTE(leo): The frames are opaque, a pixel with any other alpha is a wrong one.
+        for(u32 j = 0; j < run && i < pixels_count; ++j)
+        {
+            pixels[i++] = a == 255 ? pixel & 0xFFFFFF : U32_MAX;
+        }
+    }
+
+    u8 end_marker[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+
+    return at == end && memcmp(end, end_marker, 8) == 0;
+}
+
+// NOTE(leo): The match only has two colors, which leaves most of the QOI ops and the index
+// untouched, so a few pixels that go back to colors seen before are checked on their own.
+INTERNAL b32
+linux_check_qoi_pixels(void)
+{
+    u32 pixels[] = {0xFFFFFF, 0x000000, 0x804020, 0xFFFFFF, 0x804020, 0x000000,
+                    0x000000, 0x7F3F1F, 0x804020, 0x102030, 0xFFFFFF, 0x102030};
+
+    BackBuffer frame   = {0};
+    frame.pixels       = pixels;
+    frame.pixels_count = (s32)STATIC_ARRAY_LENGTH(pixels);
+    frame.width        = frame.pixels_count;
+    frame.height       = 1;
+    frame.pitch        = (s32)sizeof(pixels);
+    frame.format       = BACK_BUFFER_RGB;
+
+    u32 row[STATIC_ARRAY_LENGTH(pixels)];
+    u32 decoded[STATIC_ARRAY_LENGTH(pixels)];
+    u8  encoded[256];
+
+    FileContents file;
+    file.data = encoded;
+    file.size = screenshot_encode_qoi(&frame, row, encoded);
+
+    return linux_decode_qoi(file, frame.width, frame.height, decoded)
+           && memcmp(decoded, pixels, sizeof(pixels)) == 0;
+}
+
+// NOTE(leo): Plays an AI match at 60 frames per second and takes a screenshot of every frame,
+// far more than the encoding thread can write, so the pool runs out and captures are refused.
+// What the game thread pays is the copy. Every file written is decoded and must be the frame
+// it was taken from, pixel for pixel. The files are removed at the end.
+INTERNAL int
+linux_run_screenshot_bench(u32                  frames,
+                           s32                  width,
+                           s32                  height,
+                           ScreenshotFileFormat file_format)
+{
+    linux_resize_graphics(width, height);
+
+    ScreenshotPool pool;
+
+    if(!screenshot_pool_init(&pool))
+    {
+        LINUX_ERROR_LITERAL("Failed to start the screenshot thread.");
+    }
+
+    screenshot_pool_reserve(&pool, &g_back_buffer);
+
+    GameState game_state;
+    game_main(&game_state, 0x853C49E6748FEA9BULL, 0xDA3E39CB94B95BDBULL);
+
+    AiPlayer players[2];
+    ai_init(&players[0], false, AI_HARD, 0x853C49E6748FEA9BULL, 1);
+    ai_init(&players[1], true, AI_MEDIUM, 0x853C49E6748FEA9BULL, 2);
+
+    // NOTE(leo): The state of every frame that was taken, to render it again when checking.
+    GameState *captured_states = malloc(frames * sizeof(GameState));
+    u32       *captured_frames = malloc(frames * sizeof(u32));
+    u32        captured_count  = 0;
+
+    if(!captured_states || !captured_frames)
+    {
+        LINUX_ERROR_LITERAL("Failed to allocate the captured states.");
+    }
+
+    char *extension = file_format == SCREENSHOT_QOI ? "qoi" : "png";
+
+    s64 capture_ticks     = 0;
+    s64 max_capture_ticks = 0;
+    s64 frame_ticks       = NANOSECONDS_PER_SECOND / 60;
+    s64 bench_begin       = linux_get_cpu_tick();
+
+    for(u32 frame = 0; frame < frames; ++frame)
+    {
+        s64       frame_begin = linux_get_cpu_tick();
+        GameInput input       = {0};
+
+        input.is_key_down[KEY_ENTER] = !game_state.match_started;
+
+        ai_update(&players[0], &game_state, NETPLAY_TICK_SECONDS, &input);
+        ai_update(&players[1], &game_state, NETPLAY_TICK_SECONDS, &input);
+        game_update(&game_state, &input, NETPLAY_TICK_SECONDS);
+        game_render(&game_state);
+
+        char    path_buffer[SCREENSHOT_PATH_CAPACITY];
+        String8 path = {path_buffer, 0};
+        path.length  = STR8_FORMAT_LITERAL(path_buffer,
+                                          sizeof(path_buffer),
+                                          "screenshot_bench_%u32.%a",
+                                          frame,
+                                          extension);
+
+        s64 capture_begin = linux_get_cpu_tick();
+        b32 is_captured   = screenshot_capture(&pool, &g_back_buffer, path, file_format);
+        s64 ticks         = linux_get_cpu_tick() - capture_begin;
+
+        if(is_captured)
+        {
+            capture_ticks += ticks;
+            max_capture_ticks = MAX(max_capture_ticks, ticks);
+
+            captured_states[captured_count] = game_state;
+            captured_frames[captured_count] = frame;
+            captured_count++;
+        }
+
+        linux_present();
+        linux_sleep_until(frame_begin + frame_ticks);
+    }
+
+    screenshot_pool_wait_idle(&pool);
+
+    s64 bench_ticks = linux_get_cpu_tick() - bench_begin;
+
+    u32 *decoded         = malloc((u64)width * (u64)height * sizeof(u32));
+    u32 *row             = malloc((u64)width * sizeof(u32));
+    u32  files_differing = 0;
+
+    if(!decoded || !row)
+    {
+        LINUX_ERROR_LITERAL("Failed to allocate the decoded frame.");
+    }
+
+    for(u32 i = 0; i < captured_count; ++i)
+    {
+        char path[SCREENSHOT_PATH_CAPACITY];
+        u32  path_length = STR8_FORMAT_LITERAL(path,
+                                              sizeof(path) - 1,
+                                              "screenshot_bench_%u32.%a",
+                                              captured_frames[i],
+                                              extension);
+        path[path_length] = 0;
+
+        FileContents file = os_read_entire_file(path);
+
+        b32 is_same = file.data
+                      && (file_format == SCREENSHOT_QOI
+                            ? linux_decode_qoi(file, width, height, decoded)
+                            : linux_decode_png(file, width, height, decoded));
+
+        game_render(&captured_states[i]);
+
+        for(s32 y = 0; is_same && y < height; ++y)
+        {
+            screenshot_read_row(&g_back_buffer, y, row);
+
+            is_same = memcmp(row, decoded + ((u64)y * (u64)width), (u64)width * sizeof(u32))
+                      == 0;
+        }
+
+        files_differing += !is_same;
+
+        free(file.data);
+        unlink(path);
+    }
+
+    b32 are_pixels_same = file_format != SCREENSHOT_QOI || linux_check_qoi_pixels();
+    b32 has_failed      = files_differing || !are_pixels_same || pool.stats.files_failed
+                          || pool.stats.files_written != captured_count;
+
+    u64 files_written = MAX(pool.stats.files_written, 1);
+
+    OS_PRINTF_LITERAL("Screenshot benchmark: %u32 frames at %u32x%u32 in %.2f s, %a\n"
+                      "  %u64 captured, %u64 refused (pool of %u32)\n"
+                      "  game thread: %.3f ms per capture, %.3f ms at most\n"
+                      "  encoding thread: %.3f ms to encode, %.3f ms to write, %.2f MB "
+                      "per file\n"
+                      "  %u32 files differ%a, %a\n",
+                      frames,
+                      (u32)width,
+                      (u32)height,
+                      (f64)bench_ticks / NANOSECONDS_PER_SECOND,
+                      extension,
+                      pool.stats.captures,
+                      pool.stats.captures_refused,
+                      (u32)SCREENSHOT_POOL_SIZE,
+                      (f64)capture_ticks / 1000000.0 / MAX(captured_count, 1),
+                      (f64)max_capture_ticks / 1000000.0,
+                      (f64)pool.stats.encode_ticks / 1000000.0 / (f64)files_written,
+                      (f64)pool.stats.write_ticks / 1000000.0 / (f64)files_written,
+                      (f64)pool.stats.bytes_written / 1000000.0 / (f64)files_written,
+                      files_differing,
+                      are_pixels_same ? "" : " (and the QOI index check)",
+                      has_failed ? "FAILED" : "PASSED");
+
+    screenshot_pool_shutdown(&pool);
+
+    free(captured_states);
+    free(captured_frames);
+    free(decoded);
+    free(row);
+
+    return has_failed ? 1 : 0;
+}
+
+// NOTE(leo): Plays an AI match at 60 frames per second, records every frame (see video.c)
+// and plays the recording back. Every frame played must be the one recorded, pixel for pixel.
+INTERNAL int
+linux_run_video_bench(u32 frames, s32 width, s32 height, BackBufferFormat format)
+{
+    BackBuffer palette_holder = {0};
+    game_set_bitplane_palette(&palette_holder);
+
+    g_back_buffer.format = format;
+    linux_allocate_back_buffer(&g_back_buffer, width, height);
+    g_back_buffer.palette[0] = palette_holder.palette[0];
+    g_back_buffer.palette[1] = palette_holder.palette[1];
+
+    char *file_path = "video_bench.pvid";
+
+    VideoRecorder recorder;
+
+    if(!video_recorder_open(&recorder, file_path, palette_holder.palette))
+    {
+        LINUX_ERROR_LITERAL("Failed to start recording to %a.", file_path);
+    }
+
+    // NOTE(leo): The match is played twice, to record it and to check what's played back.
+    GameState game_states[2];
+    AiPlayer  players[2][2];
+
+    for(u32 i = 0; i < 2; ++i)
+    {
+        game_main(&game_states[i], 0x853C49E6748FEA9BULL, 0xDA3E39CB94B95BDBULL);
+        ai_init(&players[i][0], false, AI_HARD, 0x853C49E6748FEA9BULL, 1);
+        ai_init(&players[i][1], true, AI_MEDIUM, 0x853C49E6748FEA9BULL, 2);
+    }
+
+    u64 frame_microseconds = 1000000 / 60;
+    s64 max_encode_ticks   = 0;
+
+    for(u32 frame = 0; frame < frames; ++frame)
+    {
+        GameInput input = {0};
+
+        input.is_key_down[KEY_ENTER] = !game_states[0].match_started;
+
+        ai_update(&players[0][0], &game_states[0], NETPLAY_TICK_SECONDS, &input);
+        ai_update(&players[0][1], &game_states[0], NETPLAY_TICK_SECONDS, &input);
+        game_update(&game_states[0], &input, NETPLAY_TICK_SECONDS);
+        game_render(&game_states[0]);
+
+        s64 encode_ticks = recorder.stats.encode_ticks;
+
+        video_recorder_add_frame(&recorder, &g_back_buffer, frame ? frame_microseconds : 0);
+
+        max_encode_ticks = MAX(max_encode_ticks, recorder.stats.encode_ticks - encode_ticks);
+    }
+
+    video_recorder_close(&recorder);
+
+    FileContents file = os_read_entire_file(file_path);
+    VideoPlayer  player;
+
+    if(!video_player_open(&player, file))
+    {
+        LINUX_ERROR_LITERAL("Failed to open %a as a video.", file_path);
+    }
+
+    u32 *played_row       = malloc((u64)width * sizeof(u32));
+    u32 *rendered_row     = malloc((u64)width * sizeof(u32));
+    u32  frames_differing = 0;
+    u32  frames_rendered  = 0;
+    s64  decode_ticks     = 0;
+
+    if(!played_row || !rendered_row)
+    {
+        LINUX_ERROR_LITERAL("Failed to allocate the rows to compare.");
+    }
+
+    for(;;)
+    {
+        s64 decode_begin = linux_get_cpu_tick();
+        b32 has_frame    = video_player_next_frame(&player);
+        decode_ticks += linux_get_cpu_tick() - decode_begin;
+
+        if(!has_frame)
+        {
+            break;
+        }
+
+        // NOTE(leo): Frames that were dropped only show as time.
+        u64 frame = (player.microseconds + (frame_microseconds / 2)) / frame_microseconds;
+
+        while(frames_rendered <= frame)
+        {
+            GameInput input = {0};
+
+            input.is_key_down[KEY_ENTER] = !game_states[1].match_started;
+
+            ai_update(&players[1][0], &game_states[1], NETPLAY_TICK_SECONDS, &input);
+            ai_update(&players[1][1], &game_states[1], NETPLAY_TICK_SECONDS, &input);
+            game_update(&game_states[1], &input, NETPLAY_TICK_SECONDS);
+
+            frames_rendered++;
+        }
+
+        game_render(&game_states[1]);
+
+        b32 is_same = player.frame.width == width && player.frame.height == height;
+
+        for(s32 y = 0; is_same && y < height; ++y)
+        {
+            screenshot_read_row(&player.frame, y, played_row);
+            screenshot_read_row(&g_back_buffer, y, rendered_row);
+
+            is_same = memcmp(played_row, rendered_row, (u64)width * sizeof(u32)) == 0;
+        }
+
+        frames_differing += !is_same;
+    }
+
+    u64 frames_played  = player.frames_count;
+    b32 has_failed     = frames_differing || player.is_corrupt
+                         || frames_played != recorder.stats.frames_encoded
+                         || recorder.stats.has_write_failed;
+    f64 frames_encoded = (f64)MAX(recorder.stats.frames_encoded, 1);
+
+    // NOTE(leo): At 60 frames per second.
+    f64 megabytes_per_minute = (f64)file.size / 1000000.0 / (f64)frames * 3600.0;
+    f64 raw_megabytes_per_minute =
+        (f64)width * (f64)height * sizeof(u32) / 1000000.0 * 3600.0;
+
+    OS_PRINTF_LITERAL("Video benchmark: %u32 frames at %u32x%u32 from a %a back buffer\n"
+                      "  %u64 frames recorded (%u64 key frames), %u64 dropped\n"
+                      "  encode: %.3f ms per frame, %.3f ms at most\n"
+                      "  decode: %.3f ms per frame\n"
+                      "  %.2f MB per minute, %.0f MB per minute as 32-bit frames (%.0fx)\n"
+                      "  %u32 frames differ, %a\n",
+                      frames,
+                      (u32)width,
+                      (u32)height,
+                      format == BACK_BUFFER_BITPLANE ? "bitplane" : "32-bit",
+                      recorder.stats.frames_encoded,
+                      recorder.stats.key_frames,
+                      recorder.stats.frames_dropped,
+                      (f64)recorder.stats.encode_ticks / 1000000.0 / frames_encoded,
+                      (f64)max_encode_ticks / 1000000.0,
+                      (f64)decode_ticks / 1000000.0 / (f64)MAX(frames_played, 1),
+                      megabytes_per_minute,
+                      raw_megabytes_per_minute,
+                      raw_megabytes_per_minute / megabytes_per_minute,
+                      frames_differing,
+                      has_failed ? "FAILED" : "PASSED");
+
+    video_player_close(&player);
+    free(file.data);
+    free(played_row);
+    free(rendered_row);
+    unlink(file_path);
+
+    linux_free_back_buffer(&g_back_buffer);
+    memset(&g_back_buffer, 0, sizeof(g_back_buffer));
+
+    return has_failed ? 1 : 0;
+}
+
+// NOTE(leo): Plays a video made by video.c as fast as it decodes, and saves one of its frames
+// as a PNG.
+INTERNAL int
+linux_run_video_play(char *file_path, u32 frame_to_save, char *png_path)
+{
+    FileContents file = os_read_entire_file(file_path);
+    VideoPlayer  player;
+
+    if(!video_player_open(&player, file))
+    {
+        LINUX_ERROR_LITERAL("Failed to open %a as a video.", file_path);
+    }
+
+    b32 has_saved    = false;
+    s64 decode_begin = linux_get_cpu_tick();
+
+    while(video_player_next_frame(&player))
+    {
+        if(png_path && player.frames_count == frame_to_save + 1)
+        {
+            u32 *row     = malloc((u64)player.frame.width * sizeof(u32));
+            u8  *encoded = malloc(screenshot_encoded_capacity(&player.frame, SCREENSHOT_PNG));
+
+            if(!row || !encoded)
+            {
+                LINUX_ERROR_LITERAL("Failed to allocate the PNG.");
+            }
+
+            crc32_init_tables();
+
+            u64 size  = screenshot_encode_png(&player.frame, row, encoded);
+            has_saved = os_write_entire_file(png_path, encoded, size);
+
+            free(row);
+            free(encoded);
+        }
+    }
+
+    s64 decode_ticks = linux_get_cpu_tick() - decode_begin;
+    f64 seconds      = (f64)player.microseconds / 1000000.0;
+
+    OS_PRINTF_LITERAL("%a: %u32 frames, %.2f s, last frame %u32x%u32, %.2f MB per minute, "
+                      "decoded in %.3f ms per frame%a\n",
+                      file_path,
+                      player.frames_count,
+                      seconds,
+                      (u32)player.frame.width,
+                      (u32)player.frame.height,
+                      seconds > 0.0 ? (f64)file.size / 1000000.0 / seconds * 60.0 : 0.0,
+                      (f64)decode_ticks / 1000000.0 / (f64)MAX(player.frames_count, 1),
+                      player.is_corrupt ? ", cut short by a corrupt frame" : "");
+
+    if(png_path && !has_saved)
+    {
+        LINUX_ERROR_LITERAL("Failed to save frame %u32 to %a.", frame_to_save, png_path);
+    }
+
+    b32 is_corrupt = player.is_corrupt;
+
+    video_player_close(&player);
+    free(file.data);
+
+    return is_corrupt ? 1 : 0;
+}
+
+// ===========================================================================================
+
+// NOTE(leo): The reader of the frame export benchmark, on a thread of its own like it would
+// be in a process of its own. Every frame it reads whole is checked against the checksum the
+// host took before publishing it.
+typedef struct
+{
+    FrameExport *export;
+    u64         *checksums;
+
+    u64 frames_read;
+    u64 frames_missed;
+    u64 frames_differing;
+    u64 reads_torn;
+
+} LinuxFrameExportReader;
+
+INTERNAL u64
+linux_frame_checksum(u8 *pixels, u64 size)
+{
+    u64 *words  = (u64 *)pixels;
+    u64  result = 0xCBF29CE484222325ULL;
+
+    for(u64 i = 0; i < size / sizeof(u64); ++i)
+    {
+        result = (result ^ words[i]) * 0x100000001B3ULL;
+    }
+
+    return result;
+}
+
+INTERNAL void
+linux_frame_export_reader_thread(void *parameter)
+{
+    LinuxFrameExportReader *reader     = parameter;
+    FrameExport            *export     = reader->export;
+    u64                     last_index = U64_MAX;
+
+    while(!__atomic_load_n(&export->is_closed, __ATOMIC_ACQUIRE))
+    {
+        u32              sequence;
+        FrameExportSlot *slot = frame_export_read_begin(export, &sequence);
+
+        if(!slot || slot->index == last_index)
+        {
+            linux_sleep_until(linux_get_cpu_tick() + (NANOSECONDS_PER_SECOND / 1000));
+            continue;
+        }
+
+        u64 index    = slot->index;
+        u64 size     = MIN(slot->size, export->slot_capacity);
+        u64 checksum = linux_frame_checksum(frame_export_pixels(export, slot), size);
+
+        if(!frame_export_read_end(slot, sequence))
+        {
+            reader->reads_torn++;
+            continue;
+        }
+
+        reader->frames_missed += last_index == U64_MAX ? 0 : index - last_index - 1;
+        reader->frames_differing += checksum != reader->checksums[index];
+        reader->frames_read++;
+
+        last_index = index;
+    }
+}
+
+// NOTE(leo): Plays an AI match at 60 frames per second and publishes every frame through the
+// frame export (see frame_export.c), like -D FRAME_EXPORT does, with a reader following it.
+// The segment has the default name, so pong_frame_reader can follow it too.
+INTERNAL int
+linux_run_frame_export_bench(u32 frames, s32 width, s32 height, BackBufferFormat format)
+{
+    g_back_buffer.format = format;
+    linux_allocate_back_buffer(&g_back_buffer, width, height);
+    game_set_bitplane_palette(&g_back_buffer);
+
+    FrameExport *export = frame_export_create(FRAME_EXPORT_DEFAULT_NAME,
+                                              FRAME_EXPORT_DEFAULT_SLOTS,
+                                              back_buffer_size(&g_back_buffer));
+
+    // NOTE(leo): The present it's compared to, a copy or an expansion into a window sized
+    // 32-bit buffer.
+    u32 *front_buffer  = malloc((u64)width * (u64)height * sizeof(u32));
+    s64 *publish_ticks = malloc(frames * sizeof(s64));
+    u64 *checksums     = malloc(frames * sizeof(u64));
+
+    if(!export || !front_buffer || !publish_ticks || !checksums)
+    {
+        LINUX_ERROR_LITERAL("Failed to create the shared memory to export the frames.");
+    }
+
+    LinuxFrameExportReader reader = {0};
+    reader.export                 = export;
+    reader.checksums              = checksums;
+
+    OsThread reader_thread;
+
+    if(!os_thread_create(&reader_thread, linux_frame_export_reader_thread, &reader))
+    {
+        LINUX_ERROR_LITERAL("Failed to start the reader thread.");
+    }
+
+    GameState game_state;
+    game_main(&game_state, 0x853C49E6748FEA9BULL, 0xDA3E39CB94B95BDBULL);
+
+    AiPlayer players[2];
+    ai_init(&players[0], false, AI_HARD, 0x853C49E6748FEA9BULL, 1);
+    ai_init(&players[1], true, AI_MEDIUM, 0x853C49E6748FEA9BULL, 2);
+
+    s64 render_ticks  = 0;
+    s64 present_ticks = 0;
+    s64 frame_ticks   = NANOSECONDS_PER_SECOND / 60;
+    u64 size          = back_buffer_size(&g_back_buffer);
+
+    for(u32 frame = 0; frame < frames; ++frame)
+    {
+        s64       frame_begin = linux_get_cpu_tick();
+        GameInput input       = {0};
+
+        input.is_key_down[KEY_ENTER] = !game_state.match_started;
+
+        ai_update(&players[0], &game_state, NETPLAY_TICK_SECONDS, &input);
+        ai_update(&players[1], &game_state, NETPLAY_TICK_SECONDS, &input);
+        game_update(&game_state, &input, NETPLAY_TICK_SECONDS);
+        game_render(&game_state);
+
+        s64 present_begin = linux_get_cpu_tick();
+
+        if(format == BACK_BUFFER_BITPLANE)
+        {
+            expand_bitplane(&g_back_buffer, front_buffer, width * (s32)sizeof(u32));
+        }
+        else
+        {
+            linux_copy_frame(&g_back_buffer, front_buffer);
+        }
+
+        s64 present_end = linux_get_cpu_tick();
+
+        // NOTE(leo): Before publishing, the reader can get to the frame right after.
+        checksums[frame] = linux_frame_checksum(g_back_buffer.pixels, size);
+
+        s64 publish_begin = linux_get_cpu_tick();
+        frame_export_publish(export, &g_back_buffer, frame);
+        s64 publish_end = linux_get_cpu_tick();
+
+        render_ticks += present_begin - frame_begin;
+        present_ticks += present_end - present_begin;
+        publish_ticks[frame] = publish_end - publish_begin;
+
+        linux_sleep_until(frame_begin + frame_ticks);
+    }
+
+    // NOTE(leo): Gives the reader the time to get to the last frame.
+    linux_sleep_until(linux_get_cpu_tick() + frame_ticks);
+
+    // NOTE(leo): The reader shares the host's mapping here, it has to stop before it goes.
+    __atomic_store_n(&export->is_closed, true, __ATOMIC_RELEASE);
+    os_thread_join(&reader_thread);
+
+    frame_export_destroy(export, FRAME_EXPORT_DEFAULT_NAME);
+
+    s64 publish_total = 0;
+
+    for(u32 frame = 0; frame < frames; ++frame)
+    {
+        publish_total += publish_ticks[frame];
+    }
+
+    qsort(publish_ticks, frames, sizeof(s64), linux_compare_s64);
+
+    u32 last       = frames - 1;
+    f64 publish_ms = (f64)publish_total / 1000000.0 / (f64)frames;
+    b32 has_failed = reader.frames_differing || !reader.frames_read;
+
+    OS_PRINTF_LITERAL("Frame export benchmark: %u32 frames at %u32x%u32 from a %a back "
+                      "buffer, %u32 slots of %.2f MB\n"
+                      "  render: %.3f ms per frame, present: %.3f ms per frame\n"
+                      "  publish: %.3f ms per frame (%.1f%% of a 60 Hz frame), p99 %.3f ms, "
+                      "max %.3f ms, %.2f GB/s\n"
+                      "  reader: %u64 frames read, %u64 missed, %u64 reads written over\n"
+                      "  %u64 frames differ, %a\n",
+                      frames,
+                      (u32)width,
+                      (u32)height,
+                      format == BACK_BUFFER_BITPLANE ? "bitplane" : "32-bit",
+                      (u32)FRAME_EXPORT_DEFAULT_SLOTS,
+                      (f64)size / 1000000.0,
+                      (f64)render_ticks / 1000000.0 / (f64)frames,
+                      (f64)present_ticks / 1000000.0 / (f64)frames,
+                      publish_ms,
+                      publish_ms / (1000.0 / 60.0) * 100.0,
+                      (f64)publish_ticks[(u64)last * 99 / 100] / 1000000.0,
+                      (f64)publish_ticks[last] / 1000000.0,
+                      (f64)size / 1000000.0 / publish_ms,
+                      reader.frames_read,
+                      reader.frames_missed,
+                      reader.reads_torn,
+                      reader.frames_differing,
+                      has_failed ? "FAILED" : "PASSED");
+
+    free(front_buffer);
+    free(publish_ticks);
+    free(checksums);
+
+    linux_free_back_buffer(&g_back_buffer);
+    memset(&g_back_buffer, 0, sizeof(g_back_buffer));
+
+    return has_failed ? 1 : 0;
+}
+
+#define LINUX_POST_PROCESS_RUNS 3
+
+// NOTE(leo): Plays an AI match without pacing and post-processes every frame three ways from
+// the same scene: every pass over the whole frame before the next one (the reference), in
+// tiles, and in tiles cut across the threads_count workers of a job system. The same frames
+// also go through a render pipeline with post-processing on, like in the game. Every frame
+// must be the same as the reference, pixel for pixel.
+INTERNAL int
+linux_run_post_process_bench(u32 frames, s32 width, s32 height, u32 threads_count)
+{
+    char *run_names[LINUX_POST_PROCESS_RUNS] = {"untiled", "tiled", "threaded"};
+
+    BackBuffer  dests[LINUX_POST_PROCESS_RUNS] = {0};
+    PostProcess posts[LINUX_POST_PROCESS_RUNS];
+
+    // NOTE(leo): This thread is worker 0.
+    JobSystem       jobs;
+    JobSystemConfig jobs_config = {0};
+    jobs_config.workers_count   = MAX(threads_count, 1);
+
+    if(!job_system_init(&jobs, &jobs_config))
+    {
+        LINUX_ERROR_LITERAL("Failed to start the job system.");
+    }
+
+    for(u32 run = 0; run < LINUX_POST_PROCESS_RUNS; ++run)
+    {
+        linux_allocate_back_buffer(&dests[run], width, height);
+
+        post_process_init(&posts[run], run == 2 ? &jobs : NULL);
+
+        if(!post_process_prepare(&posts[run], &dests[run]))
+        {
+            LINUX_ERROR_LITERAL("Failed to allocate the post-process buffers.");
+        }
+    }
+
+    posts[0].tile_rows = height;
+
+    BackBuffer pipeline_buffers[RENDER_PIPELINE_BUFFERS_COUNT] = {0};
+
+    for(u32 i = 0; i < RENDER_PIPELINE_BUFFERS_COUNT; ++i)
+    {
+        linux_allocate_back_buffer(&pipeline_buffers[i], width, height);
+    }
+
+    RenderPipeline pipeline;
+
+    if(!render_pipeline_init(&pipeline, false, threads_count))
+    {
+        LINUX_ERROR_LITERAL("Failed to start the post-process threads.");
+    }
+
+    render_pipeline_set_post_processing(&pipeline, true);
+    render_pipeline_set_back_buffers(&pipeline, pipeline_buffers);
+
+    GameState game_state;
+    game_main(&game_state, 0x853C49E6748FEA9BULL, 0xDA3E39CB94B95BDBULL);
+
+    AiPlayer players[2];
+    ai_init(&players[0], false, AI_HARD, 0x853C49E6748FEA9BULL, 1);
+    ai_init(&players[1], true, AI_MEDIUM, 0x853C49E6748FEA9BULL, 2);
+
+    s64 render_ticks                                          = 0;
+    s64 pipeline_ticks                                        = 0;
+    s64 run_ticks[LINUX_POST_PROCESS_RUNS]                    = {0};
+    s64 pass_ticks[LINUX_POST_PROCESS_RUNS][POST_PASSES_COUNT] = {0};
+    u32 frames_differing                                      = 0;
+
+    memset(&g_overlay_text, 0, sizeof(g_overlay_text));
+
+    for(u32 frame = 0; frame < frames; ++frame)
+    {
+        GameInput input = {0};
+
+        input.is_key_down[KEY_ENTER] = !game_state.match_started;
+
+        ai_update(&players[0], &game_state, NETPLAY_TICK_SECONDS, &input);
+        ai_update(&players[1], &game_state, NETPLAY_TICK_SECONDS, &input);
+        game_update(&game_state, &input, NETPLAY_TICK_SECONDS);
+
+        s64 begin = linux_get_cpu_tick();
+
+        g_back_buffer = posts[0].scene;
+        game_render(&game_state);
+
+        render_ticks += linux_get_cpu_tick() - begin;
+
+        b32 is_differing = false;
+
+        for(u32 run = 0; run < LINUX_POST_PROCESS_RUNS; ++run)
+        {
+            if(run)
+            {
+                memcpy(posts[run].scene.pixels,
+                       posts[0].scene.pixels,
+                       back_buffer_size(&posts[0].scene));
+            }
+
+            post_process_run(&posts[run], &dests[run]);
+
+            s64 ticks[POST_PASSES_COUNT];
+            run_ticks[run] += post_process_last_ticks(&posts[run], ticks);
+
+            for(u32 pass = 0; pass < POST_PASSES_COUNT; ++pass)
+            {
+                pass_ticks[run][pass] += ticks[pass];
+            }
+
+            is_differing |= run && !linux_back_buffers_match(&dests[0], &dests[run]);
+        }
+
+        String8 overlay_text = {"", 0};
+        render_pipeline_submit(&pipeline, &game_state, overlay_text);
+
+        s32 buffer = render_pipeline_acquire_frame(&pipeline, false);
+
+        if(buffer < 0)
+        {
+            LINUX_ERROR_LITERAL("The render pipeline didn't render frame %u32.", frame);
+        }
+
+        pipeline_ticks += render_pipeline_last_render_ticks(&pipeline);
+        is_differing |= !linux_back_buffers_match(&dests[0], &pipeline.back_buffers[buffer]);
+
+        render_pipeline_release_frame(&pipeline, buffer);
+
+        frames_differing += is_differing;
+    }
+
+    OS_PRINTF_LITERAL("Post-process benchmark: %u32 frames at %u32x%u32, %u32 rows per tile, "
+                      "%u32 workers, %u32 processors\n"
+                      "  render:   %.3f ms per frame\n",
+                      frames,
+                      (u32)width,
+                      (u32)height,
+                      (u32)post_process_tile_rows(&posts[1]),
+                      posts[2].bands_count,
+                      os_get_processors_count(),
+                      (f64)render_ticks / 1000000.0 / frames);
+
+    // NOTE(leo): With workers, the passes are added up over the bands.
+    for(u32 run = 0; run < LINUX_POST_PROCESS_RUNS; ++run)
+    {
+        f64 run_ms = (f64)run_ticks[run] / 1000000.0 / frames;
+
+        OS_PRINTF_LITERAL("  %a:%a%.3f ms per frame (%.1f%% of a 60 Hz frame), %a %.3f, %a "
+                          "%.3f, %a %.3f\n",
+                          run_names[run],
+                          run == 0 ? "  " : run == 1 ? "    " : " ",
+                          run_ms,
+                          run_ms / (1000.0 / 60.0) * 100.0,
+                          g_post_pass_names[POST_PASS_PERSISTENCE],
+                          (f64)pass_ticks[run][POST_PASS_PERSISTENCE] / 1000000.0 / frames,
+                          g_post_pass_names[POST_PASS_BLOOM],
+                          (f64)pass_ticks[run][POST_PASS_BLOOM] / 1000000.0 / frames,
+                          g_post_pass_names[POST_PASS_SCANLINES],
+                          (f64)pass_ticks[run][POST_PASS_SCANLINES] / 1000000.0 / frames);
+    }
+
+    OS_PRINTF_LITERAL("  render pipeline: %.3f ms per frame rendered and post-processed\n"
+                      "  %u32 frames differ, %a\n",
+                      (f64)pipeline_ticks / 1000000.0 / frames,
+                      frames_differing,
+                      frames_differing ? "FAILED" : "PASSED");
+
+    render_pipeline_shutdown(&pipeline);
+
+    for(u32 i = 0; i < RENDER_PIPELINE_BUFFERS_COUNT; ++i)
+    {
+        linux_free_back_buffer(&pipeline_buffers[i]);
+    }
+
+    for(u32 run = 0; run < LINUX_POST_PROCESS_RUNS; ++run)
+    {
+        post_process_shutdown(&posts[run]);
+        linux_free_back_buffer(&dests[run]);
+    }
+
+    job_system_shutdown(&jobs);
+
+    memset(&g_back_buffer, 0, sizeof(g_back_buffer));
+    memset(&g_overlay_text, 0, sizeof(g_overlay_text));
+
+    return frames_differing ? 1 : 0;
+}
+
+#define LINUX_PARTICLE_BENCH_RUNS 3
+
+// NOTE(leo): Budget for updating and drawing the particles, out of a 60 Hz frame.
+#define LINUX_PARTICLE_BUDGET_MS 4.0
+
+// NOTE(leo): What particles_update does, one particle at a time.
+INTERNAL void
+linux_particles_update_reference(ParticleSystem *particles, f32 seconds)
+{
+    f32 gravity = PARTICLES_GRAVITY * seconds;
+    f32 limit   = 1.0f + PARTICLES_SCREEN_MARGIN;
+    u32 alive   = 0;
+
+    for(u32 i = 0; i < particles->count; ++i)
+    {
+        f32 velocity_y = particles->velocity_y[i] - gravity;
+        f32 x          = particles->x[i] + (particles->velocity_x[i] * seconds);
+        f32 y          = particles->y[i] + (velocity_y * seconds);
+        f32 brightness = particles->brightness[i] - (particles->fade[i] * seconds);
+
+        if(brightness > 0.0f && x <= limit && x >= -limit && y <= limit && y >= -limit)
+        {
+            particles->x[alive]          = x;
+            particles->y[alive]          = y;
+            particles->velocity_x[alive] = particles->velocity_x[i];
+            particles->velocity_y[alive] = velocity_y;
+            particles->brightness[alive] = brightness;
+            particles->fade[alive]       = particles->fade[i];
+
+            alive++;
+        }
+    }
+
+    particles->count = alive;
+}
+
+INTERNAL b32
+linux_particles_match(ParticleSystem *a, ParticleSystem *b)
+{
+    u64 size = (u64)a->count * sizeof(f32);
+
+    return a->count == b->count && memcmp(a->x, b->x, size) == 0
+           && memcmp(a->y, b->y, size) == 0 && memcmp(a->velocity_x, b->velocity_x, size) == 0
+           && memcmp(a->velocity_y, b->velocity_y, size) == 0
+           && memcmp(a->brightness, b->brightness, size) == 0
+           && memcmp(a->fade, b->fade, size) == 0;
+}
+
+// NOTE(leo): Keeps a quarter, half and all of particles_count particles alive, spawning new
+// ones as they die, and updates and draws them every frame, at 60 Hz. The cost per particle
+// should be about the same in the three. Every update is checked against
+// linux_particles_update_reference, they must leave the same particles bit for bit.
+INTERNAL int
+linux_run_particle_bench(u32 particles_count, u32 frames, s32 width, s32 height)
+{
+    linux_allocate_back_buffer(&g_back_buffer, width, height);
+
+    ParticleSystem particles;
+    ParticleSystem reference;
+
+    if(!particles_init(&particles, particles_count, 0x853C49E6748FEA9BULL)
+       || !particles_init(&reference, particles_count, 0))
+    {
+        LINUX_ERROR_LITERAL("Failed to allocate the particles.");
+    }
+
+    OS_PRINTF_LITERAL("Particle benchmark: %u32 frames at %u32x%u32, up to %u32 particles\n",
+                      frames,
+                      (u32)width,
+                      (u32)height,
+                      particles_count);
+
+    f32 seconds          = 1.0f / 60.0f;
+    u32 frames_differing = 0;
+    f64 last_run_ms      = 0.0;
+
+    for(u32 run = 0; run < LINUX_PARTICLE_BENCH_RUNS; ++run)
+    {
+        u32 target = particles_count >> (LINUX_PARTICLE_BENCH_RUNS - 1 - run);
+
+        particles.count = 0;
+        reference.count = 0;
+
+        s64 spawn_ticks  = 0;
+        s64 update_ticks = 0;
+        s64 render_ticks = 0;
+        u64 spawned      = 0;
+        u64 updated      = 0;
+
+        for(u32 frame = 0; frame < frames; ++frame)
+        {
+            s64 begin = linux_get_cpu_tick();
+
+            while(particles.count < target)
+            {
+                pcg32_random_t *rng = &particles.rng;
+
+                f32 x          = (2.0f * random_f32_0_1(rng)) - 1.0f;
+                f32 y          = (2.0f * random_f32_0_1(rng)) - 1.0f;
+                f32 velocity_x = random_f32_0_1(rng) - 0.5f;
+                f32 velocity_y = random_f32_0_1(rng) - 0.5f;
+                f32 life       = 0.5f + (2.5f * random_f32_0_1(rng));
+
+                particles_spawn(&particles, x, y, velocity_x, velocity_y, life);
+                particles_spawn(&reference, x, y, velocity_x, velocity_y, life);
+                spawned++;
+            }
+
+            s64 spawn_end = linux_get_cpu_tick();
+
+            updated += particles.count;
+            particles_update(&particles, seconds);
+
+            s64 update_end = linux_get_cpu_tick();
+
+            linux_particles_update_reference(&reference, seconds);
+            frames_differing += !linux_particles_match(&particles, &reference);
+
+            clear_back_buffer(BACKGROUND_COLOR);
+
+            s64 render_begin = linux_get_cpu_tick();
+
+            particles_render(&particles, PARTICLE_SCALE, ENTITIES_COLOR, BACKGROUND_COLOR);
+
+            spawn_ticks += spawn_end - begin;
+            update_ticks += update_end - spawn_end;
+            render_ticks += linux_get_cpu_tick() - render_begin;
+        }
+
+        f64 update_ms = (f64)update_ticks / 1000000.0 / frames;
+        f64 render_ms = (f64)render_ticks / 1000000.0 / frames;
+        last_run_ms   = update_ms + render_ms;
+
+        OS_PRINTF_LITERAL("  %u32 particles: update %.3f ms (%.2f ns each), render %.3f ms "
+                          "(%.2f ns each), %.1f%% of a 60 Hz frame; spawned %.0f per frame "
+                          "in %.3f ms\n",
+                          target,
+                          update_ms,
+                          (f64)update_ticks / (f64)MAX(updated, 1),
+                          render_ms,
+                          (f64)render_ticks / (f64)MAX(updated, 1),
+                          last_run_ms / (1000.0 / 60.0) * 100.0,
+                          (f64)spawned / frames,
+                          (f64)spawn_ticks / 1000000.0 / frames);
+    }
+
+    b32 has_failed = frames_differing || last_run_ms > LINUX_PARTICLE_BUDGET_MS;
+
+    OS_PRINTF_LITERAL("  %u32 updates differ from the reference, %.3f ms against a budget of "
+                      "%.1f ms, %a\n",
+                      frames_differing,
+                      last_run_ms,
+                      LINUX_PARTICLE_BUDGET_MS,
+                      has_failed ? "FAILED" : "PASSED");
+
+    particles_destroy(&particles);
+    particles_destroy(&reference);
+
+    linux_free_back_buffer(&g_back_buffer);
+    memset(&g_back_buffer, 0, sizeof(g_back_buffer));
+
+    return has_failed ? 1 : 0;
+}
+
+INTERNAL void
+linux_print_usage(void)
+{
+    OS_PRINT_LITERAL("Usage: pong <mode> [arguments]\n"
+                     "Modes:\n"
+                     "  --latency-test [frames]     Synthetic input-to-present latency.\n"
+                     "  --record <file> [ticks]     Records a match with random inputs.\n"
+                     "  --replay <file> [--render]  Replays a match and verifies it.\n"
+                     "  --netplay-test [ticks] [latency ms] [jitter ms] [loss %] "
+                     "[desync tick]\n"
+                     "                              Rollback netplay over loopback UDP.\n"
+                     "  --spectator-bench [ticks] [position bits] [velocity bits] [loss %]\n"
+                     "                              Spectator snapshot codec benchmark.\n"
+                     "  --ai-match [points] [left difficulty] [right difficulty]\n"
+                     "                              AI against AI (easy, medium or hard).\n"
+                     "  --env-bench [environments] [steps] [state|frame]\n"
+                     "                              Bot training environment benchmark.\n"
+                     "  --bot-bench [ticks]         Shared memory bot round trip latency.\n"
+                     "  --job-stress [workers] [jobs] [rounds]\n"
+                     "                              Job system correctness and overhead.\n"
+                     "  --render-pipeline-bench [frames] [width] [height] [tick us]\n"
+                     "                              Serial against threaded rendering.\n"
+                     "  --resolution-governor [frames] [width] [height] [budget ms]\n"
+                     "                              Dynamic render resolution.\n"
+                     "  --bitplane-bench [frames] [width] [height]\n"
+                     "                              32-bit against 1-bit back buffer.\n"
+                     "  --span-bench [frames] [width] [height]\n"
+                     "                              Immediate against span rendering.\n"
+                     "  --glyph-bench [frames] [width] [height]\n"
+                     "                              Glyphs from rectangles and an atlas.\n"
+                     "  --compositor-bench [frames] [width] [height]\n"
+                     "                              Whole against composited frames.\n"
+                     "  --framebuffer-bench [width] [height] [allocations] [frames]\n"
+                     "                              Frame times after a resize.\n"
+                     "  --screenshot-bench [frames] [width] [height] [png|qoi]\n"
+                     "                              Screenshots of every frame.\n"
+                     "  --video-bench [frames] [width] [height] [rgb|bitplane]\n"
+                     "                              Records a match and plays it back.\n"
+                     "  --video-play <file> [frame] [png file]\n"
+                     "                              Plays a video, saves a frame.\n"
+                     "  --frame-export-bench [frames] [width] [height] [rgb|bitplane]\n"
+                     "                              Frames to other processes.\n"
+                     "  --post-process-bench [frames] [width] [height] [threads]\n"
+                     "                              CRT post-process passes.\n"
+                     "  --particle-bench [particles] [frames] [width] [height]\n"
+                     "                              Particle update and drawing.\n");
+}
+
+int
+main(int argc, char **argv)
+{
+    g_cpu_ticks_per_second = (f32)NANOSECONDS_PER_SECOND;
+
+    int exit_code = 0;
+
+    if(argc >= 2 && strcmp(argv[1], "--latency-test") == 0)
+    {
+        u32 frames_to_run = argc >= 3 ? (u32)strtoul(argv[2], NULL, 10) : 600;
+        exit_code         = linux_run_latency_test(frames_to_run);
+    }
+    else if(argc >= 3 && strcmp(argv[1], "--record") == 0)
+    {
+        u32 ticks_to_run = argc >= 4 ? (u32)strtoul(argv[3], NULL, 10) : 60 * 60 * 10;
+        exit_code        = linux_run_record(argv[2], ticks_to_run);
+    }
+    else if(argc >= 3 && strcmp(argv[1], "--replay") == 0)
+    {
+        b32 render = argc >= 4 && strcmp(argv[3], "--render") == 0;
+        exit_code  = linux_run_replay(argv[2], render);
+    }
+    else if(argc >= 2 && strcmp(argv[1], "--netplay-test") == 0)
+    {
+        u32 ticks_to_run = argc >= 3 ? (u32)strtoul(argv[2], NULL, 10) : 60 * 60;
+        f32 latency_ms   = argc >= 4 ? strtof(argv[3], NULL) : 60.0f;
+        f32 jitter_ms    = argc >= 5 ? strtof(argv[4], NULL) : 20.0f;
+        f32 loss_percent = argc >= 6 ? strtof(argv[5], NULL) : 5.0f;
+        u32 desync_tick  = argc >= 7 ? (u32)strtoul(argv[6], NULL, 10) : U32_MAX;
+
+        exit_code = linux_run_netplay_test(ticks_to_run,
+                                           latency_ms,
+                                           jitter_ms,
+                                           loss_percent,
+                                           desync_tick);
+    }
+    else if(argc >= 2 && strcmp(argv[1], "--spectator-bench") == 0)
+    {
+        u32 ticks_to_run  = argc >= 3 ? (u32)strtoul(argv[2], NULL, 10) : 60 * 60 * 10;
+        u32 position_bits = argc >= 4 ? (u32)strtoul(argv[3], NULL, 10)
+                                      : SPECTATOR_DEFAULT_POSITION_FRACTION_BITS;
+        u32 velocity_bits = argc >= 5 ? (u32)strtoul(argv[4], NULL, 10)
+                                      : SPECTATOR_DEFAULT_VELOCITY_FRACTION_BITS;
+        f32 loss_percent  = argc >= 6 ? strtof(argv[5], NULL) : 5.0f;
+
+        if(position_bits > SPECTATOR_MAX_FRACTION_BITS
+           || velocity_bits > SPECTATOR_MAX_FRACTION_BITS)
+        {
+            LINUX_ERROR_LITERAL("At most %u32 fraction bits.", SPECTATOR_MAX_FRACTION_BITS);
+        }
+
+        exit_code = linux_run_spectator_bench(ticks_to_run,
+                                              position_bits,
+                                              velocity_bits,
+                                              loss_percent);
+    }
+    else if(argc >= 2 && strcmp(argv[1], "--ai-match") == 0)
+    {
+        u32          points_to_win   = argc >= 3 ? (u32)strtoul(argv[2], NULL, 10) : 11;
+        AiDifficulty difficulties[2] = {AI_HARD, AI_MEDIUM};
+
+        for(int i = 3; i < argc && i < 5; ++i)
+        {
+            String8 name = {argv[i], (u32)strlen(argv[i])};
+
+            if(!ai_difficulty_from_name(name, &difficulties[i - 3]))
+            {
+                LINUX_ERROR_LITERAL("Unknown difficulty %a, use easy, medium or hard.",
+                                    argv[i]);
+            }
+        }
+
+        exit_code = linux_run_ai_match(points_to_win, difficulties[0], difficulties[1]);
+    }
+    else if(argc >= 2 && strcmp(argv[1], "--env-bench") == 0)
+    {
+        u32 envs_count       = argc >= 3 ? (u32)strtoul(argv[2], NULL, 10) : 64;
+        u32 steps            = argc >= 4 ? (u32)strtoul(argv[3], NULL, 10) : 10000;
+        u32 observation_type = PONG_ENV_OBSERVE_FRAME;
+
+        if(argc >= 5 && strcmp(argv[4], "state") == 0)
+        {
+            observation_type = PONG_ENV_OBSERVE_STATE;
+        }
+
+        exit_code = linux_run_env_bench(envs_count, steps, observation_type);
+    }
+    else if(argc >= 2 && strcmp(argv[1], "--bot-bench") == 0)
+    {
+        u32 ticks_to_run = argc >= 3 ? (u32)strtoul(argv[2], NULL, 10) : 60 * 60 * 10;
+
+        if(!ticks_to_run)
+        {
+            LINUX_ERROR_LITERAL("At least one tick.");
+        }
+
+        exit_code = linux_run_bot_bench(ticks_to_run);
+    }
+    else if(argc >= 2 && strcmp(argv[1], "--job-stress") == 0)
+    {
+        u32 workers_count = argc >= 3 ? (u32)strtoul(argv[2], NULL, 10) : 0;
+        u32 jobs_count    = argc >= 4 ? (u32)strtoul(argv[3], NULL, 10) : 100000;
+        u32 rounds        = argc >= 5 ? (u32)strtoul(argv[4], NULL, 10) : 20;
+
+        if(!jobs_count)
+        {
+            LINUX_ERROR_LITERAL("At least one job.");
+        }
+
+        exit_code = linux_run_job_stress(workers_count, jobs_count, rounds);
+    }
+    else if(argc >= 2 && strcmp(argv[1], "--render-pipeline-bench") == 0)
+    {
+        u32 frames            = argc >= 3 ? (u32)strtoul(argv[2], NULL, 10) : 600;
+        s32 width             = argc >= 4 ? (s32)strtol(argv[3], NULL, 10) : 3840;
+        s32 height            = argc >= 5 ? (s32)strtol(argv[4], NULL, 10) : 2160;
+        u32 tick_microseconds = argc >= 6 ? (u32)strtoul(argv[5], NULL, 10) : 0;
+
+        if(!frames || width <= 0 || height <= 0)
+        {
+            LINUX_ERROR_LITERAL("At least one frame, of at least one pixel.");
+        }
+
+        exit_code = linux_run_render_pipeline_bench(frames, width, height, tick_microseconds);
+    }
+    else if(argc >= 2 && strcmp(argv[1], "--resolution-governor") == 0)
+    {
+        u32 frames              = argc >= 3 ? (u32)strtoul(argv[2], NULL, 10) : 600;
+        s32 width               = argc >= 4 ? (s32)strtol(argv[3], NULL, 10) : 3840;
+        s32 height              = argc >= 5 ? (s32)strtol(argv[4], NULL, 10) : 2160;
+        f32 budget_milliseconds = argc >= 6 ? strtof(argv[5], NULL) : 1.0f;
+
+        if(!frames || width <= 0 || height <= 0 || budget_milliseconds <= 0.0f)
+        {
+            LINUX_ERROR_LITERAL("At least one frame, of at least one pixel, and a budget.");
+        }
+
+        exit_code = linux_run_resolution_governor(frames, width, height, budget_milliseconds);
+    }
+    else if(argc >= 2 && strcmp(argv[1], "--bitplane-bench") == 0)
+    {
+        u32 frames = argc >= 3 ? (u32)strtoul(argv[2], NULL, 10) : 600;
+        s32 width  = argc >= 4 ? (s32)strtol(argv[3], NULL, 10) : 3840;
+        s32 height = argc >= 5 ? (s32)strtol(argv[4], NULL, 10) : 2160;
+
+        if(!frames || width <= 0 || height <= 0)
+        {
+            LINUX_ERROR_LITERAL("At least one frame, of at least one pixel.");
+        }
+
+        exit_code = linux_run_bitplane_bench(frames, width, height);
+    }
+    else if(argc >= 2 && strcmp(argv[1], "--span-bench") == 0)
+    {
+        u32 frames = argc >= 3 ? (u32)strtoul(argv[2], NULL, 10) : 600;
+        s32 width  = argc >= 4 ? (s32)strtol(argv[3], NULL, 10) : 3840;
+        s32 height = argc >= 5 ? (s32)strtol(argv[4], NULL, 10) : 2160;
+
+        if(!frames || width <= 0 || height <= 0)
+        {
+            LINUX_ERROR_LITERAL("At least one frame, of at least one pixel.");
+        }
+
+        exit_code = linux_run_span_bench(frames, width, height);
+    }
+    else if(argc >= 2 && strcmp(argv[1], "--glyph-bench") == 0)
+    {
+        u32 frames = argc >= 3 ? (u32)strtoul(argv[2], NULL, 10) : 1000;
+        s32 width  = argc >= 4 ? (s32)strtol(argv[3], NULL, 10) : 3840;
+        s32 height = argc >= 5 ? (s32)strtol(argv[4], NULL, 10) : 2160;
+
+        if(!frames || width <= 0 || height <= 0)
+        {
+            LINUX_ERROR_LITERAL("At least one frame, of at least one pixel.");
+        }
+
+        exit_code = linux_run_glyph_bench(frames, width, height);
+    }
+    else if(argc >= 2 && strcmp(argv[1], "--compositor-bench") == 0)
+    {
+        u32 frames = argc >= 3 ? (u32)strtoul(argv[2], NULL, 10) : 3000;
+        s32 width  = argc >= 4 ? (s32)strtol(argv[3], NULL, 10) : 3840;
+        s32 height = argc >= 5 ? (s32)strtol(argv[4], NULL, 10) : 2160;
+
+        if(!frames || width <= 0 || height <= 0)
+        {
+            LINUX_ERROR_LITERAL("At least one frame, of at least one pixel.");
+        }
+
+        exit_code = linux_run_compositor_bench(frames, width, height);
+    }
+    else if(argc >= 2 && strcmp(argv[1], "--framebuffer-bench") == 0)
+    {
+        s32 width  = argc >= 3 ? (s32)strtol(argv[2], NULL, 10) : 3840;
+        s32 height = argc >= 4 ? (s32)strtol(argv[3], NULL, 10) : 2160;
+        u32 rounds = argc >= 5 ? (u32)strtoul(argv[4], NULL, 10) : 20;
+        u32 frames = argc >= 6 ? (u32)strtoul(argv[5], NULL, 10) : 10;
+
+        if(width <= 0 || height <= 0 || !rounds || !frames)
+        {
+            LINUX_ERROR_LITERAL("At least one allocation and one frame, of at least one "
+                                "pixel.");
+        }
+
+        exit_code = linux_run_framebuffer_bench(width, height, rounds, frames);
+    }
+    else if(argc >= 2 && strcmp(argv[1], "--screenshot-bench") == 0)
+    {
+        u32 frames = argc >= 3 ? (u32)strtoul(argv[2], NULL, 10) : 300;
+        s32 width  = argc >= 4 ? (s32)strtol(argv[3], NULL, 10) : 1920;
+        s32 height = argc >= 5 ? (s32)strtol(argv[4], NULL, 10) : 1080;
+
+        ScreenshotFileFormat file_format =
+            argc >= 6 && strcmp(argv[5], "qoi") == 0 ? SCREENSHOT_QOI : SCREENSHOT_PNG;
+
+        if(!frames || width <= 0 || height <= 0)
+        {
+            LINUX_ERROR_LITERAL("At least one frame, of at least one pixel.");
+        }
+
+        exit_code = linux_run_screenshot_bench(frames, width, height, file_format);
+    }
+    else if(argc >= 2 && strcmp(argv[1], "--video-bench") == 0)
+    {
+        u32 frames = argc >= 3 ? (u32)strtoul(argv[2], NULL, 10) : 3600;
+        s32 width  = argc >= 4 ? (s32)strtol(argv[3], NULL, 10) : 1920;
+        s32 height = argc >= 5 ? (s32)strtol(argv[4], NULL, 10) : 1080;
+
+        BackBufferFormat format = argc >= 6 && strcmp(argv[5], "bitplane") == 0
+                                    ? BACK_BUFFER_BITPLANE
+                                    : BACK_BUFFER_RGB;
+
+        if(!frames || width <= 0 || height <= 0)
+        {
+            LINUX_ERROR_LITERAL("At least one frame, of at least one pixel.");
+        }
+
+        exit_code = linux_run_video_bench(frames, width, height, format);
+    }
+    else if(argc >= 3 && strcmp(argv[1], "--video-play") == 0)
+    {
+        u32   frame_to_save = argc >= 4 ? (u32)strtoul(argv[3], NULL, 10) : 0;
+        char *png_path      = argc >= 5 ? argv[4] : NULL;
+
+        exit_code = linux_run_video_play(argv[2], frame_to_save, png_path);
+    }
+    else if(argc >= 2 && strcmp(argv[1], "--frame-export-bench") == 0)
+    {
+        u32 frames = argc >= 3 ? (u32)strtoul(argv[2], NULL, 10) : 600;
+        s32 width  = argc >= 4 ? (s32)strtol(argv[3], NULL, 10) : 1920;
+        s32 height = argc >= 5 ? (s32)strtol(argv[4], NULL, 10) : 1080;
+
+        BackBufferFormat format = argc >= 6 && strcmp(argv[5], "bitplane") == 0
+                                    ? BACK_BUFFER_BITPLANE
+                                    : BACK_BUFFER_RGB;
+
+        if(!frames || width <= 0 || height <= 0)
+        {
+            LINUX_ERROR_LITERAL("At least one frame, of at least one pixel.");
+        }
+
+        exit_code = linux_run_frame_export_bench(frames, width, height, format);
+    }
+    else if(argc >= 2 && strcmp(argv[1], "--post-process-bench") == 0)
+    {
+        u32 frames  = argc >= 3 ? (u32)strtoul(argv[2], NULL, 10) : 300;
+        s32 width   = argc >= 4 ? (s32)strtol(argv[3], NULL, 10) : 3840;
+        s32 height  = argc >= 5 ? (s32)strtol(argv[4], NULL, 10) : 2160;
+        u32 threads = argc >= 6 ? (u32)strtoul(argv[5], NULL, 10)
+                                : MAX(os_get_processors_count(), 2) - 1;
+
+        if(!frames || width <= 0 || height <= 0)
+        {
+            LINUX_ERROR_LITERAL("At least one frame, of at least one pixel.");
+        }
+
+        exit_code = linux_run_post_process_bench(frames, width, height, threads);
+    }
+    else if(argc >= 2 && strcmp(argv[1], "--particle-bench") == 0)
+    {
+        u32 particles = argc >= 3 ? (u32)strtoul(argv[2], NULL, 10) : 100000;
+        u32 frames    = argc >= 4 ? (u32)strtoul(argv[3], NULL, 10) : 600;
+        s32 width     = argc >= 5 ? (s32)strtol(argv[4], NULL, 10) : 1920;
+        s32 height    = argc >= 6 ? (s32)strtol(argv[5], NULL, 10) : 1080;
+
+        if(!particles || !frames || width <= 0 || height <= 0)
+        {
+            LINUX_ERROR_LITERAL("At least one particle and one frame, of at least one "
+                                "pixel.");
+        }
+
+        exit_code = linux_run_particle_bench(particles, frames, width, height);
+    }
+    else
+    {
+        linux_print_usage();
+        exit_code = 1;
+    }
+
+    return exit_code;
+}
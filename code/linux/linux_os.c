@@ -0,0 +1,429 @@
+INTERNAL void
+os_print(String8 to_print)
+{
+    u32 total_written = 0;
+
+    while(total_written < to_print.length)
+    {
+        ssize_t written = write(STDOUT_FILENO,
+                                to_print.data + total_written,
+                                to_print.length - total_written);
+
+        if(written <= 0)
+        {
+            break;
+        }
+
+        total_written += (u32)written;
+    }
+}
+
+INTERNAL b32
+os_file_create(OsFile *file, char *file_path)
+{
+    int file_descriptor = open(file_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    file->handle = (u64)file_descriptor;
+
+    return file_descriptor >= 0;
+}
+
+INTERNAL b32
+os_file_write(OsFile *file, void *data, u64 size)
+{
+    u8 *to_write = data;
+
+    while(size)
+    {
+        ssize_t written = write((int)file->handle, to_write, size);
+
+        if(written <= 0)
+        {
+            return false;
+        }
+
+        to_write += written;
+        size -= (u64)written;
+    }
+
+    return true;
+}
+
+INTERNAL void
+os_file_close(OsFile *file)
+{
+    close((int)file->handle);
+}
+
+INTERNAL b32
+os_write_entire_file(char *file_path, void *data, u64 size)
+{
+    OsFile file;
+
+    if(!os_file_create(&file, file_path))
+    {
+        return false;
+    }
+
+    b32 result = os_file_write(&file, data, size);
+    os_file_close(&file);
+
+    return result;
+}
+
+INTERNAL FileContents
+os_read_entire_file(char *file_path)
+{
+    FileContents result = {0};
+
+    int file_descriptor = open(file_path, O_RDONLY);
+
+    if(file_descriptor >= 0)
+    {
+        struct stat file_status;
+
+        if(fstat(file_descriptor, &file_status) == 0 && file_status.st_size > 0)
+        {
+            result.size = (u64)file_status.st_size;
+            result.data = malloc(result.size);
+
+            u8 *to_read = result.data;
+            u64 size    = result.size;
+
+            while(to_read && size)
+            {
+                ssize_t bytes_read = read(file_descriptor, to_read, size);
+
+                if(bytes_read <= 0)
+                {
+                    free(result.data);
+                    result.data = NULL;
+                    break;
+                }
+
+                to_read += bytes_read;
+                size -= (u64)bytes_read;
+            }
+
+            if(!result.data)
+            {
+                result.size = 0;
+            }
+        }
+
+        close(file_descriptor);
+    }
+
+    return result;
+}
+
+INTERNAL b32
+os_udp_open(UdpSocket *udp_socket, u16 port)
+{
+    memset(udp_socket, 0, sizeof(*udp_socket));
+
+    int socket_descriptor = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+
+    if(socket_descriptor < 0)
+    {
+        return false;
+    }
+
+    struct sockaddr_in address = {0};
+    address.sin_family         = AF_INET;
+    address.sin_addr.s_addr    = htonl(INADDR_ANY);
+    address.sin_port           = htons(port);
+
+    socklen_t address_size = sizeof(address);
+
+    if(bind(socket_descriptor, (struct sockaddr *)&address, sizeof(address)) != 0
+       || getsockname(socket_descriptor, (struct sockaddr *)&address, &address_size) != 0)
+    {
+        close(socket_descriptor);
+        return false;
+    }
+
+    udp_socket->handle = (u64)socket_descriptor;
+    udp_socket->port   = ntohs(address.sin_port);
+
+    return true;
+}
+
+INTERNAL void
+os_udp_close(UdpSocket *udp_socket)
+{
+    close((int)udp_socket->handle);
+    memset(udp_socket, 0, sizeof(*udp_socket));
+}
+
+INTERNAL b32
+os_udp_send(UdpSocket *udp_socket, NetAddress to, void *data, u32 size)
+{
+    struct sockaddr_in address = {0};
+    address.sin_family         = AF_INET;
+    address.sin_addr.s_addr    = htonl(to.ipv4);
+    address.sin_port           = htons(to.port);
+
+    ssize_t sent = sendto((int)udp_socket->handle,
+                          data,
+                          size,
+                          0,
+                          (struct sockaddr *)&address,
+                          sizeof(address));
+
+    return sent == (ssize_t)size;
+}
+
+INTERNAL u32
+os_udp_receive(UdpSocket *udp_socket, NetAddress *from, void *buffer, u32 capacity)
+{
+    struct sockaddr_in address      = {0};
+    socklen_t          address_size = sizeof(address);
+
+    ssize_t received = recvfrom((int)udp_socket->handle,
+                                buffer,
+                                capacity,
+                                0,
+                                (struct sockaddr *)&address,
+                                &address_size);
+
+    if(received <= 0)
+    {
+        return 0;
+    }
+
+    from->ipv4 = ntohl(address.sin_addr.s_addr);
+    from->port = ntohs(address.sin_port);
+
+    return (u32)received;
+}
+
+INTERNAL void *
+os_shared_memory_open(char *name, u64 size, b32 create)
+{
+    char path[256];
+    STR8_FORMAT_LITERAL(path, sizeof(path), "/%a", name);
+
+    int flags           = create ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR;
+    int file_descriptor = shm_open(path, flags, 0600);
+
+    if(file_descriptor < 0)
+    {
+        return NULL;
+    }
+
+    void       *memory = NULL;
+    struct stat file_status;
+
+    if((!create || ftruncate(file_descriptor, (off_t)size) == 0)
+       && fstat(file_descriptor, &file_status) == 0 && (u64)file_status.st_size >= size)
+    {
+        memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, file_descriptor, 0);
+
+        if(memory == MAP_FAILED)
+        {
+            memory = NULL;
+        }
+    }
+
+    close(file_descriptor);
+
+    return memory;
+}
+
+INTERNAL void
+os_shared_memory_close(char *name, void *memory, u64 size, b32 remove)
+{
+    munmap(memory, size);
+
+    if(remove)
+    {
+        char path[256];
+        STR8_FORMAT_LITERAL(path, sizeof(path), "/%a", name);
+
+        shm_unlink(path);
+    }
+}
+
+// NOTE(leo): The huge page size of x64.
+#define LINUX_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+INTERNAL void *
+os_allocate_frame_memory(u64 size, b32 *is_huge)
+{
+    u64 huge_size = (size + LINUX_HUGE_PAGE_SIZE - 1) & ~(u64)(LINUX_HUGE_PAGE_SIZE - 1);
+
+    // NOTE(leo): Explicit huge pages only exist if the administrator reserved some
+    // (vm.nr_hugepages), MAP_POPULATE maps them right away.
+    void *memory = mmap(NULL,
+                        huge_size,
+                        PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE,
+                        -1,
+                        0);
+
+    if(memory != MAP_FAILED)
+    {
+        *is_huge = true;
+        return memory;
+    }
+
+    *is_huge = false;
+
+    // NOTE(leo): Otherwise transparent huge pages, which need the mapping to be aligned to
+    // the huge page size. Mapping one huge page more and unmapping what's around the aligned
+    // part is how to get that.
+    u64 mapping_size = huge_size + LINUX_HUGE_PAGE_SIZE;
+    u8 *mapping =
+        mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if(mapping == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    u8 *aligned = (u8 *)(((u64)mapping + LINUX_HUGE_PAGE_SIZE - 1)
+                         & ~(u64)(LINUX_HUGE_PAGE_SIZE - 1));
+    u8 *end     = aligned + huge_size;
+
+    if(aligned > mapping)
+    {
+        munmap(mapping, (size_t)(aligned - mapping));
+    }
+
+    if(mapping + mapping_size > end)
+    {
+        munmap(end, (size_t)((mapping + mapping_size) - end));
+    }
+
+    // NOTE(leo): Only a hint, it's fine if the kernel has them disabled.
+    madvise(aligned, huge_size, MADV_HUGEPAGE);
+    os_prefault(aligned, huge_size);
+
+    return aligned;
+}
+
+INTERNAL void
+os_free_frame_memory(void *memory, u64 size)
+{
+    if(memory)
+    {
+        munmap(memory,
+               (size + LINUX_HUGE_PAGE_SIZE - 1) & ~(u64)(LINUX_HUGE_PAGE_SIZE - 1));
+    }
+}
+
+INTERNAL void
+os_yield_processor(void)
+{
+    sched_yield();
+}
+
+INTERNAL s64
+os_get_cpu_tick(void)
+{
+    struct timespec time_spec;
+    clock_gettime(CLOCK_MONOTONIC, &time_spec);
+
+    return ((s64)time_spec.tv_sec * 1000000000LL) + (s64)time_spec.tv_nsec;
+}
+
+INTERNAL u32
+os_get_processors_count(void)
+{
+    cpu_set_t cpu_set;
+
+    if(sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0)
+    {
+        return (u32)CPU_COUNT(&cpu_set);
+    }
+
+    long processors_count = sysconf(_SC_NPROCESSORS_ONLN);
+    return processors_count > 0 ? (u32)processors_count : 1;
+}
+
+INTERNAL void *
+linux_thread_start(void *parameter)
+{
+    OsThread *thread = parameter;
+    thread->proc(thread->parameter);
+
+    return NULL;
+}
+
+INTERNAL b32
+os_thread_create(OsThread *thread, OsThreadProc *proc, void *parameter)
+{
+    thread->proc      = proc;
+    thread->parameter = parameter;
+
+    pthread_t pthread;
+
+    if(pthread_create(&pthread, NULL, linux_thread_start, thread) != 0)
+    {
+        return false;
+    }
+
+    thread->handle = (u64)pthread;
+
+    return true;
+}
+
+INTERNAL void
+os_thread_join(OsThread *thread)
+{
+    pthread_join((pthread_t)thread->handle, NULL);
+}
+
+INTERNAL b32
+os_thread_set_affinity(OsThread *thread, u32 processor)
+{
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(processor, &cpu_set);
+
+    pthread_t pthread = thread ? (pthread_t)thread->handle : pthread_self();
+
+    return pthread_setaffinity_np(pthread, sizeof(cpu_set), &cpu_set) == 0;
+}
+
+INTERNAL b32
+os_semaphore_init(OsSemaphore *semaphore, u32 initial_count)
+{
+    sem_t *linux_semaphore = malloc(sizeof(sem_t));
+
+    if(!linux_semaphore || sem_init(linux_semaphore, 0, initial_count) != 0)
+    {
+        free(linux_semaphore);
+        return false;
+    }
+
+    semaphore->handle = (u64)linux_semaphore;
+
+    return true;
+}
+
+INTERNAL void
+os_semaphore_destroy(OsSemaphore *semaphore)
+{
+    sem_destroy((sem_t *)semaphore->handle);
+    free((sem_t *)semaphore->handle);
+}
+
+INTERNAL void
+os_semaphore_wait(OsSemaphore *semaphore)
+{
+    // NOTE(leo): Interrupted by a signal means waiting again.
+    while(sem_wait((sem_t *)semaphore->handle) != 0 && errno == EINTR)
+    {
+    }
+}
+
+INTERNAL void
+os_semaphore_signal(OsSemaphore *semaphore, u32 count)
+{
+    for(u32 i = 0; i < count; ++i)
+    {
+        sem_post((sem_t *)semaphore->handle);
+    }
+}
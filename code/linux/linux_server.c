@@ -0,0 +1,1044 @@
+#ifndef __clang__
+// NOTE(leo): Same as the other platform layers, we are using Clang-only stuff.
+    #error This code should only be compiled with Clang.
+#endif // __clang__
+
+#ifndef __x86_64__
+    #error This code should only be compiled for x64.
+#endif // __x86_64__
+
+// ===========================================================================================
+
+// NOTE(leo): Dedicated match server. It's built from the game core only (no renderer and no
+// audio) and hosts many server-authoritative matches at once: clients send their inputs, the
+// server runs every match at the fixed netplay tick and sends the resulting state back to
+// both players.
+//
+// One network thread waits on epoll and drains the socket with recvmmsg. The main thread is
+// the tick scheduler: every tick it hands the matches, in chunks, to a pool of worker
+// threads, which simulate them and send the states out with sendmmsg. The same executable has
+// a load generator mode that plays many matches against a server on localhost.
+
+#define _GNU_SOURCE
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <x86intrin.h>
+
+#include "../game_core.c"
+#include "../snapshot_ring.c"
+#include "../netplay.c"
+
+// ===========================================================================================
+
+#include "linux_os.c"
+#include "linux_common.c"
+
+#define SERVER_MAGIC 0x56525350 // NOTE(leo): "PSRV" in little endian.
+
+// NOTE(leo): How many datagrams go in one recvmmsg or sendmmsg call.
+#define SERVER_BATCH_SIZE 64
+
+// NOTE(leo): Small enough to balance the load between workers, big enough that taking a
+// chunk (one atomic add) costs nothing next to simulating it.
+#define SERVER_MATCHES_PER_CHUNK 16
+
+#define SERVER_DEFAULT_MAX_MATCHES   1024
+#define SERVER_MATCH_TIMEOUT_TICKS   (NETPLAY_TICKS_PER_SECOND * 10)
+#define SERVER_REPORT_INTERVAL_TICKS (NETPLAY_TICKS_PER_SECOND * 5)
+
+#define SERVER_SOCKET_BUFFER_SIZE (8 * 1024 * 1024)
+
+#define LOOPBACK_IPV4 0x7F000001 // NOTE(leo): 127.0.0.1
+
+// ===========================================================================================
+
+typedef enum
+{
+    SERVER_PACKET_JOIN,
+    SERVER_PACKET_INPUT,
+    SERVER_PACKET_STATE
+
+} ServerPacketType;
+
+// NOTE(leo): Sent as is, like the netplay packets. JOIN and INPUT only send the header.
+// Clients pick their own id and learn their match from the first STATE they get.
+typedef struct
+{
+    u32 magic;
+    u8  type;
+    u8  player;
+    u8  input;
+    u8  padding;
+    u32 client_id;
+    u32 match_index;
+    u32 match_generation;
+    u32 tick;
+
+    GameState game_state;
+
+} ServerPacket;
+
+#define SERVER_PACKET_HEADER_SIZE (__builtin_offsetof(ServerPacket, game_state))
+
+// NOTE(leo): Each match gets its own cache lines, so the network thread writing the inputs
+// of a match doesn't slow down the worker simulating the one next to it.
+typedef struct __attribute__((aligned(64)))
+{
+    // NOTE(leo): Written by the network thread, read by the workers and the scheduler.
+    b32          is_active;
+    u32          generation;
+    NetplayInput inputs[2];
+    u64          last_input_ticks[2];
+
+    // NOTE(leo): Only written while the match isn't active.
+    u32                client_ids[2];
+    struct sockaddr_in client_addresses[2];
+
+    // NOTE(leo): Only touched by the worker simulating the match.
+    GameState game_state;
+    u32       tick;
+
+} ServerMatch;
+
+typedef struct
+{
+    pthread_t thread;
+
+    ServerPacket   packets[SERVER_BATCH_SIZE];
+    struct iovec   iovecs[SERVER_BATCH_SIZE];
+    struct mmsghdr messages[SERVER_BATCH_SIZE];
+    u32            messages_count;
+
+    // NOTE(leo): Read by the scheduler after every tick.
+    u64 match_ticks;
+    u64 match_ticks_nanoseconds;
+    u64 worst_chunk_nanoseconds_per_match;
+    u64 packets_sent;
+    u64 packets_dropped;
+
+} ServerWorker;
+
+GLOBAL struct
+{
+    int socket_descriptor;
+
+    ServerMatch *matches;
+    u32          max_matches;
+
+    // NOTE(leo): Slots that were ever used. The network thread bumps it, the scheduler
+    // reads it.
+    u32 matches_count;
+
+    // NOTE(leo): Slots of expired matches, pushed by the scheduler and popped by the network
+    // thread.
+    pthread_mutex_t free_list_mutex;
+    u32            *free_list;
+    u32             free_list_count;
+
+    pthread_mutex_t tick_mutex;
+    pthread_cond_t  tick_started;
+    pthread_cond_t  tick_finished;
+    u64             tick;
+    u32             chunks_count;
+    u32             next_chunk;
+    u32             workers_done;
+
+    ServerWorker *workers;
+    u32           workers_count;
+
+    // NOTE(leo): Only touched by the network thread.
+    b32                has_waiting_client;
+    u32                waiting_client_id;
+    struct sockaddr_in waiting_client_address;
+    u64                packets_received;
+    u64                packets_rejected;
+    u64                matches_started;
+
+} g_server;
+
+// ===========================================================================================
+
+INTERNAL u64
+server_get_thread_cpu_nanoseconds(void)
+{
+    struct timespec time_spec;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time_spec);
+
+    return ((u64)time_spec.tv_sec * NANOSECONDS_PER_SECOND) + (u64)time_spec.tv_nsec;
+}
+
+INTERNAL void
+server_set_socket_buffers(int socket_descriptor)
+{
+    int buffer_size = SERVER_SOCKET_BUFFER_SIZE;
+
+    // NOTE(leo): The kernel may cap these (net.core.rmem_max), which only means more drops
+    // under heavy load.
+    setsockopt(socket_descriptor, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+    setsockopt(socket_descriptor, SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
+}
+
+INTERNAL void
+server_start_match(u32 client_ids[2], struct sockaddr_in client_addresses[2])
+{
+    u32 match_index = U32_MAX;
+
+    pthread_mutex_lock(&g_server.free_list_mutex);
+    if(g_server.free_list_count)
+    {
+        match_index = g_server.free_list[--g_server.free_list_count];
+    }
+    pthread_mutex_unlock(&g_server.free_list_mutex);
+
+    if(match_index == U32_MAX)
+    {
+        u32 matches_count = __atomic_load_n(&g_server.matches_count, __ATOMIC_RELAXED);
+
+        if(matches_count == g_server.max_matches)
+        {
+            // NOTE(leo): Full. The clients will time out waiting for their first state.
+            return;
+        }
+
+        match_index = matches_count;
+    }
+
+    ServerMatch *match = &g_server.matches[match_index];
+    u64          tick  = __atomic_load_n(&g_server.tick, __ATOMIC_RELAXED);
+
+    ASSERT(!match->is_active);
+
+    match->generation++;
+    match->inputs[0]           = 0;
+    match->inputs[1]           = 0;
+    match->last_input_ticks[0] = tick;
+    match->last_input_ticks[1] = tick;
+    match->tick                = 0;
+
+    for(u32 player = 0; player < 2; ++player)
+    {
+        match->client_ids[player]       = client_ids[player];
+        match->client_addresses[player] = client_addresses[player];
+    }
+
+    game_main(&match->game_state, __rdtsc() ^ match_index, (u64)match);
+
+    // NOTE(leo): Everything above must be visible to the workers before they see the match
+    // as active.
+    __atomic_store_n(&match->is_active, true, __ATOMIC_RELEASE);
+
+    if(match_index == g_server.matches_count)
+    {
+        __atomic_store_n(&g_server.matches_count, match_index + 1, __ATOMIC_RELEASE);
+    }
+
+    g_server.matches_started++;
+}
+
+INTERNAL void
+server_receive_packet(ServerPacket *packet, u32 size, struct sockaddr_in *from)
+{
+    if(size < SERVER_PACKET_HEADER_SIZE || packet->magic != SERVER_MAGIC)
+    {
+        g_server.packets_rejected++;
+        return;
+    }
+
+    g_server.packets_received++;
+
+    if(packet->type == SERVER_PACKET_JOIN)
+    {
+        // NOTE(leo): First come, first served. Two clients waiting make a match.
+        if(!g_server.has_waiting_client)
+        {
+            g_server.has_waiting_client     = true;
+            g_server.waiting_client_id      = packet->client_id;
+            g_server.waiting_client_address = *from;
+        }
+        else if(g_server.waiting_client_id != packet->client_id)
+        {
+            u32                client_ids[2]       = {g_server.waiting_client_id,
+                                                      packet->client_id};
+            struct sockaddr_in client_addresses[2] = {g_server.waiting_client_address, *from};
+
+            server_start_match(client_ids, client_addresses);
+            g_server.has_waiting_client = false;
+        }
+    }
+    else if(packet->type == SERVER_PACKET_INPUT)
+    {
+        if(packet->match_index >= g_server.max_matches || packet->player > 1)
+        {
+            g_server.packets_rejected++;
+            return;
+        }
+
+        ServerMatch *match = &g_server.matches[packet->match_index];
+
+        if(!__atomic_load_n(&match->is_active, __ATOMIC_ACQUIRE)
+           || match->generation != packet->match_generation
+           || match->client_ids[packet->player] != packet->client_id)
+        {
+            g_server.packets_rejected++;
+            return;
+        }
+
+        __atomic_store_n(&match->inputs[packet->player], packet->input, __ATOMIC_RELAXED);
+        __atomic_store_n(&match->last_input_ticks[packet->player],
+                         __atomic_load_n(&g_server.tick, __ATOMIC_RELAXED),
+                         __ATOMIC_RELAXED);
+    }
+    else
+    {
+        g_server.packets_rejected++;
+    }
+}
+
+INTERNAL void *
+server_network_thread(void *parameter)
+{
+    (void)parameter;
+
+    int epoll_descriptor = epoll_create1(0);
+
+    struct epoll_event event = {0};
+    event.events             = EPOLLIN;
+    event.data.fd            = g_server.socket_descriptor;
+
+    if(epoll_descriptor < 0
+       || epoll_ctl(epoll_descriptor, EPOLL_CTL_ADD, g_server.socket_descriptor, &event) != 0)
+    {
+        LINUX_ERROR_LITERAL("Failed to set up epoll for the server socket.");
+    }
+
+    PERSISTENT ServerPacket       packets[SERVER_BATCH_SIZE];
+    PERSISTENT struct sockaddr_in addresses[SERVER_BATCH_SIZE];
+    PERSISTENT struct iovec       iovecs[SERVER_BATCH_SIZE];
+    PERSISTENT struct mmsghdr     messages[SERVER_BATCH_SIZE];
+
+    for(u32 i = 0; i < SERVER_BATCH_SIZE; ++i)
+    {
+        iovecs[i].iov_base = &packets[i];
+        iovecs[i].iov_len  = sizeof(packets[i]);
+
+        messages[i].msg_hdr.msg_name   = &addresses[i];
+        messages[i].msg_hdr.msg_iov    = &iovecs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    for(;;)
+    {
+        struct epoll_event ready_event;
+
+        if(epoll_wait(epoll_descriptor, &ready_event, 1, -1) <= 0)
+        {
+            continue;
+        }
+
+        for(;;)
+        {
+            for(u32 i = 0; i < SERVER_BATCH_SIZE; ++i)
+            {
+                messages[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+            }
+
+            int received_count = recvmmsg(g_server.socket_descriptor,
+                                          messages,
+                                          SERVER_BATCH_SIZE,
+                                          MSG_DONTWAIT,
+                                          NULL);
+
+            if(received_count <= 0)
+            {
+                break;
+            }
+
+            for(int i = 0; i < received_count; ++i)
+            {
+                server_receive_packet(&packets[i], messages[i].msg_len, &addresses[i]);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+INTERNAL void
+server_flush_states(ServerWorker *worker)
+{
+    u32 sent_count = 0;
+
+    while(sent_count < worker->messages_count)
+    {
+        int sent = sendmmsg(g_server.socket_descriptor,
+                            worker->messages + sent_count,
+                            worker->messages_count - sent_count,
+                            MSG_DONTWAIT);
+
+        if(sent <= 0)
+        {
+            // NOTE(leo): The send buffer is full. The state of the next tick replaces this
+            // one anyway, so it's dropped instead of waiting.
+            worker->packets_dropped += worker->messages_count - sent_count;
+            break;
+        }
+
+        sent_count += (u32)sent;
+    }
+
+    worker->packets_sent += sent_count;
+    worker->messages_count = 0;
+}
+
+INTERNAL void
+server_queue_state(ServerWorker *worker, ServerMatch *match, u32 match_index, u32 player)
+{
+    u32           message_index = worker->messages_count++;
+    ServerPacket *packet        = &worker->packets[message_index];
+
+    packet->magic            = SERVER_MAGIC;
+    packet->type             = SERVER_PACKET_STATE;
+    packet->player           = (u8)player;
+    packet->input            = 0;
+    packet->padding          = 0;
+    packet->client_id        = match->client_ids[player];
+    packet->match_index      = match_index;
+    packet->match_generation = match->generation;
+    packet->tick             = match->tick;
+    packet->game_state       = match->game_state;
+
+    struct msghdr *header = &worker->messages[message_index].msg_hdr;
+    header->msg_name      = &match->client_addresses[player];
+    header->msg_namelen   = sizeof(match->client_addresses[player]);
+
+    if(worker->messages_count == SERVER_BATCH_SIZE)
+    {
+        server_flush_states(worker);
+    }
+}
+
+INTERNAL void
+server_tick_chunk(ServerWorker *worker, u32 chunk)
+{
+    u32 first_match = chunk * SERVER_MATCHES_PER_CHUNK;
+    u32 end_match   = first_match + SERVER_MATCHES_PER_CHUNK;
+    u32 ticked      = 0;
+
+    u32 matches_count = __atomic_load_n(&g_server.matches_count, __ATOMIC_ACQUIRE);
+
+    if(end_match > matches_count)
+    {
+        end_match = matches_count;
+    }
+
+    u64 begin_nanoseconds = server_get_thread_cpu_nanoseconds();
+
+    for(u32 match_index = first_match; match_index < end_match; ++match_index)
+    {
+        ServerMatch *match = &g_server.matches[match_index];
+
+        if(!__atomic_load_n(&match->is_active, __ATOMIC_ACQUIRE))
+        {
+            continue;
+        }
+
+        GameInput input =
+            netplay_game_input(__atomic_load_n(&match->inputs[0], __ATOMIC_RELAXED),
+                               __atomic_load_n(&match->inputs[1], __ATOMIC_RELAXED));
+
+        game_update(&match->game_state, &input, NETPLAY_TICK_SECONDS);
+        match->tick++;
+
+        server_queue_state(worker, match, match_index, 0);
+        server_queue_state(worker, match, match_index, 1);
+
+        ticked++;
+    }
+
+    if(ticked)
+    {
+        u64 nanoseconds           = server_get_thread_cpu_nanoseconds() - begin_nanoseconds;
+        u64 nanoseconds_per_match = nanoseconds / ticked;
+
+        worker->match_ticks += ticked;
+        worker->match_ticks_nanoseconds += nanoseconds;
+
+        if(nanoseconds_per_match > worker->worst_chunk_nanoseconds_per_match)
+        {
+            worker->worst_chunk_nanoseconds_per_match = nanoseconds_per_match;
+        }
+    }
+}
+
+INTERNAL void *
+server_worker_thread(void *parameter)
+{
+    ServerWorker *worker    = parameter;
+    u64           last_tick = 0;
+
+    for(u32 i = 0; i < SERVER_BATCH_SIZE; ++i)
+    {
+        worker->iovecs[i].iov_base = &worker->packets[i];
+        worker->iovecs[i].iov_len  = sizeof(worker->packets[i]);
+
+        worker->messages[i].msg_hdr.msg_iov    = &worker->iovecs[i];
+        worker->messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    for(;;)
+    {
+        pthread_mutex_lock(&g_server.tick_mutex);
+
+        while(g_server.tick == last_tick)
+        {
+            pthread_cond_wait(&g_server.tick_started, &g_server.tick_mutex);
+        }
+
+        last_tick        = g_server.tick;
+        u32 chunks_count = g_server.chunks_count;
+
+        pthread_mutex_unlock(&g_server.tick_mutex);
+
+        for(;;)
+        {
+            u32 chunk = __atomic_fetch_add(&g_server.next_chunk, 1, __ATOMIC_RELAXED);
+
+            if(chunk >= chunks_count)
+            {
+                break;
+            }
+
+            server_tick_chunk(worker, chunk);
+        }
+
+        server_flush_states(worker);
+
+        pthread_mutex_lock(&g_server.tick_mutex);
+
+        if(++g_server.workers_done == g_server.workers_count)
+        {
+            pthread_cond_signal(&g_server.tick_finished);
+        }
+
+        pthread_mutex_unlock(&g_server.tick_mutex);
+    }
+
+    return NULL;
+}
+
+// NOTE(leo): Called between ticks, while no worker is running, so a match can't be expired
+// in the middle of its tick.
+INTERNAL u32
+server_expire_matches(u64 tick)
+{
+    u32 expired_count = 0;
+    u32 matches_count = __atomic_load_n(&g_server.matches_count, __ATOMIC_ACQUIRE);
+
+    for(u32 match_index = 0; match_index < matches_count; ++match_index)
+    {
+        ServerMatch *match = &g_server.matches[match_index];
+
+        if(!__atomic_load_n(&match->is_active, __ATOMIC_ACQUIRE))
+        {
+            continue;
+        }
+
+        u64 last_input_tick_0 =
+            __atomic_load_n(&match->last_input_ticks[0], __ATOMIC_RELAXED);
+        u64 last_input_tick_1 =
+            __atomic_load_n(&match->last_input_ticks[1], __ATOMIC_RELAXED);
+
+        // NOTE(leo): Either player leaving ends the match.
+        if(tick - last_input_tick_0 > SERVER_MATCH_TIMEOUT_TICKS
+           || tick - last_input_tick_1 > SERVER_MATCH_TIMEOUT_TICKS)
+        {
+            __atomic_store_n(&match->is_active, false, __ATOMIC_RELEASE);
+
+            pthread_mutex_lock(&g_server.free_list_mutex);
+            g_server.free_list[g_server.free_list_count++] = match_index;
+            pthread_mutex_unlock(&g_server.free_list_mutex);
+
+            expired_count++;
+        }
+    }
+
+    return expired_count;
+}
+
+INTERNAL int
+server_run(u16 port, u32 workers_count, u32 max_matches, u32 seconds_to_run)
+{
+    UdpSocket udp_socket;
+
+    if(!os_udp_open(&udp_socket, port))
+    {
+        LINUX_ERROR_LITERAL("Failed to open UDP port %u32.", (u32)port);
+    }
+
+    g_server.socket_descriptor = (int)udp_socket.handle;
+    server_set_socket_buffers(g_server.socket_descriptor);
+
+    g_server.max_matches = max_matches;
+    g_server.matches     = aligned_alloc(64, max_matches * sizeof(ServerMatch));
+    g_server.free_list   = malloc(max_matches * sizeof(u32));
+    g_server.workers     = aligned_alloc(64, workers_count * sizeof(ServerWorker));
+
+    if(!g_server.matches || !g_server.free_list || !g_server.workers)
+    {
+        LINUX_ERROR_LITERAL("Failed to allocate room for %u32 matches.", max_matches);
+    }
+
+    memset(g_server.matches, 0, max_matches * sizeof(ServerMatch));
+    memset(g_server.workers, 0, workers_count * sizeof(ServerWorker));
+
+    pthread_mutex_init(&g_server.free_list_mutex, NULL);
+    pthread_mutex_init(&g_server.tick_mutex, NULL);
+    pthread_cond_init(&g_server.tick_started, NULL);
+    pthread_cond_init(&g_server.tick_finished, NULL);
+
+    g_server.workers_count = workers_count;
+
+    for(u32 i = 0; i < workers_count; ++i)
+    {
+        if(pthread_create(&g_server.workers[i].thread,
+                          NULL,
+                          server_worker_thread,
+                          &g_server.workers[i])
+           != 0)
+        {
+            LINUX_ERROR_LITERAL("Failed to create worker thread %u32.", i);
+        }
+    }
+
+    pthread_t network_thread;
+    if(pthread_create(&network_thread, NULL, server_network_thread, NULL) != 0)
+    {
+        LINUX_ERROR_LITERAL("Failed to create the network thread.");
+    }
+
+    OS_PRINTF_LITERAL("Serving on UDP port %u32 with %u32 workers, up to %u32 matches.\n",
+                      (u32)udp_socket.port,
+                      workers_count,
+                      max_matches);
+
+    s64 tick_duration        = NANOSECONDS_PER_SECOND / NETPLAY_TICKS_PER_SECOND;
+    s64 next_tick_time       = linux_get_cpu_tick();
+    u64 ticks_to_run         = (u64)seconds_to_run * NETPLAY_TICKS_PER_SECOND;
+    s64 worst_tick_time      = 0;
+    s64 total_tick_time      = 0;
+    u32 overruns             = 0;
+    u32 matches_expired      = 0;
+    u64 last_report_sent     = 0;
+    u64 last_report_dropped  = 0;
+    u64 last_report_received = 0;
+
+    for(u64 tick = 1; !ticks_to_run || tick <= ticks_to_run; ++tick)
+    {
+        linux_sleep_until(next_tick_time);
+
+        s64 tick_begin_time = linux_get_cpu_tick();
+
+        if(tick % NETPLAY_TICKS_PER_SECOND == 0)
+        {
+            matches_expired += server_expire_matches(tick);
+        }
+
+        u32 matches_count = __atomic_load_n(&g_server.matches_count, __ATOMIC_ACQUIRE);
+
+        pthread_mutex_lock(&g_server.tick_mutex);
+
+        __atomic_store_n(&g_server.tick, tick, __ATOMIC_RELAXED);
+        g_server.chunks_count =
+            (matches_count + SERVER_MATCHES_PER_CHUNK - 1) / SERVER_MATCHES_PER_CHUNK;
+        g_server.next_chunk   = 0;
+        g_server.workers_done = 0;
+
+        pthread_cond_broadcast(&g_server.tick_started);
+
+        while(g_server.workers_done < g_server.workers_count)
+        {
+            pthread_cond_wait(&g_server.tick_finished, &g_server.tick_mutex);
+        }
+
+        pthread_mutex_unlock(&g_server.tick_mutex);
+
+        s64 tick_time = linux_get_cpu_tick() - tick_begin_time;
+        total_tick_time += tick_time;
+
+        if(tick_time > worst_tick_time)
+        {
+            worst_tick_time = tick_time;
+        }
+
+        next_tick_time += tick_duration;
+
+        // NOTE(leo): An overrun pushes the schedule instead of running late ticks back to
+        // back, the clients would rather see a hitch than a burst.
+        if(linux_get_cpu_tick() > next_tick_time)
+        {
+            next_tick_time = linux_get_cpu_tick();
+            overruns++;
+        }
+
+        if(tick % SERVER_REPORT_INTERVAL_TICKS == 0)
+        {
+            u64 match_ticks             = 0;
+            u64 match_ticks_nanoseconds = 0;
+            u64 worst_nanoseconds       = 0;
+            u64 packets_sent            = 0;
+            u64 packets_dropped         = 0;
+
+            for(u32 i = 0; i < workers_count; ++i)
+            {
+                ServerWorker *worker = &g_server.workers[i];
+
+                match_ticks += worker->match_ticks;
+                match_ticks_nanoseconds += worker->match_ticks_nanoseconds;
+                packets_sent += worker->packets_sent;
+                packets_dropped += worker->packets_dropped;
+
+                if(worker->worst_chunk_nanoseconds_per_match > worst_nanoseconds)
+                {
+                    worst_nanoseconds = worker->worst_chunk_nanoseconds_per_match;
+                }
+
+                worker->match_ticks                       = 0;
+                worker->match_ticks_nanoseconds           = 0;
+                worker->worst_chunk_nanoseconds_per_match = 0;
+            }
+
+            u64 packets_received =
+                __atomic_load_n(&g_server.packets_received, __ATOMIC_RELAXED);
+
+            OS_PRINTF_LITERAL(
+                "Tick %u64: %u64 match ticks, %.3f us of CPU per match per tick (worst chunk "
+                "%.3f us), tick took %.3f ms on average and %.3f ms at worst (budget %.3f "
+                "ms), %u32 overruns, %u32 matches expired, %u64 states sent, %u64 dropped, "
+                "%u64 packets received\n",
+                tick,
+                match_ticks,
+                match_ticks ? (f64)match_ticks_nanoseconds / (f64)match_ticks / 1000.0 : 0.0,
+                (f64)worst_nanoseconds / 1000.0,
+                (f64)total_tick_time / SERVER_REPORT_INTERVAL_TICKS / 1000000.0,
+                (f64)worst_tick_time / 1000000.0,
+                (f64)tick_duration / 1000000.0,
+                overruns,
+                matches_expired,
+                packets_sent - last_report_sent,
+                packets_dropped - last_report_dropped,
+                packets_received - last_report_received);
+
+            last_report_sent     = packets_sent;
+            last_report_dropped  = packets_dropped;
+            last_report_received = packets_received;
+            worst_tick_time      = 0;
+            total_tick_time      = 0;
+            overruns             = 0;
+            matches_expired      = 0;
+        }
+    }
+
+    return 0;
+}
+
+// ===========================================================================================
+
+typedef struct
+{
+    u32 match_index;
+    u32 match_generation;
+    u8  player;
+    b32 is_in_match;
+    u32 last_tick;
+
+    NetplayInput held_input;
+
+} LoadClient;
+
+// NOTE(leo): Plays the given number of matches against a server on localhost, two clients per
+// match, all from one socket. Every client sends its input every tick and checks that it gets
+// the state of every tick back.
+INTERNAL int
+server_run_load(u16 port, u32 matches_to_play, u32 seconds_to_run)
+{
+    u32 clients_count = matches_to_play * 2;
+
+    LoadClient *clients = calloc(clients_count, sizeof(LoadClient));
+
+    if(!clients)
+    {
+        LINUX_ERROR_LITERAL("Failed to allocate %u32 clients.", clients_count);
+    }
+
+    UdpSocket udp_socket;
+
+    if(!os_udp_open(&udp_socket, 0))
+    {
+        LINUX_ERROR_LITERAL("Failed to open a UDP socket.");
+    }
+
+    int socket_descriptor = (int)udp_socket.handle;
+    server_set_socket_buffers(socket_descriptor);
+
+    pcg32_random_t input_rng;
+    pcg32_srandom_r(&input_rng, __rdtsc(), (u64)clients);
+
+    // NOTE(leo): Random, so that several load generators can share a server.
+    u32 client_id_base = pcg32_random_r(&input_rng) & 0x7FFFFFFF;
+
+    struct sockaddr_in server_address = {0};
+    server_address.sin_family         = AF_INET;
+    server_address.sin_addr.s_addr    = htonl(LOOPBACK_IPV4);
+    server_address.sin_port           = htons(port);
+
+    PERSISTENT ServerPacket   packets[SERVER_BATCH_SIZE];
+    PERSISTENT struct iovec   iovecs[SERVER_BATCH_SIZE];
+    PERSISTENT struct mmsghdr messages[SERVER_BATCH_SIZE];
+
+    u64 states_received = 0;
+    u64 states_missed   = 0;
+    u64 inputs_sent     = 0;
+
+    s64 tick_duration  = NANOSECONDS_PER_SECOND / NETPLAY_TICKS_PER_SECOND;
+    s64 next_tick_time = linux_get_cpu_tick();
+    u32 ticks_to_run   = seconds_to_run * NETPLAY_TICKS_PER_SECOND;
+
+    for(u32 tick = 0; tick <= ticks_to_run; ++tick)
+    {
+        // NOTE(leo): Receiving.
+        for(;;)
+        {
+            for(u32 i = 0; i < SERVER_BATCH_SIZE; ++i)
+            {
+                iovecs[i].iov_base = &packets[i];
+                iovecs[i].iov_len  = sizeof(packets[i]);
+
+                memset(&messages[i].msg_hdr, 0, sizeof(messages[i].msg_hdr));
+                messages[i].msg_hdr.msg_iov    = &iovecs[i];
+                messages[i].msg_hdr.msg_iovlen = 1;
+            }
+
+            int received_count =
+                recvmmsg(socket_descriptor, messages, SERVER_BATCH_SIZE, MSG_DONTWAIT, NULL);
+
+            if(received_count <= 0)
+            {
+                break;
+            }
+
+            for(int i = 0; i < received_count; ++i)
+            {
+                ServerPacket *packet       = &packets[i];
+                u32           client_index = packet->client_id - client_id_base;
+
+                if(messages[i].msg_len != sizeof(ServerPacket)
+                   || packet->magic != SERVER_MAGIC
+                   || packet->type != SERVER_PACKET_STATE
+                   || client_index >= clients_count)
+                {
+                    continue;
+                }
+
+                LoadClient *client = &clients[client_index];
+
+                if(!client->is_in_match)
+                {
+                    client->is_in_match      = true;
+                    client->match_index      = packet->match_index;
+                    client->match_generation = packet->match_generation;
+                    client->player           = packet->player;
+                }
+                else if(packet->tick > client->last_tick + 1)
+                {
+                    states_missed += packet->tick - client->last_tick - 1;
+                }
+
+                if(packet->tick > client->last_tick)
+                {
+                    client->last_tick = packet->tick;
+                }
+
+                states_received++;
+            }
+        }
+
+        // NOTE(leo): Sending. Joins on the first tick, inputs after that.
+        u32 messages_count = 0;
+
+        for(u32 client_index = 0; client_index < clients_count; ++client_index)
+        {
+            LoadClient *client = &clients[client_index];
+
+            if(tick > 0 && !client->is_in_match)
+            {
+                continue;
+            }
+
+            ServerPacket *packet = &packets[messages_count];
+            memset(packet, 0, SERVER_PACKET_HEADER_SIZE);
+
+            packet->magic     = SERVER_MAGIC;
+            packet->client_id = client_id_base + client_index;
+
+            if(tick == 0)
+            {
+                packet->type = SERVER_PACKET_JOIN;
+            }
+            else
+            {
+                if(pcg32_boundedrand_r(&input_rng, 20) == 0)
+                {
+                    NetplayInput directions[] = {0, NETPLAY_INPUT_UP, NETPLAY_INPUT_DOWN};
+                    client->held_input = directions[pcg32_boundedrand_r(&input_rng, 3)];
+                }
+
+                packet->type             = SERVER_PACKET_INPUT;
+                packet->player           = client->player;
+                packet->match_index      = client->match_index;
+                packet->match_generation = client->match_generation;
+                packet->input            = client->held_input;
+
+                if(pcg32_boundedrand_r(&input_rng, 120) == 0)
+                {
+                    packet->input |= NETPLAY_INPUT_ENTER;
+                }
+            }
+
+            iovecs[messages_count].iov_base = packet;
+            iovecs[messages_count].iov_len  = SERVER_PACKET_HEADER_SIZE;
+
+            memset(&messages[messages_count].msg_hdr, 0, sizeof(struct msghdr));
+            messages[messages_count].msg_hdr.msg_name    = &server_address;
+            messages[messages_count].msg_hdr.msg_namelen = sizeof(server_address);
+            messages[messages_count].msg_hdr.msg_iov     = &iovecs[messages_count];
+            messages[messages_count].msg_hdr.msg_iovlen  = 1;
+
+            messages_count++;
+
+            if(messages_count == SERVER_BATCH_SIZE || client_index == clients_count - 1)
+            {
+                int sent = sendmmsg(socket_descriptor, messages, messages_count, 0);
+                inputs_sent += sent > 0 ? (u64)sent : 0;
+                messages_count = 0;
+            }
+        }
+
+        if(messages_count)
+        {
+            int sent = sendmmsg(socket_descriptor, messages, messages_count, 0);
+            inputs_sent += sent > 0 ? (u64)sent : 0;
+        }
+
+        if(tick && tick % NETPLAY_TICKS_PER_SECOND == 0)
+        {
+            u32 clients_in_matches = 0;
+
+            for(u32 i = 0; i < clients_count; ++i)
+            {
+                clients_in_matches += clients[i].is_in_match ? 1 : 0;
+            }
+
+            OS_PRINTF_LITERAL("Second %u32: %u32 of %u32 clients in matches, %u64 states "
+                              "received, %u64 missed, %u64 packets sent\n",
+                              tick / NETPLAY_TICKS_PER_SECOND,
+                              clients_in_matches,
+                              clients_count,
+                              states_received,
+                              states_missed,
+                              inputs_sent);
+        }
+
+        next_tick_time += tick_duration;
+        linux_sleep_until(next_tick_time);
+    }
+
+    u32 clients_in_matches = 0;
+
+    for(u32 i = 0; i < clients_count; ++i)
+    {
+        clients_in_matches += clients[i].is_in_match ? 1 : 0;
+    }
+
+    f64 missed_ratio = (f64)states_missed / (f64)(states_received + states_missed + 1);
+
+    OS_PRINTF_LITERAL("Load: %u32 of %u32 clients got a match, %u64 states received, "
+                      "%.3f%% missed\n",
+                      clients_in_matches,
+                      clients_count,
+                      states_received,
+                      missed_ratio * 100.0);
+
+    return clients_in_matches == clients_count ? 0 : 1;
+}
+
+// ===========================================================================================
+
+INTERNAL void
+server_print_usage(void)
+{
+    OS_PRINT_LITERAL("Usage: pong_server <mode> [arguments]\n"
+                     "Modes:\n"
+                     "  --serve <port> [workers] [max matches] [seconds]\n"
+                     "                              Hosts matches, forever if seconds is 0.\n"
+                     "  --load <port> <matches> [seconds]\n"
+                     "                              Plays matches against a local server.\n");
+}
+
+int
+main(int argc, char **argv)
+{
+    g_cpu_ticks_per_second = (f32)NANOSECONDS_PER_SECOND;
+
+    int exit_code = 0;
+
+    if(argc >= 3 && strcmp(argv[1], "--serve") == 0)
+    {
+        long processors_count = sysconf(_SC_NPROCESSORS_ONLN);
+
+        // NOTE(leo): One core is left for the network thread and the scheduler.
+        u32 default_workers = processors_count > 1 ? (u32)processors_count - 1 : 1;
+
+        u16 port          = (u16)strtoul(argv[2], NULL, 10);
+        u32 workers_count = argc >= 4 ? (u32)strtoul(argv[3], NULL, 10) : default_workers;
+        u32 max_matches =
+            argc >= 5 ? (u32)strtoul(argv[4], NULL, 10) : SERVER_DEFAULT_MAX_MATCHES;
+        u32 seconds_to_run = argc >= 6 ? (u32)strtoul(argv[5], NULL, 10) : 0;
+
+        if(!workers_count || !max_matches)
+        {
+            server_print_usage();
+            return 1;
+        }
+
+        exit_code = server_run(port, workers_count, max_matches, seconds_to_run);
+    }
+    else if(argc >= 4 && strcmp(argv[1], "--load") == 0)
+    {
+        u16 port            = (u16)strtoul(argv[2], NULL, 10);
+        u32 matches_to_play = (u32)strtoul(argv[3], NULL, 10);
+        u32 seconds_to_run  = argc >= 5 ? (u32)strtoul(argv[4], NULL, 10) : 10;
+
+        exit_code = server_run_load(port, matches_to_play, seconds_to_run);
+    }
+    else
+    {
+        server_print_usage();
+        exit_code = 1;
+    }
+
+    return exit_code;
+}
@@ -0,0 +1,632 @@
+#ifndef __clang__
+// NOTE(leo): Same as the other platform layers, we are using Clang-only stuff.
+    #error This code should only be compiled with Clang.
+#endif // __clang__
+
+#ifndef __x86_64__
+    #error This code should only be compiled for x64.
+#endif // __x86_64__
+
+// ===========================================================================================
+
+// NOTE(leo): Tournament runner (<executable>_tournament). Every AI configuration plays every
+// other one on both sides, a number of rounds, in short matches to a target score. It's built
+// from the game core only, like the match server.
+//
+// Each match is one job of the job system (job_system.c), so matches of very different
+// lengths are balanced by its work stealing and every core stays busy until the end.
+//
+// Every match is seeded from the tournament seed and its index, and the results are stored
+// by index, so the outcome doesn't depend on how many workers played it or which one played
+// what.
+
+#define _GNU_SOURCE
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <x86intrin.h>
+
+#include "../game_core.c"
+#include "../ai.c"
+#include "../job_system.c"
+
+// ===========================================================================================
+
+#include "linux_os.c"
+#include "linux_common.c"
+
+#define TOURNAMENT_TICK_SECONDS (1.0f / 60.0f)
+
+#define TOURNAMENT_MAX_ENTRANTS 32
+#define TOURNAMENT_MAX_WORKERS  JOB_MAX_WORKERS
+
+// NOTE(leo): A match that takes longer than this is a draw. Two AIs that never miss would
+// otherwise never finish.
+#define TOURNAMENT_MAX_MATCH_TICKS (60 * 60 * 10)
+
+#define TOURNAMENT_DEFAULT_POINTS 5
+#define TOURNAMENT_DEFAULT_ROUNDS 50
+
+#define ELO_MEAN       1500.0
+#define ELO_ITERATIONS 200
+
+// ===========================================================================================
+
+typedef struct
+{
+    String8    name;
+    AiSettings settings;
+
+} Entrant;
+
+typedef struct
+{
+    u32 left_points;
+    u32 right_points;
+    u32 ticks;
+    u32 rallies;
+    u32 paddle_hits;
+
+} MatchResult;
+
+typedef struct
+{
+    f64 seconds;
+
+    JobWorkerStats stats;
+    u64            fewest_matches;
+    u64            most_matches;
+
+} TournamentRun;
+
+GLOBAL struct
+{
+    Entrant entrants[TOURNAMENT_MAX_ENTRANTS];
+    u32     entrants_count;
+
+    u32 points_to_win;
+    u32 rounds;
+    u64 seed;
+
+    u32          matches_count;
+    MatchResult *results;
+
+    b32 pin_workers;
+
+} g_tournament;
+
+// ===========================================================================================
+
+// NOTE(leo): Every round plays every ordered pair, so each pairing is played on both sides.
+INTERNAL void
+tournament_get_match_entrants(u32 match_index, u32 *left, u32 *right)
+{
+    u32 entrants_count = g_tournament.entrants_count;
+    u32 pairing        = match_index % (entrants_count * (entrants_count - 1));
+
+    *left  = pairing / (entrants_count - 1);
+    *right = pairing % (entrants_count - 1);
+
+    if(*right >= *left)
+    {
+        (*right)++;
+    }
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+
+INTERNAL void
+tournament_play_match(JobWorker *worker, void *data)
+
+#pragma clang diagnostic pop
+{
+    MatchResult *result      = data;
+    u32          match_index = (u32)(result - g_tournament.results);
+
+    u32 left;
+    u32 right;
+    tournament_get_match_entrants(match_index, &left, &right);
+
+    u64 rng_state    = g_tournament.seed;
+    u64 rng_sequence = match_index;
+
+    GameState game_state;
+    game_main(&game_state, rng_state, rng_sequence);
+
+    AiPlayer players[2];
+    ai_init_with_settings(&players[0],
+                          false,
+                          g_tournament.entrants[left].settings,
+                          rng_state,
+                          rng_sequence + 0x100000000);
+    ai_init_with_settings(&players[1],
+                          true,
+                          g_tournament.entrants[right].settings,
+                          rng_state,
+                          rng_sequence + 0x200000000);
+
+    memset(result, 0, sizeof(*result));
+
+    while(result->ticks < TOURNAMENT_MAX_MATCH_TICKS
+          && game_state.left_points < g_tournament.points_to_win
+          && game_state.right_points < g_tournament.points_to_win)
+    {
+        GameInput input = {0};
+
+        if(!game_state.match_started)
+        {
+            input.is_key_down[KEY_ENTER] = true;
+            result->rallies++;
+        }
+
+        ai_update(&players[0], &game_state, TOURNAMENT_TICK_SECONDS, &input);
+        ai_update(&players[1], &game_state, TOURNAMENT_TICK_SECONDS, &input);
+
+        game_update(&game_state, &input, TOURNAMENT_TICK_SECONDS);
+        result->ticks++;
+
+        if(game_state.collision_detected && game_state.sound_to_play == SOUND_PADDLE)
+        {
+            result->paddle_hits++;
+        }
+    }
+
+    result->left_points  = game_state.left_points;
+    result->right_points = game_state.right_points;
+}
+
+// NOTE(leo): Plays the whole tournament with the given number of workers, this thread being
+// the first one.
+INTERNAL TournamentRun
+tournament_run(u32 workers_count)
+{
+    JobSystemConfig config = {0};
+    config.workers_count   = workers_count;
+    config.pin_workers     = g_tournament.pin_workers;
+
+    JobSystem job_system;
+
+    if(!job_system_init(&job_system, &config))
+    {
+        LINUX_ERROR_LITERAL("Failed to start %u32 workers.", workers_count);
+    }
+
+    TournamentRun run = {0};
+
+    s64        begin_tick  = linux_get_cpu_tick();
+    JobWorker *main_worker = job_system_main_worker(&job_system);
+    JobCounter matches     = {0};
+
+    for(u32 i = 0; i < g_tournament.matches_count; ++i)
+    {
+        job_submit(main_worker, tournament_play_match, &g_tournament.results[i], &matches);
+    }
+
+    job_wait(main_worker, &matches);
+
+    run.seconds = (f64)(linux_get_cpu_tick() - begin_tick) / (f64)NANOSECONDS_PER_SECOND;
+    run.stats   = job_system_get_stats(&job_system);
+
+    run.fewest_matches = U64_MAX;
+
+    for(u32 i = 0; i < job_system.workers_count; ++i)
+    {
+        u64 matches_played = job_system.workers[i].stats.jobs_executed;
+
+        run.fewest_matches = MIN(run.fewest_matches, matches_played);
+        run.most_matches   = MAX(run.most_matches, matches_played);
+    }
+
+    job_system_shutdown(&job_system);
+
+    return run;
+}
+
+// NOTE(leo): To tell whether two runs with different numbers of workers played the same
+// matches.
+INTERNAL u32
+tournament_hash_results(void)
+{
+    u32 hash = 0;
+
+    for(u32 i = 0; i < g_tournament.matches_count; ++i)
+    {
+        MatchResult *result = &g_tournament.results[i];
+        hash = (hash * 31) + result->left_points;
+        hash = (hash * 31) + result->right_points;
+        hash = (hash * 31) + result->ticks;
+    }
+
+    return hash;
+}
+
+// NOTE(leo): Bradley-Terry ratings fitted to every result at once, on the Elo scale, so they
+// don't depend on the order the matches were played in like incremental Elo does. A draw is
+// half a win for each side. Every pairing starts with one virtual draw, otherwise an entrant
+// that never lost would have an infinite rating.
+INTERNAL void
+tournament_compute_elo(f64 *elo)
+{
+    u32 entrants_count = g_tournament.entrants_count;
+
+    f64 wins[TOURNAMENT_MAX_ENTRANTS]                           = {0};
+    f64 games[TOURNAMENT_MAX_ENTRANTS][TOURNAMENT_MAX_ENTRANTS] = {0};
+    f64 strength[TOURNAMENT_MAX_ENTRANTS];
+
+    for(u32 i = 0; i < entrants_count; ++i)
+    {
+        strength[i] = 1.0;
+
+        for(u32 j = 0; j < entrants_count; ++j)
+        {
+            if(i != j)
+            {
+                games[i][j] = 1.0;
+                wins[i] += 0.5;
+            }
+        }
+    }
+
+    for(u32 i = 0; i < g_tournament.matches_count; ++i)
+    {
+        MatchResult *result = &g_tournament.results[i];
+
+        u32 left;
+        u32 right;
+        tournament_get_match_entrants(i, &left, &right);
+
+        games[left][right] += 1.0;
+        games[right][left] += 1.0;
+
+        if(result->left_points > result->right_points)
+        {
+            wins[left] += 1.0;
+        }
+        else if(result->right_points > result->left_points)
+        {
+            wins[right] += 1.0;
+        }
+        else
+        {
+            wins[left] += 0.5;
+            wins[right] += 0.5;
+        }
+    }
+
+    for(u32 iteration = 0; iteration < ELO_ITERATIONS; ++iteration)
+    {
+        for(u32 i = 0; i < entrants_count; ++i)
+        {
+            f64 denominator = 0.0;
+
+            for(u32 j = 0; j < entrants_count; ++j)
+            {
+                if(i != j)
+                {
+                    denominator += games[i][j] / (strength[i] + strength[j]);
+                }
+            }
+
+            strength[i] = wins[i] / denominator;
+        }
+    }
+
+    f64 elo_sum = 0.0;
+
+    for(u32 i = 0; i < entrants_count; ++i)
+    {
+        elo[i] = 400.0 * __builtin_log10(strength[i]);
+        elo_sum += elo[i];
+    }
+
+    for(u32 i = 0; i < entrants_count; ++i)
+    {
+        elo[i] += ELO_MEAN - (elo_sum / (f64)entrants_count);
+    }
+}
+
+INTERNAL void
+tournament_print_standings(void)
+{
+    u32 entrants_count = g_tournament.entrants_count;
+
+    u32 played[TOURNAMENT_MAX_ENTRANTS]      = {0};
+    u32 won[TOURNAMENT_MAX_ENTRANTS]         = {0};
+    u32 drawn[TOURNAMENT_MAX_ENTRANTS]       = {0};
+    u64 rallies[TOURNAMENT_MAX_ENTRANTS]     = {0};
+    u64 paddle_hits[TOURNAMENT_MAX_ENTRANTS] = {0};
+
+    for(u32 i = 0; i < g_tournament.matches_count; ++i)
+    {
+        MatchResult *result = &g_tournament.results[i];
+
+        u32 left;
+        u32 right;
+        tournament_get_match_entrants(i, &left, &right);
+
+        u32 sides[2]  = {left, right};
+        u32 points[2] = {result->left_points, result->right_points};
+
+        for(u32 side = 0; side < 2; ++side)
+        {
+            u32 entrant = sides[side];
+
+            played[entrant]++;
+            rallies[entrant] += result->rallies;
+            paddle_hits[entrant] += result->paddle_hits;
+
+            if(points[side] > points[1 - side])
+            {
+                won[entrant]++;
+            }
+            else if(points[side] == points[1 - side])
+            {
+                drawn[entrant]++;
+            }
+        }
+    }
+
+    f64 elo[TOURNAMENT_MAX_ENTRANTS];
+    tournament_compute_elo(elo);
+
+    // NOTE(leo): Highest rating first. Selection sort, there are only a few entrants.
+    u32 order[TOURNAMENT_MAX_ENTRANTS];
+
+    for(u32 i = 0; i < entrants_count; ++i)
+    {
+        order[i] = i;
+    }
+
+    for(u32 i = 0; i < entrants_count; ++i)
+    {
+        for(u32 j = i + 1; j < entrants_count; ++j)
+        {
+            if(elo[order[j]] > elo[order[i]])
+            {
+                u32 swap = order[i];
+                order[i] = order[j];
+                order[j] = swap;
+            }
+        }
+    }
+
+    for(u32 i = 0; i < entrants_count; ++i)
+    {
+        u32 entrant = order[i];
+
+        OS_PRINTF_LITERAL("  %S: Elo %.0f, %.1f%% won, %u32 drawn, "
+                          "%.2f paddle hits per rally\n",
+                          &g_tournament.entrants[entrant].name,
+                          elo[entrant],
+                          100.0 * (f64)won[entrant] / (f64)played[entrant],
+                          drawn[entrant],
+                          (f64)paddle_hits[entrant] / (f64)MAX(rallies[entrant], 1));
+    }
+}
+
+// NOTE(leo): A difficulty name, or reaction ticks/noise/dead zone (10/0.16/0.02 is medium).
+INTERNAL b32
+tournament_parse_entrant(char *argument, Entrant *entrant)
+{
+    entrant->name = (String8) {argument, (u32)strlen(argument)};
+
+    AiDifficulty difficulty;
+
+    if(ai_difficulty_from_name(entrant->name, &difficulty))
+    {
+        entrant->settings = g_ai_settings[difficulty];
+        return true;
+    }
+
+    char *at       = argument;
+    u32   reaction = (u32)strtoul(at, &at, 10);
+
+    if(*at++ != '/')
+    {
+        return false;
+    }
+
+    f32 noise = strtof(at, &at);
+
+    if(*at++ != '/')
+    {
+        return false;
+    }
+
+    f32 dead_zone = strtof(at, &at);
+
+    if(*at || reaction >= AI_OBSERVATIONS_CAPACITY || noise < 0.0f || dead_zone < 0.0f)
+    {
+        return false;
+    }
+
+    entrant->settings.reaction_delay_ticks = reaction;
+    entrant->settings.prediction_noise     = noise;
+    entrant->settings.dead_zone            = dead_zone;
+
+    return true;
+}
+
+INTERNAL void
+tournament_print_usage(void)
+{
+    OS_PRINTF_LITERAL("Usage: pong_tournament [options] <AI> <AI> [AI...]\n"
+                      "AIs are easy, medium, hard or <reaction ticks>/<noise>/<dead zone>.\n"
+                      "Options:\n"
+                      "  --points <points>   Points to win a match (%u32).\n"
+                      "  --rounds <rounds>   Times each pairing is played on each side "
+                      "(%u32).\n"
+                      "  --workers <count>   Worker threads (one per core).\n"
+                      "  --scaling           Plays it again with 1, 2, 4... workers.\n"
+                      "  --pin               Pins each worker to its own core.\n"
+                      "  --seed <seed>       Seed of the whole tournament.\n",
+                      (u32)TOURNAMENT_DEFAULT_POINTS,
+                      (u32)TOURNAMENT_DEFAULT_ROUNDS);
+}
+
+int
+main(int argc, char **argv)
+{
+    g_cpu_ticks_per_second = (f32)NANOSECONDS_PER_SECOND;
+
+    u32 workers_count   = os_get_processors_count();
+    b32 measure_scaling = false;
+
+    g_tournament.points_to_win = TOURNAMENT_DEFAULT_POINTS;
+    g_tournament.rounds        = TOURNAMENT_DEFAULT_ROUNDS;
+    g_tournament.seed          = __rdtsc();
+
+    Entrant *entrants = g_tournament.entrants;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        b32 has_value = i + 1 < argc;
+
+        if(strcmp(argv[i], "--points") == 0 && has_value)
+        {
+            g_tournament.points_to_win = (u32)strtoul(argv[++i], NULL, 10);
+        }
+        else if(strcmp(argv[i], "--rounds") == 0 && has_value)
+        {
+            g_tournament.rounds = (u32)strtoul(argv[++i], NULL, 10);
+        }
+        else if(strcmp(argv[i], "--workers") == 0 && has_value)
+        {
+            workers_count = (u32)strtoul(argv[++i], NULL, 10);
+        }
+        else if(strcmp(argv[i], "--seed") == 0 && has_value)
+        {
+            g_tournament.seed = strtoull(argv[++i], NULL, 10);
+        }
+        else if(strcmp(argv[i], "--scaling") == 0)
+        {
+            measure_scaling = true;
+        }
+        else if(strcmp(argv[i], "--pin") == 0)
+        {
+            g_tournament.pin_workers = true;
+        }
+        else if(g_tournament.entrants_count < TOURNAMENT_MAX_ENTRANTS
+                && tournament_parse_entrant(argv[i], &entrants[g_tournament.entrants_count]))
+        {
+            g_tournament.entrants_count++;
+        }
+        else
+        {
+            tournament_print_usage();
+            return 1;
+        }
+    }
+
+    u32 entrants_count = g_tournament.entrants_count;
+
+    if(entrants_count < 2 || !g_tournament.points_to_win || !g_tournament.rounds
+       || !workers_count || workers_count > TOURNAMENT_MAX_WORKERS)
+    {
+        tournament_print_usage();
+        return 1;
+    }
+
+    u64 matches_count = (u64)g_tournament.rounds * entrants_count * (entrants_count - 1);
+
+    if(matches_count > U32_MAX)
+    {
+        LINUX_ERROR_LITERAL("Too many matches.");
+    }
+
+    g_tournament.matches_count = (u32)matches_count;
+    g_tournament.results       = malloc(matches_count * sizeof(MatchResult));
+
+    if(!g_tournament.results)
+    {
+        LINUX_ERROR_LITERAL("Failed to allocate %u64 matches.", matches_count);
+    }
+
+    OS_PRINTF_LITERAL("Tournament: %u32 AIs, %u32 rounds, %u32 matches to %u32 points, "
+                      "seed %u64\n",
+                      entrants_count,
+                      g_tournament.rounds,
+                      g_tournament.matches_count,
+                      g_tournament.points_to_win,
+                      g_tournament.seed);
+
+    TournamentRun run  = tournament_run(workers_count);
+    u32           hash = tournament_hash_results();
+
+    u64 ticks_simulated = 0;
+
+    for(u32 i = 0; i < g_tournament.matches_count; ++i)
+    {
+        ticks_simulated += g_tournament.results[i].ticks;
+    }
+
+    tournament_print_standings();
+
+    OS_PRINTF_LITERAL("%u32 workers: %.3f s, %.0f matches per second, %.0f ticks per second\n"
+                      "  %u64 to %u64 matches per worker, %u64 steals (%u64 lost races)\n",
+                      workers_count,
+                      run.seconds,
+                      (f64)g_tournament.matches_count / run.seconds,
+                      (f64)ticks_simulated / run.seconds,
+                      run.fewest_matches,
+                      run.most_matches,
+                      run.stats.jobs_stolen,
+                      run.stats.failed_steals);
+
+    if(measure_scaling)
+    {
+        // NOTE(leo): Efficiency is the speedup over one worker divided by the workers. The
+        // results must be the same on every run.
+        OS_PRINT_LITERAL("Scaling:\n");
+
+        f64 single_worker_rate = 0.0;
+        b32 is_deterministic   = true;
+
+        for(u32 count = 1;; count = MIN(count * 2, workers_count))
+        {
+            f64 rate = (f64)g_tournament.matches_count / tournament_run(count).seconds;
+
+            if(count == 1)
+            {
+                single_worker_rate = rate;
+            }
+
+            is_deterministic = is_deterministic && tournament_hash_results() == hash;
+
+            OS_PRINTF_LITERAL("  %u32 workers: %.0f matches per second, %.2fx, %.0f%% "
+                              "efficiency\n",
+                              count,
+                              rate,
+                              rate / single_worker_rate,
+                              100.0 * rate / (single_worker_rate * count));
+
+            if(count == workers_count)
+            {
+                break;
+            }
+        }
+
+        OS_PRINTF_LITERAL("  Results are %a on every run.\n",
+                          is_deterministic ? "the same" : "NOT the same");
+
+        if(!is_deterministic)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -1,13 +1,88 @@
+// NOTE(leo): The simulation does its math with real, which is f32 by default. Building with
+// FIXED_POINT_PHYSICS makes it Q16.16 fixed point instead: integer math gives the same bits
+// no matter the optimization level, the compiler or the CPU, so replays recorded with one
+// build reproduce on any other fixed point build. Everything outside the simulation (the
+// renderer, the AI) reads it through real_to_f32.
+#ifdef FIXED_POINT_PHYSICS
+
+typedef s32 real;
+
+    #define REAL_FRACTION_BITS 16
+    #define REAL_ONE           (1 << REAL_FRACTION_BITS)
+
+    // NOTE(leo): For constants only, it's folded at compile time.
+    #define REAL(literal)                                                                    \
+        ((real)(((literal) * (f32)REAL_ONE) + ((literal) >= 0.0f ? 0.5f : -0.5f)))
+
+#else
+
+typedef f32 real;
+
+    #define REAL(literal) (literal)
+
+#endif // FIXED_POINT_PHYSICS
+
 typedef struct
 {
-    f32 x, y;
+    real x, y;
 
 } v2;
 
-GLOBAL pcg32_random_t g_rng;
-
 // ===========================================================================================
 
+INTERNAL real
+real_multiply(real a, real b)
+{
+#ifdef FIXED_POINT_PHYSICS
+    return (real)(((s64)a * (s64)b) >> REAL_FRACTION_BITS);
+#else
+    return a * b;
+#endif // FIXED_POINT_PHYSICS
+}
+
+INTERNAL real
+real_divide(real a, real b)
+{
+#ifdef FIXED_POINT_PHYSICS
+    return (real)(((s64)a * REAL_ONE) / b);
+#else
+    return a / b;
+#endif // FIXED_POINT_PHYSICS
+}
+
+// NOTE(leo): Rounds to the closest, so the same f32 (a delta time read from a replay, for
+// example) always gives the same real.
+INTERNAL real
+real_from_f32(f32 value)
+{
+#ifdef FIXED_POINT_PHYSICS
+    f32 scaled = value * (f32)REAL_ONE;
+    return (real)(scaled + (scaled >= 0.0f ? 0.5f : -0.5f));
+#else
+    return value;
+#endif // FIXED_POINT_PHYSICS
+}
+
+INTERNAL f32
+real_to_f32(real value)
+{
+#ifdef FIXED_POINT_PHYSICS
+    return (f32)value / (f32)REAL_ONE;
+#else
+    return value;
+#endif // FIXED_POINT_PHYSICS
+}
+
+// NOTE(leo): The bits of a real, for hashing and comparing states.
+INTERNAL u32
+real_bits(real value)
+{
+    u32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    return bits;
+}
+
 INTERNAL v2
 v2_add(v2 a, v2 b)
 {
@@ -18,11 +93,11 @@ v2_add(v2 a, v2 b)
 }
 
 INTERNAL v2
-v2_scalar_multiply(v2 v, f32 scalar)
+v2_scalar_multiply(v2 v, real scalar)
 {
     v2 result;
-    result.x = v.x * scalar;
-    result.y = v.y * scalar;
+    result.x = real_multiply(v.x, scalar);
+    result.y = real_multiply(v.y, scalar);
     return result;
 }
 
@@ -73,7 +148,19 @@ ldexp(f64 x, s32 exp)
 }
 
 INTERNAL f32
-random_f32_0_1(void)
+random_f32_0_1(pcg32_random_t *rng)
+{
+    return (f32)ldexp(pcg32_random_r(rng), -32);
+}
+
+// NOTE(leo): Consumes one number from the generator in both builds, so the random sequence
+// of a match doesn't depend on the physics.
+INTERNAL real
+random_real_0_1(pcg32_random_t *rng)
 {
-    return (f32)ldexp(pcg32_random_r(&g_rng), -32);
+#ifdef FIXED_POINT_PHYSICS
+    return (real)(pcg32_random_r(rng) >> (32 - REAL_FRACTION_BITS));
+#else
+    return random_f32_0_1(rng);
+#endif // FIXED_POINT_PHYSICS
 }
@@ -0,0 +1,603 @@
+// NOTE(leo): GGPO style rollback netcode, for two players on two machines, each one owning a
+// paddle. The match runs at a fixed tick. Instead of waiting for the remote input of a tick
+// like lockstep would (a full round trip of input delay), we predict it by repeating the last
+// remote input we know of and simulate ahead. When a remote input arrives and it's not what
+// we predicted, the state of the mispredicted tick is restored from the snapshot ring and
+// every tick since then is simulated again with the corrected inputs, in the same frame.
+//
+// Every packet carries all the local inputs the other side hasn't acknowledged yet, so a lost
+// packet costs nothing as long as a later one arrives. If the other side falls too far behind
+// (or stops answering) we stall instead of predicting further, so a rollback never has to
+// re-simulate more than NETPLAY_MAX_PREDICTION_TICKS ticks.
+//
+// Every packet also carries the running checksum (see game_state_checksum) of the newest
+// tick the sender has both inputs of, so a desync is noticed a round trip after it happens
+// instead of when the players see different matches.
+
+#define NETPLAY_TICKS_PER_SECOND 60
+#define NETPLAY_TICK_SECONDS     (1.0f / NETPLAY_TICKS_PER_SECOND)
+
+#define NETPLAY_MAX_PREDICTION_TICKS  8
+#define NETPLAY_MAX_INPUTS_PER_PACKET 64
+
+// NOTE(leo): Both must be powers of two. The inputs ring (and the checksums, which use the
+// same indices) must hold every input that wasn't acknowledged yet, and the snapshots ring
+// every tick we may have to roll back to.
+#define NETPLAY_INPUTS_CAPACITY    256
+#define NETPLAY_SNAPSHOTS_CAPACITY 16
+
+#define NETPLAY_INPUT_INDEX(tick) ((tick) & (NETPLAY_INPUTS_CAPACITY - 1))
+
+#define NETPLAY_MAGIC 0x4C504E50 // NOTE(leo): "PNPL" in little endian.
+
+#define NETPLAY_INPUT_UP    (1 << 0)
+#define NETPLAY_INPUT_DOWN  (1 << 1)
+#define NETPLAY_INPUT_ENTER (1 << 2)
+
+// NOTE(leo): Enough for about a second of packets at the highest latency we care about.
+#define NETPLAY_CONDITIONER_CAPACITY 256
+
+// ===========================================================================================
+
+enum
+{
+    NETPLAY_LEFT_PLAYER,
+    NETPLAY_RIGHT_PLAYER
+};
+
+// NOTE(leo): The keys of one player for one tick, see NETPLAY_INPUT_*.
+typedef u8 NetplayInput;
+
+// NOTE(leo): Sent as is, both sides are x64 (little endian). Only the first inputs_count
+// inputs go on the wire.
+typedef struct
+{
+    u32 magic;
+    u8  player;
+    u8  inputs_count;
+    u16 padding;
+
+    // NOTE(leo): The tick of inputs[0].
+    u32 first_tick;
+
+    // NOTE(leo): How many of the receiver's inputs the sender has, so the receiver can stop
+    // resending them.
+    u32 acknowledged_ticks;
+
+    // NOTE(leo): The running checksum of the state after the first checksum_ticks ticks. Only
+    // meaningful when checksum_ticks isn't zero.
+    u32 checksum_ticks;
+    u32 checksum;
+
+    // NOTE(leo): The seed of the match. Only the left player's one is used.
+    u64 rng_state;
+    u64 rng_sequence;
+
+    NetplayInput inputs[NETPLAY_MAX_INPUTS_PER_PACKET];
+
+} NetplayPacket;
+
+#define NETPLAY_PACKET_HEADER_SIZE (sizeof(NetplayPacket) - NETPLAY_MAX_INPUTS_PER_PACKET)
+
+typedef struct
+{
+    u64 ticks_advanced;
+    u64 ticks_stalled;
+    u64 rollbacks;
+    u64 ticks_resimulated;
+    u32 max_rollback_ticks;
+    u64 packets_sent;
+    u64 packets_received;
+    u64 packets_rejected;
+    u64 checksums_compared;
+
+} NetplayStats;
+
+typedef struct
+{
+    u32 local_player;
+    b32 is_running;
+    u64 rng_state;
+    u64 rng_sequence;
+
+    // NOTE(leo): The state before tick current_tick, and every state before it still in the
+    // ring. Snapshot t is the state before tick t.
+    GameState    game_state;
+    SnapshotRing snapshots;
+
+    NetplayInput local_inputs[NETPLAY_INPUTS_CAPACITY];
+
+    // NOTE(leo): Confirmed for ticks before remote_confirmed_ticks, predicted after.
+    NetplayInput remote_inputs[NETPLAY_INPUTS_CAPACITY];
+
+    u32 current_tick;
+    u32 remote_confirmed_ticks;
+    u32 remote_acknowledged_ticks;
+
+    b32 has_misprediction;
+    u32 first_mispredicted_tick;
+
+    // NOTE(leo): checksums[NETPLAY_INPUT_INDEX(t)] is the running checksum of the state after
+    // tick t, for the ticks before checksummed_ticks. Only ticks with both inputs confirmed
+    // are checksummed, since a rollback can't change them anymore.
+    u32 checksums[NETPLAY_INPUTS_CAPACITY];
+    u32 checksummed_ticks;
+
+    // NOTE(leo): The other side agreed with every tick before verified_ticks. When a checksum
+    // doesn't match, the match diverged somewhere from verified_ticks to desync_tick.
+    u32 verified_ticks;
+    b32 has_desync;
+    u32 desync_tick;
+
+    NetplayStats stats;
+
+} NetplaySession;
+
+typedef struct
+{
+    f64 delivery_seconds;
+    u32 size;
+    u8  data[sizeof(NetplayPacket)];
+
+} NetplayDelayedPacket;
+
+// NOTE(leo): Artificial latency, jitter and loss for one direction of a link, for testing on
+// loopback. Packets go in when they'd be sent and come out when they'd arrive. With jitter
+// they may come out in a different order, like on a real network.
+typedef struct
+{
+    f32            latency_seconds;
+    f32            jitter_seconds;
+    f32            loss_probability;
+    pcg32_random_t rng;
+
+    NetplayDelayedPacket packets[NETPLAY_CONDITIONER_CAPACITY];
+    u32                  packets_count;
+    u64                  packets_dropped;
+
+} NetplayConditioner;
+
+// ===========================================================================================
+
+// NOTE(leo): Whoever is playing on this machine can use either set of keys.
+INTERNAL NetplayInput
+netplay_input_from_keys(b32 *is_key_down)
+{
+    NetplayInput input = 0;
+
+    if(is_key_down[KEY_W] || is_key_down[KEY_UP])
+    {
+        input |= NETPLAY_INPUT_UP;
+    }
+
+    if(is_key_down[KEY_S] || is_key_down[KEY_DOWN])
+    {
+        input |= NETPLAY_INPUT_DOWN;
+    }
+
+    if(is_key_down[KEY_ENTER])
+    {
+        input |= NETPLAY_INPUT_ENTER;
+    }
+
+    return input;
+}
+
+INTERNAL GameInput
+netplay_game_input(NetplayInput left_input, NetplayInput right_input)
+{
+    GameInput game_input = {0};
+
+    game_input.is_key_down[KEY_W]     = (left_input & NETPLAY_INPUT_UP) != 0;
+    game_input.is_key_down[KEY_S]     = (left_input & NETPLAY_INPUT_DOWN) != 0;
+    game_input.is_key_down[KEY_UP]    = (right_input & NETPLAY_INPUT_UP) != 0;
+    game_input.is_key_down[KEY_DOWN]  = (right_input & NETPLAY_INPUT_DOWN) != 0;
+    game_input.is_key_down[KEY_ENTER] =
+        ((left_input | right_input) & NETPLAY_INPUT_ENTER) != 0;
+
+    return game_input;
+}
+
+// NOTE(leo): Only dotted decimal, like "192.168.0.10".
+INTERNAL b32
+netplay_parse_ipv4(String8 string, u32 *ipv4)
+{
+    u32 result = 0;
+    u32 at     = 0;
+
+    for(u32 part = 0; part < 4; ++part)
+    {
+        u32 value  = 0;
+        u32 digits = 0;
+
+        while(at < string.length && string.data[at] >= '0' && string.data[at] <= '9'
+              && digits < 3)
+        {
+            value = (value * 10) + (u32)(string.data[at++] - '0');
+            digits++;
+        }
+
+        if(!digits || value > 255)
+        {
+            return false;
+        }
+
+        if(part < 3)
+        {
+            if(at >= string.length || string.data[at++] != '.')
+            {
+                return false;
+            }
+        }
+
+        result = (result << 8) | value;
+    }
+
+    *ipv4 = result;
+
+    return at == string.length;
+}
+
+// NOTE(leo): The right player passes anything as the seed, it takes the left player's one
+// when the first packet arrives.
+INTERNAL void
+netplay_session_init(NetplaySession *session,
+                     u32             local_player,
+                     u64             rng_state,
+                     u64             rng_sequence)
+{
+    memset(session, 0, sizeof(*session));
+
+    session->local_player = local_player;
+    session->rng_state    = rng_state;
+    session->rng_sequence = rng_sequence;
+
+    snapshot_ring_init(&session->snapshots, NETPLAY_SNAPSHOTS_CAPACITY);
+
+    // NOTE(leo): Something to render while we wait for the other player.
+    game_main(&session->game_state, rng_state, rng_sequence);
+}
+
+INTERNAL void
+netplay_simulate_tick(NetplaySession *session, u32 tick)
+{
+    NetplayInput local_input  = session->local_inputs[NETPLAY_INPUT_INDEX(tick)];
+    NetplayInput remote_input = session->remote_inputs[NETPLAY_INPUT_INDEX(tick)];
+
+    GameInput game_input = session->local_player == NETPLAY_LEFT_PLAYER
+                             ? netplay_game_input(local_input, remote_input)
+                             : netplay_game_input(remote_input, local_input);
+
+    game_update(&session->game_state, &game_input, NETPLAY_TICK_SECONDS);
+    snapshot_ring_push(&session->snapshots, &session->game_state);
+}
+
+INTERNAL NetplayInput
+netplay_predict_remote_input(NetplaySession *session)
+{
+    NetplayInput prediction = 0;
+
+    if(session->remote_confirmed_ticks)
+    {
+        u32 last_confirmed_tick = session->remote_confirmed_ticks - 1;
+        prediction = session->remote_inputs[NETPLAY_INPUT_INDEX(last_confirmed_tick)];
+    }
+
+    return prediction;
+}
+
+// NOTE(leo): Rolls back to the first mispredicted tick, if there is one, and simulates again
+// up to the current tick with the inputs we know now. Called by netplay_advance, and on its
+// own when the caller needs the corrected state without advancing.
+INTERNAL void
+netplay_synchronize(NetplaySession *session)
+{
+    if(!session->has_misprediction)
+    {
+        return;
+    }
+
+    u32 tick = session->first_mispredicted_tick;
+    ASSERT(tick < session->current_tick);
+    ASSERT(snapshot_ring_has(&session->snapshots, tick));
+
+    session->game_state = *snapshot_ring_get(&session->snapshots, tick);
+    snapshot_ring_truncate(&session->snapshots, tick);
+
+    u32 rollback_ticks = session->current_tick - tick;
+
+    session->stats.rollbacks++;
+    session->stats.ticks_resimulated += rollback_ticks;
+
+    if(rollback_ticks > session->stats.max_rollback_ticks)
+    {
+        session->stats.max_rollback_ticks = rollback_ticks;
+    }
+
+    NetplayInput prediction = netplay_predict_remote_input(session);
+
+    for(; tick < session->current_tick; ++tick)
+    {
+        // NOTE(leo): The ticks we still don't have remote inputs for are predicted again,
+        // from the newest input we know of.
+        if(tick >= session->remote_confirmed_ticks)
+        {
+            session->remote_inputs[NETPLAY_INPUT_INDEX(tick)] = prediction;
+        }
+
+        netplay_simulate_tick(session, tick);
+    }
+
+    session->has_misprediction = false;
+}
+
+// NOTE(leo): Simulates one tick with the given local input. Returns false, without
+// simulating, while waiting for the other player to connect or when it fell too far behind.
+INTERNAL b32
+netplay_advance(NetplaySession *session, NetplayInput local_input)
+{
+    if(!session->is_running)
+    {
+        return false;
+    }
+
+    netplay_synchronize(session);
+
+    // NOTE(leo): The other side may be a few ticks ahead of us, so we may already have the
+    // remote inputs of the ticks we are about to simulate.
+    u32 predicted_ticks = session->current_tick > session->remote_confirmed_ticks
+                            ? session->current_tick - session->remote_confirmed_ticks
+                            : 0;
+
+    u32 unacknowledged_ticks = session->current_tick - session->remote_acknowledged_ticks;
+
+    if(predicted_ticks >= NETPLAY_MAX_PREDICTION_TICKS
+       || unacknowledged_ticks >= NETPLAY_MAX_INPUTS_PER_PACKET)
+    {
+        session->stats.ticks_stalled++;
+        return false;
+    }
+
+    u32 tick  = session->current_tick;
+    u32 index = NETPLAY_INPUT_INDEX(tick);
+
+    session->local_inputs[index] = local_input;
+
+    if(tick >= session->remote_confirmed_ticks)
+    {
+        session->remote_inputs[index] = netplay_predict_remote_input(session);
+    }
+
+    netplay_simulate_tick(session, tick);
+
+    session->current_tick++;
+    session->stats.ticks_advanced++;
+
+    return true;
+}
+
+// NOTE(leo): Checksums the ticks that got both of their inputs since the last call.
+INTERNAL void
+netplay_update_checksums(NetplaySession *session)
+{
+    if(!session->is_running)
+    {
+        return;
+    }
+
+    // NOTE(leo): The states after a mispredicted tick are wrong until we roll back.
+    netplay_synchronize(session);
+
+    u32 confirmed_ticks = MIN(session->current_tick, session->remote_confirmed_ticks);
+
+    for(; session->checksummed_ticks < confirmed_ticks; ++session->checksummed_ticks)
+    {
+        u32 tick     = session->checksummed_ticks;
+        u32 previous = tick ? session->checksums[NETPLAY_INPUT_INDEX(tick - 1)] : 0;
+
+        GameState *state = snapshot_ring_get(&session->snapshots, tick + 1);
+
+        session->checksums[NETPLAY_INPUT_INDEX(tick)] = game_state_checksum(state, previous);
+    }
+}
+
+// NOTE(leo): Returns the size to send. Should be sent every frame, even when nothing changed,
+// since it's also how the other side learns what we have.
+INTERNAL u32
+netplay_build_packet(NetplaySession *session, NetplayPacket *packet)
+{
+    netplay_update_checksums(session);
+
+    u32 first_tick   = session->remote_acknowledged_ticks;
+    u32 inputs_count = session->current_tick - first_tick;
+
+    ASSERT(inputs_count <= NETPLAY_MAX_INPUTS_PER_PACKET);
+
+    packet->magic              = NETPLAY_MAGIC;
+    packet->player             = (u8)session->local_player;
+    packet->inputs_count       = (u8)inputs_count;
+    packet->padding            = 0;
+    packet->first_tick         = first_tick;
+    packet->acknowledged_ticks = session->remote_confirmed_ticks;
+    packet->checksum_ticks     = session->checksummed_ticks;
+    packet->checksum           = 0;
+    packet->rng_state          = session->rng_state;
+    packet->rng_sequence       = session->rng_sequence;
+
+    if(session->checksummed_ticks)
+    {
+        u32 tick         = session->checksummed_ticks - 1;
+        packet->checksum = session->checksums[NETPLAY_INPUT_INDEX(tick)];
+    }
+
+    for(u32 i = 0; i < inputs_count; ++i)
+    {
+        packet->inputs[i] = session->local_inputs[NETPLAY_INPUT_INDEX(first_tick + i)];
+    }
+
+    session->stats.packets_sent++;
+
+    return (u32)NETPLAY_PACKET_HEADER_SIZE + inputs_count;
+}
+
+INTERNAL void
+netplay_receive_packet(NetplaySession *session, void *data, u32 size)
+{
+    NetplayPacket *packet = data;
+
+    if(size < NETPLAY_PACKET_HEADER_SIZE || packet->magic != NETPLAY_MAGIC
+       || packet->player == session->local_player
+       || packet->inputs_count > NETPLAY_MAX_INPUTS_PER_PACKET
+       || size != NETPLAY_PACKET_HEADER_SIZE + packet->inputs_count)
+    {
+        session->stats.packets_rejected++;
+        return;
+    }
+
+    session->stats.packets_received++;
+
+    if(!session->is_running)
+    {
+        if(session->local_player == NETPLAY_RIGHT_PLAYER)
+        {
+            session->rng_state    = packet->rng_state;
+            session->rng_sequence = packet->rng_sequence;
+        }
+
+        game_main(&session->game_state, session->rng_state, session->rng_sequence);
+        snapshot_ring_push(&session->snapshots, &session->game_state);
+
+        session->is_running = true;
+    }
+
+    // NOTE(leo): Packets may arrive out of order, so an older acknowledgement is ignored.
+    if(packet->acknowledged_ticks > session->remote_acknowledged_ticks
+       && packet->acknowledged_ticks <= session->current_tick)
+    {
+        session->remote_acknowledged_ticks = packet->acknowledged_ticks;
+    }
+
+    // NOTE(leo): We compare when we checksummed that tick too and it's still in the ring. If
+    // we didn't get there yet, a later packet will have a tick we can compare.
+    u32 checksum_ticks = packet->checksum_ticks;
+
+    if(checksum_ticks && checksum_ticks <= session->checksummed_ticks
+       && session->checksummed_ticks - checksum_ticks < NETPLAY_INPUTS_CAPACITY)
+    {
+        u32 tick = checksum_ticks - 1;
+
+        session->stats.checksums_compared++;
+
+        if(session->checksums[NETPLAY_INPUT_INDEX(tick)] != packet->checksum)
+        {
+            if(!session->has_desync)
+            {
+                session->has_desync  = true;
+                session->desync_tick = tick;
+            }
+        }
+        else if(!session->has_desync && checksum_ticks > session->verified_ticks)
+        {
+            session->verified_ticks = checksum_ticks;
+        }
+    }
+
+    // NOTE(leo): Remote inputs are only taken in order. Anything after a gap comes again in
+    // a later packet, since it wasn't acknowledged.
+    for(u32 i = 0; i < packet->inputs_count; ++i)
+    {
+        u32 tick = packet->first_tick + i;
+
+        if(tick != session->remote_confirmed_ticks)
+        {
+            continue;
+        }
+
+        // NOTE(leo): The remote side stalls long before it gets this far ahead of us, so
+        // this only guards the ring against a broken packet.
+        if(tick >= session->current_tick + (NETPLAY_INPUTS_CAPACITY / 2))
+        {
+            break;
+        }
+
+        u32          index = NETPLAY_INPUT_INDEX(tick);
+        NetplayInput input = packet->inputs[i];
+
+        if(tick < session->current_tick && session->remote_inputs[index] != input)
+        {
+            if(!session->has_misprediction || tick < session->first_mispredicted_tick)
+            {
+                session->first_mispredicted_tick = tick;
+            }
+
+            session->has_misprediction = true;
+        }
+
+        session->remote_inputs[index] = input;
+        session->remote_confirmed_ticks++;
+    }
+}
+
+// ===========================================================================================
+
+INTERNAL void
+netplay_conditioner_init(NetplayConditioner *conditioner,
+                         f32                 latency_seconds,
+                         f32                 jitter_seconds,
+                         f32                 loss_probability,
+                         u64                 rng_state)
+{
+    memset(conditioner, 0, sizeof(*conditioner));
+
+    conditioner->latency_seconds  = latency_seconds;
+    conditioner->jitter_seconds   = jitter_seconds;
+    conditioner->loss_probability = loss_probability;
+
+    pcg32_srandom_r(&conditioner->rng, rng_state, (u64)conditioner);
+}
+
+INTERNAL void
+netplay_conditioner_push(NetplayConditioner *conditioner,
+                         f64                 now_seconds,
+                         void               *data,
+                         u32                 size)
+{
+    ASSERT(size <= sizeof(conditioner->packets[0].data));
+
+    if(random_f32_0_1(&conditioner->rng) < conditioner->loss_probability
+       || conditioner->packets_count == NETPLAY_CONDITIONER_CAPACITY)
+    {
+        conditioner->packets_dropped++;
+        return;
+    }
+
+    f32 jitter_seconds = conditioner->jitter_seconds * random_f32_0_1(&conditioner->rng);
+
+    NetplayDelayedPacket *delayed = &conditioner->packets[conditioner->packets_count++];
+    delayed->delivery_seconds =
+        now_seconds + (f64)(conditioner->latency_seconds + jitter_seconds);
+    delayed->size             = size;
+    memcpy(delayed->data, data, size);
+}
+
+// NOTE(leo): Returns the size of a packet whose time has come, or 0 if there is none.
+INTERNAL u32
+netplay_conditioner_pop(NetplayConditioner *conditioner, f64 now_seconds, void *buffer)
+{
+    for(u32 i = 0; i < conditioner->packets_count; ++i)
+    {
+        NetplayDelayedPacket *delayed = &conditioner->packets[i];
+
+        if(delayed->delivery_seconds <= now_seconds)
+        {
+            u32 size = delayed->size;
+            memcpy(buffer, delayed->data, size);
+
+            *delayed = conditioner->packets[--conditioner->packets_count];
+
+            return size;
+        }
+    }
+
+    return 0;
+}
@@ -5,12 +5,146 @@
 
 // ===========================================================================================
 
+typedef struct
+{
+    u8 *data;
+    u64 size;
+
+} FileContents;
+
+typedef struct
+{
+    u64 handle;
+
+} OsFile;
+
+typedef struct
+{
+    u64 handle;
+
+    // NOTE(leo): The port it is bound to, useful when the OS picked it.
+    u16 port;
+
+} UdpSocket;
+
+typedef void OsThreadProc(void *parameter);
+
+// NOTE(leo): The struct is the thread's start parameter, so it must outlive the thread.
+typedef struct
+{
+    u64           handle;
+    OsThreadProc *proc;
+    void         *parameter;
+
+} OsThread;
+
+typedef struct
+{
+    u64 handle;
+
+} OsSemaphore;
+
+// NOTE(leo): Both in host byte order.
+typedef struct
+{
+    u32 ipv4;
+    u16 port;
+
+} NetAddress;
+
+// ===========================================================================================
+
 INTERNAL void os_print(String8 to_print);
 
+// NOTE(leo): The data is allocated with malloc and it's NULL on failure.
+INTERNAL FileContents os_read_entire_file(char *file_path);
+
+// NOTE(leo): Creates the file if it doesn't exist, truncates it otherwise. Returns false on
+// failure and lets the caller decide whether that is fatal or not.
+INTERNAL b32 os_write_entire_file(char *file_path, void *data, u64 size);
+
+// NOTE(leo): For files written a piece at a time. Creating works like
+// os_write_entire_file, and writing appends all of the data or returns false.
+INTERNAL b32  os_file_create(OsFile *file, char *file_path);
+INTERNAL b32  os_file_write(OsFile *file, void *data, u64 size);
+INTERNAL void os_file_close(OsFile *file);
+
+// NOTE(leo): The socket is non-blocking and bound to every interface. Port 0 lets the OS pick
+// one.
+INTERNAL b32  os_udp_open(UdpSocket *udp_socket, u16 port);
+INTERNAL void os_udp_close(UdpSocket *udp_socket);
+INTERNAL b32  os_udp_send(UdpSocket *udp_socket, NetAddress to, void *data, u32 size);
+
+// NOTE(leo): Returns the size of the datagram received, or 0 if there is none waiting.
+INTERNAL u32
+os_udp_receive(UdpSocket *udp_socket, NetAddress *from, void *buffer, u32 capacity);
+
+// NOTE(leo): Maps a named segment of memory shared with other processes. With create, it's
+// created (or truncated) and zeroed, otherwise it must exist and have at least that size.
+// The name is a plain identifier, each platform adds what its namespace needs. Returns NULL
+// on failure.
+INTERNAL void *os_shared_memory_open(char *name, u64 size, b32 create);
+
+// NOTE(leo): With remove, the name goes away too. Processes that still have it mapped keep
+// their mapping.
+INTERNAL void os_shared_memory_close(char *name, void *memory, u64 size, b32 remove);
+
+// NOTE(leo): Memory for back buffers. Page aligned, so rows with an aligned pitch are too,
+// backed by huge pages when the OS has them to give, and prefaulted: every page is mapped
+// before it returns instead of on the first frame drawn into it, which at 4K is thousands of
+// page faults. is_huge tells whether it got explicit huge pages. Returns NULL on failure.
+INTERNAL void *os_allocate_frame_memory(u64 size, b32 *is_huge);
+
+// NOTE(leo): size is the one it was allocated with.
+INTERNAL void os_free_frame_memory(void *memory, u64 size);
+
+// NOTE(leo): Gives the rest of the time slice to another thread that is ready to run, for
+// spin waits that would otherwise starve the thread they wait on when there are more of them
+// than cores.
+INTERNAL void os_yield_processor(void);
+
+// NOTE(leo): Logical processors the process can run on.
+INTERNAL u32 os_get_processors_count(void);
+
+// NOTE(leo): The same counter the platform layer times frames with, for code that is timed
+// on threads of its own. The platform layer knows how many ticks make a second.
+INTERNAL s64 os_get_cpu_tick(void);
+
+INTERNAL b32  os_thread_create(OsThread *thread, OsThreadProc *proc, void *parameter);
+INTERNAL void os_thread_join(OsThread *thread);
+
+// NOTE(leo): Pins the thread (the calling one if thread is NULL) to one logical processor.
+// Returns false if the OS refused, which isn't fatal.
+INTERNAL b32 os_thread_set_affinity(OsThread *thread, u32 processor);
+
+INTERNAL b32  os_semaphore_init(OsSemaphore *semaphore, u32 initial_count);
+INTERNAL void os_semaphore_destroy(OsSemaphore *semaphore);
+INTERNAL void os_semaphore_wait(OsSemaphore *semaphore);
+INTERNAL void os_semaphore_signal(OsSemaphore *semaphore, u32 count);
+
 // ===========================================================================================
 
-#ifdef DEVELOPMENT
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-function"
+
+// NOTE(leo): The smallest page of every platform we run on.
+#define OS_PAGE_SIZE 4096
+
+// NOTE(leo): Writes to every page, so the OS maps them now. For memory handed out by
+// somebody else, like a DIB section.
+INTERNAL void
+os_prefault(void *memory, u64 size)
+{
+    volatile u8 *byte = memory;
+
+    for(u64 offset = 0; offset < size; offset += OS_PAGE_SIZE)
+    {
+        byte[offset] = 0;
+    }
+}
 
+// NOTE(leo): Available on every build because the headless platform layers print their
+// reports even on release builds.
 INTERNAL void
 os_printf(String8 format, ...)
 {
@@ -18,4 +152,4 @@ os_printf(String8 format, ...)
     os_print((String8) {formated, formated_length});
 }
 
-#endif // DEVELOPMENT
+#pragma clang diagnostic pop
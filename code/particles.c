@@ -0,0 +1,313 @@
+// NOTE(leo): Particles, for the looks only: the sparks of a hit and the ball's trail. They
+// aren't part of the match. The platform spawns them from the state after each tick (see
+// game_spawn_particles), and they are drawn over it.
+//
+// A pool of a fixed capacity, allocated once, as a structure of arrays: each field has an
+// array of its own, so the update is the same few SSE instructions for 4 particles at a time.
+// Particles die when they fade out or leave the screen. The same pass moves the live ones
+// down over the dead ones, in order, so the live particles are always the first count
+// entries. Spawning, updating and drawing are all linear in the number of particles.
+//
+// They are drawn as small squares, fading from one color to another, converted to pixels a
+// batch at a time and drawn with draw_rectangle_batch.
+
+#define PARTICLES_LANES 4
+
+// NOTE(leo): How many particles are converted to pixels before drawing them.
+#define PARTICLES_RENDER_BATCH 256
+
+// NOTE(leo): In screen units per second squared.
+#define PARTICLES_GRAVITY 1.5f
+
+// NOTE(leo): Particles further than this off the screen are culled.
+#define PARTICLES_SCREEN_MARGIN 0.05f
+
+// ===========================================================================================
+
+typedef struct
+{
+    // NOTE(leo): capacity entries each, the live particles are the first count. brightness
+    // goes from 1 (just spawned) to 0 (dead), fade is how much of it goes per second.
+    f32 *x;
+    f32 *y;
+    f32 *velocity_x;
+    f32 *velocity_y;
+    f32 *brightness;
+    f32 *fade;
+
+    u32 count;
+    u32 capacity;
+
+    // NOTE(leo): Spawned while the pool was full, so never were.
+    u64 particles_dropped;
+
+    pcg32_random_t rng;
+
+} ParticleSystem;
+
+// ===========================================================================================
+
+// NOTE(leo): Allocates the pool. The capacity is rounded up to a multiple of PARTICLES_LANES,
+// so every array starts 16-byte aligned. Returns false if there isn't enough memory.
+INTERNAL b32
+particles_init(ParticleSystem *particles, u32 capacity, u64 seed)
+{
+    memset(particles, 0, sizeof(*particles));
+
+    capacity = (capacity + PARTICLES_LANES - 1) & ~(u32)(PARTICLES_LANES - 1);
+
+    // NOTE(leo): Zeroed, so the lanes past count the update goes over are never garbage.
+    u64  array_size = (u64)capacity * sizeof(f32);
+    f32 *memory     = malloc(array_size * 6);
+
+    if(!memory)
+    {
+        return false;
+    }
+
+    memset(memory, 0, array_size * 6);
+
+    particles->x          = memory;
+    particles->y          = particles->x + capacity;
+    particles->velocity_x = particles->y + capacity;
+    particles->velocity_y = particles->velocity_x + capacity;
+    particles->brightness = particles->velocity_y + capacity;
+    particles->fade       = particles->brightness + capacity;
+    particles->capacity   = capacity;
+
+    pcg32_srandom_r(&particles->rng, seed, 0xDA3E39CB94B95BDBULL);
+
+    return true;
+}
+
+INTERNAL void
+particles_destroy(ParticleSystem *particles)
+{
+    free(particles->x);
+    memset(particles, 0, sizeof(*particles));
+}
+
+// NOTE(leo): Dropped if the pool is full.
+INTERNAL void
+particles_spawn(ParticleSystem *particles,
+                f32             x,
+                f32             y,
+                f32             velocity_x,
+                f32             velocity_y,
+                f32             seconds_to_live)
+{
+    if(particles->count == particles->capacity)
+    {
+        particles->particles_dropped++;
+        return;
+    }
+
+    u32 i = particles->count++;
+
+    particles->x[i]          = x;
+    particles->y[i]          = y;
+    particles->velocity_x[i] = velocity_x;
+    particles->velocity_y[i] = velocity_y;
+    particles->brightness[i] = 1.0f;
+    particles->fade[i]       = 1.0f / seconds_to_live;
+}
+
+// NOTE(leo): Moves the particles seconds forward and culls the dead ones.
+INTERNAL void
+particles_update(ParticleSystem *particles, f32 seconds)
+{
+    __m128 delta     = _mm_set1_ps(seconds);
+    __m128 gravity   = _mm_set1_ps(PARTICLES_GRAVITY * seconds);
+    __m128 limit     = _mm_set1_ps(1.0f + PARTICLES_SCREEN_MARGIN);
+    __m128 sign_bits = _mm_set1_ps(-0.0f);
+    __m128 zero      = _mm_setzero_ps();
+
+    u32 count = particles->count;
+    u32 alive = 0;
+
+    for(u32 i = 0; i < count; i += PARTICLES_LANES)
+    {
+        __m128 velocity_x = _mm_load_ps(particles->velocity_x + i);
+        __m128 velocity_y = _mm_sub_ps(_mm_load_ps(particles->velocity_y + i), gravity);
+        __m128 fade       = _mm_load_ps(particles->fade + i);
+
+        __m128 x = _mm_add_ps(_mm_load_ps(particles->x + i), _mm_mul_ps(velocity_x, delta));
+        __m128 y = _mm_add_ps(_mm_load_ps(particles->y + i), _mm_mul_ps(velocity_y, delta));
+        __m128 brightness =
+            _mm_sub_ps(_mm_load_ps(particles->brightness + i), _mm_mul_ps(fade, delta));
+
+        __m128 is_on_screen = _mm_and_ps(_mm_cmple_ps(_mm_andnot_ps(sign_bits, x), limit),
+                                         _mm_cmple_ps(_mm_andnot_ps(sign_bits, y), limit));
+        __m128 is_alive     = _mm_and_ps(_mm_cmpgt_ps(brightness, zero), is_on_screen);
+
+        u32 lanes = MIN(count - i, PARTICLES_LANES);
+        u32 mask  = (u32)_mm_movemask_ps(is_alive) & ((1u << lanes) - 1);
+
+        // NOTE(leo): alive is never past i, so the stores only go over particles already
+        // loaded.
+        if(mask == 0xF)
+        {
+            _mm_storeu_ps(particles->x + alive, x);
+            _mm_storeu_ps(particles->y + alive, y);
+            _mm_storeu_ps(particles->velocity_x + alive, velocity_x);
+            _mm_storeu_ps(particles->velocity_y + alive, velocity_y);
+            _mm_storeu_ps(particles->brightness + alive, brightness);
+            _mm_storeu_ps(particles->fade + alive, fade);
+
+            alive += PARTICLES_LANES;
+        }
+        else if(mask)
+        {
+            __attribute__((aligned(16))) f32 lanes_x[PARTICLES_LANES];
+            __attribute__((aligned(16))) f32 lanes_y[PARTICLES_LANES];
+            __attribute__((aligned(16))) f32 lanes_velocity_x[PARTICLES_LANES];
+            __attribute__((aligned(16))) f32 lanes_velocity_y[PARTICLES_LANES];
+            __attribute__((aligned(16))) f32 lanes_brightness[PARTICLES_LANES];
+            __attribute__((aligned(16))) f32 lanes_fade[PARTICLES_LANES];
+
+            _mm_store_ps(lanes_x, x);
+            _mm_store_ps(lanes_y, y);
+            _mm_store_ps(lanes_velocity_x, velocity_x);
+            _mm_store_ps(lanes_velocity_y, velocity_y);
+            _mm_store_ps(lanes_brightness, brightness);
+            _mm_store_ps(lanes_fade, fade);
+
+            for(u32 lane = 0; lane < PARTICLES_LANES; ++lane)
+            {
+                if(mask & (1u << lane))
+                {
+                    particles->x[alive]          = lanes_x[lane];
+                    particles->y[alive]          = lanes_y[lane];
+                    particles->velocity_x[alive] = lanes_velocity_x[lane];
+                    particles->velocity_y[alive] = lanes_velocity_y[lane];
+                    particles->brightness[alive] = lanes_brightness[lane];
+                    particles->fade[alive]       = lanes_fade[lane];
+
+                    alive++;
+                }
+            }
+        }
+    }
+
+    particles->count = alive;
+}
+
+// NOTE(leo): The live particles of source, as many as fit in dest. For the render pipeline
+// to take them to the render thread.
+INTERNAL void
+particles_copy(ParticleSystem *dest, ParticleSystem *source)
+{
+    u32 count = MIN(source->count, dest->capacity);
+    u64 size  = (u64)count * sizeof(f32);
+
+    dest->count = count;
+
+    memcpy(dest->x, source->x, size);
+    memcpy(dest->y, source->y, size);
+    memcpy(dest->velocity_x, source->velocity_x, size);
+    memcpy(dest->velocity_y, source->velocity_y, size);
+    memcpy(dest->brightness, source->brightness, size);
+    memcpy(dest->fade, source->fade, size);
+}
+
+// NOTE(leo): Draws the particles into g_back_buffer as squares of size (in screen units, like
+// draw_rectangle), from the color to the background color as they fade. Returns the
+// rectangle around all of them, empty if there are none.
+INTERNAL PixelRect
+particles_render(ParticleSystem *particles, f32 size, Color color, Color background)
+{
+    PixelRect drawn = {0};
+
+    if(!particles->count)
+    {
+        return drawn;
+    }
+
+    PixelRect square = rectangle_to_pixels(0.0f, 0.0f, size, size);
+    s32       width  = MAX(square.width, 1);
+    s32       height = MAX(square.height, 1);
+
+    // NOTE(leo): From the center in screen units to the top left corner in pixels, the way
+    // rectangle_to_pixels does it, but rounded to the nearest.
+    f32    half_width  = (f32)g_back_buffer.width / 2.0f;
+    f32    half_height = (f32)g_back_buffer.height / 2.0f;
+    __m128 scale_x     = _mm_set1_ps(half_width);
+    __m128 scale_y     = _mm_set1_ps(-half_height);
+    __m128 offset_x    = _mm_set1_ps(half_width - ((f32)width / 2.0f));
+    __m128 offset_y    = _mm_set1_ps(half_height - ((f32)height / 2.0f));
+
+    // NOTE(leo): Each channel goes from the background's (brightness 0) to the color's.
+    u32    color_u32      = color_to_u32(color);
+    u32    background_u32 = color_to_u32(background);
+    __m128 channels_begin[3];
+    __m128 channels_range[3];
+
+    for(u32 channel = 0; channel < 3; ++channel)
+    {
+        f32 begin = (f32)((background_u32 >> (16 - (8 * channel))) & 0xFF);
+        f32 end   = (f32)((color_u32 >> (16 - (8 * channel))) & 0xFF);
+
+        channels_begin[channel] = _mm_set1_ps(begin);
+        channels_range[channel] = _mm_set1_ps(end - begin);
+    }
+
+    __m128 one = _mm_set1_ps(1.0f);
+
+    s32 x_begin = S32_MAX;
+    s32 y_begin = S32_MAX;
+    s32 x_end   = S32_MIN;
+    s32 y_end   = S32_MIN;
+
+    for(u32 batch = 0; batch < particles->count; batch += PARTICLES_RENDER_BATCH)
+    {
+        __attribute__((aligned(16))) s32 xs[PARTICLES_RENDER_BATCH];
+        __attribute__((aligned(16))) s32 ys[PARTICLES_RENDER_BATCH];
+        __attribute__((aligned(16))) u32 colors[PARTICLES_RENDER_BATCH];
+
+        u32 batch_count = MIN(particles->count - batch, PARTICLES_RENDER_BATCH);
+
+        // NOTE(leo): The lanes past count are converted too, but not drawn.
+        for(u32 i = 0; i < batch_count; i += PARTICLES_LANES)
+        {
+            u32 at = batch + i;
+
+            __m128 x = _mm_add_ps(_mm_mul_ps(_mm_load_ps(particles->x + at), scale_x),
+                                  offset_x);
+            __m128 y = _mm_add_ps(_mm_mul_ps(_mm_load_ps(particles->y + at), scale_y),
+                                  offset_y);
+
+            _mm_store_si128((__m128i *)(xs + i), _mm_cvtps_epi32(x));
+            _mm_store_si128((__m128i *)(ys + i), _mm_cvtps_epi32(y));
+
+            __m128  brightness = _mm_min_ps(_mm_load_ps(particles->brightness + at), one);
+            __m128i pixels     = _mm_setzero_si128();
+
+            for(u32 channel = 0; channel < 3; ++channel)
+            {
+                __m128 value = _mm_add_ps(channels_begin[channel],
+                                          _mm_mul_ps(channels_range[channel], brightness));
+
+                pixels = _mm_or_si128(_mm_slli_epi32(pixels, 8), _mm_cvtps_epi32(value));
+            }
+
+            _mm_store_si128((__m128i *)(colors + i), pixels);
+        }
+
+        draw_rectangle_batch(xs, ys, colors, batch_count, width, height);
+
+        for(u32 i = 0; i < batch_count; ++i)
+        {
+            x_begin = MIN(x_begin, xs[i]);
+            y_begin = MIN(y_begin, ys[i]);
+            x_end   = MAX(x_end, xs[i] + width);
+            y_end   = MAX(y_end, ys[i] + height);
+        }
+    }
+
+    drawn.x      = x_begin;
+    drawn.y      = y_begin;
+    drawn.width  = x_end - x_begin;
+    drawn.height = y_end - y_begin;
+
+    return drawn;
+}
@@ -0,0 +1,84 @@
+#ifndef PONG_ENV_H
+#define PONG_ENV_H
+
+// NOTE(leo): The C API of the reinforcement learning environment, for programs that link
+// with the shared library (libpong_env.so). It's plain C with stdint types only, so that it
+// can be loaded from Python with ctypes as well.
+//
+// One PongEnv steps many independent matches (a vectorized environment) per call. Each
+// match is played by one agent on the left paddle against the built-in AI, or by two agents
+// (self play). A point scored is a reward of +1 for the player who scored and -1 for the
+// other one. A match ends after points_per_episode points and starts over on its own, so
+// dones only tells that the step finished an episode.
+//
+// Observations are written into a buffer the caller owns, envs_count observations back to
+// back. A frame is rendered by the software renderer straight into the buffer, at the
+// requested size, so there is nothing to copy or resize.
+//
+// A PongEnv isn't thread safe, and frames are rendered through the renderer's global back
+// buffer, so only one thread per process may call pong_env_observe at a time. Run one process
+// per core to use more cores.
+
+#include <stdint.h>
+
+#define PONG_ENV_API __attribute__((visibility("default")))
+
+// NOTE(leo): The state vector is PONG_ENV_STATE_VALUES_COUNT floats: the ball's x, y, x
+// velocity and y velocity, then the left paddle's y and y velocity, then the right
+// paddle's. The court goes from -1 to 1 in both axes.
+#define PONG_ENV_OBSERVE_STATE 0
+
+// NOTE(leo): A frame_width * frame_height grayscale frame, one byte per pixel, top row first.
+#define PONG_ENV_OBSERVE_FRAME 1
+
+#define PONG_ENV_STATE_VALUES_COUNT 8
+
+// NOTE(leo): One per player per match.
+#define PONG_ENV_ACTION_STAY 0
+#define PONG_ENV_ACTION_UP   1
+#define PONG_ENV_ACTION_DOWN 2
+
+#define PONG_ENV_AI_EASY   0
+#define PONG_ENV_AI_MEDIUM 1
+#define PONG_ENV_AI_HARD   2
+
+typedef struct
+{
+    uint32_t envs_count;
+
+    // NOTE(leo): 1 plays the right paddle with the built-in AI, 2 takes actions for both.
+    uint32_t players_count;
+    uint32_t ai_difficulty;
+
+    uint32_t observation_type;
+    uint32_t frame_width;
+    uint32_t frame_height;
+
+    uint32_t points_per_episode;
+    uint64_t seed;
+
+} PongEnvConfig;
+
+typedef struct PongEnv PongEnv;
+
+// NOTE(leo): Returns NULL if the config is invalid or it couldn't allocate. The matches
+// start reset.
+PONG_ENV_API PongEnv *pong_env_create(PongEnvConfig *config);
+PONG_ENV_API void     pong_env_destroy(PongEnv *env);
+
+// NOTE(leo): The size in bytes of one match's observation.
+PONG_ENV_API uint64_t pong_env_observation_size(PongEnv *env);
+
+// NOTE(leo): Starts every match over.
+PONG_ENV_API void pong_env_reset(PongEnv *env);
+
+// NOTE(leo): Advances every match one tick (1/60 of a second). actions and rewards have
+// envs_count * players_count entries, the players of a match next to each other (left
+// first), and dones has envs_count.
+PONG_ENV_API void
+pong_env_step(PongEnv *env, const uint8_t *actions, float *rewards, uint8_t *dones);
+
+// NOTE(leo): observations must hold envs_count * pong_env_observation_size(env) bytes.
+PONG_ENV_API void pong_env_observe(PongEnv *env, void *observations);
+
+#endif // PONG_ENV_H
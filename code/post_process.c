@@ -0,0 +1,554 @@
+// NOTE(leo): The CRT look for arcade cabinets, a stage between rendering a frame and
+// presenting it. The game renders into the post-process' own scene buffer, and the passes
+// write the back buffer that gets presented from it:
+//
+// - persistence: phosphors fade instead of going dark at once. The history buffer keeps what
+//   was shown, and every frame it fades a bit and takes the brighter of itself and the new
+//   scene, so whatever moves leaves a trail.
+// - bloom: a blur of the scene, above a threshold, is added on top, so bright things glow a
+//   little into the dark around them.
+// - scanlines: every other band of rows is darker. The bands are sized so there are about
+//   POST_SCANLINES_COUNT of them at any resolution.
+//
+// Every pass is a function over a row, in SSE2, 4 pixels at a time. The frame is done in
+// tiles of rows small enough for their scene, history and back buffer rows to stay in the L2
+// cache, and all the passes run over a tile before the next one, so a pixel comes from memory
+// once instead of once per pass. With a job system (job_system.c), the frame is cut into one
+// band of tiles per worker, each band a job, the calling thread taking the first.
+//
+// Only 0x00RRGGBB back buffers.
+
+#define POST_PROCESS_MAX_BANDS 8
+
+// NOTE(leo): What the rows of a tile should take at most, in every buffer the passes touch.
+#define POST_PROCESS_TILE_BYTES (256 * 1024)
+
+// NOTE(leo): In 256ths. How much of its brightness the history keeps every frame, and what
+// the dark scanlines keep.
+#define POST_PERSISTENCE_LEVEL 176
+#define POST_SCANLINE_LEVEL    168
+
+// NOTE(leo): Only the part of the blurred scene above the threshold glows, a quarter of it.
+#define POST_BLOOM_THRESHOLD 0x20
+#define POST_BLOOM_SHIFT     2
+
+// NOTE(leo): The bloom samples the scene this fraction of the height away (at least a pixel).
+#define POST_BLOOM_DISTANCE_DIVISOR 360
+
+#define POST_SCANLINES_COUNT 270
+
+// ===========================================================================================
+
+typedef enum
+{
+    POST_PASS_PERSISTENCE,
+    POST_PASS_BLOOM,
+    POST_PASS_SCANLINES,
+
+    POST_PASSES_COUNT
+
+} PostPass;
+
+GLOBAL char *g_post_pass_names[POST_PASSES_COUNT] = {"persistence", "bloom", "scanlines"};
+
+typedef struct PostProcess PostProcess;
+
+typedef struct __attribute__((aligned(64)))
+{
+    PostProcess *post;
+
+    // NOTE(leo): The rows of the frame this band is, from first_row to rows_end.
+    s32 first_row;
+    s32 rows_end;
+
+    // NOTE(leo): The vertical blur of the row the bloom is at, with room on both sides for
+    // the horizontal one.
+    u32 *blur_row;
+    u64  blur_row_capacity;
+
+    s64 pass_ticks[POST_PASSES_COUNT];
+
+} PostProcessBand;
+
+typedef struct
+{
+    // NOTE(leo): Of the last frame, in os_get_cpu_tick ticks. A pass' time is added up over
+    // the bands, so with workers the passes add up to more than the frame. Read them with
+    // post_process_last_ticks.
+    s64 pass_ticks[POST_PASSES_COUNT];
+    s64 frame_ticks;
+
+    u64 frames_processed;
+
+} PostProcessStats;
+
+struct PostProcess
+{
+    // NOTE(leo): Frame memory, the size of the back buffers. The game renders into scene,
+    // history is what persistence keeps from a frame to the next.
+    BackBuffer scene;
+    BackBuffer history;
+    u64        buffers_capacity;
+
+    // NOTE(leo): 0 picks them from POST_PROCESS_TILE_BYTES, the whole height does every pass
+    // over the whole frame before the next one.
+    s32 tile_rows;
+
+    // NOTE(leo): The frame being processed, set before the bands are submitted.
+    BackBuffer *dest;
+
+    // NOTE(leo): NULL runs the one band on the calling thread, see post_process_init.
+    JobSystem *jobs;
+
+    PostProcessBand bands[POST_PROCESS_MAX_BANDS];
+    u32             bands_count;
+
+    PostProcessStats stats;
+};
+
+// ===========================================================================================
+
+INTERNAL u32 *
+post_row(BackBuffer *buffer, s32 y)
+{
+    return (u32 *)((u8 *)buffer->pixels + ((u64)y * (u64)buffer->pitch));
+}
+
+// NOTE(leo): Each channel times level / 256.
+INTERNAL __m128i
+post_scale(__m128i pixels, __m128i level)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i low  = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(pixels, zero), level), 8);
+    __m128i high = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(pixels, zero), level), 8);
+
+    return _mm_packus_epi16(low, high);
+}
+
+// NOTE(leo): The passes work on 4 pixels at a time, the last 1 to 3 of a row go through
+// registers too, so the passes don't need a scalar version.
+INTERNAL __m128i
+post_load_tail(u32 *pixels, s32 count)
+{
+    u32 tail[4] = {0};
+    memcpy(tail, pixels, (u64)count * sizeof(u32));
+
+    return _mm_loadu_si128((__m128i *)tail);
+}
+
+INTERNAL void
+post_store_tail(u32 *pixels, s32 count, __m128i value)
+{
+    u32 tail[4];
+    _mm_storeu_si128((__m128i *)tail, value);
+
+    memcpy(pixels, tail, (u64)count * sizeof(u32));
+}
+
+// NOTE(leo): history = max(history faded, scene).
+INTERNAL void
+post_persistence_row(u32 *scene, u32 *history, s32 width)
+{
+    __m128i level = _mm_set1_epi16(POST_PERSISTENCE_LEVEL);
+    s32     x     = 0;
+
+    // NOTE(leo): Both are frame memory with aligned rows.
+    for(; x + 4 <= width; x += 4)
+    {
+        __m128i faded = post_scale(_mm_load_si128((__m128i *)(history + x)), level);
+        __m128i shown = _mm_max_epu8(faded, _mm_load_si128((__m128i *)(scene + x)));
+
+        _mm_store_si128((__m128i *)(history + x), shown);
+    }
+
+    if(x < width)
+    {
+        __m128i faded = post_scale(post_load_tail(history + x, width - x), level);
+        __m128i shown = _mm_max_epu8(faded, post_load_tail(scene + x, width - x));
+
+        post_store_tail(history + x, width - x, shown);
+    }
+}
+
+// NOTE(leo): dest = history + the glow of the scene around row y. The blur averages the rows
+// distance above and below with the row itself, then does the same across the columns.
+INTERNAL void
+post_bloom_row(BackBuffer *scene,
+               s32         y,
+               s32         distance,
+               u32        *blur_row,
+               u32        *history,
+               u32        *dest)
+{
+    s32  width  = scene->width;
+    u32 *above  = post_row(scene, MAX(y - distance, 0));
+    u32 *center = post_row(scene, y);
+    u32 *below  = post_row(scene, MIN(y + distance, scene->height - 1));
+
+    // NOTE(leo): The blurred row starts distance pixels in, the edges are repeated around it.
+    u32 *blurred = blur_row + distance;
+    s32  x       = 0;
+
+    for(; x + 4 <= width; x += 4)
+    {
+        __m128i vertical = _mm_avg_epu8(_mm_load_si128((__m128i *)(above + x)),
+                                        _mm_load_si128((__m128i *)(below + x)));
+        vertical         = _mm_avg_epu8(vertical, _mm_load_si128((__m128i *)(center + x)));
+
+        _mm_storeu_si128((__m128i *)(blurred + x), vertical);
+    }
+
+    if(x < width)
+    {
+        __m128i vertical = _mm_avg_epu8(post_load_tail(above + x, width - x),
+                                        post_load_tail(below + x, width - x));
+        vertical = _mm_avg_epu8(vertical, post_load_tail(center + x, width - x));
+
+        post_store_tail(blurred + x, width - x, vertical);
+    }
+
+    for(s32 i = 0; i < distance; ++i)
+    {
+        blur_row[i] = blurred[0];
+    }
+
+    // NOTE(leo): The last group of 4 pixels reads up to 3 past the end, and distance more.
+    for(s32 i = 0; i < distance + 3; ++i)
+    {
+        blurred[width + i] = blurred[width - 1];
+    }
+
+    __m128i threshold = _mm_set1_epi8(POST_BLOOM_THRESHOLD);
+    __m128i mask      = _mm_set1_epi8((char)(0xFF >> POST_BLOOM_SHIFT));
+
+    // NOTE(leo): The back buffer can be a bitmap of the OS, its rows aren't always aligned.
+    // The blurred row goes on past the width, so only the store of the last pixels needs a
+    // tail.
+    for(x = 0; x < width; x += 4)
+    {
+        __m128i left       = _mm_loadu_si128((__m128i *)(blurred + x - distance));
+        __m128i right      = _mm_loadu_si128((__m128i *)(blurred + x + distance));
+        __m128i horizontal = _mm_avg_epu8(_mm_avg_epu8(left, right),
+                                          _mm_loadu_si128((__m128i *)(blurred + x)));
+
+        __m128i glow = _mm_subs_epu8(horizontal, threshold);
+        glow         = _mm_and_si128(_mm_srli_epi16(glow, POST_BLOOM_SHIFT), mask);
+
+        if(x + 4 <= width)
+        {
+            __m128i shown = _mm_adds_epu8(_mm_load_si128((__m128i *)(history + x)), glow);
+            _mm_storeu_si128((__m128i *)(dest + x), shown);
+        }
+        else
+        {
+            __m128i shown = _mm_adds_epu8(post_load_tail(history + x, width - x), glow);
+            post_store_tail(dest + x, width - x, shown);
+        }
+    }
+}
+
+INTERNAL void
+post_scanline_row(u32 *dest, s32 width)
+{
+    __m128i level = _mm_set1_epi16(POST_SCANLINE_LEVEL);
+    s32     x     = 0;
+
+    for(; x + 4 <= width; x += 4)
+    {
+        __m128i darker = post_scale(_mm_loadu_si128((__m128i *)(dest + x)), level);
+        _mm_storeu_si128((__m128i *)(dest + x), darker);
+    }
+
+    if(x < width)
+    {
+        __m128i darker = post_scale(post_load_tail(dest + x, width - x), level);
+        post_store_tail(dest + x, width - x, darker);
+    }
+}
+
+// ===========================================================================================
+
+INTERNAL s32
+post_bloom_distance(s32 height)
+{
+    return MAX(height / POST_BLOOM_DISTANCE_DIVISOR, 1);
+}
+
+// NOTE(leo): Whether row y is in a dark band.
+INTERNAL b32
+post_is_scanline(s32 y, s32 height)
+{
+    s32 period = MAX(height / POST_SCANLINES_COUNT, 2);
+
+    return (y % period) >= period / 2;
+}
+
+INTERNAL s32
+post_process_tile_rows(PostProcess *post)
+{
+    if(post->tile_rows > 0)
+    {
+        return post->tile_rows;
+    }
+
+    // NOTE(leo): The scene, history and back buffer rows of a tile, and the rows around it
+    // the bloom reads.
+    u64 row_bytes = (u64)post->scene.width * sizeof(u32) * 4;
+
+    return (s32)MAX(POST_PROCESS_TILE_BYTES / row_bytes, 1);
+}
+
+// NOTE(leo): Runs every pass over the band's rows, a tile at a time.
+INTERNAL void
+post_process_band(PostProcess *post, PostProcessBand *band)
+{
+    BackBuffer *scene     = &post->scene;
+    BackBuffer *history   = &post->history;
+    BackBuffer *dest      = post->dest;
+    s32         width     = scene->width;
+    s32         distance  = post_bloom_distance(scene->height);
+    s32         tile_rows = post_process_tile_rows(post);
+
+    memset(band->pass_ticks, 0, sizeof(band->pass_ticks));
+
+    for(s32 tile = band->first_row; tile < band->rows_end; tile += tile_rows)
+    {
+        s32 tile_end = MIN(tile + tile_rows, band->rows_end);
+        s64 begin    = os_get_cpu_tick();
+
+        for(s32 y = tile; y < tile_end; ++y)
+        {
+            post_persistence_row(post_row(scene, y), post_row(history, y), width);
+        }
+
+        s64 persistence_end = os_get_cpu_tick();
+
+        for(s32 y = tile; y < tile_end; ++y)
+        {
+            post_bloom_row(scene,
+                           y,
+                           distance,
+                           band->blur_row,
+                           post_row(history, y),
+                           post_row(dest, y));
+        }
+
+        s64 bloom_end = os_get_cpu_tick();
+
+        for(s32 y = tile; y < tile_end; ++y)
+        {
+            if(post_is_scanline(y, scene->height))
+            {
+                post_scanline_row(post_row(dest, y), width);
+            }
+        }
+
+        s64 scanlines_end = os_get_cpu_tick();
+
+        band->pass_ticks[POST_PASS_PERSISTENCE] += persistence_end - begin;
+        band->pass_ticks[POST_PASS_BLOOM] += bloom_end - persistence_end;
+        band->pass_ticks[POST_PASS_SCANLINES] += scanlines_end - bloom_end;
+    }
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+
+INTERNAL void
+post_process_band_job(JobWorker *worker, void *data)
+
+#pragma clang diagnostic pop
+{
+    PostProcessBand *band = data;
+
+    post_process_band(band->post, band);
+}
+
+// ===========================================================================================
+
+INTERNAL void
+post_process_shutdown(PostProcess *post)
+{
+    for(u32 i = 0; i < post->bands_count; ++i)
+    {
+        free(post->bands[i].blur_row);
+    }
+
+    os_free_frame_memory(post->scene.pixels, post->buffers_capacity);
+    os_free_frame_memory(post->history.pixels, post->buffers_capacity);
+
+    memset(post, 0, sizeof(*post));
+}
+
+// NOTE(leo): The frame is cut in a band per worker of jobs, which must outlive the
+// post-process. The thread calling post_process_run must be worker 0 of it. jobs can be
+// NULL, the calling thread then does the whole frame.
+INTERNAL void
+post_process_init(PostProcess *post, JobSystem *jobs)
+{
+    memset(post, 0, sizeof(*post));
+
+    post->jobs        = jobs;
+    post->bands_count = jobs ? MIN(jobs->workers_count, POST_PROCESS_MAX_BANDS) : 1;
+
+    for(u32 i = 0; i < post->bands_count; ++i)
+    {
+        post->bands[i].post = post;
+    }
+}
+
+INTERNAL void
+post_process_clear_history(PostProcess *post)
+{
+    memset(post->history.pixels, 0, back_buffer_size(&post->history));
+}
+
+// NOTE(leo): Sets the scene and history up for back buffers like this one, if they aren't
+// already. The history starts black. Only grows, like the static layer of the compositor.
+// Returns false if there isn't enough memory.
+INTERNAL b32
+post_process_prepare(PostProcess *post, BackBuffer *back_buffer)
+{
+    ASSERT(back_buffer->format == BACK_BUFFER_RGB);
+
+    if(post->scene.pixels && post->scene.width == back_buffer->width
+       && post->scene.height == back_buffer->height)
+    {
+        return true;
+    }
+
+    BackBuffer buffer   = {0};
+    buffer.format       = BACK_BUFFER_RGB;
+    back_buffer_set_size(&buffer, back_buffer->width, back_buffer->height, true);
+    buffer.aspect_ratio = back_buffer->aspect_ratio;
+
+    u64 size = back_buffer_size(&buffer);
+
+    if(size > post->buffers_capacity)
+    {
+        os_free_frame_memory(post->scene.pixels, post->buffers_capacity);
+        os_free_frame_memory(post->history.pixels, post->buffers_capacity);
+
+        b32 is_huge;
+        post->scene.pixels     = os_allocate_frame_memory(size, &is_huge);
+        post->history.pixels   = os_allocate_frame_memory(size, &is_huge);
+        post->buffers_capacity = size;
+
+        if(!post->scene.pixels || !post->history.pixels)
+        {
+            os_free_frame_memory(post->scene.pixels, size);
+            os_free_frame_memory(post->history.pixels, size);
+
+            memset(&post->scene, 0, sizeof(post->scene));
+            memset(&post->history, 0, sizeof(post->history));
+            post->buffers_capacity = 0;
+
+            return false;
+        }
+    }
+
+    void *scene_pixels   = post->scene.pixels;
+    void *history_pixels = post->history.pixels;
+
+    post->scene          = buffer;
+    post->scene.pixels   = scene_pixels;
+    post->history        = buffer;
+    post->history.pixels = history_pixels;
+
+    post_process_clear_history(post);
+
+    // NOTE(leo): Room for the blur to read distance pixels past both ends, and 3 more past
+    // the end for the last group of 4 pixels.
+    u64 blur_capacity = (u64)buffer.width + (2 * (u64)post_bloom_distance(buffer.height)) + 3;
+
+    for(u32 i = 0; i < post->bands_count; ++i)
+    {
+        PostProcessBand *band = &post->bands[i];
+
+        if(blur_capacity > band->blur_row_capacity)
+        {
+            free(band->blur_row);
+
+            band->blur_row          = malloc(blur_capacity * sizeof(u32));
+            band->blur_row_capacity = band->blur_row ? blur_capacity : 0;
+
+            if(!band->blur_row)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// NOTE(leo): Runs the passes from the scene (which the frame must already be rendered into)
+// into dest, a back buffer the size post_process_prepare was called for.
+INTERNAL void
+post_process_run(PostProcess *post, BackBuffer *dest)
+{
+    ASSERT(dest->format == BACK_BUFFER_RGB && dest->width == post->scene.width
+           && dest->height == post->scene.height);
+
+    s64 begin = os_get_cpu_tick();
+
+    post->dest = dest;
+
+    // NOTE(leo): Bands of whole tiles, so the tiles are the same with or without workers.
+    s32 height     = post->scene.height;
+    s32 tile_rows  = post_process_tile_rows(post);
+    s32 tiles      = (height + tile_rows - 1) / tile_rows;
+    s32 band_tiles = (tiles + (s32)post->bands_count - 1) / (s32)post->bands_count;
+
+    for(u32 i = 0; i < post->bands_count; ++i)
+    {
+        post->bands[i].first_row = MIN((s32)i * band_tiles * tile_rows, height);
+        post->bands[i].rows_end  = MIN(((s32)i + 1) * band_tiles * tile_rows, height);
+    }
+
+    if(post->jobs)
+    {
+        JobWorker *worker = job_system_main_worker(post->jobs);
+        JobCounter bands  = {0};
+
+        for(u32 i = 1; i < post->bands_count; ++i)
+        {
+            job_submit(worker, post_process_band_job, &post->bands[i], &bands);
+        }
+
+        post_process_band(post, &post->bands[0]);
+        job_wait(worker, &bands);
+    }
+    else
+    {
+        post_process_band(post, &post->bands[0]);
+    }
+
+    for(u32 pass = 0; pass < POST_PASSES_COUNT; ++pass)
+    {
+        s64 ticks = 0;
+
+        for(u32 i = 0; i < post->bands_count; ++i)
+        {
+            ticks += post->bands[i].pass_ticks[pass];
+        }
+
+        __atomic_store_n(&post->stats.pass_ticks[pass], ticks, __ATOMIC_RELAXED);
+    }
+
+    __atomic_store_n(&post->stats.frame_ticks, os_get_cpu_tick() - begin, __ATOMIC_RELAXED);
+    post->stats.frames_processed++;
+}
+
+// NOTE(leo): From another thread than the one running the passes. The times of the last
+// frame, pass_ticks gets each pass'. Returns the frame's.
+INTERNAL s64
+post_process_last_ticks(PostProcess *post, s64 *pass_ticks)
+{
+    for(u32 pass = 0; pass < POST_PASSES_COUNT; ++pass)
+    {
+        pass_ticks[pass] = __atomic_load_n(&post->stats.pass_ticks[pass], __ATOMIC_RELAXED);
+    }
+
+    return __atomic_load_n(&post->stats.frame_ticks, __ATOMIC_RELAXED);
+}
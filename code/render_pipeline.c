@@ -0,0 +1,539 @@
+// NOTE(leo): Renders on a thread of its own, so the platform's main thread can simulate the
+// next tick (and present the last frame) while the current one is rasterized.
+//
+// The main thread submits the state to draw through a mailbox: three copies of the state,
+// the producer's, the consumer's and the one in between, which each side swaps its own with
+// one atomic exchange. Nobody waits: the render thread always draws the newest state, and if
+// the main thread submits twice before it gets there, the older state is skipped.
+//
+// The frames go back through two back buffers. The render thread alternates between them,
+// so it never draws over the newest finished frame, and the main thread presents the newest
+// one that's ready. Each buffer has a state changed with compare and swap. The only wait is
+// the render thread's, when the buffer it's about to draw into is being presented.
+//
+// On a machine with a single processor there is no thread: submitting renders right away,
+// and the rest works the same way.
+//
+// With post-processing on (see post_process.c), the frame is rendered into the
+// post-process' scene buffer, and the passes write it into the back buffer. The passes are
+// cut across the pipeline's job system. Whoever renders is its worker 0: the render thread,
+// which gets the role when the main thread starts it, or the main thread without one.
+//
+// The particles (see particles.c) are simulated by the main thread. Every state submitted
+// takes a copy of the live ones, into a pool of its own allocated up front.
+
+#define RENDER_PIPELINE_BUFFERS_COUNT 2
+
+// NOTE(leo): Set in the mailbox's shared index when it holds a state the render thread
+// hasn't taken yet.
+#define RENDER_STATE_IS_NEW 0x80000000u
+
+// ===========================================================================================
+
+typedef enum
+{
+    RENDER_BUFFER_FREE,
+    RENDER_BUFFER_RENDERING,
+    RENDER_BUFFER_READY,
+    RENDER_BUFFER_PRESENTING
+
+} RenderBufferState;
+
+#define RENDER_OVERLAY_TEXT_CAPACITY 64
+
+typedef struct
+{
+    GameState game_state;
+    u64       frame;
+
+    char overlay_text[RENDER_OVERLAY_TEXT_CAPACITY];
+    u32  overlay_text_length;
+
+    b32 is_post_processing;
+
+    ParticleSystem particles;
+
+} RenderState;
+
+typedef struct
+{
+    u64 frames_rendered;
+
+    // NOTE(leo): States replaced by a newer one before the render thread got to them.
+    u64 states_skipped;
+
+    // NOTE(leo): Frames rendered over before they were presented.
+    u64 frames_dropped;
+
+    u64 frames_presented;
+
+    // NOTE(leo): In os_get_cpu_tick ticks. Read it with render_pipeline_last_render_ticks.
+    s64 last_render_ticks;
+
+} RenderPipelineStats;
+
+typedef struct
+{
+    b32 is_threaded;
+
+    // NOTE(leo): The mailbox. producer_state is only touched by the main thread and
+    // consumer_state by the render thread.
+    RenderState states[3];
+    u32         producer_state;
+    u32         consumer_state;
+    u32         shared_state;
+    u64         frames_submitted;
+
+    // NOTE(leo): The platform sets the buffers up, and only changes them after
+    // render_pipeline_wait_idle. buffer_frames[i] is the frame last rendered into
+    // buffer i.
+    BackBuffer back_buffers[RENDER_PIPELINE_BUFFERS_COUNT];
+    u32        buffer_states[RENDER_PIPELINE_BUFFERS_COUNT];
+    u64        buffer_frames[RENDER_PIPELINE_BUFFERS_COUNT];
+    u32        next_buffer;
+    u64        last_rendered_frame;
+    s32        last_presented_buffer;
+
+    OsThread    thread;
+    OsSemaphore state_submitted;
+    b32         is_stopping;
+
+    // NOTE(leo): is_post_processing is the main thread's, every state submitted takes it.
+    // was_post_processing is the render thread's, whether the last frame was.
+    PostProcess post_process;
+    b32         is_post_processing;
+    b32         was_post_processing;
+
+    // NOTE(leo): Only started with more than one post-process worker.
+    JobSystem jobs;
+    b32       has_jobs;
+
+    // NOTE(leo): The main thread's, see render_pipeline_set_particles.
+    ParticleSystem *particles;
+
+#ifdef SPAN_RENDERING
+    DrawList draw_list;
+#else
+    Compositor compositor;
+#endif // SPAN_RENDERING
+
+    RenderPipelineStats stats;
+
+} RenderPipeline;
+
+// ===========================================================================================
+
+// NOTE(leo): Render side. Draws the state into the buffer after the one drawn last.
+INTERNAL void
+render_pipeline_render(RenderPipeline *pipeline, RenderState *state)
+{
+    u32 buffer = pipeline->next_buffer;
+
+    for(;;)
+    {
+        u32 buffer_state =
+            __atomic_load_n(&pipeline->buffer_states[buffer], __ATOMIC_ACQUIRE);
+
+        if(buffer_state != RENDER_BUFFER_PRESENTING
+           && __atomic_compare_exchange_n(&pipeline->buffer_states[buffer],
+                                          &buffer_state,
+                                          RENDER_BUFFER_RENDERING,
+                                          false,
+                                          __ATOMIC_ACQUIRE,
+                                          __ATOMIC_RELAXED))
+        {
+            if(buffer_state == RENDER_BUFFER_READY)
+            {
+                pipeline->stats.frames_dropped++;
+            }
+
+            break;
+        }
+
+        // NOTE(leo): A present is one copy, it doesn't take long.
+        os_yield_processor();
+    }
+
+    s64 render_begin = os_get_cpu_tick();
+
+    String8 overlay_text = {state->overlay_text, state->overlay_text_length};
+
+    BackBuffer  *back_buffer  = &pipeline->back_buffers[buffer];
+    PostProcess *post_process = &pipeline->post_process;
+
+    b32 is_post_processing = state->is_post_processing
+                             && back_buffer->format == BACK_BUFFER_RGB
+                             && post_process_prepare(post_process, back_buffer);
+
+    if(is_post_processing != pipeline->was_post_processing)
+    {
+        // NOTE(leo): Otherwise what was shown before it was turned off fades in and out.
+        if(is_post_processing)
+        {
+            post_process_clear_history(post_process);
+        }
+
+#ifndef SPAN_RENDERING
+        // NOTE(leo): The compositor remembers what it drew into the back buffers, but the
+        // passes wrote over them, and it never drew into the scene buffer. When the scene
+        // buffer is reallocated for a new size, render_pipeline_set_back_buffers already
+        // invalidated it.
+        compositor_invalidate(&pipeline->compositor);
+#endif // SPAN_RENDERING
+
+        pipeline->was_post_processing = is_post_processing;
+    }
+
+    g_back_buffer  = is_post_processing ? post_process->scene : *back_buffer;
+    g_overlay_text = overlay_text;
+    g_particles    = &state->particles;
+
+#ifdef SPAN_RENDERING
+    game_render_spans(&state->game_state, &pipeline->draw_list);
+#else
+    game_render_layers(&state->game_state, &pipeline->compositor);
+#endif // SPAN_RENDERING
+
+    if(is_post_processing)
+    {
+        post_process_run(post_process, back_buffer);
+    }
+
+    __atomic_store_n(&pipeline->stats.last_render_ticks,
+                     os_get_cpu_tick() - render_begin,
+                     __ATOMIC_RELAXED);
+
+    // NOTE(leo): The main thread can read it while looking for the newest frame, even
+    // though it won't take this buffer.
+    __atomic_store_n(&pipeline->buffer_frames[buffer], state->frame, __ATOMIC_RELAXED);
+
+    pipeline->next_buffer = (buffer + 1) % RENDER_PIPELINE_BUFFERS_COUNT;
+    pipeline->stats.frames_rendered++;
+
+    __atomic_store_n(&pipeline->buffer_states[buffer], RENDER_BUFFER_READY, __ATOMIC_RELEASE);
+    __atomic_store_n(&pipeline->last_rendered_frame, state->frame, __ATOMIC_RELEASE);
+}
+
+// NOTE(leo): Render side. Returns NULL if nothing was submitted since the last call.
+INTERNAL RenderState *
+render_pipeline_take_state(RenderPipeline *pipeline)
+{
+    if(!(__atomic_load_n(&pipeline->shared_state, __ATOMIC_ACQUIRE) & RENDER_STATE_IS_NEW))
+    {
+        return NULL;
+    }
+
+    u32 state = __atomic_exchange_n(&pipeline->shared_state,
+                                    pipeline->consumer_state,
+                                    __ATOMIC_ACQ_REL);
+
+    pipeline->consumer_state = state & ~RENDER_STATE_IS_NEW;
+
+    return &pipeline->states[pipeline->consumer_state];
+}
+
+INTERNAL void
+render_pipeline_thread(void *parameter)
+{
+    RenderPipeline *pipeline = parameter;
+
+    for(;;)
+    {
+        os_semaphore_wait(&pipeline->state_submitted);
+
+        if(__atomic_load_n(&pipeline->is_stopping, __ATOMIC_ACQUIRE))
+        {
+            break;
+        }
+
+        // NOTE(leo): Every submit signals, so a wake up can find the state already taken.
+        RenderState *state = render_pipeline_take_state(pipeline);
+
+        if(state)
+        {
+            render_pipeline_render(pipeline, state);
+        }
+    }
+}
+
+// ===========================================================================================
+
+// NOTE(leo): The back buffers must be set up before the first submit. post_process_workers
+// is how many workers the post-process cuts its frames across, the thread rendering
+// included. Returns false if a thread couldn't be started.
+INTERNAL b32
+render_pipeline_init(RenderPipeline *pipeline, b32 is_threaded, u32 post_process_workers)
+{
+    memset(pipeline, 0, sizeof(*pipeline));
+
+    if(post_process_workers > 1)
+    {
+        JobSystemConfig config = {0};
+        config.workers_count   = post_process_workers;
+
+        if(!job_system_init(&pipeline->jobs, &config))
+        {
+            return false;
+        }
+
+        pipeline->has_jobs = true;
+    }
+
+    post_process_init(&pipeline->post_process, pipeline->has_jobs ? &pipeline->jobs : NULL);
+
+    pipeline->producer_state = 0;
+    pipeline->shared_state   = 1;
+    pipeline->consumer_state = 2;
+    pipeline->is_threaded    = is_threaded;
+
+    pipeline->last_presented_buffer = -1;
+
+    if(is_threaded)
+    {
+        b32 has_semaphore = os_semaphore_init(&pipeline->state_submitted, 0);
+
+        if(!has_semaphore
+           || !os_thread_create(&pipeline->thread, render_pipeline_thread, pipeline))
+        {
+            if(has_semaphore)
+            {
+                os_semaphore_destroy(&pipeline->state_submitted);
+            }
+
+            post_process_shutdown(&pipeline->post_process);
+
+            if(pipeline->has_jobs)
+            {
+                job_system_shutdown(&pipeline->jobs);
+            }
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+INTERNAL void
+render_pipeline_shutdown(RenderPipeline *pipeline)
+{
+    if(pipeline->is_threaded)
+    {
+        __atomic_store_n(&pipeline->is_stopping, true, __ATOMIC_RELEASE);
+        os_semaphore_signal(&pipeline->state_submitted, 1);
+        os_thread_join(&pipeline->thread);
+        os_semaphore_destroy(&pipeline->state_submitted);
+    }
+
+    post_process_shutdown(&pipeline->post_process);
+
+    if(pipeline->has_jobs)
+    {
+        job_system_shutdown(&pipeline->jobs);
+    }
+
+    for(u32 i = 0; i < STATIC_ARRAY_LENGTH(pipeline->states); ++i)
+    {
+        particles_destroy(&pipeline->states[i].particles);
+    }
+
+#ifndef SPAN_RENDERING
+    compositor_destroy(&pipeline->compositor);
+#endif // SPAN_RENDERING
+}
+
+// NOTE(leo): Main thread. Copies the state and the overlay text (drawn over the frame, see
+// render_overlay_text, cut at RENDER_OVERLAY_TEXT_CAPACITY), the caller can change them
+// right away.
+INTERNAL void
+render_pipeline_submit(RenderPipeline *pipeline, GameState *game_state, String8 overlay_text)
+{
+    RenderState *state        = &pipeline->states[pipeline->producer_state];
+    state->game_state         = *game_state;
+    state->frame              = ++pipeline->frames_submitted;
+    state->is_post_processing = pipeline->is_post_processing;
+
+    if(pipeline->particles)
+    {
+        particles_copy(&state->particles, pipeline->particles);
+    }
+
+    state->overlay_text_length = MIN(overlay_text.length, RENDER_OVERLAY_TEXT_CAPACITY);
+    memcpy(state->overlay_text, overlay_text.data, state->overlay_text_length);
+
+    if(!pipeline->is_threaded)
+    {
+        render_pipeline_render(pipeline, state);
+        return;
+    }
+
+    u32 previous = __atomic_exchange_n(&pipeline->shared_state,
+                                       pipeline->producer_state | RENDER_STATE_IS_NEW,
+                                       __ATOMIC_ACQ_REL);
+
+    if(previous & RENDER_STATE_IS_NEW)
+    {
+        pipeline->stats.states_skipped++;
+    }
+
+    pipeline->producer_state = previous & ~RENDER_STATE_IS_NEW;
+
+    os_semaphore_signal(&pipeline->state_submitted, 1);
+}
+
+// NOTE(leo): Main thread. Returns the index of the newest finished frame's buffer, which
+// stays untouched until render_pipeline_release_frame, or -1 if no frame was finished since
+// the last one presented. With can_repeat, that last one is returned instead, if the render
+// thread hasn't started drawing over it (for a window that has to be painted again).
+INTERNAL s32
+render_pipeline_acquire_frame(RenderPipeline *pipeline, b32 can_repeat)
+{
+    for(;;)
+    {
+        s32 newest       = -1;
+        u64 newest_frame = 0;
+
+        for(u32 i = 0; i < RENDER_PIPELINE_BUFFERS_COUNT; ++i)
+        {
+            u64 frame = __atomic_load_n(&pipeline->buffer_frames[i], __ATOMIC_RELAXED);
+
+            if(__atomic_load_n(&pipeline->buffer_states[i], __ATOMIC_ACQUIRE)
+                   == RENDER_BUFFER_READY
+               && (newest < 0 || frame > newest_frame))
+            {
+                newest       = (s32)i;
+                newest_frame = frame;
+            }
+        }
+
+        if(newest < 0)
+        {
+            break;
+        }
+
+        // NOTE(leo): Fails if the render thread just started drawing over it, then there
+        // may be another one.
+        u32 ready = RENDER_BUFFER_READY;
+
+        if(__atomic_compare_exchange_n(&pipeline->buffer_states[newest],
+                                       &ready,
+                                       RENDER_BUFFER_PRESENTING,
+                                       false,
+                                       __ATOMIC_ACQUIRE,
+                                       __ATOMIC_RELAXED))
+        {
+            pipeline->last_presented_buffer = newest;
+            pipeline->stats.frames_presented++;
+
+            return newest;
+        }
+    }
+
+    s32 last       = pipeline->last_presented_buffer;
+    u32 free_state = RENDER_BUFFER_FREE;
+
+    // NOTE(leo): The render thread only comes back to the last presented buffer after it
+    // finished the other one, so if it's still free it still has the last frame.
+    if(can_repeat && last >= 0
+       && __atomic_compare_exchange_n(&pipeline->buffer_states[last],
+                                      &free_state,
+                                      RENDER_BUFFER_PRESENTING,
+                                      false,
+                                      __ATOMIC_ACQUIRE,
+                                      __ATOMIC_RELAXED))
+    {
+        return last;
+    }
+
+    return -1;
+}
+
+INTERNAL void
+render_pipeline_release_frame(RenderPipeline *pipeline, s32 buffer)
+{
+    __atomic_store_n(&pipeline->buffer_states[buffer], RENDER_BUFFER_FREE, __ATOMIC_RELEASE);
+}
+
+// NOTE(leo): Main thread. How long the last frame took to render, without the time spent
+// waiting for its buffer.
+INTERNAL s64
+render_pipeline_last_render_ticks(RenderPipeline *pipeline)
+{
+    return __atomic_load_n(&pipeline->stats.last_render_ticks, __ATOMIC_RELAXED);
+}
+
+// NOTE(leo): Main thread. Waits for the render thread to finish the frame, or a newer one.
+INTERNAL void
+render_pipeline_wait_for_frame(RenderPipeline *pipeline, u64 frame)
+{
+    while(__atomic_load_n(&pipeline->last_rendered_frame, __ATOMIC_ACQUIRE) < frame)
+    {
+        os_yield_processor();
+    }
+}
+
+// NOTE(leo): Main thread. Waits for the render thread to finish every state submitted, so
+// the platform can change the back buffers.
+INTERNAL void
+render_pipeline_wait_idle(RenderPipeline *pipeline)
+{
+    render_pipeline_wait_for_frame(pipeline, pipeline->frames_submitted);
+}
+
+// NOTE(leo): Main thread, after render_pipeline_wait_idle. The old frames are thrown away,
+// they were drawn at the old size.
+INTERNAL void
+render_pipeline_set_back_buffers(RenderPipeline *pipeline, BackBuffer *back_buffers)
+{
+    for(u32 i = 0; i < RENDER_PIPELINE_BUFFERS_COUNT; ++i)
+    {
+        ASSERT(pipeline->buffer_states[i] != RENDER_BUFFER_RENDERING
+               && pipeline->buffer_states[i] != RENDER_BUFFER_PRESENTING);
+
+        pipeline->back_buffers[i]  = back_buffers[i];
+        pipeline->buffer_states[i] = RENDER_BUFFER_FREE;
+    }
+
+    pipeline->last_presented_buffer = -1;
+
+    // NOTE(leo): Here rather than on the first frame at the new size, the render thread is
+    // idle anyway. If it fails, the render thread tries again and renders without it.
+    if(pipeline->is_post_processing && back_buffers[0].format == BACK_BUFFER_RGB)
+    {
+        post_process_prepare(&pipeline->post_process, &back_buffers[0]);
+    }
+
+#ifndef SPAN_RENDERING
+    compositor_invalidate(&pipeline->compositor);
+#endif // SPAN_RENDERING
+}
+
+// NOTE(leo): Main thread. Takes effect from the next state submitted.
+INTERNAL void
+render_pipeline_set_post_processing(RenderPipeline *pipeline, b32 is_post_processing)
+{
+    pipeline->is_post_processing = is_post_processing;
+}
+
+// NOTE(leo): Main thread, before the first submit. Every state submitted from then on draws
+// the particles live in particles when it's submitted. Returns false if there isn't enough
+// memory for the states' copies, then none are drawn.
+INTERNAL b32
+render_pipeline_set_particles(RenderPipeline *pipeline, ParticleSystem *particles)
+{
+    pipeline->particles = NULL;
+
+    for(u32 i = 0; i < STATIC_ARRAY_LENGTH(pipeline->states); ++i)
+    {
+        particles_destroy(&pipeline->states[i].particles);
+
+        if(!particles_init(&pipeline->states[i].particles, particles->capacity, 0))
+        {
+            return false;
+        }
+    }
+
+    pipeline->particles = particles;
+
+    return true;
+}
@@ -0,0 +1,358 @@
+// NOTE(leo): Input recording and deterministic replay. The file has the RNG seed the match
+// was started with, the final GameState (to verify the replay bit for bit) and one varint per
+// record. The lowest bit of the varint tells whether it's a tick or a rewind.
+//
+// A tick packs the keys that changed since the last tick in the next KEYS_COUNT bits and the
+// zigzag encoded difference between the bits of this tick's delta time and the last one in
+// the remaining bits. A tick that changes no key and has the same delta time as the last one
+// costs a single byte, and real frame times cost about three.
+//
+// Every tick is followed by the running checksum of the state after it (see
+// game_state_checksum), so a replay that diverges is caught on the tick it happens, not at
+// the end of the match.
+//
+// A rewind has how many ticks the match went back in time (see snapshot_ring.c). Replaying
+// it needs a snapshot ring with at least the same capacity as the one used when recording.
+//
+// Layout: ReplayHeader | GameState final_state | records...
+
+#define REPLAY_MAGIC   0x4C505250 // NOTE(leo): "PRPL" in little endian.
+#define REPLAY_VERSION 4
+
+#define REPLAY_RECORD_REWIND_BIT 1
+
+#define REPLAY_TICK_CHECKSUM_SIZE 4
+
+// NOTE(leo): Float and fixed point builds don't produce the same states, so a replay only
+// plays on the kind of build it was recorded with.
+#define REPLAY_FIXED_POINT_PHYSICS_FLAG 1
+
+#ifdef FIXED_POINT_PHYSICS
+    #define REPLAY_FLAGS REPLAY_FIXED_POINT_PHYSICS_FLAG
+#else
+    #define REPLAY_FLAGS 0
+#endif // FIXED_POINT_PHYSICS
+
+// NOTE(leo): At 60 ticks per second and a few bytes per tick, this is many hours of play.
+#define REPLAY_RECORDER_CAPACITY (16 * 1024 * 1024)
+
+#define REPLAY_MAX_VARINT_BYTES 10
+
+// ===========================================================================================
+
+typedef struct
+{
+    u32 magic;
+    u32 version;
+    u64 rng_state;
+    u64 rng_sequence;
+    u64 records_count;
+    u32 game_state_size;
+    u32 keys_count;
+    u32 flags;
+
+} ReplayHeader;
+
+typedef struct
+{
+    // NOTE(leo): The header and the final state are reserved at the beginning of the buffer,
+    // so saving is a single write.
+    u8 *buffer;
+    u64 capacity;
+    u64 size;
+
+    u32 last_keys_mask;
+    u32 last_delta_time_bits;
+    u32 last_checksum;
+    b32 is_full;
+
+} ReplayRecorder;
+
+typedef struct
+{
+    ReplayHeader *header;
+    GameState    *final_state;
+    u8           *at;
+    u8           *end;
+
+    u64 records_read;
+    u32 keys_mask;
+    u32 delta_time_bits;
+
+    // NOTE(leo): The running checksum of the state after the last tick read.
+    u32 tick_checksum;
+
+} ReplayPlayer;
+
+typedef enum
+{
+    REPLAY_RECORD_END,
+    REPLAY_RECORD_TICK,
+    REPLAY_RECORD_REWIND
+
+} ReplayRecordType;
+
+// ===========================================================================================
+
+INTERNAL u8 *
+replay_write_varint(u8 *at, u64 value)
+{
+    while(value >= 0x80)
+    {
+        *at++ = (u8)(value | 0x80);
+        value >>= 7;
+    }
+
+    *at++ = (u8)value;
+
+    return at;
+}
+
+// NOTE(leo): Returns NULL if the varint goes past the end.
+INTERNAL u8 *
+replay_read_varint(u8 *at, u8 *end, u64 *value)
+{
+    u64 result = 0;
+    u32 shift  = 0;
+
+    for(;;)
+    {
+        if(at >= end || shift >= 64)
+        {
+            return NULL;
+        }
+
+        u8 byte = *at++;
+        result |= (u64)(byte & 0x7F) << shift;
+        shift += 7;
+
+        if(!(byte & 0x80))
+        {
+            break;
+        }
+    }
+
+    *value = result;
+
+    return at;
+}
+
+INTERNAL u32
+replay_keys_mask_from_input(GameInput *input)
+{
+    u32 keys_mask = 0;
+
+    for(u32 key = 0; key < KEYS_COUNT; ++key)
+    {
+        if(input->is_key_down[key])
+        {
+            keys_mask |= (u32)1 << key;
+        }
+    }
+
+    return keys_mask;
+}
+
+INTERNAL void
+replay_recorder_init(ReplayRecorder *recorder, u64 capacity, u64 rng_state, u64 rng_sequence)
+{
+    memset(recorder, 0, sizeof(*recorder));
+
+    recorder->buffer   = malloc(capacity);
+    recorder->capacity = recorder->buffer ? capacity : 0;
+    recorder->size     = sizeof(ReplayHeader) + sizeof(GameState);
+
+    if(recorder->capacity < recorder->size)
+    {
+        // NOTE(leo): Recording is a debugging aid, the game runs fine without it.
+        recorder->is_full = true;
+        return;
+    }
+
+    ReplayHeader *header = (ReplayHeader *)recorder->buffer;
+    memset(header, 0, sizeof(ReplayHeader) + sizeof(GameState));
+
+    header->magic           = REPLAY_MAGIC;
+    header->version         = REPLAY_VERSION;
+    header->rng_state       = rng_state;
+    header->rng_sequence    = rng_sequence;
+    header->game_state_size = sizeof(GameState);
+    header->keys_count      = KEYS_COUNT;
+    header->flags           = REPLAY_FLAGS;
+}
+
+INTERNAL b32
+replay_write_record(ReplayRecorder *recorder, u64 record, GameState *game_state)
+{
+    if(recorder->is_full)
+    {
+        return false;
+    }
+
+    if(recorder->size + REPLAY_MAX_VARINT_BYTES + REPLAY_TICK_CHECKSUM_SIZE
+       > recorder->capacity)
+    {
+        // NOTE(leo): We stop here and keep the state of the last recorded tick as the final
+        // state, so the replay still verifies.
+        recorder->is_full = true;
+        return false;
+    }
+
+    u8 *at = replay_write_varint(recorder->buffer + recorder->size, record);
+
+    if(!(record & REPLAY_RECORD_REWIND_BIT))
+    {
+        u32 checksum = game_state_checksum(game_state, recorder->last_checksum);
+
+        for(u32 i = 0; i < REPLAY_TICK_CHECKSUM_SIZE; ++i)
+        {
+            *at++ = (u8)(checksum >> (i * 8));
+        }
+
+        recorder->last_checksum = checksum;
+    }
+
+    recorder->size = (u64)(at - recorder->buffer);
+
+    ReplayHeader *header = (ReplayHeader *)recorder->buffer;
+    header->records_count++;
+
+    memcpy(recorder->buffer + sizeof(ReplayHeader), game_state, sizeof(GameState));
+
+    return true;
+}
+
+// NOTE(leo): Must be called once per game_update, with the same input and delta time, after
+// the update.
+INTERNAL void
+replay_record_tick(ReplayRecorder *recorder,
+                   GameInput      *input,
+                   f32             delta_time_seconds,
+                   GameState      *game_state)
+{
+    u32 keys_mask = replay_keys_mask_from_input(input);
+    u32 delta_time_bits;
+    memcpy(&delta_time_bits, &delta_time_seconds, sizeof(delta_time_bits));
+
+    s32 delta_time_difference = (s32)(delta_time_bits - recorder->last_delta_time_bits);
+    u32 zigzag = ((u32)delta_time_difference << 1) ^ (u32)(delta_time_difference >> 31);
+
+    u64 record = ((u64)zigzag << KEYS_COUNT) | (keys_mask ^ recorder->last_keys_mask);
+
+    if(replay_write_record(recorder, record << 1, game_state))
+    {
+        recorder->last_keys_mask       = keys_mask;
+        recorder->last_delta_time_bits = delta_time_bits;
+    }
+}
+
+// NOTE(leo): The match went back the given number of ticks and continues from the given
+// state.
+INTERNAL void
+replay_record_rewind(ReplayRecorder *recorder, u64 ticks_back, GameState *game_state)
+{
+    replay_write_record(recorder, (ticks_back << 1) | REPLAY_RECORD_REWIND_BIT, game_state);
+}
+
+INTERNAL b32
+replay_save(ReplayRecorder *recorder, char *file_path)
+{
+    b32 result = false;
+
+    if(recorder->buffer)
+    {
+        result = os_write_entire_file(file_path, recorder->buffer, recorder->size);
+    }
+
+    return result;
+}
+
+// NOTE(leo): The player points into the file contents, so they must outlive it.
+INTERNAL b32
+replay_player_open(ReplayPlayer *player, FileContents file)
+{
+    memset(player, 0, sizeof(*player));
+
+    if(!file.data || file.size < sizeof(ReplayHeader) + sizeof(GameState))
+    {
+        return false;
+    }
+
+    ReplayHeader *header = (ReplayHeader *)file.data;
+
+    if(header->magic != REPLAY_MAGIC || header->version != REPLAY_VERSION
+       || header->game_state_size != sizeof(GameState) || header->keys_count != KEYS_COUNT
+       || header->flags != REPLAY_FLAGS)
+    {
+        return false;
+    }
+
+    player->header      = header;
+    player->final_state = (GameState *)(file.data + sizeof(ReplayHeader));
+    player->at          = file.data + sizeof(ReplayHeader) + sizeof(GameState);
+    player->end         = file.data + file.size;
+
+    return true;
+}
+
+// NOTE(leo): On REPLAY_RECORD_TICK, input, delta_time_seconds and the player's
+// tick_checksum are filled. On REPLAY_RECORD_REWIND, ticks_back is filled. REPLAY_RECORD_END
+// is also returned if the file is truncated.
+INTERNAL ReplayRecordType
+replay_next_record(ReplayPlayer *player,
+                   GameInput    *input,
+                   f32          *delta_time_seconds,
+                   u64          *ticks_back)
+{
+    if(player->records_read >= player->header->records_count)
+    {
+        return REPLAY_RECORD_END;
+    }
+
+    u64 record;
+    player->at = replay_read_varint(player->at, player->end, &record);
+
+    if(!player->at)
+    {
+        return REPLAY_RECORD_END;
+    }
+
+    player->records_read++;
+
+    if(record & REPLAY_RECORD_REWIND_BIT)
+    {
+        *ticks_back = record >> 1;
+        return REPLAY_RECORD_REWIND;
+    }
+
+    if(player->end - player->at < REPLAY_TICK_CHECKSUM_SIZE)
+    {
+        return REPLAY_RECORD_END;
+    }
+
+    player->tick_checksum = 0;
+
+    for(u32 i = 0; i < REPLAY_TICK_CHECKSUM_SIZE; ++i)
+    {
+        player->tick_checksum |= (u32)player->at[i] << (i * 8);
+    }
+
+    player->at += REPLAY_TICK_CHECKSUM_SIZE;
+
+    record >>= 1;
+
+    u32 zigzag                = (u32)(record >> KEYS_COUNT);
+    s32 delta_time_difference = (s32)((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+
+    player->keys_mask ^= (u32)(record & ((1 << KEYS_COUNT) - 1));
+    player->delta_time_bits += (u32)delta_time_difference;
+
+    for(u32 key = 0; key < KEYS_COUNT; ++key)
+    {
+        input->is_key_down[key] = GET_BIT(player->keys_mask, key);
+    }
+
+    memcpy(delta_time_seconds, &player->delta_time_bits, sizeof(*delta_time_seconds));
+
+    return REPLAY_RECORD_TICK;
+}
@@ -0,0 +1,148 @@
+// NOTE(leo): Picks the resolution frames are rendered at. Rendering costs about as much as
+// the pixels it fills, so when the frames take longer than the budget, the governor lowers
+// the scale of the back buffer relative to the window, and the platform stretches the frames
+// back up when presenting them (nearest neighbour, everything we draw is an axis-aligned
+// rectangle, so it stays sharp).
+//
+// It looks at the average of the last RESOLUTION_GOVERNOR_WINDOW frames, not at single
+// frames, and only once a whole window was measured at the current scale. Lowering happens
+// when the average goes over the budget. Raising happens when the average, scaled by how
+// many more pixels the next scale has, would still be well under it. The gap between the
+// two is what keeps it from going back and forth between two scales.
+
+#define RESOLUTION_GOVERNOR_WINDOW 32
+
+// NOTE(leo): Fractions of RESOLUTION_SCALE_DENOMINATOR. The integer ones come first to
+// mind, but the steps between them are too big at the top.
+#define RESOLUTION_SCALE_DENOMINATOR 12
+
+GLOBAL u32 g_resolution_scales[] = {12, 10, 8, 6, 4, 3};
+
+// NOTE(leo): The part of a frame the platform layers give to rendering.
+#define RESOLUTION_GOVERNOR_FRAME_FRACTION 0.75f
+
+// NOTE(leo): Raising only when the next scale is predicted to take at most this much of the
+// budget.
+#define RESOLUTION_GOVERNOR_RAISE_FRACTION 0.75f
+
+// ===========================================================================================
+
+typedef struct
+{
+    f32 budget_seconds;
+
+    f32 samples[RESOLUTION_GOVERNOR_WINDOW];
+    f32 samples_sum;
+    u32 samples_count;
+    u32 next_sample;
+
+    // NOTE(leo): Index in g_resolution_scales.
+    u32 level;
+    u32 changes_count;
+
+} ResolutionGovernor;
+
+// ===========================================================================================
+
+INTERNAL void
+resolution_governor_init(ResolutionGovernor *governor, f32 budget_seconds)
+{
+    memset(governor, 0, sizeof(*governor));
+    governor->budget_seconds = budget_seconds;
+}
+
+INTERNAL u32
+resolution_governor_scale(ResolutionGovernor *governor)
+{
+    return g_resolution_scales[governor->level];
+}
+
+// NOTE(leo): The size to render at for a window area of output_width by output_height.
+INTERNAL void
+resolution_governor_apply(ResolutionGovernor *governor,
+                          s32                 output_width,
+                          s32                 output_height,
+                          s32                *render_width,
+                          s32                *render_height)
+{
+    s32 scale = (s32)resolution_governor_scale(governor);
+
+    *render_width  = (output_width * scale) / RESOLUTION_SCALE_DENOMINATOR;
+    *render_height = (output_height * scale) / RESOLUTION_SCALE_DENOMINATOR;
+
+    if(*render_width < 1)
+    {
+        *render_width = 1;
+    }
+
+    if(*render_height < 1)
+    {
+        *render_height = 1;
+    }
+}
+
+INTERNAL f32
+resolution_governor_average(ResolutionGovernor *governor)
+{
+    return governor->samples_count ? governor->samples_sum / (f32)governor->samples_count
+                                   : 0.0f;
+}
+
+// NOTE(leo): Takes how long the last frame took, the part of it that depends on the
+// resolution. Returns true if the scale changed, then the back buffer has to be resized.
+INTERNAL b32
+resolution_governor_update(ResolutionGovernor *governor, f32 frame_seconds)
+{
+    if(governor->samples_count == RESOLUTION_GOVERNOR_WINDOW)
+    {
+        governor->samples_sum -= governor->samples[governor->next_sample];
+    }
+    else
+    {
+        governor->samples_count++;
+    }
+
+    governor->samples[governor->next_sample] = frame_seconds;
+    governor->samples_sum += frame_seconds;
+    governor->next_sample = (governor->next_sample + 1) % RESOLUTION_GOVERNOR_WINDOW;
+
+    if(governor->samples_count < RESOLUTION_GOVERNOR_WINDOW)
+    {
+        return false;
+    }
+
+    f32 average   = resolution_governor_average(governor);
+    u32 old_level = governor->level;
+
+    if(average > governor->budget_seconds)
+    {
+        if(governor->level + 1 < STATIC_ARRAY_LENGTH(g_resolution_scales))
+        {
+            governor->level++;
+        }
+    }
+    else if(governor->level > 0)
+    {
+        f32 scale      = (f32)g_resolution_scales[governor->level];
+        f32 next_scale = (f32)g_resolution_scales[governor->level - 1];
+        f32 predicted  = average * ((next_scale * next_scale) / (scale * scale));
+
+        if(predicted < governor->budget_seconds * RESOLUTION_GOVERNOR_RAISE_FRACTION)
+        {
+            governor->level--;
+        }
+    }
+
+    if(governor->level == old_level)
+    {
+        return false;
+    }
+
+    // NOTE(leo): The samples were measured at the old scale.
+    governor->samples_sum   = 0.0f;
+    governor->samples_count = 0;
+    governor->next_sample   = 0;
+    governor->changes_count++;
+
+    return true;
+}
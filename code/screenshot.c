@@ -0,0 +1,742 @@
+// NOTE(leo): Screenshots that cost the thread taking them one copy. The frame is copied,
+// padding and all, into a buffer from a small pool, and a thread of its own encodes it (to
+// PNG or QOI) and writes the file. When every buffer of the pool is still waiting for its
+// file, taking a screenshot fails right away instead of waiting: the caller decides whether
+// to drop it or to try again with a later frame.
+//
+// The PNGs aren't compressed, their deflate stream is made of stored blocks: they are big,
+// but encoding them is copying and checksums, and anything opens them. QOI files are
+// compressed (a frame is mostly runs of the same color) and quicker to encode, but fewer
+// programs open them.
+
+#define SCREENSHOT_POOL_SIZE      4
+#define SCREENSHOT_PATH_CAPACITY 256
+
+// NOTE(leo): The most a deflate stored block can have.
+#define PNG_STORED_BLOCK_MAX_SIZE 65535
+
+// ===========================================================================================
+
+typedef enum
+{
+    SCREENSHOT_PNG,
+    SCREENSHOT_QOI
+
+} ScreenshotFileFormat;
+
+typedef enum
+{
+    SCREENSHOT_SLOT_FREE,
+    SCREENSHOT_SLOT_QUEUED
+
+} ScreenshotSlotState;
+
+typedef struct
+{
+    // NOTE(leo): The copy of the frame, pixels points to the slot's memory.
+    BackBuffer frame;
+    u64        capacity;
+
+    // NOTE(leo): Slots are encoded in the order they were taken in.
+    u64 sequence;
+
+    ScreenshotFileFormat file_format;
+    char                 path[SCREENSHOT_PATH_CAPACITY];
+
+    // NOTE(leo): A slot that's free belongs to the thread taking the screenshots, a queued
+    // one to the encoding thread.
+    u32 state;
+
+} ScreenshotSlot;
+
+typedef struct
+{
+    u64 captures;
+
+    // NOTE(leo): Captures that failed because every slot was queued.
+    u64 captures_refused;
+
+    // NOTE(leo): Written by the encoding thread, read them after screenshot_pool_wait_idle.
+    u64 files_written;
+    u64 files_failed;
+    u64 bytes_written;
+    s64 encode_ticks;
+    s64 write_ticks;
+
+} ScreenshotStats;
+
+typedef struct
+{
+    ScreenshotSlot slots[SCREENSHOT_POOL_SIZE];
+    u64            next_sequence;
+
+    // NOTE(leo): Only touched by the encoding thread. A row of the frame as 0x00RRGGBB, and
+    // the file being encoded.
+    u32 *row;
+    u64  row_capacity;
+    u8  *encoded;
+    u64  encoded_capacity;
+
+    OsThread    thread;
+    OsSemaphore capture_queued;
+    b32         is_stopping;
+
+    ScreenshotStats stats;
+
+} ScreenshotPool;
+
+// NOTE(leo): Slicing by 8: g_crc32_tables[k][byte] is the CRC of byte followed by k zero
+// bytes, so eight bytes are folded in with eight independent lookups.
+GLOBAL u32 g_crc32_tables[8][256];
+
+// ===========================================================================================
+
+INTERNAL void
+crc32_init_tables(void)
+{
+    for(u32 i = 0; i < 256; ++i)
+    {
+        u32 crc = i;
+
+        for(u32 bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc & 1) ? (0xEDB88320u ^ (crc >> 1)) : (crc >> 1);
+        }
+
+        g_crc32_tables[0][i] = crc;
+    }
+
+    for(u32 i = 0; i < 256; ++i)
+    {
+        for(u32 k = 1; k < 8; ++k)
+        {
+            u32 previous         = g_crc32_tables[k - 1][i];
+            g_crc32_tables[k][i] = g_crc32_tables[0][previous & 0xFF] ^ (previous >> 8);
+        }
+    }
+}
+
+// NOTE(leo): Starts with crc = 0. The tables must be initialized.
+INTERNAL u32
+crc32_update(u32 crc, u8 *data, u64 size)
+{
+    crc = ~crc;
+
+    for(; size >= 8; size -= 8, data += 8)
+    {
+        u32 low  = crc ^ ((u32)data[0] | ((u32)data[1] << 8) | ((u32)data[2] << 16)
+                         | ((u32)data[3] << 24));
+        u32 high = (u32)data[4] | ((u32)data[5] << 8) | ((u32)data[6] << 16)
+                   | ((u32)data[7] << 24);
+
+        crc = g_crc32_tables[7][low & 0xFF] ^ g_crc32_tables[6][(low >> 8) & 0xFF]
+              ^ g_crc32_tables[5][(low >> 16) & 0xFF] ^ g_crc32_tables[4][low >> 24]
+              ^ g_crc32_tables[3][high & 0xFF] ^ g_crc32_tables[2][(high >> 8) & 0xFF]
+              ^ g_crc32_tables[1][(high >> 16) & 0xFF] ^ g_crc32_tables[0][high >> 24];
+    }
+
+    for(u64 i = 0; i < size; ++i)
+    {
+        crc = g_crc32_tables[0][(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
+
+// NOTE(leo): Starts with adler = 1.
+INTERNAL u32
+adler32_update(u32 adler, u8 *data, u64 size)
+{
+    u32 a = adler & 0xFFFF;
+    u32 b = adler >> 16;
+
+    while(size)
+    {
+        // NOTE(leo): The most bytes that can be added before b overflows.
+        u64 chunk_size = MIN(size, 5552);
+
+        for(u64 i = 0; i < chunk_size; ++i)
+        {
+            a += data[i];
+            b += a;
+        }
+
+        a %= 65521;
+        b %= 65521;
+
+        data += chunk_size;
+        size -= chunk_size;
+    }
+
+    return (b << 16) | a;
+}
+
+INTERNAL u8 *
+write_u32_big_endian(u8 *at, u32 value)
+{
+    at[0] = (u8)(value >> 24);
+    at[1] = (u8)(value >> 16);
+    at[2] = (u8)(value >> 8);
+    at[3] = (u8)value;
+
+    return at + 4;
+}
+
+// NOTE(leo): Converts row y of the frame to 0x00RRGGBB.
+INTERNAL void
+screenshot_read_row(BackBuffer *frame, s32 y, u32 *row)
+{
+    u8 *source = (u8 *)frame->pixels + ((u64)y * (u64)frame->pitch);
+
+    switch(frame->format)
+    {
+        case BACK_BUFFER_RGB:
+        {
+            memcpy(row, source, (u64)frame->width * sizeof(u32));
+            break;
+        }
+        case BACK_BUFFER_GRAYSCALE:
+        {
+            for(s32 x = 0; x < frame->width; ++x)
+            {
+                row[x] = (u32)source[x] * 0x010101u;
+            }
+            break;
+        }
+        case BACK_BUFFER_BITPLANE:
+        {
+            BackBuffer source_row = *frame;
+            source_row.pixels     = source;
+            source_row.height     = 1;
+
+            expand_bitplane(&source_row, row, 0);
+            break;
+        }
+        default:
+        {
+            ASSERT(!"Unsupported back buffer format.");
+            break;
+        }
+    }
+}
+
+// NOTE(leo): The most bytes the file can take.
+INTERNAL u64
+screenshot_encoded_capacity(BackBuffer *frame, ScreenshotFileFormat file_format)
+{
+    u64 pixels_count = (u64)frame->width * (u64)frame->height;
+
+    if(file_format == SCREENSHOT_QOI)
+    {
+        // NOTE(leo): The header, 4 bytes for a pixel at worst and the end marker.
+        return 14 + (pixels_count * 4) + 8;
+    }
+
+    // NOTE(leo): Each row starts with its filter. The stored blocks have a 5 bytes header,
+    // the zlib stream 2 bytes of header and 4 of checksum. Then the signature and the
+    // chunks (12 bytes each plus their data): the header, the data and the end.
+    u64 raw_size     = (u64)frame->height * (1 + ((u64)frame->width * 3));
+    u64 blocks_count = MAX((raw_size + PNG_STORED_BLOCK_MAX_SIZE - 1)
+                               / PNG_STORED_BLOCK_MAX_SIZE,
+                           1);
+
+    return 8 + (12 + 13) + (12 + 2 + raw_size + (blocks_count * 5) + 4) + 12;
+}
+
+typedef struct
+{
+    u8 *at;
+    u8 *block_header;
+    u32 block_size;
+    u32 adler;
+
+} PngStoredWriter;
+
+INTERNAL void
+png_stored_close_block(PngStoredWriter *writer, b32 is_final)
+{
+    u16 size         = (u16)writer->block_size;
+    u16 size_inverse = (u16)~size;
+
+    writer->block_header[0] = is_final ? 1 : 0;
+    writer->block_header[1] = (u8)size;
+    writer->block_header[2] = (u8)(size >> 8);
+    writer->block_header[3] = (u8)size_inverse;
+    writer->block_header[4] = (u8)(size_inverse >> 8);
+}
+
+// NOTE(leo): Appends the bytes to the stored blocks, starting a block when the last one is
+// full. A block's header is written when it's full, or by png_stored_close_block at the end.
+INTERNAL void
+png_stored_write(PngStoredWriter *writer, u8 *data, u64 size)
+{
+    writer->adler = adler32_update(writer->adler, data, size);
+
+    while(size)
+    {
+        if(writer->block_size == PNG_STORED_BLOCK_MAX_SIZE)
+        {
+            png_stored_close_block(writer, false);
+
+            writer->block_header = writer->at;
+            writer->block_size   = 0;
+            writer->at += 5;
+        }
+
+        u32 to_copy = (u32)MIN(size, PNG_STORED_BLOCK_MAX_SIZE - writer->block_size);
+
+        memcpy(writer->at, data, to_copy);
+
+        writer->at += to_copy;
+        writer->block_size += to_copy;
+        data += to_copy;
+        size -= to_copy;
+    }
+}
+
+INTERNAL u8 *
+png_begin_chunk(u8 *at, u32 size, char *type)
+{
+    at = write_u32_big_endian(at, size);
+    memcpy(at, type, 4);
+
+    return at + 4;
+}
+
+// NOTE(leo): at is where the chunk's data ended.
+INTERNAL u8 *
+png_end_chunk(u8 *chunk_type, u8 *at)
+{
+    return write_u32_big_endian(at, crc32_update(0, chunk_type, (u64)(at - chunk_type)));
+}
+
+// NOTE(leo): row needs room for a row of the frame, and encoded
+// screenshot_encoded_capacity bytes. Returns the size of the file.
+INTERNAL u64
+screenshot_encode_png(BackBuffer *frame, u32 *row, u8 *encoded)
+{
+    u8 *at = encoded;
+
+    u8 signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    memcpy(at, signature, sizeof(signature));
+    at += sizeof(signature);
+
+    // NOTE(leo): 8 bits per channel, RGB, no interlacing.
+    at       = png_begin_chunk(at, 13, "IHDR");
+    u8 *ihdr = at - 4;
+    at       = write_u32_big_endian(at, (u32)frame->width);
+    at       = write_u32_big_endian(at, (u32)frame->height);
+
+    u8 ihdr_rest[5] = {8, 2, 0, 0, 0};
+    memcpy(at, ihdr_rest, sizeof(ihdr_rest));
+    at = png_end_chunk(ihdr, at + sizeof(ihdr_rest));
+
+    // NOTE(leo): The size of the data is patched in at the end.
+    u8 *idat_size = at;
+    at            = png_begin_chunk(at, 0, "IDAT");
+    u8 *idat      = at - 4;
+
+    // NOTE(leo): Deflate with a 32K window and no dictionary, the check bits make the header
+    // a multiple of 31.
+    *at++ = 0x78;
+    *at++ = 0x01;
+
+    PngStoredWriter writer = {0};
+    writer.block_header    = at;
+    writer.at              = at + 5;
+    writer.adler           = 1;
+
+    u8 *rgb = (u8 *)row;
+
+    for(s32 y = 0; y < frame->height; ++y)
+    {
+        screenshot_read_row(frame, y, row);
+
+        // NOTE(leo): In place, the three bytes of a pixel end before the next pixel starts.
+        for(s32 x = 0; x < frame->width; ++x)
+        {
+            u32 pixel      = row[x];
+            rgb[x * 3]     = (u8)(pixel >> 16);
+            rgb[x * 3 + 1] = (u8)(pixel >> 8);
+            rgb[x * 3 + 2] = (u8)pixel;
+        }
+
+        u8 filter = 0;
+        png_stored_write(&writer, &filter, 1);
+        png_stored_write(&writer, rgb, (u64)frame->width * 3);
+    }
+
+    png_stored_close_block(&writer, true);
+
+    at = write_u32_big_endian(writer.at, writer.adler);
+
+    write_u32_big_endian(idat_size, (u32)(at - idat - 4));
+    at = png_end_chunk(idat, at);
+
+    at = png_begin_chunk(at, 0, "IEND");
+    at = png_end_chunk(at - 4, at);
+
+    return (u64)(at - encoded);
+}
+
+// NOTE(leo): See https://qoiformat.org/qoi-specification.pdf. The frame has no alpha, so
+// the file has three channels and the QOI_OP_RGBA op is never needed.
+INTERNAL u64
+screenshot_encode_qoi(BackBuffer *frame, u32 *row, u8 *encoded)
+{
+    u8 *at = encoded;
+
+    memcpy(at, "qoif", 4);
+    at    = write_u32_big_endian(at + 4, (u32)frame->width);
+    at    = write_u32_big_endian(at, (u32)frame->height);
+    *at++ = 3; // NOTE(leo): Channels.
+    *at++ = 0; // NOTE(leo): sRGB with linear alpha.
+
+    // NOTE(leo): The decoder's index starts as RGBA (0, 0, 0, 0), which no opaque pixel
+    // matches, so the slots start as a value no pixel can have. previous starts as
+    // (0, 0, 0, 255) for both.
+    u32 index[64];
+    u32 previous = 0;
+    u32 run      = 0;
+
+    memset(index, 0xFF, sizeof(index));
+
+    for(s32 y = 0; y < frame->height; ++y)
+    {
+        screenshot_read_row(frame, y, row);
+
+        for(s32 x = 0; x < frame->width; ++x)
+        {
+            u32 pixel = row[x] & 0xFFFFFF;
+
+            if(pixel == previous)
+            {
+                run++;
+
+                if(run == 62)
+                {
+                    *at++ = (u8)(0xC0 | (run - 1));
+                    run   = 0;
+                }
+
+                continue;
+            }
+
+            if(run)
+            {
+                *at++ = (u8)(0xC0 | (run - 1));
+                run   = 0;
+            }
+
+            u32 r = (pixel >> 16) & 0xFF;
+            u32 g = (pixel >> 8) & 0xFF;
+            u32 b = pixel & 0xFF;
+
+            // NOTE(leo): Alpha is always 255.
+            u32 hash = ((r * 3) + (g * 5) + (b * 7) + (255 * 11)) % 64;
+
+            if(index[hash] == pixel)
+            {
+                *at++ = (u8)hash;
+            }
+            else
+            {
+                index[hash] = pixel;
+
+                s32 dr = (s8)(u8)(r - ((previous >> 16) & 0xFF));
+                s32 dg = (s8)(u8)(g - ((previous >> 8) & 0xFF));
+                s32 db = (s8)(u8)(b - (previous & 0xFF));
+
+                s32 dr_dg = dr - dg;
+                s32 db_dg = db - dg;
+
+                if(dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+                {
+                    *at++ = (u8)(0x40 | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2));
+                }
+                else if(dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8
+                        && db_dg <= 7)
+                {
+                    *at++ = (u8)(0x80 | (dg + 32));
+                    *at++ = (u8)(((dr_dg + 8) << 4) | (db_dg + 8));
+                }
+                else
+                {
+                    *at++ = 0xFE;
+                    *at++ = (u8)r;
+                    *at++ = (u8)g;
+                    *at++ = (u8)b;
+                }
+            }
+
+            previous = pixel;
+        }
+    }
+
+    if(run)
+    {
+        *at++ = (u8)(0xC0 | (run - 1));
+    }
+
+    u8 end_marker[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+    memcpy(at, end_marker, sizeof(end_marker));
+    at += sizeof(end_marker);
+
+    return (u64)(at - encoded);
+}
+
+// ===========================================================================================
+
+// NOTE(leo): Encoding thread.
+INTERNAL void
+screenshot_pool_encode_slot(ScreenshotPool *pool, ScreenshotSlot *slot)
+{
+    BackBuffer *frame = &slot->frame;
+
+    u64 row_size         = (u64)frame->width * sizeof(u32);
+    u64 encoded_capacity = screenshot_encoded_capacity(frame, slot->file_format);
+
+    // NOTE(leo): Only grow, like the slots.
+    if(row_size > pool->row_capacity)
+    {
+        free(pool->row);
+
+        pool->row          = malloc(row_size);
+        pool->row_capacity = pool->row ? row_size : 0;
+    }
+
+    if(encoded_capacity > pool->encoded_capacity)
+    {
+        free(pool->encoded);
+
+        pool->encoded          = malloc(encoded_capacity);
+        pool->encoded_capacity = pool->encoded ? encoded_capacity : 0;
+    }
+
+    if(!pool->row || !pool->encoded)
+    {
+        __atomic_add_fetch(&pool->stats.files_failed, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    s64 encode_begin = os_get_cpu_tick();
+
+    u64 encoded_size = slot->file_format == SCREENSHOT_QOI
+                         ? screenshot_encode_qoi(frame, pool->row, pool->encoded)
+                         : screenshot_encode_png(frame, pool->row, pool->encoded);
+
+    ASSERT(encoded_size <= encoded_capacity);
+
+    s64 write_begin = os_get_cpu_tick();
+    b32 is_written  = os_write_entire_file(slot->path, pool->encoded, encoded_size);
+    s64 write_end   = os_get_cpu_tick();
+
+    s64 encode_ticks = write_begin - encode_begin;
+    s64 write_ticks  = write_end - write_begin;
+
+    __atomic_add_fetch(&pool->stats.encode_ticks, encode_ticks, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&pool->stats.write_ticks, write_ticks, __ATOMIC_RELAXED);
+
+    if(is_written)
+    {
+        __atomic_add_fetch(&pool->stats.files_written, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&pool->stats.bytes_written, encoded_size, __ATOMIC_RELAXED);
+    }
+    else
+    {
+        __atomic_add_fetch(&pool->stats.files_failed, 1, __ATOMIC_RELAXED);
+    }
+}
+
+INTERNAL void
+screenshot_pool_thread(void *parameter)
+{
+    ScreenshotPool *pool = parameter;
+
+    for(;;)
+    {
+        os_semaphore_wait(&pool->capture_queued);
+
+        // NOTE(leo): Every capture signals, so a wake up can find its slot already done. The
+        // oldest queued slot first.
+        for(;;)
+        {
+            ScreenshotSlot *oldest = NULL;
+
+            for(u32 i = 0; i < SCREENSHOT_POOL_SIZE; ++i)
+            {
+                ScreenshotSlot *slot = &pool->slots[i];
+
+                if(__atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) == SCREENSHOT_SLOT_QUEUED
+                   && (!oldest || slot->sequence < oldest->sequence))
+                {
+                    oldest = slot;
+                }
+            }
+
+            if(!oldest)
+            {
+                break;
+            }
+
+            screenshot_pool_encode_slot(pool, oldest);
+
+            __atomic_store_n(&oldest->state, SCREENSHOT_SLOT_FREE, __ATOMIC_RELEASE);
+        }
+
+        // NOTE(leo): Only after the queue is empty, so the last screenshots are written.
+        if(__atomic_load_n(&pool->is_stopping, __ATOMIC_ACQUIRE))
+        {
+            break;
+        }
+    }
+}
+
+// ===========================================================================================
+
+// NOTE(leo): Returns false if the encoding thread couldn't be started.
+INTERNAL b32
+screenshot_pool_init(ScreenshotPool *pool)
+{
+    memset(pool, 0, sizeof(*pool));
+
+    crc32_init_tables();
+
+    if(!os_semaphore_init(&pool->capture_queued, 0))
+    {
+        return false;
+    }
+
+    if(!os_thread_create(&pool->thread, screenshot_pool_thread, pool))
+    {
+        os_semaphore_destroy(&pool->capture_queued);
+        return false;
+    }
+
+    return true;
+}
+
+// NOTE(leo): Writes the screenshots still queued before returning.
+INTERNAL void
+screenshot_pool_shutdown(ScreenshotPool *pool)
+{
+    __atomic_store_n(&pool->is_stopping, true, __ATOMIC_RELEASE);
+    os_semaphore_signal(&pool->capture_queued, 1);
+    os_thread_join(&pool->thread);
+    os_semaphore_destroy(&pool->capture_queued);
+
+    for(u32 i = 0; i < SCREENSHOT_POOL_SIZE; ++i)
+    {
+        os_free_frame_memory(pool->slots[i].frame.pixels, pool->slots[i].capacity);
+    }
+
+    free(pool->row);
+    free(pool->encoded);
+
+    memset(pool, 0, sizeof(*pool));
+}
+
+// NOTE(leo): Only grows. The slots are frame memory, prefaulted, so that the copy into a slot
+// doesn't page fault.
+INTERNAL b32
+screenshot_slot_reserve(ScreenshotSlot *slot, u64 size)
+{
+    if(size > slot->capacity)
+    {
+        os_free_frame_memory(slot->frame.pixels, slot->capacity);
+
+        b32 is_huge;
+        slot->frame.pixels = os_allocate_frame_memory(size, &is_huge);
+        slot->capacity     = slot->frame.pixels ? size : 0;
+    }
+
+    return slot->frame.pixels != NULL;
+}
+
+// NOTE(leo): Makes room for screenshots of frames like this one in the free slots, so that
+// the first ones don't allocate. For when the back buffers are resized.
+INTERNAL void
+screenshot_pool_reserve(ScreenshotPool *pool, BackBuffer *frame)
+{
+    for(u32 i = 0; i < SCREENSHOT_POOL_SIZE; ++i)
+    {
+        ScreenshotSlot *slot = &pool->slots[i];
+
+        if(__atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) == SCREENSHOT_SLOT_FREE)
+        {
+            screenshot_slot_reserve(slot, back_buffer_size(frame));
+        }
+    }
+}
+
+// NOTE(leo): Copies the frame to write it to path in the background. Only one thread can
+// take screenshots. Returns false, without waiting, if every slot is queued (then the
+// screenshot can be taken again later), or if the frame couldn't be copied.
+INTERNAL b32
+screenshot_capture(ScreenshotPool      *pool,
+                   BackBuffer          *frame,
+                   String8              path,
+                   ScreenshotFileFormat file_format)
+{
+    if(path.length >= SCREENSHOT_PATH_CAPACITY || !frame->pixels || frame->width <= 0
+       || frame->height <= 0)
+    {
+        return false;
+    }
+
+    ScreenshotSlot *slot = NULL;
+
+    for(u32 i = 0; i < SCREENSHOT_POOL_SIZE; ++i)
+    {
+        if(__atomic_load_n(&pool->slots[i].state, __ATOMIC_ACQUIRE) == SCREENSHOT_SLOT_FREE)
+        {
+            slot = &pool->slots[i];
+            break;
+        }
+    }
+
+    if(!slot)
+    {
+        pool->stats.captures_refused++;
+        return false;
+    }
+
+    if(!screenshot_slot_reserve(slot, back_buffer_size(frame)))
+    {
+        return false;
+    }
+
+    void *pixels = slot->frame.pixels;
+
+    slot->frame        = *frame;
+    slot->frame.pixels = pixels;
+
+    memcpy(slot->frame.pixels, frame->pixels, back_buffer_size(frame));
+
+    memcpy(slot->path, path.data, path.length);
+    slot->path[path.length] = 0;
+
+    slot->file_format = file_format;
+    slot->sequence    = pool->next_sequence++;
+
+    __atomic_store_n(&slot->state, SCREENSHOT_SLOT_QUEUED, __ATOMIC_RELEASE);
+    os_semaphore_signal(&pool->capture_queued, 1);
+
+    pool->stats.captures++;
+
+    return true;
+}
+
+// NOTE(leo): Waits for every screenshot taken to be written.
+INTERNAL void
+screenshot_pool_wait_idle(ScreenshotPool *pool)
+{
+    for(u32 i = 0; i < SCREENSHOT_POOL_SIZE; ++i)
+    {
+        while(__atomic_load_n(&pool->slots[i].state, __ATOMIC_ACQUIRE)
+              != SCREENSHOT_SLOT_FREE)
+        {
+            os_yield_processor();
+        }
+    }
+}
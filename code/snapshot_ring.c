@@ -0,0 +1,262 @@
+// NOTE(leo): Fixed-size ring of GameState snapshots, one per tick, in a single block
+// allocated up front. Tick t lives at index t & (capacity - 1), so restoring any tick still
+// in the ring is O(1) and there is no re-simulation from the beginning of the match. The
+// rewind controller on top of it lets the player step back and forth through the history and
+// play back the last point.
+
+// NOTE(leo): 2^16 snapshots of ~112 bytes is 7MB, about 18 minutes at 60 ticks per second.
+#define SNAPSHOT_RING_CAPACITY (1 << 16)
+
+// ===========================================================================================
+
+typedef struct
+{
+    GameState *states;
+    u64        capacity;
+
+    // NOTE(leo): Valid ticks are [next_tick - count, next_tick - 1].
+    u64 next_tick;
+    u64 count;
+
+} SnapshotRing;
+
+typedef enum
+{
+    REWIND_LIVE,
+    REWIND_PAUSED,
+    REWIND_PLAYBACK
+
+} RewindMode;
+
+typedef struct
+{
+    SnapshotRing ring;
+    RewindMode   mode;
+    u64          viewed_tick;
+    u64          last_rally_start_tick;
+    b32          was_match_started;
+
+} RewindController;
+
+// ===========================================================================================
+
+INTERNAL void
+snapshot_ring_init(SnapshotRing *ring, u64 capacity)
+{
+    // NOTE(leo): Power of two, so the modulo is a mask.
+    ASSERT(capacity && (capacity & (capacity - 1)) == 0);
+
+    memset(ring, 0, sizeof(*ring));
+
+    ring->states   = malloc(capacity * sizeof(GameState));
+    ring->capacity = ring->states ? capacity : 0;
+}
+
+// NOTE(leo): Returns the tick the snapshot was stored as.
+INTERNAL u64
+snapshot_ring_push(SnapshotRing *ring, GameState *game_state)
+{
+    u64 tick = ring->next_tick++;
+
+    if(ring->capacity)
+    {
+        ring->states[tick & (ring->capacity - 1)] = *game_state;
+
+        if(ring->count < ring->capacity)
+        {
+            ring->count++;
+        }
+    }
+
+    return tick;
+}
+
+INTERNAL u64
+snapshot_ring_oldest_tick(SnapshotRing *ring)
+{
+    return ring->next_tick - ring->count;
+}
+
+INTERNAL u64
+snapshot_ring_newest_tick(SnapshotRing *ring)
+{
+    ASSERT(ring->count);
+    return ring->next_tick - 1;
+}
+
+INTERNAL b32
+snapshot_ring_has(SnapshotRing *ring, u64 tick)
+{
+    return ring->count && tick >= snapshot_ring_oldest_tick(ring) && tick < ring->next_tick;
+}
+
+INTERNAL GameState *
+snapshot_ring_get(SnapshotRing *ring, u64 tick)
+{
+    ASSERT(snapshot_ring_has(ring, tick));
+    return &ring->states[tick & (ring->capacity - 1)];
+}
+
+// NOTE(leo): Drops every snapshot after the given tick, for when the match continues from a
+// past tick and the old future is no longer valid.
+INTERNAL void
+snapshot_ring_truncate(SnapshotRing *ring, u64 tick)
+{
+    ASSERT(snapshot_ring_has(ring, tick));
+
+    u64 dropped = ring->next_tick - (tick + 1);
+
+    ring->next_tick = tick + 1;
+    ring->count -= dropped;
+}
+
+// ===========================================================================================
+
+INTERNAL void
+rewind_init(RewindController *rewind, GameState *initial_state)
+{
+    memset(rewind, 0, sizeof(*rewind));
+
+    snapshot_ring_init(&rewind->ring, SNAPSHOT_RING_CAPACITY);
+    snapshot_ring_push(&rewind->ring, initial_state);
+}
+
+// NOTE(leo): Called after every live game_update.
+INTERNAL void
+rewind_record_tick(RewindController *rewind, GameState *game_state)
+{
+    u64 tick = snapshot_ring_push(&rewind->ring, game_state);
+
+    if(game_state->match_started && !rewind->was_match_started)
+    {
+        rewind->last_rally_start_tick = tick;
+    }
+
+    rewind->was_match_started = game_state->match_started;
+}
+
+INTERNAL b32
+rewind_is_live(RewindController *rewind)
+{
+    return rewind->mode == REWIND_LIVE;
+}
+
+// NOTE(leo): Negative steps go back in time. Pauses the match if it was live.
+INTERNAL void
+rewind_step(RewindController *rewind, s32 steps)
+{
+    if(!rewind->ring.count)
+    {
+        return;
+    }
+
+    if(rewind->mode == REWIND_LIVE)
+    {
+        rewind->viewed_tick = snapshot_ring_newest_tick(&rewind->ring);
+    }
+
+    rewind->mode = REWIND_PAUSED;
+
+    u64 oldest = snapshot_ring_oldest_tick(&rewind->ring);
+    u64 newest = snapshot_ring_newest_tick(&rewind->ring);
+
+    if(steps < 0)
+    {
+        u64 back = (u64)(-(s64)steps);
+
+        if(rewind->viewed_tick - oldest > back)
+        {
+            rewind->viewed_tick -= back;
+        }
+        else
+        {
+            rewind->viewed_tick = oldest;
+        }
+    }
+    else
+    {
+        u64 forward = (u64)steps;
+
+        if(newest - rewind->viewed_tick > forward)
+        {
+            rewind->viewed_tick += forward;
+        }
+        else
+        {
+            rewind->viewed_tick = newest;
+        }
+    }
+}
+
+// NOTE(leo): Plays back the history from the start of the last rally (or the oldest tick we
+// still have) up to the present, one snapshot per frame.
+INTERNAL void
+rewind_start_instant_replay(RewindController *rewind)
+{
+    if(!rewind->ring.count)
+    {
+        return;
+    }
+
+    rewind->mode = REWIND_PLAYBACK;
+
+    if(snapshot_ring_has(&rewind->ring, rewind->last_rally_start_tick))
+    {
+        rewind->viewed_tick = rewind->last_rally_start_tick;
+    }
+    else
+    {
+        rewind->viewed_tick = snapshot_ring_oldest_tick(&rewind->ring);
+    }
+}
+
+// NOTE(leo): Returns the snapshot to render this frame while not live. Playback stops (and
+// pauses) at the newest snapshot.
+INTERNAL GameState *
+rewind_update_frame(RewindController *rewind)
+{
+    ASSERT(rewind->mode != REWIND_LIVE);
+
+    GameState *result = snapshot_ring_get(&rewind->ring, rewind->viewed_tick);
+
+    if(rewind->mode == REWIND_PLAYBACK)
+    {
+        if(rewind->viewed_tick < snapshot_ring_newest_tick(&rewind->ring))
+        {
+            rewind->viewed_tick++;
+        }
+        else
+        {
+            rewind->mode = REWIND_PAUSED;
+        }
+    }
+
+    return result;
+}
+
+// NOTE(leo): Continues the match from the viewed tick, which becomes the newest one. Returns
+// how many ticks were thrown away, so that a recording can be told about it.
+INTERNAL u64
+rewind_resume(RewindController *rewind, GameState *game_state)
+{
+    u64 dropped_ticks = 0;
+
+    if(rewind->mode != REWIND_LIVE)
+    {
+        dropped_ticks = snapshot_ring_newest_tick(&rewind->ring) - rewind->viewed_tick;
+
+        *game_state = *snapshot_ring_get(&rewind->ring, rewind->viewed_tick);
+        snapshot_ring_truncate(&rewind->ring, rewind->viewed_tick);
+
+        // NOTE(leo): The last rally may have started in the future we just threw away.
+        if(rewind->last_rally_start_tick > rewind->viewed_tick)
+        {
+            rewind->last_rally_start_tick = snapshot_ring_oldest_tick(&rewind->ring);
+        }
+
+        rewind->was_match_started = game_state->match_started;
+        rewind->mode              = REWIND_LIVE;
+    }
+
+    return dropped_ticks;
+}
@@ -1,8 +1,3 @@
-#define TARGET_ASPECT_RATIO_NUMERATOR   16.0f
-#define TARGET_ASPECT_RATIO_DENOMINATOR 9.0f
-
-#define TARGET_ASPECT_RATIO (TARGET_ASPECT_RATIO_NUMERATOR / TARGET_ASPECT_RATIO_DENOMINATOR)
-
 #define COLOR(r, g, b) ((Color) {r, g, b})
 
 // ===========================================================================================
@@ -21,7 +16,29 @@ typedef struct
 
 } PixelRect;
 
-GLOBAL struct
+typedef enum
+{
+    // NOTE(leo): 0x00RRGGBB, what the platforms present.
+    BACK_BUFFER_RGB,
+
+    // NOTE(leo): One byte per pixel, the luminance. Used to render observations for bots
+    // (see env.c).
+    BACK_BUFFER_GRAYSCALE,
+
+    // NOTE(leo): One bit per pixel, which of the two colors of the palette it has. Each row
+    // is a whole number of u64 words, the first pixel in the lowest bit. The game only ever
+    // draws with two colors, so filling a rectangle is one masked write per 64 pixels
+    // instead of 64 writes. It has to be expanded with expand_bitplane to be presented.
+    BACK_BUFFER_BITPLANE
+
+} BackBufferFormat;
+
+// NOTE(leo): What the rows of back buffers set up with back_buffer_set_size start at, in
+// bytes. A cache line, so filling a row never shares a line with the row above, and the
+// 128-bit stores are aligned from the first pixel of every row.
+#define BACK_BUFFER_ROW_ALIGNMENT 64
+
+typedef struct
 {
     void *pixels;
     s32   pixels_count;
@@ -29,10 +46,106 @@ GLOBAL struct
     s32   height;
     f32   aspect_ratio;
 
-} g_back_buffer = {0};
+    // NOTE(leo): Bytes from the start of a row to the start of the next one. Can be more
+    // than the row's pixels take, the padding at the end of the rows isn't part of the frame.
+    s32 pitch;
+
+    BackBufferFormat format;
+
+    // NOTE(leo): Only for BACK_BUFFER_BITPLANE, the color of 0 bits and of 1 bits.
+    u32 palette[2];
+
+} BackBuffer;
+
+GLOBAL BackBuffer g_back_buffer = {0};
+
+// NOTE(leo): Rectangles a frame draws, recorded instead of drawn while g_draw_list is set,
+// for render_draw_list. The arrays after rects are its scratch memory.
+#define DRAW_LIST_MAX_RECTS 512
+
+typedef struct
+{
+    s32 x_begin;
+    s32 x_end;
+    u32 color;
+
+} Span;
+
+typedef struct
+{
+    u32 clear_color;
+
+    PixelRect rects[DRAW_LIST_MAX_RECTS];
+    u32       colors[DRAW_LIST_MAX_RECTS];
+    u32       rects_count;
+
+    // NOTE(leo): Set when a frame drew more than DRAW_LIST_MAX_RECTS rectangles, then it has
+    // to be drawn the usual way.
+    b32 has_overflowed;
+
+    u16  by_top[DRAW_LIST_MAX_RECTS];
+    u16  active[DRAW_LIST_MAX_RECTS];
+    s32  edges[(DRAW_LIST_MAX_RECTS * 2) + 2];
+    Span spans[(DRAW_LIST_MAX_RECTS * 2) + 1];
+
+} DrawList;
+
+GLOBAL DrawList *g_draw_list = NULL;
 
 // ===========================================================================================
 
+INTERNAL s32
+bitplane_words_per_row(s32 width)
+{
+    return (width + 63) / 64;
+}
+
+// NOTE(leo): Bytes the pixels of a row take, without padding.
+INTERNAL s32
+back_buffer_row_size(BackBuffer *back_buffer)
+{
+    switch(back_buffer->format)
+    {
+        case BACK_BUFFER_GRAYSCALE:
+        {
+            return back_buffer->width;
+        }
+        case BACK_BUFFER_BITPLANE:
+        {
+            return bitplane_words_per_row(back_buffer->width) * (s32)sizeof(u64);
+        }
+        default:
+        {
+            return back_buffer->width * (s32)sizeof(u32);
+        }
+    }
+}
+
+// NOTE(leo): Sets everything but the pixels and the palette. The format must already be set.
+// With is_row_aligned, the pitch is padded to BACK_BUFFER_ROW_ALIGNMENT, otherwise the rows
+// are packed.
+INTERNAL void
+back_buffer_set_size(BackBuffer *back_buffer, s32 width, s32 height, b32 is_row_aligned)
+{
+    back_buffer->width        = width;
+    back_buffer->height       = height;
+    back_buffer->pixels_count = width * height;
+    back_buffer->aspect_ratio = (f32)width / (f32)height;
+    back_buffer->pitch        = back_buffer_row_size(back_buffer);
+
+    if(is_row_aligned)
+    {
+        back_buffer->pitch = (back_buffer->pitch + BACK_BUFFER_ROW_ALIGNMENT - 1)
+                           & ~(BACK_BUFFER_ROW_ALIGNMENT - 1);
+    }
+}
+
+INTERNAL u64
+back_buffer_size(BackBuffer *back_buffer)
+{
+    return (u64)back_buffer->pitch * (u64)back_buffer->height;
+}
+
 INTERNAL u32
 color_to_u32(Color color)
 {
@@ -73,17 +186,70 @@ color_to_u32(Color color)
     return (u32)(b | (g << 8) | (r << 16));
 }
 
+// NOTE(leo): Rec. 601 luma.
+INTERNAL u8
+u32_to_gray(u32 rgb)
+{
+    u32 r = (rgb >> 16) & 0xFF;
+    u32 g = (rgb >> 8) & 0xFF;
+    u32 b = rgb & 0xFF;
+
+    return (u8)(((r * 299) + (g * 587) + (b * 114) + 500) / 1000);
+}
+
+INTERNAL u8
+color_to_gray(Color color)
+{
+    return u32_to_gray(color_to_u32(color));
+}
+
+// NOTE(leo): What the bits of a color are in a BACK_BUFFER_BITPLANE buffer.
+INTERNAL u64
+bitplane_fill_for_color(u32 color_u32)
+{
+    ASSERT(color_u32 == g_back_buffer.palette[0] || color_u32 == g_back_buffer.palette[1]);
+
+    return color_u32 == g_back_buffer.palette[1] ? U64_MAX : 0;
+}
+
 INTERNAL void
 clear_back_buffer(Color color)
 {
-    u32 color_u32 = color_to_u32(color);
+    if(g_draw_list)
+    {
+        g_draw_list->clear_color    = color_to_u32(color);
+        g_draw_list->rects_count    = 0;
+        g_draw_list->has_overflowed = false;
+        return;
+    }
+
+    // NOTE(leo): The padding at the end of the rows is cleared too, it's faster to go
+    // through the buffer in one go than row by row.
+    if(g_back_buffer.format == BACK_BUFFER_GRAYSCALE)
+    {
+        memset(g_back_buffer.pixels,
+               color_to_gray(color),
+               (size_t)back_buffer_size(&g_back_buffer));
+        return;
+    }
+
+    u32 color_u32    = color_to_u32(color);
+    s32 pixels_count = (s32)(back_buffer_size(&g_back_buffer) / sizeof(u32));
+
+    if(g_back_buffer.format == BACK_BUFFER_BITPLANE)
+    {
+        memset(g_back_buffer.pixels,
+               (int)(bitplane_fill_for_color(color_u32) & 0xFF),
+               (size_t)back_buffer_size(&g_back_buffer));
+        return;
+    }
 
 #ifdef OPTIMIZATIONS_ON
     // NOTE(leo): On non-optimized builds (-Od), this code is faster than the 64-bit and
     // 128-bit version bellow.
     u32 *pixel = (u32 *)g_back_buffer.pixels;
 
-    for(s32 i = 0; i < g_back_buffer.pixels_count; ++i)
+    for(s32 i = 0; i < pixels_count; ++i)
     {
         *pixel++ = color_u32;
     }
@@ -94,7 +260,7 @@ clear_back_buffer(Color color)
     u128 *pixels = (u128 *)g_back_buffer.pixels;
     u128  colors = ((u128)color_u64 << 64) | color_u64;
 
-    for(s32 i = 0; i < g_back_buffer.pixels_count / 4; ++i)
+    for(s32 i = 0; i < pixels_count / 4; ++i)
     {
         *pixels++ = colors;
     }
@@ -102,7 +268,7 @@ clear_back_buffer(Color color)
     u32 *pixel = (u32 *)pixels;
 
     // NOTE(leo): Filling the remaining pixels in case of an odd pixels_count.
-    for(s32 i = 0; i < g_back_buffer.pixels_count % 4; ++i)
+    for(s32 i = 0; i < pixels_count % 4; ++i)
     {
         *pixel++ = color_u32;
     }
@@ -110,11 +276,10 @@ clear_back_buffer(Color color)
 #endif // OPTIMIZATIONS_ON
 }
 
+// NOTE(leo): color_u32 is 0x00RRGGBB, one of the palette's for BACK_BUFFER_BITPLANE buffers.
 INTERNAL void
-draw_rectangle_in_pixels(s32 x, s32 y, s32 rect_width, s32 rect_height, Color color)
+draw_rectangle_in_pixels_u32(s32 x, s32 y, s32 rect_width, s32 rect_height, u32 color_u32)
 {
-    u32 color_u32 = color_to_u32(color);
-
     if(x < 0)
     {
         rect_width += x; // NOTE(leo): Here we are reducing rect_width, not increasing.
@@ -140,10 +305,68 @@ draw_rectangle_in_pixels(s32 x, s32 y, s32 rect_width, s32 rect_height, Color co
         rect_height -= rect_bottom - g_back_buffer.height;
     }
 
-    if(rect_width > 0 && rect_height > 0)
+    if(rect_width > 0 && rect_height > 0 && g_draw_list)
     {
-        s32  goto_next_line = g_back_buffer.width - rect_width;
-        u32 *pixel          = (u32 *)g_back_buffer.pixels + x + (g_back_buffer.width * y);
+        if(g_draw_list->rects_count == DRAW_LIST_MAX_RECTS)
+        {
+            g_draw_list->has_overflowed = true;
+            return;
+        }
+
+        u32 rect_index = g_draw_list->rects_count++;
+
+        g_draw_list->rects[rect_index]  = (PixelRect) {x, y, rect_width, rect_height};
+        g_draw_list->colors[rect_index] = color_u32;
+    }
+    else if(rect_width > 0 && rect_height > 0 && g_back_buffer.format == BACK_BUFFER_BITPLANE)
+    {
+        s32  words_per_row = g_back_buffer.pitch / (s32)sizeof(u64);
+        s32  first_word    = x / 64;
+        s32  last_word     = (x + rect_width - 1) / 64;
+        u64  first_mask    = U64_MAX << (x % 64);
+        u64  last_mask     = U64_MAX >> (63 - ((x + rect_width - 1) % 64));
+        u64  fill          = bitplane_fill_for_color(color_u32);
+        u64 *row           = (u64 *)g_back_buffer.pixels + (words_per_row * y);
+
+        if(first_word == last_word)
+        {
+            first_mask &= last_mask;
+        }
+
+        for(s32 h = 0; h < rect_height; ++h)
+        {
+            row[first_word] = (row[first_word] & ~first_mask) | (fill & first_mask);
+
+            if(first_word != last_word)
+            {
+                for(s32 word = first_word + 1; word < last_word; ++word)
+                {
+                    row[word] = fill;
+                }
+
+                row[last_word] = (row[last_word] & ~last_mask) | (fill & last_mask);
+            }
+
+            row += words_per_row;
+        }
+    }
+    else if(rect_width > 0 && rect_height > 0
+            && g_back_buffer.format == BACK_BUFFER_GRAYSCALE)
+    {
+        u8  gray = u32_to_gray(color_u32);
+        u8 *row  = (u8 *)g_back_buffer.pixels + x + (g_back_buffer.pitch * y);
+
+        for(s32 h = 0; h < rect_height; ++h)
+        {
+            memset(row, gray, (size_t)rect_width);
+            row += g_back_buffer.pitch;
+        }
+    }
+    else if(rect_width > 0 && rect_height > 0)
+    {
+        s32  pixels_per_row = g_back_buffer.pitch / (s32)sizeof(u32);
+        s32  goto_next_line = pixels_per_row - rect_width;
+        u32 *pixel          = (u32 *)g_back_buffer.pixels + x + (pixels_per_row * y);
 
         for(s32 h = 0; h < rect_height; ++h)
         {
@@ -157,12 +380,73 @@ draw_rectangle_in_pixels(s32 x, s32 y, s32 rect_width, s32 rect_height, Color co
     }
 }
 
+INTERNAL void
+draw_rectangle_in_pixels(s32 x, s32 y, s32 rect_width, s32 rect_height, Color color)
+{
+    draw_rectangle_in_pixels_u32(x, y, rect_width, rect_height, color_to_u32(color));
+}
+
+// NOTE(leo): Draws count rectangles of the same size, the top left corner of the i-th one at
+// xs[i], ys[i], in colors[i] (0x00RRGGBB). For lots of small ones, like particles: a
+// 0x00RRGGBB back buffer is filled right here, without going through Color. In a
+// BACK_BUFFER_BITPLANE buffer, every color but the background (palette[0]) is drawn as
+// palette[1].
+INTERNAL void
+draw_rectangle_batch(s32 *xs,
+                     s32 *ys,
+                     u32 *colors,
+                     u32  count,
+                     s32  rect_width,
+                     s32  rect_height)
+{
+    if(g_draw_list || g_back_buffer.format != BACK_BUFFER_RGB)
+    {
+        for(u32 i = 0; i < count; ++i)
+        {
+            u32 color_u32 = colors[i];
+
+            if(g_back_buffer.format == BACK_BUFFER_BITPLANE)
+            {
+                color_u32 = g_back_buffer.palette[color_u32 != g_back_buffer.palette[0]];
+            }
+
+            draw_rectangle_in_pixels_u32(xs[i], ys[i], rect_width, rect_height, color_u32);
+        }
+
+        return;
+    }
+
+    s32 pixels_per_row = g_back_buffer.pitch / (s32)sizeof(u32);
+
+    for(u32 i = 0; i < count; ++i)
+    {
+        s32 x_begin = MAX(xs[i], 0);
+        s32 y_begin = MAX(ys[i], 0);
+        s32 x_end   = MIN(xs[i] + rect_width, g_back_buffer.width);
+        s32 y_end   = MIN(ys[i] + rect_height, g_back_buffer.height);
+
+        if(x_end <= x_begin || y_end <= y_begin)
+        {
+            continue;
+        }
+
+        u32 *row = (u32 *)g_back_buffer.pixels + x_begin + (pixels_per_row * y_begin);
+
+        for(s32 y = y_begin; y < y_end; ++y)
+        {
+            for(s32 x = 0; x < x_end - x_begin; ++x)
+            {
+                row[x] = colors[i];
+            }
+
+            row += pixels_per_row;
+        }
+    }
+}
+
+// NOTE(leo): Where draw_rectangle would draw, in pixels.
 INTERNAL PixelRect
-draw_rectangle(f32   rect_center_x,
-               f32   rect_center_y,
-               f32   rect_width,
-               f32   rect_height,
-               Color color)
+rectangle_to_pixels(f32 rect_center_x, f32 rect_center_y, f32 rect_width, f32 rect_height)
 {
     f32 rect_width_px = rect_width * ((f32)g_back_buffer.width / 2.0f);
     f32 rect_height_px =
@@ -176,7 +460,296 @@ draw_rectangle(f32   rect_center_x,
     s32 w = round_f32_to_s32_up(rect_width_px);
     s32 h = round_f32_to_s32_up(rect_height_px);
 
-    draw_rectangle_in_pixels(x, y, w, h, color);
-
     return (PixelRect) {x, y, w, h};
 }
+
+INTERNAL PixelRect
+draw_rectangle(f32   rect_center_x,
+               f32   rect_center_y,
+               f32   rect_width,
+               f32   rect_height,
+               Color color)
+{
+    PixelRect rect =
+        rectangle_to_pixels(rect_center_x, rect_center_y, rect_width, rect_height);
+
+    draw_rectangle_in_pixels(rect.x, rect.y, rect.width, rect.height, color);
+
+    return rect;
+}
+
+// NOTE(leo): Nearest neighbour, to present a frame rendered at a lower resolution than the
+// one it's shown at. Only for 0x00RRGGBB buffers. Destination rows that come from the same
+// source row are copied from the row above.
+INTERNAL void
+upscale_back_buffer(BackBuffer *source, u32 *dest, s32 dest_width, s32 dest_height)
+{
+    ASSERT(source->format == BACK_BUFFER_RGB);
+
+    // NOTE(leo): 16.16 fixed point.
+    u64 step_x = ((u64)source->width << 16) / (u64)dest_width;
+    u64 step_y = ((u64)source->height << 16) / (u64)dest_height;
+
+    u32 *dest_row          = dest;
+    s32  previous_source_y = -1;
+
+    for(s32 y = 0; y < dest_height; ++y)
+    {
+        s32 source_y = (s32)(((u64)y * step_y) >> 16);
+
+        if(source_y == previous_source_y)
+        {
+            memcpy(dest_row, dest_row - dest_width, (size_t)dest_width * sizeof(u32));
+        }
+        else
+        {
+            u32 *source_row = (u32 *)((u8 *)source->pixels + (source_y * source->pitch));
+            u64  source_x   = 0;
+
+            for(s32 x = 0; x < dest_width; ++x)
+            {
+                dest_row[x] = source_row[source_x >> 16];
+                source_x += step_x;
+            }
+
+            previous_source_y = source_y;
+        }
+
+        dest_row += dest_width;
+    }
+}
+
+// NOTE(leo): Writes a BACK_BUFFER_BITPLANE buffer out as 0x00RRGGBB pixels into dest, which
+// has the buffer's width and height and dest_pitch bytes per row, once per frame when
+// presenting. Four pixels at a time: each
+// nibble of a word picks one of the 16 ways four pixels can be colored, which is one SSE2
+// store.
+INTERNAL void
+expand_bitplane(BackBuffer *source, u32 *dest, s32 dest_pitch)
+{
+    ASSERT(source->format == BACK_BUFFER_BITPLANE);
+
+    __m128i nibble_colors[16];
+
+    for(u32 nibble = 0; nibble < 16; ++nibble)
+    {
+        nibble_colors[nibble] = _mm_setr_epi32((int)source->palette[nibble & 1],
+                                               (int)source->palette[(nibble >> 1) & 1],
+                                               (int)source->palette[(nibble >> 2) & 1],
+                                               (int)source->palette[(nibble >> 3) & 1]);
+    }
+
+    s32  words_per_row = bitplane_words_per_row(source->width);
+    u64 *row           = (u64 *)source->pixels;
+
+    for(s32 y = 0; y < source->height; ++y)
+    {
+        u32 *pixel = (u32 *)((u8 *)dest + ((s64)y * dest_pitch));
+
+        for(s32 word_index = 0; word_index < words_per_row; ++word_index)
+        {
+            u64 word         = row[word_index];
+            s32 pixels_count = source->width - (word_index * 64);
+
+            if(pixels_count > 64)
+            {
+                pixels_count = 64;
+            }
+
+            for(s32 i = 0; i < pixels_count / 4; ++i)
+            {
+                _mm_storeu_si128((__m128i *)pixel, nibble_colors[word & 0xF]);
+
+                word >>= 4;
+                pixel += 4;
+            }
+
+            for(s32 i = 0; i < pixels_count % 4; ++i)
+            {
+                *pixel++ = source->palette[word & 1];
+                word >>= 1;
+            }
+        }
+
+        row += source->pitch / (s32)sizeof(u64);
+    }
+}
+
+// NOTE(leo): Fills count pixels with 128-bit stores, aligned ones after the first few.
+INTERNAL void
+fill_pixels(u32 *pixel, s32 count, u32 color)
+{
+    while(count > 0 && ((u64)pixel & 15))
+    {
+        *pixel++ = color;
+        count--;
+    }
+
+    __m128i colors = _mm_set1_epi32((int)color);
+
+    for(; count >= 4; count -= 4)
+    {
+        _mm_store_si128((__m128i *)pixel, colors);
+        pixel += 4;
+    }
+
+    while(count-- > 0)
+    {
+        *pixel++ = color;
+    }
+}
+
+// NOTE(leo): Works out which rectangle is on top along a scanline crossed by the active
+// rectangles (sorted from first to last drawn) and turns the row into spans of one color
+// each, from the left edge of the buffer to the right one. Returns how many.
+INTERNAL u32
+draw_list_build_spans(DrawList *list, u32 active_count)
+{
+    s32 *edges       = list->edges;
+    u32  edges_count = 0;
+
+    edges[edges_count++] = 0;
+    edges[edges_count++] = g_back_buffer.width;
+
+    for(u32 i = 0; i < active_count; ++i)
+    {
+        PixelRect *rect = &list->rects[list->active[i]];
+
+        edges[edges_count++] = rect->x;
+        edges[edges_count++] = rect->x + rect->width;
+    }
+
+    // NOTE(leo): Insertion sort, there are only a few rectangles per scanline.
+    for(u32 i = 1; i < edges_count; ++i)
+    {
+        s32 edge = edges[i];
+        u32 j    = i;
+
+        for(; j > 0 && edges[j - 1] > edge; --j)
+        {
+            edges[j] = edges[j - 1];
+        }
+
+        edges[j] = edge;
+    }
+
+    u32 spans_count = 0;
+
+    for(u32 i = 0; i + 1 < edges_count; ++i)
+    {
+        s32 x_begin = edges[i];
+        s32 x_end   = edges[i + 1];
+
+        if(x_begin == x_end)
+        {
+            continue;
+        }
+
+        // NOTE(leo): The last one drawn wins, like it would drawing them in order.
+        u32 color = list->clear_color;
+
+        for(u32 j = active_count; j > 0; --j)
+        {
+            PixelRect *rect = &list->rects[list->active[j - 1]];
+
+            if(rect->x <= x_begin && x_end <= rect->x + rect->width)
+            {
+                color = list->colors[list->active[j - 1]];
+                break;
+            }
+        }
+
+        if(spans_count && list->spans[spans_count - 1].color == color)
+        {
+            list->spans[spans_count - 1].x_end = x_end;
+        }
+        else
+        {
+            list->spans[spans_count++] = (Span) {x_begin, x_end, color};
+        }
+    }
+
+    return spans_count;
+}
+
+// NOTE(leo): Draws the recorded frame into g_back_buffer (0x00RRGGBB only) one scanline at a
+// time, so every pixel is written once, instead of being cleared and then drawn over. The
+// spans only change on the rows where a rectangle starts or ends, the rows in between reuse
+// them.
+INTERNAL void
+render_draw_list(DrawList *list)
+{
+    ASSERT(g_back_buffer.format == BACK_BUFFER_RGB && !list->has_overflowed);
+
+    // NOTE(leo): Stable, so rectangles starting on the same row stay in drawing order.
+    for(u32 i = 0; i < list->rects_count; ++i)
+    {
+        u32 j = i;
+
+        for(; j > 0 && list->rects[list->by_top[j - 1]].y > list->rects[i].y; --j)
+        {
+            list->by_top[j] = list->by_top[j - 1];
+        }
+
+        list->by_top[j] = (u16)i;
+    }
+
+    u32  next_by_top  = 0;
+    u32  active_count = 0;
+    u32  spans_count  = 0;
+    u32 *row          = (u32 *)g_back_buffer.pixels;
+
+    for(s32 y = 0; y < g_back_buffer.height; ++y)
+    {
+        b32 has_changed = y == 0;
+
+        for(u32 i = 0; i < active_count;)
+        {
+            PixelRect *rect = &list->rects[list->active[i]];
+
+            if(rect->y + rect->height <= y)
+            {
+                active_count--;
+
+                for(u32 j = i; j < active_count; ++j)
+                {
+                    list->active[j] = list->active[j + 1];
+                }
+
+                has_changed = true;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+
+        while(next_by_top < list->rects_count
+              && list->rects[list->by_top[next_by_top]].y == y)
+        {
+            u16 rect_index = list->by_top[next_by_top++];
+            u32 j          = active_count++;
+
+            for(; j > 0 && list->active[j - 1] > rect_index; --j)
+            {
+                list->active[j] = list->active[j - 1];
+            }
+
+            list->active[j] = rect_index;
+            has_changed     = true;
+        }
+
+        if(has_changed)
+        {
+            spans_count = draw_list_build_spans(list, active_count);
+        }
+
+        for(u32 i = 0; i < spans_count; ++i)
+        {
+            Span *span = &list->spans[i];
+            fill_pixels(row + span->x_begin, span->x_end - span->x_begin, span->color);
+        }
+
+        row += g_back_buffer.pitch / (s32)sizeof(u32);
+    }
+}
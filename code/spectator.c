@@ -0,0 +1,533 @@
+// NOTE(leo): Compact match snapshots for spectators. Positions and velocities are quantized
+// to fixed point with a configurable number of fraction bits, and every snapshot is sent as
+// the difference against the last one the spectator acknowledged, bit-packed: an unchanged
+// field costs one bit and a small change a handful. The encoder keeps a short history of
+// snapshots so each spectator can have its own baseline; when a spectator's baseline is too
+// old (or it has none yet) it gets a keyframe, which is the difference against all zeros.
+//
+// The decoder keeps the same history on its side and samples it at fractional ticks,
+// interpolating positions between the two snapshots around the requested time, so playback
+// stays smooth even with some snapshots lost.
+//
+// Packet layout, least significant bit first:
+// - tick (32 bits);
+// - distance back to the baseline tick (8 bits, 0 for a keyframe);
+// - for every field: 0 if it's the same as in the baseline, otherwise 1, then the bit length
+//   of the zigzag encoded difference minus one (5 bits), then the difference without its
+//   leading one.
+
+#define SPECTATOR_HISTORY_CAPACITY 64 // NOTE(leo): Power of two, about one second.
+
+#define SPECTATOR_NO_TICK U32_MAX
+
+// NOTE(leo): A keyframe with every field at its widest, rounded up. Real packets are a small
+// fraction of it.
+#define SPECTATOR_MAX_PACKET_SIZE (5 + (SPECTATOR_FIELDS_COUNT * (1 + 5 + 31) + 7) / 8)
+
+// NOTE(leo): 12 fraction bits is about a quarter of a pixel at 1080p, which is invisible.
+#define SPECTATOR_DEFAULT_POSITION_FRACTION_BITS 12
+#define SPECTATOR_DEFAULT_VELOCITY_FRACTION_BITS 10
+#define SPECTATOR_MAX_FRACTION_BITS              16
+
+// ===========================================================================================
+
+enum
+{
+    // NOTE(leo): Position x and y, velocity x and y, width and height, for the ball, the left
+    // paddle and the right paddle, in that order.
+    SPECTATOR_ENTITY_FIELDS_COUNT = 6,
+    SPECTATOR_ENTITIES_COUNT      = 3,
+
+    SPECTATOR_WINNER_FIELD = SPECTATOR_ENTITY_FIELDS_COUNT * SPECTATOR_ENTITIES_COUNT,
+    SPECTATOR_MATCH_STARTED_FIELD,
+    SPECTATOR_LEFT_POINTS_FIELD,
+    SPECTATOR_RIGHT_POINTS_FIELD,
+    SPECTATOR_COLLISION_DETECTED_FIELD,
+    SPECTATOR_SOUND_TO_PLAY_FIELD,
+
+    SPECTATOR_FIELDS_COUNT
+};
+
+typedef struct
+{
+    u32 position_fraction_bits;
+    u32 velocity_fraction_bits;
+
+} SpectatorConfig;
+
+// NOTE(leo): A quantized GameState, without the RNG: spectators don't simulate.
+typedef struct
+{
+    s32 fields[SPECTATOR_FIELDS_COUNT];
+
+} SpectatorFrame;
+
+typedef struct
+{
+    SpectatorConfig config;
+
+    SpectatorFrame frames[SPECTATOR_HISTORY_CAPACITY];
+    u32            ticks[SPECTATOR_HISTORY_CAPACITY];
+    u32            next_tick;
+
+} SpectatorEncoder;
+
+typedef struct
+{
+    SpectatorConfig config;
+
+    SpectatorFrame frames[SPECTATOR_HISTORY_CAPACITY];
+    u32            ticks[SPECTATOR_HISTORY_CAPACITY];
+
+    // NOTE(leo): What the spectator sends back as its acknowledgement.
+    u32 newest_tick;
+
+} SpectatorDecoder;
+
+typedef struct
+{
+    u8 *at;
+    u8 *end;
+    u64 bits;
+    u32 bits_count;
+    b32 has_overflowed;
+
+} BitWriter;
+
+typedef struct
+{
+    u8 *at;
+    u8 *end;
+    u64 bits;
+    u32 bits_count;
+    b32 has_overflowed;
+
+} BitReader;
+
+// ===========================================================================================
+
+INTERNAL void
+bit_writer_write(BitWriter *writer, u32 value, u32 bits_count)
+{
+    ASSERT(bits_count <= 32);
+
+    writer->bits |= ((u64)value & ((1ULL << bits_count) - 1)) << writer->bits_count;
+    writer->bits_count += bits_count;
+
+    while(writer->bits_count >= 8)
+    {
+        if(writer->at < writer->end)
+        {
+            *writer->at++ = (u8)writer->bits;
+        }
+        else
+        {
+            writer->has_overflowed = true;
+        }
+
+        writer->bits >>= 8;
+        writer->bits_count -= 8;
+    }
+}
+
+INTERNAL void
+bit_writer_flush(BitWriter *writer)
+{
+    if(writer->bits_count)
+    {
+        bit_writer_write(writer, 0, 8 - writer->bits_count);
+    }
+}
+
+// NOTE(leo): Reading past the end gives zeros and sets has_overflowed.
+INTERNAL u32
+bit_reader_read(BitReader *reader, u32 bits_count)
+{
+    ASSERT(bits_count <= 32);
+
+    while(reader->bits_count < bits_count)
+    {
+        if(reader->at < reader->end)
+        {
+            reader->bits |= (u64)*reader->at++ << reader->bits_count;
+        }
+        else
+        {
+            reader->has_overflowed = true;
+        }
+
+        reader->bits_count += 8;
+    }
+
+    u32 result = (u32)(reader->bits & ((1ULL << bits_count) - 1));
+
+    reader->bits >>= bits_count;
+    reader->bits_count -= bits_count;
+
+    return result;
+}
+
+// ===========================================================================================
+
+INTERNAL s32
+spectator_quantize_f32(f32 value, u32 fraction_bits)
+{
+    f32 scaled = value * (f32)(1 << fraction_bits);
+
+    // NOTE(leo): Nothing in the game gets close to this, it only keeps a runaway ball
+    // velocity from overflowing the conversion.
+    scaled = CLAMP(scaled, -1073741824.0f, 1073741824.0f);
+
+    return (s32)(scaled + (scaled >= 0.0f ? 0.5f : -0.5f));
+}
+
+INTERNAL f32
+spectator_dequantize_f32(s32 value, u32 fraction_bits)
+{
+    return (f32)value / (f32)(1 << fraction_bits);
+}
+
+INTERNAL void
+spectator_quantize(SpectatorConfig *config, GameState *game_state, SpectatorFrame *frame)
+{
+    Entity *entities[] = {&game_state->ball,
+                          &game_state->left_paddle,
+                          &game_state->right_paddle};
+
+    u32 position_bits = config->position_fraction_bits;
+    u32 velocity_bits = config->velocity_fraction_bits;
+
+    for(u32 i = 0; i < SPECTATOR_ENTITIES_COUNT; ++i)
+    {
+        Entity *entity = entities[i];
+        s32    *fields = &frame->fields[i * SPECTATOR_ENTITY_FIELDS_COUNT];
+
+        fields[0] = spectator_quantize_f32(real_to_f32(entity->position.x), position_bits);
+        fields[1] = spectator_quantize_f32(real_to_f32(entity->position.y), position_bits);
+        fields[2] = spectator_quantize_f32(real_to_f32(entity->velocity.x), velocity_bits);
+        fields[3] = spectator_quantize_f32(real_to_f32(entity->velocity.y), velocity_bits);
+        fields[4] = spectator_quantize_f32(real_to_f32(entity->width), position_bits);
+        fields[5] = spectator_quantize_f32(real_to_f32(entity->height), position_bits);
+    }
+
+    frame->fields[SPECTATOR_WINNER_FIELD]             = (s32)game_state->winner;
+    frame->fields[SPECTATOR_MATCH_STARTED_FIELD]      = (s32)game_state->match_started;
+    frame->fields[SPECTATOR_LEFT_POINTS_FIELD]        = (s32)game_state->left_points;
+    frame->fields[SPECTATOR_RIGHT_POINTS_FIELD]       = (s32)game_state->right_points;
+    frame->fields[SPECTATOR_COLLISION_DETECTED_FIELD] = (s32)game_state->collision_detected;
+    frame->fields[SPECTATOR_SOUND_TO_PLAY_FIELD]      = (s32)game_state->sound_to_play;
+}
+
+// NOTE(leo): The inverse of spectator_quantize, except for the RNG, which is left zeroed.
+// With t between 0 and 1, the continuous fields are interpolated from a to b and the rest
+// come from a.
+INTERNAL void
+spectator_dequantize(SpectatorConfig *config,
+                     SpectatorFrame  *a,
+                     SpectatorFrame  *b,
+                     f32              t,
+                     GameState       *game_state)
+{
+    memset(game_state, 0, sizeof(*game_state));
+
+    Entity *entities[] = {&game_state->ball,
+                          &game_state->left_paddle,
+                          &game_state->right_paddle};
+
+    u32 position_bits = config->position_fraction_bits;
+    u32 velocity_bits = config->velocity_fraction_bits;
+
+    f32 values[SPECTATOR_ENTITY_FIELDS_COUNT];
+
+    for(u32 i = 0; i < SPECTATOR_ENTITIES_COUNT; ++i)
+    {
+        for(u32 j = 0; j < SPECTATOR_ENTITY_FIELDS_COUNT; ++j)
+        {
+            u32 field         = (i * SPECTATOR_ENTITY_FIELDS_COUNT) + j;
+            u32 fraction_bits = (j == 2 || j == 3) ? velocity_bits : position_bits;
+
+            f32 a_value = spectator_dequantize_f32(a->fields[field], fraction_bits);
+            f32 b_value = spectator_dequantize_f32(b->fields[field], fraction_bits);
+
+            values[j] = a_value + ((b_value - a_value) * t);
+        }
+
+        Entity *entity     = entities[i];
+        entity->position.x = real_from_f32(values[0]);
+        entity->position.y = real_from_f32(values[1]);
+        entity->velocity.x = real_from_f32(values[2]);
+        entity->velocity.y = real_from_f32(values[3]);
+        entity->width      = real_from_f32(values[4]);
+        entity->height     = real_from_f32(values[5]);
+    }
+
+    game_state->winner             = (Winner)a->fields[SPECTATOR_WINNER_FIELD];
+    game_state->match_started      = (b32)a->fields[SPECTATOR_MATCH_STARTED_FIELD];
+    game_state->left_points        = (u32)a->fields[SPECTATOR_LEFT_POINTS_FIELD];
+    game_state->right_points       = (u32)a->fields[SPECTATOR_RIGHT_POINTS_FIELD];
+    game_state->collision_detected = (b32)a->fields[SPECTATOR_COLLISION_DETECTED_FIELD];
+    game_state->sound_to_play      = (SoundToPlay)a->fields[SPECTATOR_SOUND_TO_PLAY_FIELD];
+}
+
+// ===========================================================================================
+
+INTERNAL void
+spectator_encoder_init(SpectatorEncoder *encoder, SpectatorConfig config)
+{
+    ASSERT(config.position_fraction_bits <= SPECTATOR_MAX_FRACTION_BITS);
+    ASSERT(config.velocity_fraction_bits <= SPECTATOR_MAX_FRACTION_BITS);
+
+    memset(encoder, 0, sizeof(*encoder));
+    encoder->config = config;
+
+    for(u32 i = 0; i < SPECTATOR_HISTORY_CAPACITY; ++i)
+    {
+        encoder->ticks[i] = SPECTATOR_NO_TICK;
+    }
+}
+
+// NOTE(leo): Called once per simulated tick. Returns the tick the snapshot was stored as.
+INTERNAL u32
+spectator_encoder_push(SpectatorEncoder *encoder, GameState *game_state)
+{
+    u32 tick  = encoder->next_tick++;
+    u32 index = tick & (SPECTATOR_HISTORY_CAPACITY - 1);
+
+    spectator_quantize(&encoder->config, game_state, &encoder->frames[index]);
+    encoder->ticks[index] = tick;
+
+    return tick;
+}
+
+// NOTE(leo): Encodes the newest snapshot for a spectator that acknowledged the given tick
+// (SPECTATOR_NO_TICK if none yet). Returns the packet size, or 0 if the buffer is too small.
+INTERNAL u32
+spectator_encode(SpectatorEncoder *encoder, u32 acknowledged_tick, u8 *buffer, u32 capacity)
+{
+    ASSERT(encoder->next_tick);
+
+    u32             tick  = encoder->next_tick - 1;
+    SpectatorFrame *frame = &encoder->frames[tick & (SPECTATOR_HISTORY_CAPACITY - 1)];
+
+    PERSISTENT SpectatorFrame zero_frame;
+
+    SpectatorFrame *baseline          = &zero_frame;
+    u32             baseline_distance = 0;
+
+    if(acknowledged_tick != SPECTATOR_NO_TICK && acknowledged_tick < tick
+       && tick - acknowledged_tick < SPECTATOR_HISTORY_CAPACITY
+       && encoder->ticks[acknowledged_tick & (SPECTATOR_HISTORY_CAPACITY - 1)]
+              == acknowledged_tick)
+    {
+        u32 baseline_index = acknowledged_tick & (SPECTATOR_HISTORY_CAPACITY - 1);
+
+        baseline          = &encoder->frames[baseline_index];
+        baseline_distance = tick - acknowledged_tick;
+    }
+
+    BitWriter writer = {0};
+    writer.at        = buffer;
+    writer.end       = buffer + capacity;
+
+    bit_writer_write(&writer, tick, 32);
+    bit_writer_write(&writer, baseline_distance, 8);
+
+    for(u32 field = 0; field < SPECTATOR_FIELDS_COUNT; ++field)
+    {
+        s32 difference = (s32)((u32)frame->fields[field] - (u32)baseline->fields[field]);
+
+        if(difference == 0)
+        {
+            bit_writer_write(&writer, 0, 1);
+        }
+        else
+        {
+            u32 zigzag      = ((u32)difference << 1) ^ (u32)(difference >> 31);
+            u32 bits_length = 32 - (u32)__builtin_clz(zigzag);
+
+            // NOTE(leo): The leading one is implied by the length, so it's not written.
+            bit_writer_write(&writer, 1, 1);
+            bit_writer_write(&writer, bits_length - 1, 5);
+            bit_writer_write(&writer, zigzag, bits_length - 1);
+        }
+    }
+
+    bit_writer_flush(&writer);
+
+    return writer.has_overflowed ? 0 : (u32)(writer.at - buffer);
+}
+
+// ===========================================================================================
+
+INTERNAL void
+spectator_decoder_init(SpectatorDecoder *decoder, SpectatorConfig config)
+{
+    memset(decoder, 0, sizeof(*decoder));
+    decoder->config      = config;
+    decoder->newest_tick = SPECTATOR_NO_TICK;
+
+    for(u32 i = 0; i < SPECTATOR_HISTORY_CAPACITY; ++i)
+    {
+        decoder->ticks[i] = SPECTATOR_NO_TICK;
+    }
+}
+
+INTERNAL SpectatorFrame *
+spectator_decoder_get(SpectatorDecoder *decoder, u32 tick)
+{
+    u32 index = tick & (SPECTATOR_HISTORY_CAPACITY - 1);
+
+    return decoder->ticks[index] == tick ? &decoder->frames[index] : NULL;
+}
+
+// NOTE(leo): Returns false if the packet is malformed, its baseline is no longer (or not
+// yet) in the history, or it's too old to be in the history itself (it would take the slot
+// of a newer tick), in which case it's dropped and the spectator waits for the next one.
+INTERNAL b32
+spectator_decode(SpectatorDecoder *decoder, u8 *data, u32 size)
+{
+    BitReader reader = {0};
+    reader.at        = data;
+    reader.end       = data + size;
+
+    u32 tick              = bit_reader_read(&reader, 32);
+    u32 baseline_distance = bit_reader_read(&reader, 8);
+
+    PERSISTENT SpectatorFrame zero_frame;
+
+    SpectatorFrame *baseline = &zero_frame;
+
+    if(tick == SPECTATOR_NO_TICK || baseline_distance >= SPECTATOR_HISTORY_CAPACITY)
+    {
+        return false;
+    }
+
+    if(decoder->newest_tick != SPECTATOR_NO_TICK && tick < decoder->newest_tick
+       && decoder->newest_tick - tick >= SPECTATOR_HISTORY_CAPACITY)
+    {
+        return false;
+    }
+
+    if(baseline_distance)
+    {
+        baseline = spectator_decoder_get(decoder, tick - baseline_distance);
+
+        if(!baseline)
+        {
+            return false;
+        }
+    }
+
+    SpectatorFrame frame;
+
+    for(u32 field = 0; field < SPECTATOR_FIELDS_COUNT; ++field)
+    {
+        u32 zigzag = 0;
+
+        if(bit_reader_read(&reader, 1))
+        {
+            u32 bits_length = bit_reader_read(&reader, 5) + 1;
+            u32 leading_one = 1U << (bits_length - 1);
+
+            zigzag = leading_one | bit_reader_read(&reader, bits_length - 1);
+        }
+
+        s32 difference = (s32)((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+
+        frame.fields[field] = (s32)((u32)baseline->fields[field] + (u32)difference);
+    }
+
+    if(reader.has_overflowed)
+    {
+        return false;
+    }
+
+    u32 index              = tick & (SPECTATOR_HISTORY_CAPACITY - 1);
+    decoder->frames[index] = frame;
+    decoder->ticks[index]  = tick;
+
+    if(decoder->newest_tick == SPECTATOR_NO_TICK || tick > decoder->newest_tick)
+    {
+        decoder->newest_tick = tick;
+    }
+
+    return true;
+}
+
+// NOTE(leo): Reconstructs the match at a fractional tick, interpolating between the closest
+// snapshots before and after it. Past the newest snapshot it holds the newest one. Returns
+// false if there is nothing to show yet.
+INTERNAL b32
+spectator_decoder_sample(SpectatorDecoder *decoder, f64 tick, GameState *game_state)
+{
+    if(decoder->newest_tick == SPECTATOR_NO_TICK)
+    {
+        return false;
+    }
+
+    u32 newest_tick = decoder->newest_tick;
+    u32 oldest_tick = newest_tick >= SPECTATOR_HISTORY_CAPACITY
+                        ? newest_tick - SPECTATOR_HISTORY_CAPACITY + 1
+                        : 0;
+
+    tick = CLAMP(tick, (f64)oldest_tick, (f64)newest_tick);
+
+    u32 from_tick = (u32)tick;
+    u32 to_tick   = from_tick + 1;
+
+    while(from_tick > oldest_tick && !spectator_decoder_get(decoder, from_tick))
+    {
+        from_tick--;
+    }
+
+    while(to_tick < newest_tick && !spectator_decoder_get(decoder, to_tick))
+    {
+        to_tick++;
+    }
+
+    SpectatorFrame *from = spectator_decoder_get(decoder, from_tick);
+    SpectatorFrame *to   = NULL;
+
+    if(to_tick <= newest_tick)
+    {
+        to = spectator_decoder_get(decoder, to_tick);
+    }
+
+    if(!from)
+    {
+        // NOTE(leo): Everything before the requested tick was lost, show the next snapshot.
+        from      = to ? to : spectator_decoder_get(decoder, newest_tick);
+        from_tick = to ? to_tick : newest_tick;
+    }
+
+    f32 t = 0.0f;
+
+    if(to && to != from)
+    {
+        // NOTE(leo): A point or a new round puts the ball back in the middle. Interpolating
+        // across that would draw it flying over the court, so it snaps instead.
+        b32 is_continuous = true;
+        u32 discontinuous_fields[] = {SPECTATOR_LEFT_POINTS_FIELD,
+                                      SPECTATOR_RIGHT_POINTS_FIELD,
+                                      SPECTATOR_MATCH_STARTED_FIELD};
+
+        for(u32 i = 0; i < STATIC_ARRAY_LENGTH(discontinuous_fields); ++i)
+        {
+            u32 field = discontinuous_fields[i];
+
+            if(from->fields[field] != to->fields[field])
+            {
+                is_continuous = false;
+            }
+        }
+
+        if(is_continuous && tick > (f64)from_tick)
+        {
+            t = (f32)((tick - (f64)from_tick) / (f64)(to_tick - from_tick));
+        }
+    }
+
+    spectator_dequantize(&decoder->config, from, to ? to : from, t, game_state);
+
+    return true;
+}
@@ -396,3 +396,50 @@ str8_format(char *result, u64 result_capacity, String8 format, ...)
     va_end(variable_arguments);
     return formated_length;
 }
+
+INTERNAL b32
+str8_equals(String8 a, String8 b)
+{
+    if(a.length != b.length)
+    {
+        return false;
+    }
+
+    for(u32 i = 0; i < a.length; ++i)
+    {
+        if(a.data[i] != b.data[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// NOTE(leo): Decimal digits only. Returns false for anything else, or if it overflows.
+INTERNAL b32
+str8_parse_u64(String8 string, u64 *value)
+{
+    u64 result = 0;
+
+    if(!string.length)
+    {
+        return false;
+    }
+
+    for(u32 i = 0; i < string.length; ++i)
+    {
+        char character = string.data[i];
+
+        if(character < '0' || character > '9' || result > (U64_MAX - 9) / 10)
+        {
+            return false;
+        }
+
+        result = (result * 10) + (u64)(character - '0');
+    }
+
+    *value = result;
+
+    return true;
+}
@@ -51,6 +51,12 @@ typedef double f64;
 #define GET_BIT(variable, bit_index) (((variable) >> (bit_index)) & 1)
 #define STATIC_ARRAY_LENGTH(array)   (sizeof((array)) / sizeof(*(array)))
 
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
+#define CLAMP(value, minimum, maximum)                                                       \
+    ((value) < (minimum) ? (minimum) : ((value) > (maximum) ? (maximum) : (value)))
+
 // ===========================================================================================
 
 #pragma clang diagnostic push
@@ -0,0 +1,791 @@
+// NOTE(leo): Records the frames presented into a video file small enough to keep every match.
+// The scene has two colors, the background and the entities, so each frame is a 1-bit image
+// (the layout of BACK_BUFFER_BITPLANE, whatever the back buffer's format), and most of it is
+// the same as in the frame before. A frame only stores the rows that changed since the one
+// before it, each row as runs of pixels of the same color. The thread presenting encodes the
+// frame into a ring of bytes, and a thread of its own writes the ring to the file.
+//
+// The file is "PVID" and its version, then the frames. A frame is its size (u32, not
+// counting itself), its flags, the microseconds since the frame before and:
+//   - For key frames (VIDEO_FRAME_KEY), the width, the height and the palette (two u32),
+//     then every row. They don't depend on the frame before, so a file cut short still plays
+//     from the last one.
+//   - For the others, a bit per row, set for the rows that changed, then those rows.
+// A row is a byte saying how it's stored, then either the lengths of its runs (starting with
+// a run of 0 bits, which can be empty) or its bits, whichever is smaller. Numbers other than
+// the frame's size and the palette are LEB128, and everything is little endian.
+//
+// If the ring is full the frame is dropped, the next frame is encoded against the same frame
+// the one dropped would have been, and its time includes the time of the one dropped.
+
+#define VIDEO_VERSION 1
+
+// NOTE(leo): Five seconds at 60Hz.
+#define VIDEO_KEY_FRAME_INTERVAL 300
+
+// NOTE(leo): Seconds of a 4K match compress to less than this, the ring only fills when the
+// disk stalls.
+#define VIDEO_RING_SIZE (8 * 1024 * 1024)
+
+#define VIDEO_FRAME_KEY 0x1
+
+#define VIDEO_ROW_RUNS 0
+#define VIDEO_ROW_BITS 1
+
+// ===========================================================================================
+
+typedef struct
+{
+    u64 frames_encoded;
+    u64 key_frames;
+
+    // NOTE(leo): Frames that didn't fit in the ring.
+    u64 frames_dropped;
+
+    u64 bytes_encoded;
+    s64 encode_ticks;
+
+    // NOTE(leo): Set by the writing thread, the file is missing what came after.
+    b32 has_write_failed;
+
+} VideoStats;
+
+typedef struct
+{
+    OsFile file;
+
+    // NOTE(leo): The positions only grow, they wrap around the ring when used. ring_write is
+    // only changed by the thread adding frames and ring_read by the writing thread.
+    u8 *ring;
+    u64 ring_write;
+    u64 ring_read;
+
+    OsThread    thread;
+    OsSemaphore data_queued;
+    b32         is_stopping;
+
+    // NOTE(leo): Only touched by the thread adding frames. reference is the image of the
+    // last frame that went in the ring, current the one being encoded.
+    s32  width;
+    s32  height;
+    u32  palette[2];
+    u64 *reference;
+    u64 *current;
+    u64  image_capacity;
+    u8  *encoded;
+    u64  encoded_capacity;
+    u32  frames_since_key_frame;
+    b32  needs_key_frame;
+    u64  pending_microseconds;
+
+    VideoStats stats;
+
+} VideoRecorder;
+
+typedef struct
+{
+    u8 *at;
+    u8 *end;
+
+    // NOTE(leo): The frame decoded last, in BACK_BUFFER_BITPLANE.
+    BackBuffer frame;
+    u64        frame_capacity;
+    b32        has_key_frame;
+
+    u64 microseconds;
+    u32 frames_count;
+
+    // NOTE(leo): Set when video_player_next_frame stopped before the end of the file.
+    b32 is_corrupt;
+
+} VideoPlayer;
+
+// ===========================================================================================
+
+INTERNAL u8 *
+video_write_varint(u8 *at, u64 value)
+{
+    while(value >= 0x80)
+    {
+        *at++ = (u8)(value | 0x80);
+        value >>= 7;
+    }
+
+    *at++ = (u8)value;
+
+    return at;
+}
+
+INTERNAL u8 *
+video_write_u32(u8 *at, u32 value)
+{
+    at[0] = (u8)value;
+    at[1] = (u8)(value >> 8);
+    at[2] = (u8)(value >> 16);
+    at[3] = (u8)(value >> 24);
+
+    return at + 4;
+}
+
+// NOTE(leo): Returns false if it doesn't end before end.
+INTERNAL b32
+video_read_varint(u8 **at, u8 *end, u64 *value)
+{
+    *value = 0;
+
+    for(u32 shift = 0; shift < 64 && *at < end; shift += 7)
+    {
+        u8 byte = *(*at)++;
+        *value |= (u64)(byte & 0x7F) << shift;
+
+        if(!(byte & 0x80))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+INTERNAL b32
+video_read_u32(u8 **at, u8 *end, u32 *value)
+{
+    if(end - *at < 4)
+    {
+        return false;
+    }
+
+    u8 *bytes = *at;
+    *value = (u32)bytes[0] | ((u32)bytes[1] << 8) | ((u32)bytes[2] << 16)
+             | ((u32)bytes[3] << 24);
+    *at += 4;
+
+    return true;
+}
+
+// NOTE(leo): The first pixel from x on that isn't bit, or width if there is none.
+INTERNAL s32
+video_find_run_end(u64 *row, s32 x, s32 width, u32 bit)
+{
+    u64 flip = bit ? ~0ull : 0;
+
+    while(x < width)
+    {
+        u64 word = (row[x / 64] ^ flip) >> (x % 64);
+
+        if(word)
+        {
+            return MIN(x + __builtin_ctzll(word), width);
+        }
+
+        x = (x / 64 + 1) * 64;
+    }
+
+    return width;
+}
+
+// NOTE(leo): Sets the bits from begin to end.
+INTERNAL void
+video_set_bits(u64 *row, s32 begin, s32 end)
+{
+    while(begin < end)
+    {
+        s32 bits_count = MIN(end - begin, 64 - (begin % 64));
+        u64 mask       = bits_count == 64 ? ~0ull : ((1ull << bits_count) - 1);
+
+        row[begin / 64] |= mask << (begin % 64);
+        begin += bits_count;
+    }
+}
+
+// NOTE(leo): The frame as 1 bit per pixel, set where it isn't the background. In
+// 0x00RRGGBB, four pixels are compared at a time.
+INTERNAL void
+video_frame_to_image(VideoRecorder *recorder, BackBuffer *frame, u64 *image)
+{
+    s32 words_per_row = bitplane_words_per_row(frame->width);
+
+    if(frame->format == BACK_BUFFER_BITPLANE)
+    {
+        for(s32 y = 0; y < frame->height; ++y)
+        {
+            memcpy(image + ((s64)y * words_per_row),
+                   (u8 *)frame->pixels + ((s64)y * frame->pitch),
+                   (u64)words_per_row * sizeof(u64));
+        }
+
+        return;
+    }
+
+    __m128i background = _mm_set1_epi32((int)recorder->palette[0]);
+
+    for(s32 y = 0; y < frame->height; ++y)
+    {
+        u32 *pixel = (u32 *)((u8 *)frame->pixels + ((s64)y * frame->pitch));
+        u64 *row   = image + ((s64)y * words_per_row);
+
+        for(s32 word_index = 0; word_index < words_per_row; ++word_index)
+        {
+            s32 pixels_count = MIN(frame->width - (word_index * 64), 64);
+            u64 word         = 0;
+            s32 i            = 0;
+
+            for(; i + 4 <= pixels_count; i += 4)
+            {
+                __m128i pixels  = _mm_loadu_si128((__m128i *)(pixel + i));
+                __m128i is_same = _mm_cmpeq_epi32(pixels, background);
+                u64     bits    = (u64)(~_mm_movemask_ps(_mm_castsi128_ps(is_same)) & 0xF);
+
+                word |= bits << i;
+            }
+
+            for(; i < pixels_count; ++i)
+            {
+                word |= (u64)(pixel[i] != recorder->palette[0]) << i;
+            }
+
+            row[word_index] = word;
+            pixel += 64;
+        }
+    }
+}
+
+// NOTE(leo): The Windows layer has no CRT, so no memcmp.
+INTERNAL b32
+video_rows_are_equal(u64 *a, u64 *b, s32 words_per_row)
+{
+    for(s32 i = 0; i < words_per_row; ++i)
+    {
+        if(a[i] != b[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// NOTE(leo): Returns where the row ended.
+INTERNAL u8 *
+video_encode_row(u64 *row, s32 width, u8 *at)
+{
+    u64 bits_size = ((u64)width + 7) / 8;
+    u8 *begin     = at;
+
+    *at++ = VIDEO_ROW_RUNS;
+
+    u32 bit = 0;
+
+    for(s32 x = 0; x < width;)
+    {
+        s32 run_end = video_find_run_end(row, x, width, bit);
+        at          = video_write_varint(at, (u64)(run_end - x));
+
+        // NOTE(leo): Bigger than its bits, they go instead.
+        if((u64)(at - begin) > bits_size + 1)
+        {
+            at    = begin;
+            *at++ = VIDEO_ROW_BITS;
+
+            memcpy(at, row, bits_size);
+            return at + bits_size;
+        }
+
+        x = run_end;
+        bit ^= 1;
+    }
+
+    return at;
+}
+
+// NOTE(leo): The most bytes a frame can take, its size included.
+INTERNAL u64
+video_frame_capacity(s32 width, s32 height)
+{
+    // NOTE(leo): A row of runs is given up for its bits after the run that makes it
+    // bigger, which can take a varint.
+    u64 row_capacity = 1 + (((u64)width + 7) / 8) + 10;
+
+    return 4 + 1 + 10 + 10 + 10 + 8 + (((u64)height + 7) / 8) + ((u64)height * row_capacity);
+}
+
+// NOTE(leo): Returns the size of the frame, its size included.
+INTERNAL u64
+video_encode_frame(VideoRecorder *recorder, b32 is_key_frame, u64 microseconds)
+{
+    s32 words_per_row = bitplane_words_per_row(recorder->width);
+    u8 *at            = recorder->encoded + 4;
+
+    *at++ = is_key_frame ? VIDEO_FRAME_KEY : 0;
+    at    = video_write_varint(at, microseconds);
+
+    if(is_key_frame)
+    {
+        at = video_write_varint(at, (u64)recorder->width);
+        at = video_write_varint(at, (u64)recorder->height);
+        at = video_write_u32(at, recorder->palette[0]);
+        at = video_write_u32(at, recorder->palette[1]);
+    }
+
+    u8 *changed_rows = at;
+
+    if(!is_key_frame)
+    {
+        u64 changed_rows_size = ((u64)recorder->height + 7) / 8;
+
+        memset(changed_rows, 0, changed_rows_size);
+        at += changed_rows_size;
+    }
+
+    for(s32 y = 0; y < recorder->height; ++y)
+    {
+        u64 *row           = recorder->current + ((s64)y * words_per_row);
+        u64 *reference_row = recorder->reference + ((s64)y * words_per_row);
+
+        if(!is_key_frame)
+        {
+            if(video_rows_are_equal(row, reference_row, words_per_row))
+            {
+                continue;
+            }
+
+            changed_rows[y / 8] |= (u8)(1 << (y % 8));
+        }
+
+        at = video_encode_row(row, recorder->width, at);
+    }
+
+    u64 size = (u64)(at - recorder->encoded);
+    video_write_u32(recorder->encoded, (u32)(size - 4));
+
+    return size;
+}
+
+// ===========================================================================================
+
+INTERNAL void
+video_recorder_thread(void *parameter)
+{
+    VideoRecorder *recorder = parameter;
+
+    for(;;)
+    {
+        os_semaphore_wait(&recorder->data_queued);
+
+        // NOTE(leo): Checked before writing, so what was added before stopping is written.
+        b32 is_stopping = __atomic_load_n(&recorder->is_stopping, __ATOMIC_ACQUIRE);
+
+        u64 read  = recorder->ring_read;
+        u64 write = __atomic_load_n(&recorder->ring_write, __ATOMIC_ACQUIRE);
+
+        while(read < write && !recorder->stats.has_write_failed)
+        {
+            u64 offset = read % VIDEO_RING_SIZE;
+            u64 size   = MIN(write - read, VIDEO_RING_SIZE - offset);
+
+            if(!os_file_write(&recorder->file, recorder->ring + offset, size))
+            {
+                __atomic_store_n(&recorder->stats.has_write_failed, true, __ATOMIC_RELEASE);
+                break;
+            }
+
+            read += size;
+        }
+
+        // NOTE(leo): After a failure the rest is thrown away, so the ring never fills up.
+        __atomic_store_n(&recorder->ring_read, write, __ATOMIC_RELEASE);
+
+        if(is_stopping)
+        {
+            break;
+        }
+    }
+}
+
+// NOTE(leo): Every frame added goes through the ring, it must hold at least one.
+INTERNAL b32
+video_recorder_push(VideoRecorder *recorder, u8 *data, u64 size)
+{
+    u64 read = __atomic_load_n(&recorder->ring_read, __ATOMIC_ACQUIRE);
+
+    if(VIDEO_RING_SIZE - (recorder->ring_write - read) < size)
+    {
+        return false;
+    }
+
+    u64 offset     = recorder->ring_write % VIDEO_RING_SIZE;
+    u64 first_size = MIN(size, VIDEO_RING_SIZE - offset);
+
+    memcpy(recorder->ring + offset, data, first_size);
+    memcpy(recorder->ring, data + first_size, size - first_size);
+
+    __atomic_store_n(&recorder->ring_write, recorder->ring_write + size, __ATOMIC_RELEASE);
+    os_semaphore_signal(&recorder->data_queued, 1);
+
+    return true;
+}
+
+// NOTE(leo): palette is the background's color and the entities'. Returns false if the file
+// couldn't be created or the writing thread started.
+INTERNAL b32
+video_recorder_open(VideoRecorder *recorder, char *file_path, u32 palette[2])
+{
+    memset(recorder, 0, sizeof(*recorder));
+
+    recorder->palette[0] = palette[0];
+    recorder->palette[1] = palette[1];
+
+    recorder->ring = malloc(VIDEO_RING_SIZE);
+
+    if(!recorder->ring)
+    {
+        return false;
+    }
+
+    if(!os_file_create(&recorder->file, file_path))
+    {
+        free(recorder->ring);
+        return false;
+    }
+
+    if(!os_semaphore_init(&recorder->data_queued, 0))
+    {
+        os_file_close(&recorder->file);
+        free(recorder->ring);
+        return false;
+    }
+
+    if(!os_thread_create(&recorder->thread, video_recorder_thread, recorder))
+    {
+        os_semaphore_destroy(&recorder->data_queued);
+        os_file_close(&recorder->file);
+        free(recorder->ring);
+        return false;
+    }
+
+    u8 header[8];
+    memcpy(header, "PVID", 4);
+    video_write_u32(header + 4, VIDEO_VERSION);
+
+    video_recorder_push(recorder, header, sizeof(header));
+
+    return true;
+}
+
+// NOTE(leo): Writes what's left in the ring and closes the file.
+INTERNAL void
+video_recorder_close(VideoRecorder *recorder)
+{
+    __atomic_store_n(&recorder->is_stopping, true, __ATOMIC_RELEASE);
+    os_semaphore_signal(&recorder->data_queued, 1);
+    os_thread_join(&recorder->thread);
+    os_semaphore_destroy(&recorder->data_queued);
+    os_file_close(&recorder->file);
+
+    free(recorder->ring);
+    free(recorder->reference);
+    free(recorder->current);
+    free(recorder->encoded);
+
+    recorder->ring      = NULL;
+    recorder->reference = NULL;
+    recorder->current   = NULL;
+    recorder->encoded   = NULL;
+}
+
+// NOTE(leo): Encodes the frame, microseconds after the one added before it. Only
+// BACK_BUFFER_RGB and BACK_BUFFER_BITPLANE frames, RGB pixels that aren't the background are
+// the entities' color in the video. Returns false if the frame was dropped.
+INTERNAL b32
+video_recorder_add_frame(VideoRecorder *recorder, BackBuffer *frame, u64 microseconds)
+{
+    s64 begin = os_get_cpu_tick();
+
+    recorder->pending_microseconds += microseconds;
+
+    if(frame->format != BACK_BUFFER_RGB && frame->format != BACK_BUFFER_BITPLANE)
+    {
+        return false;
+    }
+
+    if(frame->width != recorder->width || frame->height != recorder->height)
+    {
+        u64 image_size       = (u64)bitplane_words_per_row(frame->width) * sizeof(u64)
+                               * (u64)frame->height;
+        u64 encoded_capacity = video_frame_capacity(frame->width, frame->height);
+
+        // NOTE(leo): Only grows, like the glyph atlas.
+        if(image_size > recorder->image_capacity)
+        {
+            free(recorder->reference);
+            free(recorder->current);
+
+            recorder->reference      = malloc(image_size);
+            recorder->current        = malloc(image_size);
+            recorder->image_capacity = image_size;
+        }
+
+        if(encoded_capacity > recorder->encoded_capacity)
+        {
+            free(recorder->encoded);
+
+            recorder->encoded          = malloc(encoded_capacity);
+            recorder->encoded_capacity = encoded_capacity;
+        }
+
+        if(!recorder->reference || !recorder->current || !recorder->encoded)
+        {
+            free(recorder->reference);
+            free(recorder->current);
+            free(recorder->encoded);
+
+            recorder->reference        = NULL;
+            recorder->current          = NULL;
+            recorder->encoded          = NULL;
+            recorder->image_capacity   = 0;
+            recorder->encoded_capacity = 0;
+            recorder->width            = 0;
+            recorder->height           = 0;
+
+            return false;
+        }
+
+        recorder->width           = frame->width;
+        recorder->height          = frame->height;
+        recorder->needs_key_frame = true;
+    }
+
+    video_frame_to_image(recorder, frame, recorder->current);
+
+    b32 is_key_frame = recorder->needs_key_frame
+                       || recorder->frames_since_key_frame >= VIDEO_KEY_FRAME_INTERVAL;
+
+    u64 size = video_encode_frame(recorder, is_key_frame, recorder->pending_microseconds);
+    b32 fits = video_recorder_push(recorder, recorder->encoded, size);
+
+    if(fits)
+    {
+        u64 *reference      = recorder->reference;
+        recorder->reference = recorder->current;
+        recorder->current   = reference;
+
+        recorder->needs_key_frame        = false;
+        recorder->frames_since_key_frame =
+            is_key_frame ? 1 : recorder->frames_since_key_frame + 1;
+        recorder->pending_microseconds   = 0;
+
+        recorder->stats.frames_encoded++;
+        recorder->stats.key_frames += is_key_frame;
+        recorder->stats.bytes_encoded += size;
+    }
+    else
+    {
+        recorder->stats.frames_dropped++;
+    }
+
+    recorder->stats.encode_ticks += os_get_cpu_tick() - begin;
+
+    return fits;
+}
+
+// ===========================================================================================
+
+// NOTE(leo): The file must stay around while playing. Returns false if it isn't a video.
+INTERNAL b32
+video_player_open(VideoPlayer *player, FileContents file)
+{
+    memset(player, 0, sizeof(*player));
+
+    u32 version;
+
+    player->at  = file.data;
+    player->end = file.data + file.size;
+
+    if(!file.data || file.size < 8 || file.data[0] != 'P' || file.data[1] != 'V'
+       || file.data[2] != 'I' || file.data[3] != 'D')
+    {
+        return false;
+    }
+
+    player->at += 4;
+
+    return video_read_u32(&player->at, player->end, &version) && version == VIDEO_VERSION;
+}
+
+INTERNAL void
+video_player_close(VideoPlayer *player)
+{
+    free(player->frame.pixels);
+    memset(player, 0, sizeof(*player));
+}
+
+INTERNAL b32
+video_decode_row(u8 **at, u8 *end, u64 *row, s32 width)
+{
+    s32 words_per_row = bitplane_words_per_row(width);
+
+    memset(row, 0, (u64)words_per_row * sizeof(u64));
+
+    if(*at >= end)
+    {
+        return false;
+    }
+
+    u8 storage = *(*at)++;
+
+    if(storage == VIDEO_ROW_BITS)
+    {
+        u64 bits_size = ((u64)width + 7) / 8;
+
+        if((u64)(end - *at) < bits_size)
+        {
+            return false;
+        }
+
+        memcpy(row, *at, bits_size);
+        *at += bits_size;
+
+        return true;
+    }
+
+    if(storage != VIDEO_ROW_RUNS)
+    {
+        return false;
+    }
+
+    u32 bit = 0;
+
+    for(s32 x = 0; x < width;)
+    {
+        u64 run;
+
+        if(!video_read_varint(at, end, &run) || run > (u64)(width - x))
+        {
+            return false;
+        }
+
+        if(bit)
+        {
+            video_set_bits(row, x, x + (s32)run);
+        }
+
+        x += (s32)run;
+        bit ^= 1;
+    }
+
+    return true;
+}
+
+// NOTE(leo): Decodes the next frame into player->frame. Returns false at the end of the file,
+// or if the frame is corrupt (then is_corrupt is set).
+INTERNAL b32
+video_player_next_frame(VideoPlayer *player)
+{
+    if(player->at == player->end)
+    {
+        return false;
+    }
+
+    u32 size;
+    u8 *at = player->at;
+
+    if(!video_read_u32(&at, player->end, &size) || (u64)(player->end - at) < size || !size)
+    {
+        player->is_corrupt = true;
+        return false;
+    }
+
+    u8 *end   = at + size;
+    u8  flags = *at++;
+    u64 microseconds;
+
+    if(!video_read_varint(&at, end, &microseconds))
+    {
+        player->is_corrupt = true;
+        return false;
+    }
+
+    BackBuffer *frame        = &player->frame;
+    b32         is_key_frame = flags & VIDEO_FRAME_KEY;
+
+    if(is_key_frame)
+    {
+        u64 width;
+        u64 height;
+        u32 palette[2];
+
+        if(!video_read_varint(&at, end, &width) || !video_read_varint(&at, end, &height)
+           || !video_read_u32(&at, end, &palette[0]) || !video_read_u32(&at, end, &palette[1])
+           || !width || !height || width > S16_MAX || height > S16_MAX)
+        {
+            player->is_corrupt = true;
+            return false;
+        }
+
+        frame->format = BACK_BUFFER_BITPLANE;
+        back_buffer_set_size(frame, (s32)width, (s32)height, false);
+
+        frame->palette[0] = palette[0];
+        frame->palette[1] = palette[1];
+
+        u64 frame_size = back_buffer_size(frame);
+
+        if(frame_size > player->frame_capacity)
+        {
+            free(frame->pixels);
+
+            frame->pixels          = malloc(frame_size);
+            player->frame_capacity = frame->pixels ? frame_size : 0;
+
+            if(!frame->pixels)
+            {
+                player->is_corrupt = true;
+                return false;
+            }
+        }
+
+        player->has_key_frame = true;
+    }
+    else if(!player->has_key_frame)
+    {
+        player->is_corrupt = true;
+        return false;
+    }
+
+    u8 *changed_rows = at;
+
+    if(!is_key_frame)
+    {
+        u64 changed_rows_size = ((u64)frame->height + 7) / 8;
+
+        if((u64)(end - at) < changed_rows_size)
+        {
+            player->is_corrupt = true;
+            return false;
+        }
+
+        at += changed_rows_size;
+    }
+
+    for(s32 y = 0; y < frame->height; ++y)
+    {
+        if(!is_key_frame && !(changed_rows[y / 8] & (1 << (y % 8))))
+        {
+            continue;
+        }
+
+        u64 *row = (u64 *)((u8 *)frame->pixels + ((s64)y * frame->pitch));
+
+        if(!video_decode_row(&at, end, row, frame->width))
+        {
+            player->is_corrupt = true;
+            return false;
+        }
+    }
+
+    player->at = end;
+    player->microseconds += microseconds;
+    player->frames_count++;
+
+    return true;
+}
@@ -17,9 +17,27 @@
 void *memset(void *dest_buffer, int value_to_set_per_byte, size_t num_of_bytes_to_set);
 void *memcpy(void *dest_buffer, void const *src_buffer, size_t num_of_bytes_to_copy);
 void *malloc(size_t bytes_to_alloc);
+void  free(void *memory);
 
 #include "../game_main.c"
 
+#include "../replay.c"
+#include "../snapshot_ring.c"
+#include "../netplay.c"
+#include "../ai.c"
+#include "../bot_link.c"
+#include "../job_system.c"
+#include "../post_process.c"
+#include "../render_pipeline.c"
+#include "../resolution_governor.c"
+#include "../screenshot.c"
+#include "../video.c"
+#include "../frame_export.c"
+
+#ifdef LATENCY_MEASUREMENT
+    #include "../latency_meter.c"
+#endif // LATENCY_MEASUREMENT
+
 // ===========================================================================================
 
 // NOTE(leo): Setting the minimum supported Windows version to 10.
@@ -71,6 +89,8 @@ void *malloc(size_t bytes_to_alloc);
 #include <Windows.h>
 #define COM_NO_WINDOWS_H
 
+#include <winsock2.h>
+
 #include <timeapi.h>
 #include <objbase.h>
 #define COBJMACROS
@@ -163,15 +183,40 @@ GLOBAL struct
 {
     HWND    window_handle;
     HDC     window_dc;
-    HBITMAP bitmap_handle;
-    HDC     bitmap_dc;
+    HBITMAP bitmap_handles[RENDER_PIPELINE_BUFFERS_COUNT];
+    HDC     bitmap_dcs[RENDER_PIPELINE_BUFFERS_COUNT];
+    void   *bitmap_pixels[RENDER_PIPELINE_BUFFERS_COUNT];
+    s32     bitmap_pitch;
     RECT    fullscreen_rect;
     RECT    windowed_rect;
     s32     blit_dest_x;
     s32     blit_dest_y;
+    s32     blit_width;
+    s32     blit_height;
     s32     last_client_width;
     s32     last_client_height;
 
+    // NOTE(leo): With BACK_BUFFER_BITPLANE the game renders into bitplanes, which are
+    // expanded into the bitmaps when presenting.
+    BackBufferFormat back_buffer_format;
+    void            *bitplanes[RENDER_PIPELINE_BUFFERS_COUNT];
+    u64              bitplanes_size;
+
+    // NOTE(leo): The first frame presented that's at least this new is saved as a
+    // screenshot, 0 for none. It's a frame number of the render pipeline.
+    u64 screenshot_frame;
+    u32 screenshots_count;
+
+#ifdef VIDEO_RECORDING
+    b32 is_recording_video;
+    u64 video_last_frame;
+    s64 video_last_tick;
+#endif // VIDEO_RECORDING
+
+#ifdef FRAME_EXPORT
+    u64 frame_export_last_frame;
+#endif // FRAME_EXPORT
+
 } g_win32 = {0};
 
 GLOBAL struct
@@ -183,6 +228,51 @@ GLOBAL struct
 
 GLOBAL DWORD g_last_error;
 
+GLOBAL b32 g_is_key_down[KEYS_COUNT] = {0};
+
+// NOTE(leo): Every session is recorded and saved when the program quits (even when it quits
+// because of an error), so field bug reports can come with a replay attached.
+GLOBAL ReplayRecorder g_replay_recorder;
+
+// NOTE(leo): Filled by the window callback and consumed once per frame by the main loop.
+GLOBAL struct
+{
+    s32 steps;
+    b32 instant_replay;
+    b32 resume;
+
+} g_rewind_requests = {0};
+
+#ifdef LATENCY_MEASUREMENT
+GLOBAL LatencyMeter g_latency_meter;
+#endif // LATENCY_MEASUREMENT
+
+// NOTE(leo): Set when paddles are played by bots in other processes (see bot_link.c).
+GLOBAL BotLink *g_bot_link = NULL;
+
+// NOTE(leo): Frames are rendered on a thread of their own while the main thread simulates
+// the next tick (see render_pipeline.c). The render thread owns g_back_buffer, the main
+// thread only touches the pipeline's back buffers.
+GLOBAL RenderPipeline g_render_pipeline;
+
+// NOTE(leo): The back buffers are the size of the blit times the governor's scale. Until the
+// governor is initialized, that's the size of the blit.
+GLOBAL ResolutionGovernor g_resolution_governor = {0};
+
+// NOTE(leo): Screenshots are taken on F12 and at the end of every match, for disputes.
+GLOBAL ScreenshotPool g_screenshot_pool;
+
+#ifdef VIDEO_RECORDING
+// NOTE(leo): Every frame presented goes to session_<date>_<time>.pvid (see video.c).
+GLOBAL VideoRecorder g_video_recorder;
+#endif // VIDEO_RECORDING
+
+#ifdef FRAME_EXPORT
+// NOTE(leo): Every frame presented is also published to other processes (see
+// frame_export.c). NULL if the segment couldn't be created.
+GLOBAL FrameExport *g_frame_export = NULL;
+#endif // FRAME_EXPORT
+
 // ===========================================================================================
 
 INTERNAL void
@@ -191,6 +281,41 @@ win32_exit(UINT exit_code)
     // NOTE(leo): There is no need to call timeEndPeriod since the OS will automatically
     // restore the scheduler as soon as the process ends.
 
+    replay_save(&g_replay_recorder, "last_session.replay");
+
+    // NOTE(leo): Writes the screenshots still queued, the one of the last match may be.
+    if(g_screenshot_pool.thread.handle)
+    {
+        screenshot_pool_shutdown(&g_screenshot_pool);
+    }
+
+#ifdef VIDEO_RECORDING
+    if(g_win32.is_recording_video)
+    {
+        video_recorder_close(&g_video_recorder);
+    }
+#endif // VIDEO_RECORDING
+
+#ifdef FRAME_EXPORT
+    if(g_frame_export)
+    {
+        frame_export_destroy(g_frame_export, FRAME_EXPORT_DEFAULT_NAME);
+    }
+#endif // FRAME_EXPORT
+
+    if(g_bot_link)
+    {
+        __atomic_store_n(&g_bot_link->is_closed, true, __ATOMIC_RELEASE);
+    }
+
+#ifdef LATENCY_MEASUREMENT
+    char report[2048];
+    u32  report_length = latency_format_report(&g_latency_meter, report, sizeof(report));
+
+    os_print((String8) {report, report_length});
+    os_write_entire_file("latency_report.txt", report, report_length);
+#endif // LATENCY_MEASUREMENT
+
     ExitProcess(exit_code);
 }
 
@@ -251,81 +376,348 @@ win32_message(MessageType type, String8 message_format, ...)
     }
 }
 
+INTERNAL s64
+win32_get_cpu_tick(void)
+{
+    LARGE_INTEGER li_counter;
+
+    if(!QueryPerformanceCounter(&li_counter))
+    {
+        // NOTE(leo): According to MSDN, will never fail on Windows XP or later. We only
+        // ASSERT.
+        WIN32_ERROR_LITERAL("Failed to get performance counter. The MSDN docs lied to us!");
+    }
+    return li_counter.QuadPart;
+}
+
+INTERNAL f32
+win32_get_seconds_elapsed(s64 init_tick, s64 end_tick)
+{
+    s64 delta = end_tick - init_tick;
+    ASSERT(delta > 0);
+    return (f32)delta / g_cpu_ticks_per_second;
+}
+
+#ifdef LATENCY_MEASUREMENT
+
+INTERNAL void
+win32_latency_key_event(u32 paddle_index, b32 is_down, b32 was_down)
+{
+    if(is_down && !was_down)
+    {
+        // NOTE(leo): GetMessageTime tells when the message was posted, in GetTickCount
+        // milliseconds. We move the QPC stamp back by the time it sat in the queue, so the
+        // sample includes the wait for the next PeekMessage.
+        s64   now_tick  = win32_get_cpu_tick();
+        DWORD queued_ms = GetTickCount() - (DWORD)GetMessageTime();
+
+        s64 arrival_tick =
+            now_tick - (s64)(((f32)queued_ms * g_cpu_ticks_per_second) / 1000.0f);
+
+        latency_key_pressed(&g_latency_meter, paddle_index, arrival_tick);
+    }
+    else if(!is_down)
+    {
+        latency_key_released(&g_latency_meter, paddle_index);
+    }
+}
+
+#endif // LATENCY_MEASUREMENT
+
 INTERNAL void
 win32_resize_graphics(s32 new_width, s32 new_height)
 {
-    if((new_width != g_back_buffer.width) || (new_height != g_back_buffer.height))
+    BackBuffer *current = &g_render_pipeline.back_buffers[0];
+
+    if((new_width != current->width) || (new_height != current->height))
     {
+        // NOTE(leo): The render thread may still be drawing into the old bitmaps.
+        render_pipeline_wait_idle(&g_render_pipeline);
+
+        // NOTE(leo): The bitmaps are as wide as the rows padded to BACK_BUFFER_ROW_ALIGNMENT,
+        // only new_width pixels of each row are blitted. Their memory is page aligned.
+        BackBuffer bitmap_layout = {0};
+        back_buffer_set_size(&bitmap_layout, new_width, new_height, true);
+
+        g_win32.bitmap_pitch = bitmap_layout.pitch;
+
         BITMAPINFO bitmap_info = {0};
 
         bitmap_info.bmiHeader.biSize        = sizeof(bitmap_info.bmiHeader);
-        bitmap_info.bmiHeader.biWidth       = new_width;
+        bitmap_info.bmiHeader.biWidth       = bitmap_layout.pitch / (s32)sizeof(u32);
         bitmap_info.bmiHeader.biHeight      = -new_height; // NOTE(leo): Negative for top-down
         bitmap_info.bmiHeader.biPlanes      = 1;
         bitmap_info.bmiHeader.biBitCount    = 32;
         bitmap_info.bmiHeader.biCompression = BI_RGB;
         // NOTE(leo): There are more members that are beeing set to 0 and NULL.
 
-        HDC temp_bitmap_dc = NULL;
+        BackBuffer back_buffers[RENDER_PIPELINE_BUFFERS_COUNT];
 
-        void   *temp_pixels;
-        HBITMAP temp_bitmap = CreateDIBSection(g_win32.window_dc,
-                                               &bitmap_info,
-                                               DIB_RGB_COLORS,
-                                               &temp_pixels,
-                                               NULL,
-                                               0);
-        if(!temp_bitmap)
+        for(u32 i = 0; i < RENDER_PIPELINE_BUFFERS_COUNT; ++i)
         {
-            WIN32_ERROR_LITERAL("Failed to create temporary bitmap.");
-        }
+            HDC temp_bitmap_dc = NULL;
+
+            void   *temp_pixels;
+            HBITMAP temp_bitmap = CreateDIBSection(g_win32.window_dc,
+                                                   &bitmap_info,
+                                                   DIB_RGB_COLORS,
+                                                   &temp_pixels,
+                                                   NULL,
+                                                   0);
+            if(!temp_bitmap)
+            {
+                WIN32_ERROR_LITERAL("Failed to create temporary bitmap.");
+            }
 
-        temp_bitmap_dc = CreateCompatibleDC(g_win32.window_dc);
+            temp_bitmap_dc = CreateCompatibleDC(g_win32.window_dc);
 
-        if(!temp_bitmap_dc)
-        {
-            WIN32_ERROR_LITERAL("Failed to create temporary device context for the bitmap.");
-        }
+            if(!temp_bitmap_dc)
+            {
+                WIN32_ERROR_LITERAL(
+                    "Failed to create temporary device context for the bitmap.");
+            }
 
-        if(!SelectObject(temp_bitmap_dc, temp_bitmap))
-        {
-            WIN32_ERROR_LITERAL(
-                "Failed to select the temporary bitmap into its respective device context.");
-        }
+            if(!SelectObject(temp_bitmap_dc, temp_bitmap))
+            {
+                WIN32_ERROR_LITERAL(
+                    "Failed to select the temporary bitmap into its respective device "
+                    "context.");
+            }
 
-        if(g_win32.bitmap_handle)
-        {
-            if(DeleteObject(g_win32.bitmap_handle) == 0)
+            if(g_win32.bitmap_handles[i])
             {
-                WIN32_WARNING_LITERAL(
-                    "Failed to delete the old bitmap. If you continue to "
-                    "resize the window, the system WILL run out of memory and crash.");
+                if(DeleteObject(g_win32.bitmap_handles[i]) == 0)
+                {
+                    WIN32_WARNING_LITERAL(
+                        "Failed to delete the old bitmap. If you continue to "
+                        "resize the window, the system WILL run out of memory and crash.");
+                }
             }
-        }
 
-        if(g_win32.bitmap_dc)
-        {
-            if(DeleteDC(g_win32.bitmap_dc) == 0)
+            if(g_win32.bitmap_dcs[i])
             {
-                WIN32_WARNING_LITERAL(
-                    "Failed to delete the old bitmap's device context. If you continue to "
-                    "resize the window, the system WILL run out of memory and crash.");
+                if(DeleteDC(g_win32.bitmap_dcs[i]) == 0)
+                {
+                    WIN32_WARNING_LITERAL(
+                        "Failed to delete the old bitmap's device context. If you continue "
+                        "to resize the window, the system WILL run out of memory and crash.");
+                }
             }
+
+            g_win32.bitmap_handles[i] = temp_bitmap;
+            g_win32.bitmap_dcs[i]     = temp_bitmap_dc;
+            g_win32.bitmap_pixels[i]  = temp_pixels;
+
+            // NOTE(leo): The pages of a DIB section are only mapped when first written to,
+            // which would be while rendering the first frame after the resize.
+            os_prefault(temp_pixels, back_buffer_size(&bitmap_layout));
+
+            BackBuffer *back_buffer = &back_buffers[i];
+
+            back_buffer->pixels = temp_pixels;
+            back_buffer->format = g_win32.back_buffer_format;
+            back_buffer_set_size(back_buffer, new_width, new_height, true);
+
+            if(back_buffer->format == BACK_BUFFER_BITPLANE)
+            {
+                b32 is_huge;
+
+                os_free_frame_memory(g_win32.bitplanes[i], g_win32.bitplanes_size);
+                g_win32.bitplanes[i] =
+                    os_allocate_frame_memory(back_buffer_size(back_buffer), &is_huge);
+
+                if(!g_win32.bitplanes[i])
+                {
+                    WIN32_ERROR_LITERAL("Failed to allocate the bitplane back buffer.");
+                }
+
+                back_buffer->pixels = g_win32.bitplanes[i];
+                game_set_bitplane_palette(back_buffer);
+            }
+
+            // NOTE(leo): 0.03f is an epsilon.
+            ASSERT((back_buffer->aspect_ratio >= (TARGET_ASPECT_RATIO - 0.03f))
+                   && (back_buffer->aspect_ratio <= (TARGET_ASPECT_RATIO + 0.03f)));
         }
 
-        g_win32.bitmap_handle = temp_bitmap;
-        g_win32.bitmap_dc     = temp_bitmap_dc;
-        g_back_buffer.pixels  = temp_pixels;
+        g_win32.bitplanes_size = back_buffer_size(&back_buffers[0]);
 
-        g_back_buffer.width        = new_width;
-        g_back_buffer.height       = new_height;
-        g_back_buffer.pixels_count = new_width * new_height;
-        g_back_buffer.aspect_ratio = (f32)new_width / (f32)new_height;
+        render_pipeline_set_back_buffers(&g_render_pipeline, back_buffers);
+        screenshot_pool_reserve(&g_screenshot_pool, &back_buffers[0]);
+    }
+}
 
-        // NOTE(leo): 0.03f is an epsilon.
-        ASSERT((g_back_buffer.aspect_ratio >= (TARGET_ASPECT_RATIO - 0.03f))
-               && (g_back_buffer.aspect_ratio <= (TARGET_ASPECT_RATIO + 0.03f)));
+// NOTE(leo): Writes <name>_<date>_<time>, with the local time, and returns its length.
+INTERNAL u32
+win32_format_timestamped_name(char *buffer, u32 capacity, char *name)
+{
+    SYSTEMTIME time;
+    GetLocalTime(&time);
+
+    // NOTE(leo): The formatter doesn't pad numbers, so the two digits fields are written a
+    // digit at a time.
+    return STR8_FORMAT_LITERAL(buffer,
+                               capacity,
+                               "%a_%u32%u32%u32%u32%u32_%u32%u32%u32%u32%u32%u32",
+                               name,
+                               (u32)time.wYear,
+                               (u32)time.wMonth / 10,
+                               (u32)time.wMonth % 10,
+                               (u32)time.wDay / 10,
+                               (u32)time.wDay % 10,
+                               (u32)time.wHour / 10,
+                               (u32)time.wHour % 10,
+                               (u32)time.wMinute / 10,
+                               (u32)time.wMinute % 10,
+                               (u32)time.wSecond / 10,
+                               (u32)time.wSecond % 10);
+}
+
+// NOTE(leo): Saves the frame as screenshot_<date>_<time>_<count>.png in the working
+// directory, like the session's replay. Returns false if it has to be taken again later.
+INTERNAL b32
+win32_capture_screenshot(BackBuffer *frame)
+{
+    char    path_buffer[SCREENSHOT_PATH_CAPACITY];
+    String8 path = {path_buffer, 0};
+    path.length  =
+        win32_format_timestamped_name(path_buffer, sizeof(path_buffer), "screenshot");
+    path.length += STR8_FORMAT_LITERAL(path_buffer + path.length,
+                                       sizeof(path_buffer) - path.length,
+                                       "_%u32.png",
+                                       g_win32.screenshots_count);
+
+    if(!screenshot_capture(&g_screenshot_pool, frame, path, SCREENSHOT_PNG))
+    {
+        return false;
     }
+
+    g_win32.screenshots_count++;
+
+    return true;
+}
+
+// NOTE(leo): Copies the newest rendered frame to the window. Returns false if there was no
+// frame to copy, otherwise sets presented_frame (if not NULL) to the frame's number.
+INTERNAL b32
+win32_present_frame(b32 can_repeat, u64 *presented_frame)
+{
+    s32 buffer = render_pipeline_acquire_frame(&g_render_pipeline, can_repeat);
+
+    if(buffer < 0)
+    {
+        return false;
+    }
+
+    BackBuffer *back_buffer = &g_render_pipeline.back_buffers[buffer];
+    b32         has_copied  = false;
+
+    u64 frame = __atomic_load_n(&g_render_pipeline.buffer_frames[buffer], __ATOMIC_RELAXED);
+
+    if(back_buffer->format == BACK_BUFFER_BITPLANE)
+    {
+        expand_bitplane(back_buffer, g_win32.bitmap_pixels[buffer], g_win32.bitmap_pitch);
+    }
+
+    if(back_buffer->width == g_win32.blit_width && back_buffer->height == g_win32.blit_height)
+    {
+        has_copied = BitBlt(g_win32.window_dc,
+                            g_win32.blit_dest_x,
+                            g_win32.blit_dest_y,
+                            back_buffer->width,
+                            back_buffer->height,
+                            g_win32.bitmap_dcs[buffer],
+                            0,
+                            0,
+                            SRCCOPY);
+    }
+    else
+    {
+        // NOTE(leo): Nearest neighbour, the stretch mode is set when the window is created.
+        has_copied = StretchBlt(g_win32.window_dc,
+                                g_win32.blit_dest_x,
+                                g_win32.blit_dest_y,
+                                g_win32.blit_width,
+                                g_win32.blit_height,
+                                g_win32.bitmap_dcs[buffer],
+                                0,
+                                0,
+                                back_buffer->width,
+                                back_buffer->height,
+                                SRCCOPY);
+    }
+
+    if(!has_copied)
+    {
+        WIN32_ERROR_LITERAL("Failed to copy the backbuffer to the program's window.");
+    }
+
+    // NOTE(leo): GDI can batch the copy. It has to be done before the render thread is
+    // allowed to draw into the bitmap again.
+    GdiFlush();
+
+    // NOTE(leo): From the back buffer, bitplanes are 32 times smaller to copy. When the pool
+    // is full, the request stays for a later frame.
+    if(g_win32.screenshot_frame && frame >= g_win32.screenshot_frame
+       && win32_capture_screenshot(back_buffer))
+    {
+        g_win32.screenshot_frame = 0;
+    }
+
+#ifdef VIDEO_RECORDING
+    // NOTE(leo): A frame painted again (for WM_PAINT) isn't a new one, its time goes to the
+    // next.
+    if(g_win32.is_recording_video && frame != g_win32.video_last_frame)
+    {
+        s64 now          = win32_get_cpu_tick();
+        u64 microseconds = 0;
+
+        if(g_win32.video_last_tick)
+        {
+            microseconds =
+                (u64)(win32_get_seconds_elapsed(g_win32.video_last_tick, now) * 1000000.0f);
+        }
+
+        video_recorder_add_frame(&g_video_recorder, back_buffer, microseconds);
+
+        g_win32.video_last_frame = frame;
+        g_win32.video_last_tick  = now;
+    }
+#endif // VIDEO_RECORDING
+
+#ifdef FRAME_EXPORT
+    // NOTE(leo): Bitplanes are published as they are, readers expand them if they want.
+    if(g_frame_export && frame != g_win32.frame_export_last_frame)
+    {
+        frame_export_publish(g_frame_export, back_buffer, frame);
+        g_win32.frame_export_last_frame = frame;
+    }
+#endif // FRAME_EXPORT
+
+    render_pipeline_release_frame(&g_render_pipeline, buffer);
+
+    if(presented_frame)
+    {
+        *presented_frame = frame;
+    }
+
+    return true;
+}
+
+// NOTE(leo): Resizes the back buffers to the blit size at the governor's scale.
+INTERNAL void
+win32_apply_render_resolution(void)
+{
+    s32 render_width;
+    s32 render_height;
+
+    resolution_governor_apply(&g_resolution_governor,
+                              g_win32.blit_width,
+                              g_win32.blit_height,
+                              &render_width,
+                              &render_height);
+
+    win32_resize_graphics(render_width, render_height);
 }
 
 INTERNAL void
@@ -427,7 +819,10 @@ win32_window_callback(HWND window_handle, UINT message, WPARAM w_param, LPARAM l
                         ((f32)client_height - (f32)height_to_render) / 2.0f);
                 }
 
-                win32_resize_graphics(width_to_render, height_to_render);
+                g_win32.blit_width  = width_to_render;
+                g_win32.blit_height = height_to_render;
+
+                win32_apply_render_resolution();
 
                 g_win32.last_client_width  = client_width;
                 g_win32.last_client_height = client_height;
@@ -453,23 +848,61 @@ win32_window_callback(HWND window_handle, UINT message, WPARAM w_param, LPARAM l
             else if(vk_code == 'W')
             {
                 g_is_key_down[KEY_W] = is_down;
+#ifdef LATENCY_MEASUREMENT
+                win32_latency_key_event(LATENCY_LEFT_PADDLE, is_down, was_down);
+#endif // LATENCY_MEASUREMENT
             }
             else if(vk_code == 'S')
             {
                 g_is_key_down[KEY_S] = is_down;
+#ifdef LATENCY_MEASUREMENT
+                win32_latency_key_event(LATENCY_LEFT_PADDLE, is_down, was_down);
+#endif // LATENCY_MEASUREMENT
             }
             else if(vk_code == VK_UP)
             {
                 g_is_key_down[KEY_UP] = is_down;
+#ifdef LATENCY_MEASUREMENT
+                win32_latency_key_event(LATENCY_RIGHT_PADDLE, is_down, was_down);
+#endif // LATENCY_MEASUREMENT
             }
             else if(vk_code == VK_DOWN)
             {
                 g_is_key_down[KEY_DOWN] = is_down;
+#ifdef LATENCY_MEASUREMENT
+                win32_latency_key_event(LATENCY_RIGHT_PADDLE, is_down, was_down);
+#endif // LATENCY_MEASUREMENT
             }
             else if(vk_code == VK_RETURN)
             {
                 g_is_key_down[KEY_ENTER] = is_down;
             }
+            // NOTE(leo): Holding these keys repeats them, which rewinds or fast-forwards.
+            else if(vk_code == VK_BACK && is_down)
+            {
+                g_rewind_requests.steps--;
+            }
+            else if(vk_code == VK_TAB && is_down)
+            {
+                g_rewind_requests.steps++;
+            }
+            else if(vk_code == 'R' && is_down && !was_down)
+            {
+                g_rewind_requests.instant_replay = true;
+            }
+            else if(vk_code == VK_SPACE && is_down && !was_down)
+            {
+                g_rewind_requests.resume = true;
+            }
+            else if(vk_code == VK_F9 && is_down && !was_down)
+            {
+                render_pipeline_set_post_processing(&g_render_pipeline,
+                                                    !g_render_pipeline.is_post_processing);
+            }
+            else if(vk_code == VK_F12 && is_down && !was_down)
+            {
+                g_win32.screenshot_frame = MAX(g_render_pipeline.frames_submitted, 1);
+            }
 #define KEY_UP(key) (vk_code == (key) && !is_down && was_down)
             else if((KEY_UP(VK_F4) && alt_is_down) || KEY_UP(VK_ESCAPE))
             {
@@ -500,20 +933,7 @@ win32_window_callback(HWND window_handle, UINT message, WPARAM w_param, LPARAM l
                                     "WM_PAINT message received.");
             }
 
-            if(BitBlt(g_win32.window_dc,
-                      g_win32.blit_dest_x,
-                      g_win32.blit_dest_y,
-                      g_back_buffer.width,
-                      g_back_buffer.height,
-                      g_win32.bitmap_dc,
-                      0,
-                      0,
-                      SRCCOPY)
-               == 0)
-            {
-                WIN32_ERROR_LITERAL(
-                    "Failed to copy new bitmap to window after WM_PAINT message received.");
-            }
+            win32_present_frame(true, NULL);
 
             EndPaint(window_handle, &paint);
             break;
@@ -619,6 +1039,14 @@ win32_create_window(void)
     {
         WIN32_ERROR_LITERAL("Failed to get program's window device context.");
     }
+
+    // NOTE(leo): The window class has CS_OWNDC, so this sticks. COLORONCOLOR is nearest
+    // neighbour, which keeps the rectangles sharp when the frames are stretched.
+    if(!SetStretchBltMode(g_win32.window_dc, COLORONCOLOR))
+    {
+        WIN32_WARNING_LITERAL("Failed to set the stretch mode of the window. Frames rendered "
+                              "at a lower resolution may look blurry.");
+    }
 }
 
 INTERNAL f32
@@ -643,28 +1071,6 @@ win32_get_monitor_refresh_rate(HWND window_handle)
     return (f32)display_mode.dmDisplayFrequency;
 }
 
-INTERNAL s64
-win32_get_cpu_tick(void)
-{
-    LARGE_INTEGER li_counter;
-
-    if(!QueryPerformanceCounter(&li_counter))
-    {
-        // NOTE(leo): According to MSDN, will never fail on Windows XP or later. We only
-        // ASSERT.
-        WIN32_ERROR_LITERAL("Failed to get performance counter. The MSDN docs lied to us!");
-    }
-    return li_counter.QuadPart;
-}
-
-INTERNAL f32
-win32_get_seconds_elapsed(s64 init_tick, s64 end_tick)
-{
-    s64 delta = end_tick - init_tick;
-    ASSERT(delta > 0);
-    return (f32)delta / g_cpu_ticks_per_second;
-}
-
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wunused-parameter"
 
@@ -951,6 +1357,177 @@ win32_init_sound_system(void)
     }
 }
 
+// NOTE(leo): Splits the command line on spaces, into slices of it. The program path may be
+// quoted, none of the arguments we accept need to be.
+INTERNAL u32
+win32_get_arguments(String8 *arguments, u32 arguments_capacity)
+{
+    char *at              = GetCommandLineA();
+    u32   arguments_count = 0;
+
+    while(*at && arguments_count < arguments_capacity)
+    {
+        while(*at == ' ' || *at == '\t')
+        {
+            at++;
+        }
+
+        if(!*at)
+        {
+            break;
+        }
+
+        char quote = 0;
+
+        if(*at == '"')
+        {
+            quote = *at++;
+        }
+
+        char *begin = at;
+
+        while(*at && (quote ? *at != quote : (*at != ' ' && *at != '\t')))
+        {
+            at++;
+        }
+
+        arguments[arguments_count++] = (String8) {begin, (u32)(at - begin)};
+
+        if(quote && *at)
+        {
+            at++;
+        }
+    }
+
+    return arguments_count;
+}
+
+// NOTE(leo): pong.exe --netplay <left|right> <local port> <remote address> <remote port>
+// Returns false if the program wasn't started for netplay.
+INTERNAL b32
+win32_init_netplay(NetplaySession *session,
+                   UdpSocket      *udp_socket,
+                   NetAddress     *remote_address,
+                   u64             rng_state,
+                   u64             rng_sequence)
+{
+    String8 arguments[8];
+    u32     arguments_count = win32_get_arguments(arguments, STATIC_ARRAY_LENGTH(arguments));
+
+    if(arguments_count < 2 || !str8_equals(arguments[1], STRING8_LITERAL("--netplay")))
+    {
+        return false;
+    }
+
+    u64 local_port;
+    u64 remote_port;
+    u32 local_player;
+
+    if(arguments_count == 6 && str8_equals(arguments[2], STRING8_LITERAL("left")))
+    {
+        local_player = NETPLAY_LEFT_PLAYER;
+    }
+    else if(arguments_count == 6 && str8_equals(arguments[2], STRING8_LITERAL("right")))
+    {
+        local_player = NETPLAY_RIGHT_PLAYER;
+    }
+    else
+    {
+        local_player = U32_MAX;
+    }
+
+    if(local_player == U32_MAX || !str8_parse_u64(arguments[3], &local_port)
+       || !netplay_parse_ipv4(arguments[4], &remote_address->ipv4)
+       || !str8_parse_u64(arguments[5], &remote_port) || local_port > U16_MAX
+       || remote_port > U16_MAX)
+    {
+        WIN32_ERROR_LITERAL("Usage: pong.exe --netplay <left|right> <local port> <remote "
+                            "address> <remote port>");
+    }
+
+    remote_address->port = (u16)remote_port;
+
+    if(!os_udp_open(udp_socket, (u16)local_port))
+    {
+        WIN32_ERROR_LITERAL("Failed to open UDP port %u64 for netplay.", local_port);
+    }
+
+    netplay_session_init(session, local_player, rng_state, rng_sequence);
+
+    return true;
+}
+
+// NOTE(leo): pong.exe --ai <easy|medium|hard> puts the CPU on the right paddle. Returns false
+// if the program wasn't started with an AI opponent.
+INTERNAL b32
+win32_init_ai(AiPlayer *ai, u64 rng_state, u64 rng_sequence)
+{
+    String8 arguments[8];
+    u32     arguments_count = win32_get_arguments(arguments, STATIC_ARRAY_LENGTH(arguments));
+
+    if(arguments_count < 2 || !str8_equals(arguments[1], STRING8_LITERAL("--ai")))
+    {
+        return false;
+    }
+
+    AiDifficulty difficulty;
+
+    if(arguments_count != 3 || !ai_difficulty_from_name(arguments[2], &difficulty))
+    {
+        WIN32_ERROR_LITERAL("Usage: pong.exe --ai <easy|medium|hard>");
+    }
+
+    ai_init(ai, true, difficulty, rng_state, rng_sequence);
+
+    return true;
+}
+
+// NOTE(leo): pong.exe --bot <left|right|both> [sync]
+// Returns NULL if the program wasn't started with bots. The keyboard doesn't move the paddles
+// the bots play.
+INTERNAL BotLink *
+win32_init_bot_link(void)
+{
+    String8 arguments[8];
+    u32     arguments_count = win32_get_arguments(arguments, STATIC_ARRAY_LENGTH(arguments));
+
+    if(arguments_count < 2 || !str8_equals(arguments[1], STRING8_LITERAL("--bot")))
+    {
+        return NULL;
+    }
+
+    b32 is_left_bot  = false;
+    b32 is_right_bot = false;
+
+    if(arguments_count >= 3)
+    {
+        is_left_bot  = str8_equals(arguments[2], STRING8_LITERAL("left"))
+                    || str8_equals(arguments[2], STRING8_LITERAL("both"));
+        is_right_bot = str8_equals(arguments[2], STRING8_LITERAL("right"))
+                    || str8_equals(arguments[2], STRING8_LITERAL("both"));
+    }
+
+    b32 is_tick_synchronous =
+        arguments_count == 4 && str8_equals(arguments[3], STRING8_LITERAL("sync"));
+
+    if((!is_left_bot && !is_right_bot) || (arguments_count == 4 && !is_tick_synchronous)
+       || arguments_count > 4)
+    {
+        WIN32_ERROR_LITERAL("Usage: pong.exe --bot <left|right|both> [sync]");
+    }
+
+    BotLink *link = os_shared_memory_open(BOT_LINK_DEFAULT_NAME, sizeof(BotLink), true);
+
+    if(!link)
+    {
+        WIN32_ERROR_LITERAL("Failed to create the shared memory for the bots.");
+    }
+
+    bot_link_host_init(link, is_left_bot, is_right_bot, is_tick_synchronous);
+
+    return link;
+}
+
 void
 WinMainCRTStartup(void)
 {
@@ -969,12 +1546,81 @@ WinMainCRTStartup(void)
 
     g_cpu_ticks_per_second = (f32)li_frequency.QuadPart;
 
+#ifdef BITPLANE_RENDERING
+    g_win32.back_buffer_format = BACK_BUFFER_BITPLANE;
+#endif // BITPLANE_RENDERING
+
+    // NOTE(leo): Before the window, since creating it already resizes the back buffers. With
+    // a single processor the render thread would only take turns with the main thread, so
+    // the frames are rendered when they are submitted. The post-process gets every processor
+    // but the main thread's.
+    u32 processors_count = os_get_processors_count();
+
+    if(!render_pipeline_init(&g_render_pipeline,
+                             processors_count > 1,
+                             MAX(processors_count, 2) - 1))
+    {
+        WIN32_ERROR_LITERAL("Failed to start the render thread.");
+    }
+
+#ifdef CRT_POST_PROCESS
+    render_pipeline_set_post_processing(&g_render_pipeline, true);
+#endif // CRT_POST_PROCESS
+
+    if(!screenshot_pool_init(&g_screenshot_pool))
+    {
+        WIN32_ERROR_LITERAL("Failed to start the screenshot thread.");
+    }
+
+#ifdef VIDEO_RECORDING
+    char video_path[256];
+    u32  video_path_length =
+        win32_format_timestamped_name(video_path, sizeof(video_path) - 5, "session");
+    memcpy(video_path + video_path_length, ".pvid", 6);
+
+    BackBuffer video_colors = {0};
+    game_set_bitplane_palette(&video_colors);
+
+    g_win32.is_recording_video =
+        video_recorder_open(&g_video_recorder, video_path, video_colors.palette);
+
+    if(!g_win32.is_recording_video)
+    {
+        WIN32_WARNING_LITERAL("Failed to start recording the session to %a.", video_path);
+    }
+#endif // VIDEO_RECORDING
+
+#ifdef FRAME_EXPORT
+    // NOTE(leo): The slots hold a 32-bit frame the size of the primary screen, the biggest
+    // the back buffers get in fullscreen. Frames of a window on a bigger screen are skipped.
+    BackBuffer biggest_frame = {0};
+    biggest_frame.format     = BACK_BUFFER_RGB;
+    back_buffer_set_size(&biggest_frame,
+                         GetSystemMetrics(SM_CXSCREEN),
+                         GetSystemMetrics(SM_CYSCREEN),
+                         true);
+
+    g_frame_export = frame_export_create(FRAME_EXPORT_DEFAULT_NAME,
+                                         FRAME_EXPORT_DEFAULT_SLOTS,
+                                         back_buffer_size(&biggest_frame));
+
+    if(!g_frame_export)
+    {
+        WIN32_WARNING_LITERAL("Failed to create the shared memory to export the frames.");
+    }
+#endif // FRAME_EXPORT
+
     win32_create_window();
     win32_init_sound_system();
 
     f32 refresh_rate         = win32_get_monitor_refresh_rate(g_win32.window_handle);
     f32 target_frame_seconds = 1.0f / refresh_rate;
 
+    // NOTE(leo): Rendering gets most of the frame, with or without a render thread the rest
+    // of the frame's work is small. The scale starts at 1.
+    resolution_governor_init(&g_resolution_governor,
+                             target_frame_seconds * RESOLUTION_GOVERNOR_FRAME_FRACTION);
+
     if(timeBeginPeriod(1) == TIMERR_NOCANDO)
     {
         WIN32_WARNING_LITERAL(
@@ -984,8 +1630,68 @@ WinMainCRTStartup(void)
 
     generate_game_sounds();
 
+    u64 rng_state    = __rdtsc() ^ (u64)&rng_state;
+    u64 rng_sequence = (u64)&memset;
+
     GameState game_state;
-    game_main(&game_state);
+    game_main(&game_state, rng_state, rng_sequence);
+
+    replay_recorder_init(&g_replay_recorder,
+                         REPLAY_RECORDER_CAPACITY,
+                         rng_state,
+                         rng_sequence);
+
+    RewindController rewind;
+    rewind_init(&rewind, &game_state);
+
+    // NOTE(leo): In netplay the match lives in the session and runs at the fixed netplay
+    // tick. It's neither recorded nor rewindable.
+    NetplaySession netplay;
+    UdpSocket      netplay_socket;
+    NetAddress     netplay_remote_address;
+    f32            netplay_tick_accumulator = 0.0f;
+    b32            has_reported_desync      = false;
+
+    b32 is_netplay = win32_init_netplay(&netplay,
+                                        &netplay_socket,
+                                        &netplay_remote_address,
+                                        rng_state,
+                                        rng_sequence);
+
+    GameState *simulated_state = is_netplay ? &netplay.game_state : &game_state;
+
+    AiPlayer ai;
+    b32      is_ai_playing = win32_init_ai(&ai, rng_state, rng_sequence + 1);
+
+    // NOTE(leo): The state is published after every tick, so the bots have a whole frame to
+    // answer before the next one.
+    u64 bot_tick       = 0;
+    u32 bot_actions[2] = {BOT_ACTION_STAY, BOT_ACTION_STAY};
+
+    // NOTE(leo): In tick synchronous mode, a bot that timed out has probably died. Waiting
+    // for it every tick would slow the match down to a crawl, so after the first time out
+    // its last action is kept unless it already answered, and the match goes on.
+    u64 bot_max_spins = BOT_LINK_DEFAULT_MAX_SPINS;
+
+    g_bot_link = win32_init_bot_link();
+
+    if(g_bot_link)
+    {
+        bot_link_publish(g_bot_link, &game_state, bot_tick);
+    }
+
+    // NOTE(leo): Without them there are no sparks and no trail, the game plays the same.
+    ParticleSystem particles;
+
+    if(!particles_init(&particles, GAME_PARTICLES_CAPACITY, rng_state)
+       || !render_pipeline_set_particles(&g_render_pipeline, &particles))
+    {
+        WIN32_WARNING_LITERAL("Failed to allocate the particles.");
+    }
+
+#ifdef LATENCY_MEASUREMENT
+    latency_meter_init(&g_latency_meter, g_cpu_ticks_per_second);
+#endif // LATENCY_MEASUREMENT
 
     // NOTE(leo): Setting to an aproximate value for the first frame.
     f32 last_frame_time_seconds = target_frame_seconds;
@@ -1005,13 +1711,222 @@ WinMainCRTStartup(void)
             DispatchMessageA(&msg);
         }
 
+        String8 overlay_text = {0};
+
 #ifdef DEVELOPMENT
         OS_PRINTF_LITERAL("Frame time (ms): %.2f (target: %.2f)\n",
                           last_frame_time_seconds * 1000.0f,
                           target_frame_seconds * 1000.0f);
+
+        char overlay_text_buffer[RENDER_OVERLAY_TEXT_CAPACITY];
+        overlay_text.data   = overlay_text_buffer;
+        overlay_text.length =
+            STR8_FORMAT_LITERAL(overlay_text_buffer,
+                                sizeof(overlay_text_buffer),
+                                "%.2f MS %u32/%u32",
+                                last_frame_time_seconds * 1000.0f,
+                                resolution_governor_scale(&g_resolution_governor),
+                                RESOLUTION_SCALE_DENOMINATOR);
+
+        if(g_render_pipeline.is_post_processing)
+        {
+            s64 pass_ticks[POST_PASSES_COUNT];
+            s64 post_ticks =
+                post_process_last_ticks(&g_render_pipeline.post_process, pass_ticks);
+
+            // NOTE(leo): The passes are added up over the post-process' threads.
+            OS_PRINTF_LITERAL("Post-process (ms): %.2f (%a %.2f, %a %.2f, %a %.2f)\n",
+                              (f32)post_ticks * 1000.0f / g_cpu_ticks_per_second,
+                              g_post_pass_names[POST_PASS_PERSISTENCE],
+                              (f32)pass_ticks[POST_PASS_PERSISTENCE] * 1000.0f
+                                  / g_cpu_ticks_per_second,
+                              g_post_pass_names[POST_PASS_BLOOM],
+                              (f32)pass_ticks[POST_PASS_BLOOM] * 1000.0f
+                                  / g_cpu_ticks_per_second,
+                              g_post_pass_names[POST_PASS_SCANLINES],
+                              (f32)pass_ticks[POST_PASS_SCANLINES] * 1000.0f
+                                  / g_cpu_ticks_per_second);
+
+            overlay_text.length +=
+                STR8_FORMAT_LITERAL(overlay_text_buffer + overlay_text.length,
+                                    sizeof(overlay_text_buffer) - overlay_text.length,
+                                    " CRT %.2f",
+                                    (f32)post_ticks * 1000.0f / g_cpu_ticks_per_second);
+        }
 #endif // DEVELOPMENT
 
-        game_update_and_render(&game_state, last_frame_time_seconds);
+#ifdef LATENCY_MEASUREMENT
+        latency_before_update(&g_latency_meter, simulated_state);
+#endif // LATENCY_MEASUREMENT
+
+        // NOTE(leo): Set when a tick was simulated this frame, so its sound is played.
+        b32 should_send_audio = false;
+
+        b32 was_match_started = simulated_state->match_started;
+
+        particles_update(&particles, last_frame_time_seconds);
+
+        if(is_netplay)
+        {
+            memset(&g_rewind_requests, 0, sizeof(g_rewind_requests));
+
+            for(;;)
+            {
+                NetplayPacket packet;
+                NetAddress    from;
+                u32           size =
+                    os_udp_receive(&netplay_socket, &from, &packet, sizeof(packet));
+
+                if(!size)
+                {
+                    break;
+                }
+
+                netplay_receive_packet(&netplay, &packet, size);
+            }
+
+            // NOTE(leo): The netplay tick doesn't depend on the refresh rate, so we run as
+            // many ticks as fit in the time that passed. A few at most, so a long hitch
+            // (or waiting for the other player) doesn't turn into a burst of ticks.
+            netplay_tick_accumulator += last_frame_time_seconds;
+
+            for(u32 ticks = 0; ticks < 4 && netplay_tick_accumulator >= NETPLAY_TICK_SECONDS;
+                ++ticks)
+            {
+                if(!netplay_advance(&netplay, netplay_input_from_keys(g_is_key_down)))
+                {
+                    break;
+                }
+
+                netplay_tick_accumulator -= NETPLAY_TICK_SECONDS;
+                if(netplay.game_state.collision_detected)
+                {
+                    should_send_audio = true;
+                }
+
+                game_spawn_particles(&netplay.game_state, &particles);
+            }
+
+            if(netplay_tick_accumulator > NETPLAY_TICK_SECONDS)
+            {
+                netplay_tick_accumulator = NETPLAY_TICK_SECONDS;
+            }
+
+            NetplayPacket packet;
+            u32           packet_size = netplay_build_packet(&netplay, &packet);
+            os_udp_send(&netplay_socket, netplay_remote_address, &packet, packet_size);
+
+            if(netplay.has_desync && !has_reported_desync)
+            {
+                OS_PRINTF_LITERAL("Netplay desync: the match diverged between ticks %u32 "
+                                  "and %u32.\n",
+                                  netplay.verified_ticks,
+                                  netplay.desync_tick);
+                has_reported_desync = true;
+            }
+
+            render_pipeline_submit(&g_render_pipeline, &netplay.game_state, overlay_text);
+        }
+        else
+        {
+            if(g_rewind_requests.instant_replay)
+            {
+                rewind_start_instant_replay(&rewind);
+            }
+
+            if(g_rewind_requests.steps)
+            {
+                rewind_step(&rewind, g_rewind_requests.steps);
+            }
+
+            if(g_rewind_requests.resume)
+            {
+                u64 ticks_back = rewind_resume(&rewind, &game_state);
+
+                if(ticks_back)
+                {
+                    replay_record_rewind(&g_replay_recorder, ticks_back, &game_state);
+
+                    if(is_ai_playing)
+                    {
+                        ai_reset(&ai);
+                    }
+
+                    if(g_bot_link)
+                    {
+                        bot_link_publish(g_bot_link, &game_state, ++bot_tick);
+                    }
+                }
+            }
+
+            memset(&g_rewind_requests, 0, sizeof(g_rewind_requests));
+
+            if(rewind_is_live(&rewind))
+            {
+                GameInput input;
+                memcpy(input.is_key_down, g_is_key_down, sizeof(g_is_key_down));
+
+                // NOTE(leo): The AI's keys are recorded like any other, so its matches
+                // replay without it.
+                if(is_ai_playing)
+                {
+                    ai_update(&ai, &game_state, last_frame_time_seconds, &input);
+                }
+
+                if(g_bot_link)
+                {
+                    if(!bot_link_gather_actions(g_bot_link,
+                                                bot_tick,
+                                                bot_max_spins,
+                                                bot_actions)
+                       && bot_max_spins > 1)
+                    {
+                        OS_PRINT_LITERAL("WARNING: A bot didn't answer in time, the game "
+                                         "won't wait for the bots anymore.\n");
+                        bot_max_spins = 1;
+                    }
+
+                    bot_link_apply_actions(g_bot_link, bot_actions, &input);
+                }
+
+                game_update(&game_state, &input, last_frame_time_seconds);
+                game_spawn_particles(&game_state, &particles);
+
+                if(g_bot_link)
+                {
+                    bot_link_publish(g_bot_link, &game_state, ++bot_tick);
+                }
+                replay_record_tick(&g_replay_recorder,
+                                   &input,
+                                   last_frame_time_seconds,
+                                   &game_state);
+                rewind_record_tick(&rewind, &game_state);
+
+                render_pipeline_submit(&g_render_pipeline, &game_state, overlay_text);
+
+                should_send_audio = game_state.collision_detected;
+            }
+            else
+            {
+                // NOTE(leo): The match is paused while we look at (or play back) its
+                // history.
+                render_pipeline_submit(&g_render_pipeline,
+                                       rewind_update_frame(&rewind),
+                                       overlay_text);
+            }
+        }
+
+#ifdef LATENCY_MEASUREMENT
+        latency_after_update(&g_latency_meter,
+                             simulated_state,
+                             g_render_pipeline.frames_submitted);
+#endif // LATENCY_MEASUREMENT
+
+        // NOTE(leo): A point was scored, the frame just submitted has the new score.
+        if(was_match_started && !simulated_state->match_started)
+        {
+            g_win32.screenshot_frame = g_render_pipeline.frames_submitted;
+        }
 
         f32 frame_work_seconds =
             win32_get_seconds_elapsed(frame_begin_tick, win32_get_cpu_tick());
@@ -1034,21 +1949,30 @@ WinMainCRTStartup(void)
             Sleep((DWORD)(ms_to_sleep - fine_tuning));
         }
 
-        if(BitBlt(g_win32.window_dc,
-                  g_win32.blit_dest_x,
-                  g_win32.blit_dest_y,
-                  g_back_buffer.width,
-                  g_back_buffer.height,
-                  g_win32.bitmap_dc,
-                  0,
-                  0,
-                  SRCCOPY)
-           == 0)
+        // NOTE(leo): With a render thread, this is the frame of the last tick, or the one
+        // before if it's still being rendered. Then there is nothing new to present.
+        u64 presented_frame;
+
+        if(win32_present_frame(false, &presented_frame))
         {
-            WIN32_ERROR_LITERAL("Failed to copy the backbuffer to the program's window.");
+#ifdef LATENCY_MEASUREMENT
+            latency_after_present(&g_latency_meter, win32_get_cpu_tick(), presented_frame);
+#endif // LATENCY_MEASUREMENT
+
+            f32 render_seconds =
+                (f32)render_pipeline_last_render_ticks(&g_render_pipeline)
+                / g_cpu_ticks_per_second;
+
+            if(resolution_governor_update(&g_resolution_governor, render_seconds))
+            {
+                win32_apply_render_resolution();
+            }
         }
 
-        game_send_audio();
+        if(should_send_audio)
+        {
+            game_send_audio(simulated_state);
+        }
 
         last_frame_time_seconds =
             win32_get_seconds_elapsed(frame_begin_tick, win32_get_cpu_tick());
@@ -1161,3 +2085,12 @@ malloc(size_t bytes_to_alloc)
 
     return HeapAlloc(GetProcessHeap(), 0, bytes_to_alloc);
 }
+
+void
+free(void *memory)
+{
+    if(memory)
+    {
+        HeapFree(GetProcessHeap(), 0, memory);
+    }
+}
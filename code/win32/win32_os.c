@@ -16,3 +16,422 @@ os_print(String8 to_print)
 
     OutputDebugStringA(to_print.data);
 }
+
+INTERNAL b32
+os_file_create(OsFile *file, char *file_path)
+{
+    // NOTE(leo): Others can read it while it's written, a recording can be watched while
+    // it's recorded.
+    HANDLE file_handle = CreateFileA(file_path,
+                                     GENERIC_WRITE,
+                                     FILE_SHARE_READ,
+                                     NULL,
+                                     CREATE_ALWAYS,
+                                     FILE_ATTRIBUTE_NORMAL,
+                                     NULL);
+
+    file->handle = (u64)file_handle;
+
+    return file_handle != INVALID_HANDLE_VALUE;
+}
+
+INTERNAL b32
+os_file_write(OsFile *file, void *data, u64 size)
+{
+    u8 *to_write = data;
+
+    while(size)
+    {
+        // NOTE(leo): WriteFile takes a DWORD, so files bigger than 4GB are written in
+        // chunks.
+        DWORD bytes_to_write = size > U32_MAX ? U32_MAX : (DWORD)size;
+        DWORD bytes_written;
+
+        if(!WriteFile((HANDLE)file->handle, to_write, bytes_to_write, &bytes_written, NULL)
+           || bytes_written != bytes_to_write)
+        {
+            return false;
+        }
+
+        to_write += bytes_written;
+        size -= bytes_written;
+    }
+
+    return true;
+}
+
+INTERNAL void
+os_file_close(OsFile *file)
+{
+    CloseHandle((HANDLE)file->handle);
+}
+
+INTERNAL b32
+os_write_entire_file(char *file_path, void *data, u64 size)
+{
+    OsFile file;
+
+    if(!os_file_create(&file, file_path))
+    {
+        return false;
+    }
+
+    b32 result = os_file_write(&file, data, size);
+    os_file_close(&file);
+
+    return result;
+}
+
+INTERNAL FileContents
+os_read_entire_file(char *file_path)
+{
+    FileContents result = {0};
+
+    HANDLE file_handle = CreateFileA(file_path,
+                                     GENERIC_READ,
+                                     FILE_SHARE_READ,
+                                     NULL,
+                                     OPEN_EXISTING,
+                                     FILE_ATTRIBUTE_NORMAL,
+                                     NULL);
+
+    if(file_handle != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER file_size;
+
+        if(GetFileSizeEx(file_handle, &file_size) && file_size.QuadPart > 0)
+        {
+            result.size = (u64)file_size.QuadPart;
+            result.data = malloc(result.size);
+
+            u8 *to_read = result.data;
+            u64 size    = result.size;
+
+            while(to_read && size)
+            {
+                DWORD bytes_to_read = size > U32_MAX ? U32_MAX : (DWORD)size;
+                DWORD bytes_read;
+
+                if(!ReadFile(file_handle, to_read, bytes_to_read, &bytes_read, NULL)
+                   || bytes_read != bytes_to_read)
+                {
+                    free(result.data);
+                    result.data = NULL;
+                    break;
+                }
+
+                to_read += bytes_read;
+                size -= bytes_read;
+            }
+
+            if(!result.data)
+            {
+                result.size = 0;
+            }
+        }
+
+        CloseHandle(file_handle);
+    }
+
+    return result;
+}
+
+INTERNAL b32
+os_udp_open(UdpSocket *udp_socket, u16 port)
+{
+    PERSISTENT b32 is_winsock_initialized = false;
+
+    memset(udp_socket, 0, sizeof(*udp_socket));
+
+    if(!is_winsock_initialized)
+    {
+        WSADATA wsa_data;
+
+        if(WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0)
+        {
+            return false;
+        }
+
+        is_winsock_initialized = true;
+    }
+
+    SOCKET socket_handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+    if(socket_handle == INVALID_SOCKET)
+    {
+        return false;
+    }
+
+    u_long is_non_blocking = 1;
+
+    struct sockaddr_in address = {0};
+    address.sin_family         = AF_INET;
+    address.sin_addr.s_addr    = htonl(INADDR_ANY);
+    address.sin_port           = htons(port);
+
+    int address_size = sizeof(address);
+
+    if(ioctlsocket(socket_handle, FIONBIO, &is_non_blocking) != 0
+       || bind(socket_handle, (struct sockaddr *)&address, sizeof(address)) != 0
+       || getsockname(socket_handle, (struct sockaddr *)&address, &address_size) != 0)
+    {
+        closesocket(socket_handle);
+        return false;
+    }
+
+    udp_socket->handle = (u64)socket_handle;
+    udp_socket->port   = ntohs(address.sin_port);
+
+    return true;
+}
+
+INTERNAL void
+os_udp_close(UdpSocket *udp_socket)
+{
+    closesocket((SOCKET)udp_socket->handle);
+    memset(udp_socket, 0, sizeof(*udp_socket));
+}
+
+INTERNAL b32
+os_udp_send(UdpSocket *udp_socket, NetAddress to, void *data, u32 size)
+{
+    struct sockaddr_in address = {0};
+    address.sin_family         = AF_INET;
+    address.sin_addr.s_addr    = htonl(to.ipv4);
+    address.sin_port           = htons(to.port);
+
+    int sent = sendto((SOCKET)udp_socket->handle,
+                      data,
+                      (int)size,
+                      0,
+                      (struct sockaddr *)&address,
+                      sizeof(address));
+
+    return sent == (int)size;
+}
+
+INTERNAL u32
+os_udp_receive(UdpSocket *udp_socket, NetAddress *from, void *buffer, u32 capacity)
+{
+    struct sockaddr_in address      = {0};
+    int                address_size = sizeof(address);
+
+    int received = recvfrom((SOCKET)udp_socket->handle,
+                            buffer,
+                            (int)capacity,
+                            0,
+                            (struct sockaddr *)&address,
+                            &address_size);
+
+    // NOTE(leo): WSAEWOULDBLOCK when there is nothing waiting, and WSAECONNRESET when the
+    // other side isn't listening yet. Both just mean there is nothing to read.
+    if(received <= 0)
+    {
+        return 0;
+    }
+
+    from->ipv4 = ntohl(address.sin_addr.s_addr);
+    from->port = ntohs(address.sin_port);
+
+    return (u32)received;
+}
+
+INTERNAL void *
+os_shared_memory_open(char *name, u64 size, b32 create)
+{
+    char path[256];
+    STR8_FORMAT_LITERAL(path, sizeof(path), "Local\\%a", name);
+
+    HANDLE mapping;
+
+    if(create)
+    {
+        mapping = CreateFileMappingA(INVALID_HANDLE_VALUE,
+                                     NULL,
+                                     PAGE_READWRITE,
+                                     (DWORD)(size >> 32),
+                                     (DWORD)size,
+                                     path);
+    }
+    else
+    {
+        mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, path);
+    }
+
+    if(!mapping)
+    {
+        return NULL;
+    }
+
+    void *memory = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+
+    // NOTE(leo): The view keeps the mapping alive, we don't need the handle anymore.
+    CloseHandle(mapping);
+
+    // NOTE(leo): A mapping that already existed isn't zeroed.
+    if(memory && create)
+    {
+        memset(memory, 0, size);
+    }
+
+    return memory;
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+
+INTERNAL void
+os_shared_memory_close(char *name, void *memory, u64 size, b32 remove)
+
+#pragma clang diagnostic pop
+{
+    // NOTE(leo): The name goes away with the last view of the mapping, there is nothing else
+    // to remove.
+    UnmapViewOfFile(memory);
+}
+
+INTERNAL void *
+os_allocate_frame_memory(u64 size, b32 *is_huge)
+{
+    SIZE_T large_page_size = GetLargePageMinimum();
+
+    // NOTE(leo): Large pages need the "Lock pages in memory" privilege, which few accounts
+    // have, so this mostly fails. They are always resident, there is nothing to prefault.
+    if(large_page_size)
+    {
+        u64   large_size = (size + large_page_size - 1) & ~(u64)(large_page_size - 1);
+        void *memory     = VirtualAlloc(NULL,
+                                        large_size,
+                                        MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                                        PAGE_READWRITE);
+
+        if(memory)
+        {
+            *is_huge = true;
+            return memory;
+        }
+    }
+
+    *is_huge = false;
+
+    void *memory = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+
+    if(memory)
+    {
+        os_prefault(memory, size);
+    }
+
+    return memory;
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+
+INTERNAL void
+os_free_frame_memory(void *memory, u64 size)
+
+#pragma clang diagnostic pop
+{
+    if(memory)
+    {
+        VirtualFree(memory, 0, MEM_RELEASE);
+    }
+}
+
+INTERNAL void
+os_yield_processor(void)
+{
+    SwitchToThread();
+}
+
+// NOTE(leo): QueryPerformanceCounter can't fail since Windows XP (see win32_get_cpu_tick).
+INTERNAL s64
+os_get_cpu_tick(void)
+{
+    LARGE_INTEGER li_counter;
+    QueryPerformanceCounter(&li_counter);
+
+    return li_counter.QuadPart;
+}
+
+INTERNAL u32
+os_get_processors_count(void)
+{
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+
+    return (u32)system_info.dwNumberOfProcessors;
+}
+
+INTERNAL DWORD WINAPI
+win32_thread_start(LPVOID parameter)
+{
+    OsThread *thread = parameter;
+    thread->proc(thread->parameter);
+
+    return 0;
+}
+
+INTERNAL b32
+os_thread_create(OsThread *thread, OsThreadProc *proc, void *parameter)
+{
+    thread->proc      = proc;
+    thread->parameter = parameter;
+
+    HANDLE handle = CreateThread(NULL, 0, win32_thread_start, thread, 0, NULL);
+
+    if(!handle)
+    {
+        return false;
+    }
+
+    thread->handle = (u64)handle;
+
+    return true;
+}
+
+INTERNAL void
+os_thread_join(OsThread *thread)
+{
+    WaitForSingleObject((HANDLE)thread->handle, INFINITE);
+    CloseHandle((HANDLE)thread->handle);
+}
+
+INTERNAL b32
+os_thread_set_affinity(OsThread *thread, u32 processor)
+{
+    HANDLE handle = thread ? (HANDLE)thread->handle : GetCurrentThread();
+
+    return processor < 64 && SetThreadAffinityMask(handle, (DWORD_PTR)1 << processor) != 0;
+}
+
+INTERNAL b32
+os_semaphore_init(OsSemaphore *semaphore, u32 initial_count)
+{
+    HANDLE handle = CreateSemaphoreA(NULL, (LONG)initial_count, 0x7FFFFFFF, NULL);
+
+    semaphore->handle = (u64)handle;
+
+    return handle != NULL;
+}
+
+INTERNAL void
+os_semaphore_destroy(OsSemaphore *semaphore)
+{
+    CloseHandle((HANDLE)semaphore->handle);
+}
+
+INTERNAL void
+os_semaphore_wait(OsSemaphore *semaphore)
+{
+    WaitForSingleObject((HANDLE)semaphore->handle, INFINITE);
+}
+
+INTERNAL void
+os_semaphore_signal(OsSemaphore *semaphore, u32 count)
+{
+    if(count)
+    {
+        ReleaseSemaphore((HANDLE)semaphore->handle, (LONG)count, NULL);
+    }
+}